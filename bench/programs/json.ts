@@ -0,0 +1,21 @@
+// JSON.parse and JSON.stringify of small records
+
+interface Item {
+    id: number;
+    name: string;
+    active: boolean;
+}
+
+let total: number = 0;
+let matches: number = 0;
+for (let i: number = 0; i < 50000; i = i + 1) {
+    const item: Item = JSON.parse("{\"id\": 7, \"name\": \"widget\", \"active\": true}");
+    total = total + item.id;
+    const text = JSON.stringify({ id: item.id, name: item.name, tags: { hot: item.active } });
+    if (text === "{\"id\":7,\"name\":\"widget\",\"tags\":{\"hot\":true}}") {
+        matches = matches + 1;
+    }
+}
+
+console.log(total);
+console.log(matches);
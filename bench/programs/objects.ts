@@ -0,0 +1,29 @@
+// Class instances, method calls and object literal property updates
+
+class Point {
+    x: number;
+    y: number;
+
+    constructor(x: number, y: number) {
+        this.x = x;
+        this.y = y;
+    }
+
+    add(other: Point): Point {
+        return new Point(this.x + other.x, this.y + other.y);
+    }
+}
+
+let acc = new Point(0, 0);
+for (let i: number = 0; i < 200000; i = i + 1) {
+    acc = acc.add(new Point(i, 1));
+}
+
+let counter = { count: 0, label: "counter" };
+for (let i: number = 0; i < 1000000; i = i + 1) {
+    counter.count = counter.count + 1;
+}
+
+console.log(acc.x);
+console.log(acc.y);
+console.log(counter.count);
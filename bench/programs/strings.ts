@@ -0,0 +1,30 @@
+// String building, number formatting and comparison
+
+function build(n: number): string {
+    let text: string = "";
+    for (let i: number = 0; i < n; i = i + 1) {
+        text = text + "item-" + i + ";";
+    }
+    return text;
+}
+
+let a = build(100000);
+let b = build(100000);
+
+let same: number = 0;
+for (let i: number = 0; i < 200; i = i + 1) {
+    if (a === b) {
+        same = same + 1;
+    }
+}
+
+let labels: number = 0;
+for (let i: number = 0; i < 200000; i = i + 1) {
+    const label = "n" + i;
+    if (label === "n199999") {
+        labels = labels + 1;
+    }
+}
+
+console.log(same);
+console.log(labels);
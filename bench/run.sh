@@ -0,0 +1,137 @@
+#!/bin/bash
+# Benchmark suite for Zaco
+#
+# Runs the runtime microbenchmarks (bench/runtime_bench.c) and compiles and
+# runs a set of TypeScript programs, printing one JSON object per line:
+#
+#   {"suite": "runtime", "name": "str_concat", ...}        per-operation times
+#   {"suite": "programs", "name": "fibonacci", ...}        compile and run times
+#
+# Program entries embed the `zaco compile --timings` report under "compile".
+#
+# Usage: bench/run.sh [--runtime-only | --programs-only] [output.jsonl]
+#
+# Environment:
+#   ZACO        zaco binary to use (default: build target/release/zaco)
+#   CC          C compiler for the microbenchmarks (default: cc)
+#   BENCH_RUNS  runs per program, best and median are reported (default: 5)
+#
+# The microbenchmarks link the runtime directly:
+#   cc -O2 bench/runtime_bench.c runtime/zaco_runtime.c \
+#      runtime/zaco_runtime_rs/target/release/libzaco_runtime_rs.a -lpthread -ldl -lm
+
+set -e
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+CC="${CC:-cc}"
+RUNS="${BENCH_RUNS:-5}"
+OUT_DIR="$(mktemp -d "${TMPDIR:-/tmp}/zaco-bench.XXXXXX")"
+trap 'rm -rf "$OUT_DIR"' EXIT
+
+run_runtime=1
+run_programs=1
+output=""
+for arg in "$@"; do
+    case "$arg" in
+        --runtime-only) run_programs=0 ;;
+        --programs-only) run_runtime=0 ;;
+        -h|--help) sed -n '2,21p' "$0" | sed 's/^# \{0,1\}//'; exit 0 ;;
+        *) output="$arg" ;;
+    esac
+done
+if [ -n "$output" ]; then
+    exec > "$output"
+fi
+
+# Programs: name and path relative to the repository root
+PROGRAMS=(
+    "fibonacci examples/fibonacci.ts"
+    "classes examples/classes.ts"
+    "modules examples/modules/simple_main.ts"
+    "strings bench/programs/strings.ts"
+    "json bench/programs/json.ts"
+    "objects bench/programs/objects.ts"
+)
+
+case "$(uname)" in
+    Darwin) SYSLIBS="-framework CoreFoundation -framework Security -lpthread -ldl" ;;
+    *) SYSLIBS="-lpthread -ldl -lm" ;;
+esac
+
+# Wall clock in microseconds
+now_us() {
+    if [ -n "$EPOCHREALTIME" ]; then
+        echo "${EPOCHREALTIME/[.,]/}"
+    else
+        echo $(( $(date +%s%N) / 1000 ))
+    fi
+}
+
+# "best median" of the numbers on stdin
+best_median() {
+    sort -n | awk '{ v[NR] = $1 } END { printf "%.3f %.3f", v[1], v[int((NR + 1) / 2)] }'
+}
+
+log() {
+    echo "$@" >&2
+}
+
+RUST_RUNTIME="$ROOT/runtime/zaco_runtime_rs/target/release/libzaco_runtime_rs.a"
+if [ ! -f "$RUST_RUNTIME" ]; then
+    log "Building Rust runtime..."
+    (cd "$ROOT/runtime/zaco_runtime_rs" && cargo build --release >&2)
+fi
+
+if [ "$run_runtime" = 1 ]; then
+    log "Building runtime microbenchmarks..."
+    "$CC" -O2 -o "$OUT_DIR/runtime_bench" "$ROOT/bench/runtime_bench.c" "$ROOT/runtime/zaco_runtime.c" \
+        "$RUST_RUNTIME" $SYSLIBS
+    "$OUT_DIR/runtime_bench"
+fi
+
+if [ "$run_programs" = 1 ]; then
+    if [ -z "$ZACO" ]; then
+        log "Building zaco..."
+        (cd "$ROOT" && cargo build --release -p zaco-driver >&2)
+        ZACO="$ROOT/target/release/zaco"
+    fi
+
+    # Programs are compiled from the repository root so the runtime is found.
+    # One throwaway build first fills the runtime archive cache, so the first
+    # program's compile time is not inflated by compiling the runtime.
+    cd "$ROOT"
+    "$ZACO" compile examples/hello.ts -o "$OUT_DIR/hello" > /dev/null 2>&1 || true
+    for entry in "${PROGRAMS[@]}"; do
+        read -r name source <<< "$entry"
+        exe="$OUT_DIR/$name"
+        timings="$OUT_DIR/$name.timings.json"
+        log "Benchmarking $name..."
+
+        start=$(now_us)
+        if ! "$ZACO" compile "$source" -o "$exe" -O2 --no-cache --timings "$timings" > /dev/null 2> "$OUT_DIR/$name.err"; then
+            log "  compile failed: $(head -n 3 "$OUT_DIR/$name.err")"
+            echo "{\"suite\": \"programs\", \"name\": \"$name\", \"source\": \"$source\", \"ok\": false, \"stage\": \"compile\"}"
+            continue
+        fi
+        compile_ms=$(awk -v us=$(( $(now_us) - start )) 'BEGIN { printf "%.3f", us / 1000 }')
+
+        ok=true
+        samples=""
+        for _ in $(seq "$RUNS"); do
+            start=$(now_us)
+            if ! "$exe" > /dev/null 2>&1; then
+                ok=false
+            fi
+            samples="$samples$(( $(now_us) - start ))"$'\n'
+        done
+        if [ "$ok" = false ]; then
+            log "  $name exited with an error"
+        fi
+        read -r run_best run_median <<< "$(printf '%s' "$samples" | awk 'NF { print $1 / 1000 }' | best_median)"
+        bytes=$(wc -c < "$exe" | tr -d ' ')
+
+        echo "{\"suite\": \"programs\", \"name\": \"$name\", \"source\": \"$source\", \"ok\": $ok," \
+             "\"compile_ms\": $compile_ms, \"runs\": $RUNS, \"run_best_ms\": $run_best, \"run_median_ms\": $run_median," \
+             "\"binary_bytes\": $bytes, \"compile\": $(tr -s ' \n' ' ' < "$timings")}"
+    done
+fi
@@ -0,0 +1,329 @@
+// Microbenchmarks for the runtime primitives compiled code calls most
+//
+// Each benchmark runs a fixed number of operations several times and prints
+// one JSON object per line with the best and median time per operation:
+//
+//   {"suite": "runtime", "name": "str_concat", "ops": 200000, "runs": 7, "best_ns": 21.4, "median_ns": 22.0}
+//
+// Build and run through bench/run.sh, or by hand (see the top of run.sh for
+// the link line). Pass benchmark names to run a subset.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// C runtime (runtime/zaco_runtime.c)
+extern void* zaco_alloc(int64_t size);
+extern void zaco_free(void* data_ptr);
+extern void zaco_rc_inc(void* data_ptr);
+extern void zaco_rc_dec(void* data_ptr);
+
+extern void* zaco_str_new(const char* s);
+extern void* zaco_str_concat(void* a, void* b);
+extern int64_t zaco_str_len(void* s);
+extern int64_t zaco_str_eq(void* a, void* b);
+extern void* zaco_str_slice(void* s, int64_t start, int64_t end);
+extern int64_t zaco_str_index_of(void* s, void* search);
+extern void* zaco_str_split(void* s, void* separator);
+extern void* zaco_i64_to_str(int64_t n);
+extern void* zaco_f64_to_str(double n);
+extern void* zaco_strbuf_new(void* init);
+extern void zaco_strbuf_append(void* builder, void* s);
+extern void* zaco_strbuf_finish(void* builder);
+
+extern void* zaco_object_new(void);
+extern void zaco_object_set_f64(void* o, const char* key, double value);
+extern void zaco_object_set_str(void* o, const char* key, const char* value);
+extern double zaco_object_get_f64(void* o, const char* key);
+extern void zaco_object_free(void* o);
+
+extern void* zaco_array_new(int64_t elem_size, int64_t initial_capacity);
+extern void zaco_array_push_f64(void* arr, double value);
+extern double zaco_array_get_f64(void* arr, int64_t index);
+extern void* zaco_array_get_ptr(void* arr, int64_t index);
+extern int64_t zaco_array_length(void* arr);
+extern void zaco_array_destroy(void* array_ptr);
+
+extern void* zaco_json_parse(void* json_str);
+extern void zaco_json_free(void* value);
+extern void* zaco_json_stringify(void* value);
+
+#define RUNS 7
+
+// Results are folded into this so the work cannot be optimized away
+static volatile uint64_t sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// ========== Allocation and reference counting ==========
+
+static void bench_alloc_free(int64_t ops) {
+    for (int64_t i = 0; i < ops; i++) {
+        void* p = zaco_alloc(32);
+        sink += (uintptr_t)p;
+        zaco_free(p);
+    }
+}
+
+static void bench_rc_inc_dec(int64_t ops) {
+    void* s = zaco_str_new("a heap string for refcounting");
+    for (int64_t i = 0; i < ops; i++) {
+        zaco_rc_inc(s);
+        zaco_rc_dec(s);
+    }
+    zaco_rc_dec(s);
+}
+
+// ========== Strings ==========
+
+static void bench_str_new(int64_t ops) {
+    for (int64_t i = 0; i < ops; i++) {
+        void* s = zaco_str_new("hello, world");
+        sink += zaco_str_len(s);
+        zaco_rc_dec(s);
+    }
+}
+
+static void bench_str_concat(int64_t ops) {
+    void* a = zaco_str_new("user:");
+    void* b = zaco_str_new("1234567");
+    for (int64_t i = 0; i < ops; i++) {
+        void* s = zaco_str_concat(a, b);
+        sink += zaco_str_len(s);
+        zaco_rc_dec(s);
+    }
+    zaco_rc_dec(a);
+    zaco_rc_dec(b);
+}
+
+static void bench_str_eq(int64_t ops) {
+    void* a = zaco_str_new("the quick brown fox jumps over the lazy dog");
+    void* b = zaco_str_new("the quick brown fox jumps over the lazy dog");
+    for (int64_t i = 0; i < ops; i++) {
+        sink += zaco_str_eq(a, b);
+    }
+    zaco_rc_dec(a);
+    zaco_rc_dec(b);
+}
+
+static void bench_str_slice(int64_t ops) {
+    void* s = zaco_str_new("the quick brown fox jumps over the lazy dog");
+    for (int64_t i = 0; i < ops; i++) {
+        void* part = zaco_str_slice(s, 4, 19);
+        sink += zaco_str_len(part);
+        zaco_rc_dec(part);
+    }
+    zaco_rc_dec(s);
+}
+
+static void bench_str_index_of(int64_t ops) {
+    void* s = zaco_str_new("GET /api/v1/users?id=42&fields=name,email HTTP/1.1");
+    void* needle = zaco_str_new("fields=");
+    for (int64_t i = 0; i < ops; i++) {
+        sink += zaco_str_index_of(s, needle);
+    }
+    zaco_rc_dec(s);
+    zaco_rc_dec(needle);
+}
+
+// One op is splitting an 8-field line and releasing the parts
+static void bench_str_split(int64_t ops) {
+    void* s = zaco_str_new("alpha,beta,gamma,delta,epsilon,zeta,eta,theta");
+    void* sep = zaco_str_new(",");
+    for (int64_t i = 0; i < ops; i++) {
+        void* parts = zaco_str_split(s, sep);
+        int64_t n = zaco_array_length(parts);
+        for (int64_t j = 0; j < n; j++) {
+            zaco_rc_dec(zaco_array_get_ptr(parts, j));
+        }
+        sink += n;
+        zaco_array_destroy(parts);
+    }
+    zaco_rc_dec(s);
+    zaco_rc_dec(sep);
+}
+
+static void bench_i64_to_str(int64_t ops) {
+    for (int64_t i = 0; i < ops; i++) {
+        void* s = zaco_i64_to_str(100000 + i);
+        sink += zaco_str_len(s);
+        zaco_rc_dec(s);
+    }
+}
+
+static void bench_f64_to_str(int64_t ops) {
+    for (int64_t i = 0; i < ops; i++) {
+        void* s = zaco_f64_to_str((double)i + 0.25);
+        sink += zaco_str_len(s);
+        zaco_rc_dec(s);
+    }
+}
+
+// One op is one append; the builder is finished every 1000 appends
+static void bench_strbuf_append(int64_t ops) {
+    void* piece = zaco_str_new("item;");
+    void* sb = zaco_strbuf_new(NULL);
+    for (int64_t i = 0; i < ops; i++) {
+        zaco_strbuf_append(sb, piece);
+        if (i % 1000 == 999) {
+            void* s = zaco_strbuf_finish(sb);
+            sink += zaco_str_len(s);
+            zaco_rc_dec(s);
+            sb = zaco_strbuf_new(NULL);
+        }
+    }
+    zaco_rc_dec(zaco_strbuf_finish(sb));
+    zaco_rc_dec(piece);
+}
+
+// ========== Objects ==========
+
+// One op is building a 4-property object, reading it back and freeing it
+static void bench_object_build(int64_t ops) {
+    for (int64_t i = 0; i < ops; i++) {
+        void* o = zaco_object_new();
+        zaco_object_set_f64(o, "x", 1.0);
+        zaco_object_set_f64(o, "y", 2.0);
+        zaco_object_set_f64(o, "z", 3.0);
+        zaco_object_set_str(o, "label", "point");
+        sink += (int64_t)(zaco_object_get_f64(o, "x") + zaco_object_get_f64(o, "z"));
+        zaco_object_free(o);
+    }
+}
+
+static void bench_object_get(int64_t ops) {
+    void* o = zaco_object_new();
+    zaco_object_set_f64(o, "id", 1.0);
+    zaco_object_set_f64(o, "width", 2.0);
+    zaco_object_set_f64(o, "height", 3.0);
+    zaco_object_set_f64(o, "depth", 4.0);
+    for (int64_t i = 0; i < ops; i++) {
+        sink += (int64_t)zaco_object_get_f64(o, "height");
+    }
+    zaco_object_free(o);
+}
+
+static void bench_object_set(int64_t ops) {
+    void* o = zaco_object_new();
+    zaco_object_set_f64(o, "id", 1.0);
+    zaco_object_set_f64(o, "count", 0.0);
+    for (int64_t i = 0; i < ops; i++) {
+        zaco_object_set_f64(o, "count", (double)i);
+    }
+    sink += (int64_t)zaco_object_get_f64(o, "count");
+    zaco_object_free(o);
+}
+
+// ========== Arrays ==========
+
+// One op is one push plus one get; arrays grow to 1000 elements
+static void bench_array_push_get(int64_t ops) {
+    void* arr = zaco_array_new(8, 0);
+    for (int64_t i = 0; i < ops; i++) {
+        zaco_array_push_f64(arr, (double)i);
+        sink += (int64_t)zaco_array_get_f64(arr, zaco_array_length(arr) / 2);
+        if (zaco_array_length(arr) == 1000) {
+            zaco_array_destroy(arr);
+            arr = zaco_array_new(8, 0);
+        }
+    }
+    zaco_array_destroy(arr);
+}
+
+// ========== JSON ==========
+
+static const char* json_doc =
+    "{\"id\": 1042, \"name\": \"widget\", \"price\": 19.95, \"active\": true,"
+    " \"tags\": [\"tools\", \"metal\", \"sale\"], \"dims\": {\"w\": 10, \"h\": 4.5, \"d\": 2},"
+    " \"stock\": [12, 0, 7, 31, 5], \"note\": null}";
+
+static void bench_json_parse(int64_t ops) {
+    void* text = zaco_str_new(json_doc);
+    for (int64_t i = 0; i < ops; i++) {
+        void* doc = zaco_json_parse(text);
+        sink += (uintptr_t)doc;
+        zaco_json_free(doc);
+    }
+    zaco_rc_dec(text);
+}
+
+static void* json_value;
+
+static void bench_json_stringify(int64_t ops) {
+    for (int64_t i = 0; i < ops; i++) {
+        void* s = zaco_json_stringify(json_value);
+        sink += zaco_str_len(s);
+        zaco_rc_dec(s);
+    }
+}
+
+typedef struct {
+    const char* name;
+    void (*run)(int64_t ops);
+    int64_t ops;
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"alloc_free", bench_alloc_free, 1000000},
+    {"rc_inc_dec", bench_rc_inc_dec, 5000000},
+    {"str_new", bench_str_new, 1000000},
+    {"str_concat", bench_str_concat, 1000000},
+    {"str_eq", bench_str_eq, 5000000},
+    {"str_slice", bench_str_slice, 1000000},
+    {"str_index_of", bench_str_index_of, 1000000},
+    {"str_split", bench_str_split, 100000},
+    {"i64_to_str", bench_i64_to_str, 1000000},
+    {"f64_to_str", bench_f64_to_str, 1000000},
+    {"strbuf_append", bench_strbuf_append, 2000000},
+    {"object_build", bench_object_build, 500000},
+    {"object_get", bench_object_get, 5000000},
+    {"object_set", bench_object_set, 5000000},
+    {"array_push_get", bench_array_push_get, 2000000},
+    {"json_parse", bench_json_parse, 20000},
+    {"json_stringify", bench_json_stringify, 200000},
+};
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static int selected(const char* name, int argc, char** argv) {
+    if (argc < 2) return 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    json_value = zaco_json_parse(zaco_str_new(json_doc));
+
+    for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+        const Benchmark* bench = &benchmarks[b];
+        if (!selected(bench->name, argc, argv)) continue;
+
+        // Warm up caches, the allocator's free lists and lazy tables
+        bench->run(bench->ops / 10 + 1);
+
+        double per_op[RUNS];
+        for (int r = 0; r < RUNS; r++) {
+            double start = now_ns();
+            bench->run(bench->ops);
+            per_op[r] = (now_ns() - start) / (double)bench->ops;
+        }
+        qsort(per_op, RUNS, sizeof(per_op[0]), cmp_double);
+        printf("{\"suite\": \"runtime\", \"name\": \"%s\", \"ops\": %lld, \"runs\": %d, "
+               "\"best_ns\": %.2f, \"median_ns\": %.2f}\n",
+               bench->name, (long long)bench->ops, RUNS, per_op[0], per_op[RUNS / 2]);
+        fflush(stdout);
+    }
+    zaco_json_free(json_value);
+    return sink == 42 ? 1 : 0;
+}
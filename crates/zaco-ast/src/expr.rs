@@ -58,12 +58,13 @@ pub enum Expr {
     /// Object literal: { key1: value1, key2: value2 }
     Object(Vec<ObjectProperty>),
 
-    /// Arrow function: (params) => body
+    /// Arrow function: async? (params) => body
     Arrow {
         type_params: Option<Vec<TypeParam>>,
         params: Vec<Param>,
         return_type: Option<Box<Node<Type>>>,
         body: ArrowBody,
+        is_async: bool,
     },
 
     /// Function expression: function name?(params) { body }
@@ -175,7 +176,7 @@ pub enum Expr {
 #[derive(Debug, Clone, PartialEq)]
 pub enum Literal {
     Number(f64),
-    String(String),
+    String(Symbol),
     Boolean(bool),
     Null,
     Undefined,
@@ -47,12 +47,12 @@ impl<T> Node<T> {
 /// Identifier
 #[derive(Debug, Clone, PartialEq, Eq, Hash)]
 pub struct Ident {
-    pub name: String,
+    pub name: Symbol,
 }
 
 impl Ident {
-    pub fn new(name: impl Into<String>) -> Self {
-        Self { name: name.into() }
+    pub fn new(name: impl AsRef<str>) -> Self {
+        Self { name: Symbol::intern(name.as_ref()) }
     }
 }
 
@@ -101,6 +101,7 @@ pub struct Ownership {
 // Module Declarations
 // =============================================================================
 
+pub mod symbol;
 pub mod types;
 pub mod expr;
 pub mod stmt;
@@ -111,6 +112,7 @@ pub mod module;
 // Re-exports (critical for maintaining backward compatibility)
 // =============================================================================
 
+pub use symbol::Symbol;
 pub use types::*;
 pub use expr::*;
 pub use stmt::*;
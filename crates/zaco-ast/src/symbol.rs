@@ -0,0 +1,190 @@
+//! Interned strings
+//!
+//! Identifiers and string literals are interned once, when the parser
+//! creates them, into a process-wide table shared by every later phase.
+//! A [`Symbol`] is a reference to the table's single copy of its text, so
+//! symbols copy for free and compare and hash by address instead of by
+//! contents. Interned text lives for the rest of the process.
+
+use std::collections::hash_map::DefaultHasher;
+use std::collections::HashSet;
+use std::fmt;
+use std::hash::{Hash, Hasher};
+use std::ops::Deref;
+use std::sync::{Mutex, OnceLock};
+
+/// Independent locks, so threads parsing different modules rarely contend.
+const SHARDS: usize = 16;
+
+fn shards() -> &'static [Mutex<HashSet<&'static str>>; SHARDS] {
+    static TABLE: OnceLock<[Mutex<HashSet<&'static str>>; SHARDS]> = OnceLock::new();
+    TABLE.get_or_init(|| std::array::from_fn(|_| Mutex::new(HashSet::new())))
+}
+
+/// An interned string.
+#[derive(Clone, Copy)]
+pub struct Symbol(&'static str);
+
+impl Symbol {
+    /// The symbol for `text`, interning it on first use.
+    pub fn intern(text: &str) -> Symbol {
+        let mut hasher = DefaultHasher::new();
+        text.hash(&mut hasher);
+        let shard = &shards()[hasher.finish() as usize % SHARDS];
+        let mut set = shard.lock().unwrap_or_else(|e| e.into_inner());
+        if let Some(&interned) = set.get(text) {
+            return Symbol(interned);
+        }
+        let interned: &'static str = Box::leak(text.to_owned().into_boxed_str());
+        set.insert(interned);
+        Symbol(interned)
+    }
+
+    pub fn as_str(self) -> &'static str {
+        self.0
+    }
+}
+
+impl Deref for Symbol {
+    type Target = str;
+
+    fn deref(&self) -> &str {
+        self.0
+    }
+}
+
+impl AsRef<str> for Symbol {
+    fn as_ref(&self) -> &str {
+        self.0
+    }
+}
+
+impl PartialEq for Symbol {
+    fn eq(&self, other: &Symbol) -> bool {
+        std::ptr::eq(self.0, other.0)
+    }
+}
+
+impl Eq for Symbol {}
+
+impl Hash for Symbol {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        (self.0.as_ptr() as usize).hash(state);
+    }
+}
+
+/// Ordered by text, so sorted output does not depend on interning order.
+impl PartialOrd for Symbol {
+    fn partial_cmp(&self, other: &Symbol) -> Option<std::cmp::Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for Symbol {
+    fn cmp(&self, other: &Symbol) -> std::cmp::Ordering {
+        if self == other {
+            std::cmp::Ordering::Equal
+        } else {
+            self.0.cmp(other.0)
+        }
+    }
+}
+
+impl PartialEq<str> for Symbol {
+    fn eq(&self, other: &str) -> bool {
+        self.0 == other
+    }
+}
+
+impl PartialEq<&str> for Symbol {
+    fn eq(&self, other: &&str) -> bool {
+        self.0 == *other
+    }
+}
+
+impl PartialEq<String> for Symbol {
+    fn eq(&self, other: &String) -> bool {
+        self.0 == other.as_str()
+    }
+}
+
+impl PartialEq<Symbol> for String {
+    fn eq(&self, other: &Symbol) -> bool {
+        self.as_str() == other.0
+    }
+}
+
+impl PartialEq<Symbol> for &str {
+    fn eq(&self, other: &Symbol) -> bool {
+        *self == other.0
+    }
+}
+
+impl From<&str> for Symbol {
+    fn from(text: &str) -> Symbol {
+        Symbol::intern(text)
+    }
+}
+
+impl From<String> for Symbol {
+    fn from(text: String) -> Symbol {
+        Symbol::intern(&text)
+    }
+}
+
+impl From<Symbol> for String {
+    fn from(symbol: Symbol) -> String {
+        symbol.0.to_owned()
+    }
+}
+
+impl fmt::Debug for Symbol {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        fmt::Debug::fmt(self.0, f)
+    }
+}
+
+impl fmt::Display for Symbol {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.write_str(self.0)
+    }
+}
+
+impl Default for Symbol {
+    fn default() -> Symbol {
+        Symbol::intern("")
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_interning_is_by_content() {
+        let a = Symbol::intern("value");
+        let b = Symbol::intern(&String::from("value"));
+        assert_eq!(a, b);
+        assert!(std::ptr::eq(a.as_str(), b.as_str()));
+        assert_ne!(a, Symbol::intern("other"));
+        assert_eq!(a, "value");
+        assert_eq!(a.len(), 5);
+    }
+
+    #[test]
+    fn test_interning_across_threads() {
+        let symbols: Vec<Symbol> = std::thread::scope(|scope| {
+            let handles: Vec<_> = (0..4).map(|_| scope.spawn(|| Symbol::intern("shared_name"))).collect();
+            handles.into_iter().map(|h| h.join().unwrap()).collect()
+        });
+        assert!(symbols.windows(2).all(|w| w[0] == w[1]));
+    }
+
+    #[test]
+    fn test_order_follows_text() {
+        let mut symbols = vec![Symbol::intern("b"), Symbol::intern("a"), Symbol::intern("c")];
+        symbols.sort();
+        assert_eq!(symbols, ["a", "b", "c"].map(Symbol::intern));
+        assert_eq!(format!("{:?} {}", symbols[0], symbols[0]), "\"a\" a");
+    }
+}
@@ -12,16 +12,33 @@ pub use error::CodegenError;
 use cranelift::prelude::*;
 use cranelift_module::{DataDescription, FuncId as ClifFuncId, Linkage, Module};
 use cranelift_object::{ObjectBuilder, ObjectModule};
-use std::collections::HashMap;
+use std::collections::{BTreeSet, HashMap};
+use std::ops::Range;
 
 // Import from zaco_ir with explicit names to avoid conflicts
 use zaco_ir::{
-    FuncId, IrFunction, IrModule, IrType,
+    Constant, FuncId, IrFunction, IrModule, IrType,
 };
+use zaco_ir::opt::OptLevel;
 
 use crate::runtime::{RuntimeFunctions, declare_runtime_functions};
 use crate::translator::FunctionTranslator;
 
+/// A slice of a merged module that is compiled into its own object file.
+///
+/// The driver emits one unit per source module so units can be compiled
+/// concurrently and unchanged modules' objects reused. Functions and globals
+/// outside the unit are declared as imports and resolved by the linker;
+/// non-exported symbols defined in the unit get hidden visibility so sibling
+/// objects of the same program can still reference them.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct CodegenUnit {
+    /// Indices into `IrModule::functions` defined by this unit
+    pub functions: Range<usize>,
+    /// Indices into `IrModule::globals` defined by this unit
+    pub globals: Range<usize>,
+}
+
 /// Main code generator that translates Zaco IR to native code via Cranelift
 pub struct CodeGenerator {
     /// Cranelift object module for producing object files
@@ -38,11 +55,26 @@ pub struct CodeGenerator {
     runtime_funcs: RuntimeFunctions,
     /// String literal data IDs
     string_data_map: HashMap<usize, cranelift_module::DataId>,
+    /// Module global data IDs, by global name
+    global_data_map: HashMap<String, cranelift_module::DataId>,
+    /// Code size of each function compiled so far, in compilation order
+    code_sizes: Vec<(FuncId, u32)>,
 }
 
+/// Section listing compiled functions for the runtime's perf map; its
+/// entries are `{ addr, size, name }` (see `zaco_profile_start`).
+const PERF_MAP_SECTION: &str = "zaco_perf_map";
+
 impl CodeGenerator {
     /// Create a new code generator with native target configuration
     pub fn new() -> Result<Self, CodegenError> {
+        Self::with_opt_level(OptLevel::O0)
+    }
+
+    /// Create a code generator whose Cranelift `opt_level` follows `level`:
+    /// `-O0` compiles fastest, `-O1`/`-O2` optimize for speed and `-Os` for
+    /// speed and size.
+    pub fn with_opt_level(level: OptLevel) -> Result<Self, CodegenError> {
         // Get native target triple
         let _triple = target_lexicon::Triple::host();
 
@@ -55,6 +87,14 @@ impl CodeGenerator {
         flag_builder
             .set("is_pic", "true")
             .map_err(|e| CodegenError::new(format!("Failed to set is_pic: {}", e)))?;
+        let opt_level = match level {
+            OptLevel::O0 => "none",
+            OptLevel::O1 | OptLevel::O2 => "speed",
+            OptLevel::Os => "speed_and_size",
+        };
+        flag_builder
+            .set("opt_level", opt_level)
+            .map_err(|e| CodegenError::new(format!("Failed to set opt_level: {}", e)))?;
 
         let isa = isa_builder
             .finish(settings::Flags::new(flag_builder))
@@ -82,29 +122,82 @@ impl CodeGenerator {
             func_id_map: HashMap::new(),
             runtime_funcs: RuntimeFunctions::default(),
             string_data_map: HashMap::new(),
+            global_data_map: HashMap::new(),
+            code_sizes: Vec::new(),
         })
     }
 
     /// Compile a complete IR module to object file bytes
-    pub fn compile_module(mut self, ir_module: &IrModule) -> Result<Vec<u8>, CodegenError> {
+    pub fn compile_module(self, ir_module: &IrModule) -> Result<Vec<u8>, CodegenError> {
+        self.compile(ir_module, None)
+    }
+
+    /// Compile one unit of a merged IR module to object file bytes.
+    ///
+    /// Linking the objects of every unit covering `ir_module` yields the same
+    /// program as linking the output of [`CodeGenerator::compile_module`].
+    pub fn compile_unit(
+        self,
+        ir_module: &IrModule,
+        unit: &CodegenUnit,
+    ) -> Result<Vec<u8>, CodegenError> {
+        if unit.functions.end > ir_module.functions.len() || unit.globals.end > ir_module.globals.len() {
+            return Err(CodegenError::new("Codegen unit out of module bounds"));
+        }
+        self.compile(ir_module, Some(unit))
+    }
+
+    fn compile(mut self, ir_module: &IrModule, unit: Option<&CodegenUnit>) -> Result<Vec<u8>, CodegenError> {
         // Declare runtime functions first
         declare_runtime_functions(&mut self.module, &mut self.runtime_funcs, self.pointer_type)?;
 
         // Declare all functions (for forward references)
-        for function in &ir_module.functions {
-            self.declare_function(function)?;
+        for (idx, function) in ir_module.functions.iter().enumerate() {
+            let linkage = match unit {
+                None if function.is_public || function.name == "main" => Linkage::Export,
+                None => Linkage::Local,
+                Some(unit) if !unit.functions.contains(&idx) => Linkage::Import,
+                Some(_) if function.is_public || function.name == "main" => Linkage::Export,
+                Some(_) => Linkage::Hidden,
+            };
+            self.declare_function(function, linkage)?;
         }
 
-        // Declare string literals as data objects
+        // Declare string literals as data objects. A unit only carries the
+        // literals its own code refers to; literal symbols are local to each
+        // object, so units never share them.
+        let used_literals = unit.map(|unit| used_string_literals(ir_module, unit));
         for (idx, string) in ir_module.string_literals.iter().enumerate() {
-            self.declare_string_literal(idx, string)?;
+            if used_literals.as_ref().map_or(true, |used| used.contains(&idx)) {
+                self.declare_string_literal(idx, string)?;
+            }
+        }
+
+        // Declare module globals (static properties, inline-cache cells)
+        for (idx, (name, ty, init)) in ir_module.globals.iter().enumerate() {
+            match unit {
+                None => self.declare_global(name, ty, init.as_ref(), Linkage::Local, ir_module)?,
+                Some(unit) if unit.globals.contains(&idx) => {
+                    self.declare_global(name, ty, init.as_ref(), Linkage::Hidden, ir_module)?
+                }
+                Some(_) => self.import_global(name)?,
+            }
         }
 
+        // Flag tested after calls that may throw; defined by the runtime
+        self.import_global(zaco_ir::exceptions::EXCEPTION_FLAG)?;
+
         // Compile each function
-        for function in &ir_module.functions {
+        let functions = unit.map_or(0..ir_module.functions.len(), |unit| unit.functions.clone());
+        for function in &ir_module.functions[functions] {
             self.compile_function(function, ir_module)?;
         }
 
+        // Profiled programs write a perf map; perf only reads them on Linux
+        if cfg!(target_os = "linux") && zaco_ir::profile::has_profile_probes(ir_module) {
+            self.define_perf_map(ir_module)?;
+        }
+
         // Finalize the module and produce object file (consumes self.module)
         let object_product = self.module.finish();
 
@@ -114,7 +207,7 @@ impl CodeGenerator {
     }
 
     /// Declare a function signature in the module
-    fn declare_function(&mut self, ir_func: &IrFunction) -> Result<(), CodegenError> {
+    fn declare_function(&mut self, ir_func: &IrFunction, linkage: Linkage) -> Result<(), CodegenError> {
         let mut signature = self.module.make_signature();
 
         // Add parameters
@@ -129,13 +222,6 @@ impl CodeGenerator {
             signature.returns.push(AbiParam::new(cl_type));
         }
 
-        // Determine linkage
-        let linkage = if ir_func.is_public || ir_func.name == "main" {
-            Linkage::Export
-        } else {
-            Linkage::Local
-        };
-
         // Declare function
         let clif_func_id = self
             .module
@@ -150,10 +236,17 @@ impl CodeGenerator {
     /// Declare a string literal as a data object (null-terminated for C runtime)
     fn declare_string_literal(&mut self, index: usize, string: &str) -> Result<(), CodegenError> {
         let mut data_desc = DataDescription::new();
-        // Include null terminator for C string compatibility
-        let mut bytes = string.as_bytes().to_vec();
+        // Lay the literal out like a heap string so the runtime can read its
+        // length from the header: [ref_count = -1 (static)][size = len + 1][bytes][NUL].
+        // Code uses the address of the bytes (offset 16) directly.
+        let size = string.len() as i64 + 1;
+        let mut bytes = Vec::with_capacity(16 + size as usize);
+        bytes.extend_from_slice(&(-1i64).to_ne_bytes());
+        bytes.extend_from_slice(&size.to_ne_bytes());
+        bytes.extend_from_slice(string.as_bytes());
         bytes.push(0);
         data_desc.define(bytes.into_boxed_slice());
+        data_desc.set_align(8);
 
         let name = format!("str_literal_{}", index);
         let data_id = self
@@ -172,6 +265,103 @@ impl CodeGenerator {
         Ok(())
     }
 
+    /// Declare a writable module global, zero-initialized unless `init` is given
+    fn declare_global(
+        &mut self,
+        name: &str,
+        ty: &IrType,
+        init: Option<&Constant>,
+        linkage: Linkage,
+        ir_module: &IrModule,
+    ) -> Result<(), CodegenError> {
+        let mut data_desc = DataDescription::new();
+        let size = ty.size_bytes().max(8);
+        let mut bytes = vec![0u8; size];
+        match init {
+            Some(Constant::I64(n)) => bytes[..8].copy_from_slice(&n.to_ne_bytes()),
+            Some(Constant::F64(f)) => bytes[..8].copy_from_slice(&f.to_ne_bytes()),
+            Some(Constant::Bool(b)) => bytes[0] = *b as u8,
+            Some(Constant::Str(s)) => {
+                // Point at the static string literal's bytes
+                let idx = ir_module
+                    .string_literals
+                    .iter()
+                    .position(|lit| lit == s)
+                    .ok_or_else(|| CodegenError::new(format!("Global '{}' initializer not interned", name)))?;
+                let lit_id = self.string_data_map[&idx];
+                let gv = self.module.declare_data_in_data(lit_id, &mut data_desc);
+                data_desc.write_data_addr(0, gv, 16);
+            }
+            Some(Constant::Null) | None => {}
+        }
+        data_desc.define(bytes.into_boxed_slice());
+        data_desc.set_align(8);
+
+        let data_id = self
+            .module
+            .declare_data(name, linkage, true, false)
+            .map_err(|e| CodegenError::new(format!("Failed to declare global '{}': {}", name, e)))?;
+        self.module.define_data(data_id, &data_desc).map_err(|e| {
+            CodegenError::new(format!("Failed to define global '{}': {}", name, e))
+        })?;
+
+        self.global_data_map.insert(name.to_string(), data_id);
+        Ok(())
+    }
+
+    /// List this object's functions in the perf map section: the address,
+    /// code size and name (the literal the entry probe passes) of each.
+    fn define_perf_map(&mut self, ir_module: &IrModule) -> Result<(), CodegenError> {
+        let literals: HashMap<&str, usize> = ir_module
+            .string_literals
+            .iter()
+            .enumerate()
+            .map(|(idx, lit)| (lit.as_str(), idx))
+            .collect();
+        let names: HashMap<FuncId, &str> = ir_module.functions.iter().map(|f| (f.id, f.name.as_str())).collect();
+
+        let mut data_desc = DataDescription::new();
+        let mut bytes = Vec::with_capacity(24 * self.code_sizes.len());
+        for (id, size) in std::mem::take(&mut self.code_sizes) {
+            let Some(&lit_id) = literals.get(names[&id]).and_then(|idx| self.string_data_map.get(idx)) else {
+                continue;
+            };
+            let offset = bytes.len() as u32;
+            let func_ref = self.module.declare_func_in_data(self.func_id_map[&id], &mut data_desc);
+            data_desc.write_function_addr(offset, func_ref);
+            let gv = self.module.declare_data_in_data(lit_id, &mut data_desc);
+            data_desc.write_data_addr(offset + 16, gv, 16);
+            bytes.extend_from_slice(&[0u8; 8]);
+            bytes.extend_from_slice(&(size as i64).to_ne_bytes());
+            bytes.extend_from_slice(&[0u8; 8]);
+        }
+        if bytes.is_empty() {
+            return Ok(());
+        }
+        data_desc.define(bytes.into_boxed_slice());
+        data_desc.set_align(8);
+        data_desc.set_segment_section("", PERF_MAP_SECTION);
+
+        // Writable, so the linker never needs text relocations in a PIE
+        let data_id = self
+            .module
+            .declare_anonymous_data(true, false)
+            .map_err(|e| CodegenError::new(format!("Failed to declare perf map: {}", e)))?;
+        self.module
+            .define_data(data_id, &data_desc)
+            .map_err(|e| CodegenError::new(format!("Failed to define perf map: {}", e)))
+    }
+
+    /// Declare a module global defined by another codegen unit
+    fn import_global(&mut self, name: &str) -> Result<(), CodegenError> {
+        let data_id = self
+            .module
+            .declare_data(name, Linkage::Import, true, false)
+            .map_err(|e| CodegenError::new(format!("Failed to declare global '{}': {}", name, e)))?;
+        self.global_data_map.insert(name.to_string(), data_id);
+        Ok(())
+    }
+
     /// Compile a single function
     pub fn compile_function(
         &mut self,
@@ -212,6 +402,7 @@ impl CodeGenerator {
             &self.func_id_map,
             &self.runtime_funcs,
             &self.string_data_map,
+            &self.global_data_map,
             ir_func,
             ir_module,
             pointer_type,
@@ -232,6 +423,8 @@ impl CodeGenerator {
         self.module
             .define_function(clif_func_id, &mut self.ctx)
             .map_err(|e| CodegenError::new(format!("Failed to define function: {}", e)))?;
+        let code_size = self.ctx.compiled_code().map_or(0, |code| code.code_info().total_size);
+        self.code_sizes.push((ir_func.id, code_size));
 
         // Clear the context for the next function
         self.module.clear_context(&mut self.ctx);
@@ -259,6 +452,44 @@ impl CodeGenerator {
     }
 }
 
+/// Indices of the string literals referenced by a unit's functions and
+/// global initializers. Includes the empty literal, which string
+/// concatenation of zero parts materializes.
+fn used_string_literals(ir_module: &IrModule, unit: &CodegenUnit) -> BTreeSet<usize> {
+    let index: HashMap<&str, usize> = ir_module
+        .string_literals
+        .iter()
+        .enumerate()
+        .map(|(idx, lit)| (lit.as_str(), idx))
+        .collect();
+
+    let mut used = BTreeSet::new();
+    let mut mark = |value: &zaco_ir::Value| {
+        if let zaco_ir::Value::Const(Constant::Str(s)) = value {
+            if let Some(&idx) = index.get(s.as_str()) {
+                used.insert(idx);
+            }
+        }
+    };
+    for function in &ir_module.functions[unit.functions.clone()] {
+        for block in &function.blocks {
+            for inst in &block.instructions {
+                inst.operands().into_iter().for_each(&mut mark);
+            }
+            block.terminator.operands().into_iter().for_each(&mut mark);
+        }
+    }
+    for (_, _, init) in &ir_module.globals[unit.globals.clone()] {
+        if let Some(init) = init {
+            mark(&zaco_ir::Value::Const(init.clone()));
+        }
+    }
+    if let Some(&idx) = index.get("") {
+        used.insert(idx);
+    }
+    used
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -270,6 +501,13 @@ mod tests {
         assert!(result.is_ok());
     }
 
+    #[test]
+    fn test_codegen_opt_levels() {
+        for level in [OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::Os] {
+            assert!(CodeGenerator::with_opt_level(level).is_ok());
+        }
+    }
+
     #[test]
     fn test_type_conversion() {
         let codegen = CodeGenerator::new().unwrap();
@@ -315,4 +553,79 @@ mod tests {
         let result = codegen.compile_module(&module);
         assert!(result.is_ok());
     }
+
+    #[test]
+    fn test_compile_unit_imports_other_units() {
+        // helper() lives in unit 0, main() calls it from unit 1
+        let mut module = IrModule::new();
+        let mut helper = IrFunction::new(FuncId(0), "helper".to_string(), vec![], IrType::I64);
+        let entry = helper.new_block();
+        helper.entry_block = entry;
+        helper
+            .block_mut(entry)
+            .set_terminator(Terminator::Return(Some(IrValue::Const(Constant::I64(1)))));
+        module.add_function(helper);
+
+        let mut main = IrFunction::new(FuncId(1), "main".to_string(), vec![], IrType::I64);
+        let entry = main.new_block();
+        main.entry_block = entry;
+        let result = main.add_temp(IrType::I64);
+        main.block_mut(entry).push_instruction(Instruction::Call {
+            dest: Some(Place::from_temp(result)),
+            func: IrValue::Const(Constant::Str("helper".to_string())),
+            args: vec![],
+        });
+        main.block_mut(entry)
+            .set_terminator(Terminator::Return(Some(IrValue::Temp(result))));
+        module.add_function(main);
+
+        let helper_unit = CodegenUnit { functions: 0..1, globals: 0..0 };
+        let main_unit = CodegenUnit { functions: 1..2, globals: 0..0 };
+        assert!(CodeGenerator::new().unwrap().compile_unit(&module, &helper_unit).is_ok());
+        assert!(CodeGenerator::new().unwrap().compile_unit(&module, &main_unit).is_ok());
+
+        let out_of_range = CodegenUnit { functions: 1..3, globals: 0..0 };
+        assert!(CodeGenerator::new().unwrap().compile_unit(&module, &out_of_range).is_err());
+    }
+
+    #[test]
+    fn test_stack_allocations_compile() {
+        // fn main() -> f64 { let a = [1.5] on the stack; struct on the stack; return a[0] }
+        let mut module = IrModule::new();
+        module.add_struct(zaco_ir::IrStruct::new(
+            zaco_ir::StructId(0),
+            "Point".to_string(),
+            vec![("x".to_string(), IrType::F64), ("y".to_string(), IrType::F64)],
+        ));
+        module.add_extern_function(
+            "zaco_array_get_f64".to_string(),
+            vec![IrType::Ptr, IrType::I64],
+            IrType::F64,
+        );
+        let mut func = IrFunction::new(FuncId(0), "main".to_string(), vec![], IrType::F64);
+        func.is_public = true;
+        let entry = func.new_block();
+        func.entry_block = entry;
+        let point = func.add_local(IrType::Struct(zaco_ir::StructId(0)));
+        let array = func.add_temp(IrType::Array(Box::new(IrType::F64)));
+        let result = func.add_temp(IrType::F64);
+        let block = func.block_mut(entry);
+        block.push_instruction(Instruction::StackAlloc {
+            dest: Place::from_local(point),
+            ty: IrType::Struct(zaco_ir::StructId(0)),
+        });
+        block.push_instruction(Instruction::Assign {
+            dest: Place::from_temp(array),
+            value: RValue::StackArrayInit(vec![IrValue::Const(Constant::F64(1.5))]),
+        });
+        block.push_instruction(Instruction::Call {
+            dest: Some(Place::from_temp(result)),
+            func: IrValue::Const(Constant::Str("zaco_array_get_f64".to_string())),
+            args: vec![IrValue::Temp(array), IrValue::Const(Constant::I64(0))],
+        });
+        block.set_terminator(Terminator::Return(Some(IrValue::Temp(result))));
+        module.add_function(func);
+
+        assert!(CodeGenerator::new().unwrap().compile_module(&module).is_ok());
+    }
 }
@@ -131,11 +131,10 @@ pub(crate) struct RuntimeFunctions {
     pub(crate) zaco_runtime_init: Option<ClifFuncId>,
     pub(crate) zaco_runtime_shutdown: Option<ClifFuncId>,
     // Exception handling
-    pub(crate) zaco_try_push: Option<ClifFuncId>,
-    pub(crate) zaco_try_pop: Option<ClifFuncId>,
     pub(crate) zaco_throw: Option<ClifFuncId>,
     pub(crate) zaco_get_error: Option<ClifFuncId>,
     pub(crate) zaco_clear_error: Option<ClifFuncId>,
+    pub(crate) zaco_check_uncaught: Option<ClifFuncId>,
     // Global number functions
     pub(crate) zaco_parse_int: Option<ClifFuncId>,
     pub(crate) zaco_parse_float: Option<ClifFuncId>,
@@ -146,6 +145,7 @@ pub(crate) struct RuntimeFunctions {
     pub(crate) zaco_set_interval: Option<ClifFuncId>,
     pub(crate) zaco_clear_timeout: Option<ClifFuncId>,
     pub(crate) zaco_clear_interval: Option<ClifFuncId>,
+    pub(crate) zaco_event_loop_run: Option<ClifFuncId>,
     // Async fs
     pub(crate) zaco_fs_read_file: Option<ClifFuncId>,
 }
@@ -273,11 +273,10 @@ impl RuntimeFunctions {
             "zaco_runtime_init" => self.zaco_runtime_init,
             "zaco_runtime_shutdown" => self.zaco_runtime_shutdown,
             // Exception handling
-            "zaco_try_push" => self.zaco_try_push,
-            "zaco_try_pop" => self.zaco_try_pop,
             "zaco_throw" => self.zaco_throw,
             "zaco_get_error" => self.zaco_get_error,
             "zaco_clear_error" => self.zaco_clear_error,
+            "zaco_check_uncaught" => self.zaco_check_uncaught,
             // Global number functions
             "zaco_parse_int" => self.zaco_parse_int,
             "zaco_parse_float" => self.zaco_parse_float,
@@ -291,6 +290,7 @@ impl RuntimeFunctions {
             "zaco_set_interval" => self.zaco_set_interval,
             "zaco_clear_timeout" => self.zaco_clear_timeout,
             "zaco_clear_interval" => self.zaco_clear_interval,
+            "zaco_event_loop_run" => self.zaco_event_loop_run,
             // Async fs
             "zaco_fs_read_file" => self.zaco_fs_read_file,
             _ => None,
@@ -1281,21 +1281,6 @@ pub(crate) fn declare_runtime_functions(
 
     // ========== Exception Handling ==========
 
-    // zaco_try_push() -> i64  (returns 0 on initial call, 1 on exception)
-    let mut try_push_sig = module.make_signature();
-    try_push_sig.returns.push(AbiParam::new(types::I64));
-    let try_push_id = module
-        .declare_function("zaco_try_push", Linkage::Import, &try_push_sig)
-        .map_err(|e| CodegenError::new(format!("Failed to declare zaco_try_push: {}", e)))?;
-    runtime_funcs.zaco_try_push = Some(try_push_id);
-
-    // zaco_try_pop()
-    let try_pop_sig = module.make_signature();
-    let try_pop_id = module
-        .declare_function("zaco_try_pop", Linkage::Import, &try_pop_sig)
-        .map_err(|e| CodegenError::new(format!("Failed to declare zaco_try_pop: {}", e)))?;
-    runtime_funcs.zaco_try_pop = Some(try_pop_id);
-
     // zaco_throw(error: ptr)
     let mut throw_sig = module.make_signature();
     throw_sig.params.push(AbiParam::new(pointer_type));
@@ -1319,6 +1304,13 @@ pub(crate) fn declare_runtime_functions(
         .map_err(|e| CodegenError::new(format!("Failed to declare zaco_clear_error: {}", e)))?;
     runtime_funcs.zaco_clear_error = Some(clear_error_id);
 
+    // zaco_check_uncaught()
+    let check_uncaught_sig = module.make_signature();
+    let check_uncaught_id = module
+        .declare_function("zaco_check_uncaught", Linkage::Import, &check_uncaught_sig)
+        .map_err(|e| CodegenError::new(format!("Failed to declare zaco_check_uncaught: {}", e)))?;
+    runtime_funcs.zaco_check_uncaught = Some(check_uncaught_id);
+
     // ========== Global Number Functions ==========
 
     // zaco_parse_int(ptr) -> f64
@@ -1415,6 +1407,13 @@ pub(crate) fn declare_runtime_functions(
         .map_err(|e| CodegenError::new(format!("Failed to declare zaco_clear_interval: {}", e)))?;
     runtime_funcs.zaco_clear_interval = Some(clear_interval_id);
 
+    // zaco_event_loop_run() -> void  (runs pending timers; called before main returns)
+    let event_loop_run_sig = module.make_signature();
+    let event_loop_run_id = module
+        .declare_function("zaco_event_loop_run", Linkage::Import, &event_loop_run_sig)
+        .map_err(|e| CodegenError::new(format!("Failed to declare zaco_event_loop_run: {}", e)))?;
+    runtime_funcs.zaco_event_loop_run = Some(event_loop_run_id);
+
     // ========== Async FS ==========
 
     // zaco_fs_read_file(path: ptr, encoding: ptr, callback: ptr)
@@ -17,6 +17,19 @@ use crate::runtime::RuntimeFunctions;
 use cranelift::prelude::Value as ClifValue;
 use cranelift::prelude::Block as ClifBlock;
 
+/// `ZacoArray` layout (see `zaco_runtime.c`): header fields, then inline
+/// elements for literals.
+const ARRAY_LENGTH_OFFSET: i32 = 0;
+const ARRAY_CAPACITY_OFFSET: i32 = 8;
+const ARRAY_ELEM_SIZE_OFFSET: i32 = 16;
+const ARRAY_DATA_OFFSET: i32 = 24;
+const ARRAY_HEADER_SIZE: i64 = 40;
+const ARRAY_ELEM_SIZE: i64 = 8;
+/// The allocation header's size word, at `ptr - 8`. Arrays carry
+/// `ZACO_KIND_ARRAY` in its top byte so untyped code can recognise them.
+const HEADER_SIZE_WORD_OFFSET: i32 = -8;
+const ARRAY_KIND_TAG: i64 = 7 << 56;
+
 /// Context for translating a single function
 pub(crate) struct FunctionTranslator<'a> {
     /// Module reference for declaring function references
@@ -28,6 +41,8 @@ pub(crate) struct FunctionTranslator<'a> {
     /// Map from string literal indices to data IDs
     #[allow(dead_code)]
     string_data_map: &'a HashMap<usize, cranelift_module::DataId>,
+    /// Map from module global names to data IDs
+    global_data_map: &'a HashMap<String, cranelift_module::DataId>,
     /// Map from Zaco locals/temps to Cranelift values
     value_map: HashMap<ValueKey, ClifValue>,
     /// Map from Zaco block IDs to Cranelift blocks
@@ -54,6 +69,7 @@ impl<'a> FunctionTranslator<'a> {
         func_id_map: &'a HashMap<FuncId, ClifFuncId>,
         runtime_funcs: &'a RuntimeFunctions,
         string_data_map: &'a HashMap<usize, cranelift_module::DataId>,
+        global_data_map: &'a HashMap<String, cranelift_module::DataId>,
         ir_func: &'a IrFunction,
         ir_module: &'a IrModule,
         pointer_type: Type,
@@ -63,6 +79,7 @@ impl<'a> FunctionTranslator<'a> {
             func_id_map,
             runtime_funcs,
             string_data_map,
+            global_data_map,
             value_map: HashMap::new(),
             block_map: HashMap::new(),
             ir_func,
@@ -205,17 +222,12 @@ impl<'a> FunctionTranslator<'a> {
             }
 
             Instruction::Alloc { dest, ty } => {
-                let size = ty.size_bytes() as i64;
-                let size_val = builder.ins().iconst(types::I64, size);
-
-                let alloc_fn = self
-                    .runtime_funcs
-                    .zaco_alloc
-                    .ok_or_else(|| CodegenError::new("zaco_alloc not declared"))?;
-                let func_ref = self.module.declare_func_in_func(alloc_fn, builder.func);
-                let call = builder.ins().call(func_ref, &[size_val]);
-                let ptr = builder.inst_results(call)[0];
+                let ptr = self.emit_alloc(builder, ty.size_bytes(), false)?;
+                self.store_to_place(builder, dest, ptr)?;
+            }
 
+            Instruction::StackAlloc { dest, ty } => {
+                let ptr = self.emit_alloc(builder, ty.size_bytes(), true)?;
                 self.store_to_place(builder, dest, ptr)?;
             }
 
@@ -231,55 +243,26 @@ impl<'a> FunctionTranslator<'a> {
 
             Instruction::RefCount { value, delta } => {
                 let ptr = self.translate_value(builder, value)?;
-                if *delta > 0 {
-                    // Increment
-                    for _ in 0..*delta {
-                        let rc_inc_fn = self
-                            .runtime_funcs
-                            .zaco_rc_inc
-                            .ok_or_else(|| CodegenError::new("zaco_rc_inc not declared"))?;
-                        let func_ref =
-                            self.module.declare_func_in_func(rc_inc_fn, builder.func);
-                        builder.ins().call(func_ref, &[ptr]);
-                    }
-                } else if *delta < 0 {
-                    // Decrement — use array-specific RC dec for array types
-                    let is_array = matches!(self.infer_value_ir_type(value), Some(IrType::Array(_)));
-                    for _ in 0..delta.abs() {
-                        let rc_dec_fn = if is_array {
-                            self.runtime_funcs
-                                .zaco_array_rc_dec
-                                .ok_or_else(|| CodegenError::new("zaco_array_rc_dec not declared"))?
-                        } else {
-                            self.runtime_funcs
-                                .zaco_rc_dec
-                                .ok_or_else(|| CodegenError::new("zaco_rc_dec not declared"))?
-                        };
-                        let func_ref =
-                            self.module.declare_func_in_func(rc_dec_fn, builder.func);
-                        builder.ins().call(func_ref, &[ptr]);
-                    }
-                }
+                // Decrement — use array-specific RC dec for array types
+                let is_array = matches!(self.infer_value_ir_type(value), Some(IrType::Array(_)));
+                self.emit_rc_adjust(builder, ptr, *delta as i64, is_array)?;
             }
 
             Instruction::Clone { dest, source } => {
                 // Copy the pointer and increment reference count
                 let val = self.translate_value(builder, source)?;
-                if let Some(rc_inc_fn) = self.runtime_funcs.zaco_rc_inc {
-                    let func_ref = self.module.declare_func_in_func(rc_inc_fn, builder.func);
-                    builder.ins().call(func_ref, &[val]);
-                }
+                self.emit_rc_adjust(builder, val, 1, false)?;
                 self.store_to_place(builder, dest, val)?;
             }
 
             Instruction::Store { ptr, value } => {
-                let ptr_val = self.translate_value(builder, ptr)?;
+                let ptr_val = self.translate_address(builder, ptr)?;
                 let val = self.translate_value(builder, value)?;
                 builder.ins().store(MemFlags::new(), val, ptr_val, 0);
             }
 
             Instruction::Load { dest, ptr } => {
-                let ptr_val = self.translate_value(builder, ptr)?;
+                let ptr_val = self.translate_address(builder, ptr)?;
                 // Infer type from destination
                 let ty = self.infer_place_type(dest)?;
                 let cl_type = self.ir_type_to_cranelift(&ty)?;
@@ -291,6 +274,235 @@ impl<'a> FunctionTranslator<'a> {
         Ok(())
     }
 
+    /// Allocate a zeroed object of `size` bytes and return its pointer.
+    ///
+    /// Heap objects come from `zaco_alloc`. Stack objects (promoted by the IR
+    /// escape analysis) get a function-local slot with the same 16-byte
+    /// header in front, marked static (negative count) so any refcount
+    /// operation on them is a no-op.
+    fn emit_alloc(
+        &mut self,
+        builder: &mut FunctionBuilder,
+        size: usize,
+        on_stack: bool,
+    ) -> Result<ClifValue, CodegenError> {
+        const HEADER_SIZE: usize = 16;
+        if !on_stack {
+            let size_val = builder.ins().iconst(types::I64, size as i64);
+            let alloc_fn = self
+                .runtime_funcs
+                .zaco_alloc
+                .ok_or_else(|| CodegenError::new("zaco_alloc not declared"))?;
+            let func_ref = self.module.declare_func_in_func(alloc_fn, builder.func);
+            let call = builder.ins().call(func_ref, &[size_val]);
+            return Ok(builder.inst_results(call)[0]);
+        }
+
+        let padded = (size + 7) & !7;
+        let slot = builder.create_sized_stack_slot(StackSlotData::new(
+            StackSlotKind::ExplicitSlot,
+            (HEADER_SIZE + padded) as u32,
+            3,
+        ));
+        let static_rc = builder.ins().iconst(types::I64, -1);
+        builder.ins().stack_store(static_rc, slot, 0);
+        let size_val = builder.ins().iconst(types::I64, size as i64);
+        builder.ins().stack_store(size_val, slot, 8);
+        // Re-zeroed on every execution, like a fresh allocation
+        let zero = builder.ins().iconst(types::I64, 0);
+        for offset in (0..padded).step_by(8) {
+            builder.ins().stack_store(zero, slot, (HEADER_SIZE + offset) as i32);
+        }
+        Ok(builder.ins().stack_addr(self.pointer_type, slot, HEADER_SIZE as i32))
+    }
+
+    /// Build an array literal in the runtime's `ZacoArray` layout, with its
+    /// 8-byte elements stored inline right after the header.
+    fn translate_array_init(
+        &mut self,
+        builder: &mut FunctionBuilder,
+        elements: &[IrValue],
+        on_stack: bool,
+    ) -> Result<ClifValue, CodegenError> {
+        let mut translated_elems = Vec::new();
+        for elem in elements {
+            let val = self.translate_value(builder, elem)?;
+            // Narrow scalars (bools) widen to a full slot
+            let ty = builder.func.dfg.value_type(val);
+            let val = if ty.is_int() && ty.bits() < 64 {
+                builder.ins().uextend(types::I64, val)
+            } else {
+                val
+            };
+            translated_elems.push(val);
+        }
+        let count = translated_elems.len();
+        let size = ARRAY_HEADER_SIZE + count as i64 * ARRAY_ELEM_SIZE;
+        let ptr = self.emit_alloc(builder, size as usize, on_stack)?;
+        let size_word = builder.ins().iconst(types::I64, size | ARRAY_KIND_TAG);
+        builder.ins().store(MemFlags::new(), size_word, ptr, HEADER_SIZE_WORD_OFFSET);
+
+        let len = builder.ins().iconst(types::I64, count as i64);
+        builder.ins().store(MemFlags::new(), len, ptr, ARRAY_LENGTH_OFFSET);
+        builder.ins().store(MemFlags::new(), len, ptr, ARRAY_CAPACITY_OFFSET);
+        let elem_size = builder.ins().iconst(types::I64, ARRAY_ELEM_SIZE);
+        builder.ins().store(MemFlags::new(), elem_size, ptr, ARRAY_ELEM_SIZE_OFFSET);
+        let data = builder.ins().iadd_imm(ptr, ARRAY_HEADER_SIZE);
+        builder.ins().store(MemFlags::new(), data, ptr, ARRAY_DATA_OFFSET);
+        // `kinds` stays null: literals are statically typed
+
+        for (i, val) in translated_elems.iter().enumerate() {
+            let offset = ARRAY_HEADER_SIZE + i as i64 * ARRAY_ELEM_SIZE;
+            builder.ins().store(MemFlags::new(), *val, ptr, offset as i32);
+        }
+
+        Ok(ptr)
+    }
+
+    /// Expand the typed array helpers (`zaco_array_length`,
+    /// `zaco_array_get_f64`, ...) inline. Returns `None` for anything else.
+    ///
+    /// Checked reads yield 0/null for a null array or an out-of-range index,
+    /// exactly like the runtime definitions; unchecked reads index `data`
+    /// directly.
+    fn translate_array_intrinsic(
+        &mut self,
+        builder: &mut FunctionBuilder,
+        name: &str,
+        args: &[ClifValue],
+    ) -> Result<Option<ClifValue>, CodegenError> {
+        let (elem_ty, checked) = match (name, args) {
+            ("zaco_array_length" | "zaco_array_len", [_]) => (types::I64, true),
+            ("zaco_array_get_f64", [_, _]) => (types::F64, true),
+            ("zaco_array_get_ptr", [_, _]) => (self.pointer_type, true),
+            ("zaco_array_get_f64_unchecked", [_, _]) => (types::F64, false),
+            ("zaco_array_get_ptr_unchecked", [_, _]) => (self.pointer_type, false),
+            _ => return Ok(None),
+        };
+        let arr = args[0];
+        let index = args.get(1).map(|&index| {
+            let ty = builder.func.dfg.value_type(index);
+            if ty == types::F64 {
+                builder.ins().fcvt_to_sint_sat(types::I64, index)
+            } else if ty.is_int() && ty.bits() < 64 {
+                builder.ins().sextend(types::I64, index)
+            } else {
+                index
+            }
+        });
+        let pointer_type = self.pointer_type;
+        let load_elem = |builder: &mut FunctionBuilder, index: ClifValue| {
+            let data = builder.ins().load(pointer_type, MemFlags::new(), arr, ARRAY_DATA_OFFSET);
+            let offset = builder.ins().imul_imm(index, ARRAY_ELEM_SIZE);
+            let addr = builder.ins().iadd(data, offset);
+            builder.ins().load(elem_ty, MemFlags::new(), addr, 0)
+        };
+        if !checked {
+            return Ok(index.map(|index| load_elem(builder, index)));
+        }
+
+        let default = if elem_ty == types::F64 {
+            builder.ins().f64const(0.0)
+        } else {
+            builder.ins().iconst(elem_ty, 0)
+        };
+        let non_null_block = builder.create_block();
+        let done_block = builder.create_block();
+        builder.append_block_param(done_block, elem_ty);
+        builder.ins().brif(arr, non_null_block, &[], done_block, &[default]);
+
+        builder.switch_to_block(non_null_block);
+        let len = builder.ins().load(types::I64, MemFlags::new(), arr, ARRAY_LENGTH_OFFSET);
+        match index {
+            None => {
+                builder.ins().jump(done_block, &[len]);
+            }
+            Some(index) => {
+                let in_bounds_block = builder.create_block();
+                // Unsigned compare also rejects negative indices
+                let in_bounds = builder.ins().icmp(IntCC::UnsignedLessThan, index, len);
+                builder.ins().brif(in_bounds, in_bounds_block, &[], done_block, &[default]);
+
+                builder.switch_to_block(in_bounds_block);
+                let value = load_elem(builder, index);
+                builder.ins().jump(done_block, &[value]);
+            }
+        }
+
+        builder.switch_to_block(done_block);
+        Ok(Some(builder.block_params(done_block)[0]))
+    }
+
+    /// Adjust the reference count of `ptr` by `delta` inline.
+    ///
+    /// Mirrors `zaco_rc_inc`/`zaco_rc_dec`: null and static (negative count)
+    /// objects are skipped, and the count lives at `ptr - 16`. Increments and
+    /// decrements that leave the object alive never leave the function; only
+    /// a decrement that drops the count to zero calls into the runtime, with
+    /// the count set to 1 so the runtime's own decrement frees the object.
+    fn emit_rc_adjust(
+        &mut self,
+        builder: &mut FunctionBuilder,
+        ptr: ClifValue,
+        delta: i64,
+        is_array: bool,
+    ) -> Result<(), CodegenError> {
+        const RC_HEADER_OFFSET: i32 = -16;
+        if delta == 0 {
+            return Ok(());
+        }
+        let release_fn = if delta < 0 {
+            let func = if is_array {
+                self.runtime_funcs.zaco_array_rc_dec
+            } else {
+                self.runtime_funcs.zaco_rc_dec
+            };
+            Some(func.ok_or_else(|| CodegenError::new("RC decrement function not declared"))?)
+        } else {
+            None
+        };
+
+        let check_block = builder.create_block();
+        let update_block = builder.create_block();
+        let done_block = builder.create_block();
+
+        builder.ins().brif(ptr, check_block, &[], done_block, &[]);
+
+        builder.switch_to_block(check_block);
+        let rc = builder.ins().load(types::I64, MemFlags::new(), ptr, RC_HEADER_OFFSET);
+        let is_static = builder.ins().icmp_imm(IntCC::SignedLessThan, rc, 0);
+        builder.ins().brif(is_static, done_block, &[], update_block, &[]);
+
+        builder.switch_to_block(update_block);
+        let new_rc = builder.ins().iadd_imm(rc, delta);
+        match release_fn {
+            None => {
+                builder.ins().store(MemFlags::new(), new_rc, ptr, RC_HEADER_OFFSET);
+                builder.ins().jump(done_block, &[]);
+            }
+            Some(release_fn) => {
+                let store_block = builder.create_block();
+                let release_block = builder.create_block();
+                let alive = builder.ins().icmp_imm(IntCC::SignedGreaterThan, new_rc, 0);
+                builder.ins().brif(alive, store_block, &[], release_block, &[]);
+
+                builder.switch_to_block(store_block);
+                builder.ins().store(MemFlags::new(), new_rc, ptr, RC_HEADER_OFFSET);
+                builder.ins().jump(done_block, &[]);
+
+                builder.switch_to_block(release_block);
+                let one = builder.ins().iconst(types::I64, 1);
+                builder.ins().store(MemFlags::new(), one, ptr, RC_HEADER_OFFSET);
+                let func_ref = self.module.declare_func_in_func(release_fn, builder.func);
+                builder.ins().call(func_ref, &[ptr]);
+                builder.ins().jump(done_block, &[]);
+            }
+        }
+
+        builder.switch_to_block(done_block);
+        Ok(())
+    }
+
     /// Translate a terminator instruction
     fn translate_terminator(
         &mut self,
@@ -299,8 +511,13 @@ impl<'a> FunctionTranslator<'a> {
     ) -> Result<(), CodegenError> {
         match terminator {
             Terminator::Return(val_opt) => {
-                // If this is the main function, call runtime shutdown before returning
+                // If this is the main function, drain the event loop and shut the
+                // runtime down before returning
                 if self.ir_func.name == "main" {
+                    if let Some(event_loop_run_id) = self.runtime_funcs.zaco_event_loop_run {
+                        let func_ref = self.module.declare_func_in_func(event_loop_run_id, builder.func);
+                        builder.ins().call(func_ref, &[]);
+                    }
                     if let Some(runtime_shutdown_id) = self.runtime_funcs.zaco_runtime_shutdown {
                         let func_ref = self.module.declare_func_in_func(runtime_shutdown_id, builder.func);
                         builder.ins().call(func_ref, &[]);
@@ -454,75 +671,16 @@ impl<'a> FunctionTranslator<'a> {
                 Ok(ptr)
             }
 
-            RValue::ArrayInit(elements) => {
-                // Allocate array on heap
-                // Array layout: [length: i64][elements...]
-                if elements.is_empty() {
-                    // Empty array - return null or allocate header only
-                    let size_val = builder.ins().iconst(types::I64, 8); // Just length field
-                    let alloc_fn = self
-                        .runtime_funcs
-                        .zaco_alloc
-                        .ok_or_else(|| CodegenError::new("zaco_alloc not declared"))?;
-                    let func_ref =
-                        self.module.declare_func_in_func(alloc_fn, builder.func);
-                    let call = builder.ins().call(func_ref, &[size_val]);
-                    let ptr = builder.inst_results(call)[0];
-                    let len = builder.ins().iconst(types::I64, 0);
-                    builder.ins().store(MemFlags::new(), len, ptr, 0);
-                    Ok(ptr)
-                } else {
-                    // Translate all elements first to determine actual element size
-                    let mut translated_elems = Vec::new();
-                    for elem in elements {
-                        let val = self.translate_value(builder, elem)?;
-                        translated_elems.push(val);
-                    }
-                    let elem_size = if let Some(&first) = translated_elems.first() {
-                        builder.func.dfg.value_type(first).bytes() as usize
-                    } else {
-                        8
-                    };
-                    let total_size = 8 + (translated_elems.len() * elem_size);
-                    let size_val = builder.ins().iconst(types::I64, total_size as i64);
-
-                    let alloc_fn = self
-                        .runtime_funcs
-                        .zaco_alloc
-                        .ok_or_else(|| CodegenError::new("zaco_alloc not declared"))?;
-                    let func_ref =
-                        self.module.declare_func_in_func(alloc_fn, builder.func);
-                    let call = builder.ins().call(func_ref, &[size_val]);
-                    let ptr = builder.inst_results(call)[0];
-
-                    // Store length
-                    let len = builder.ins().iconst(types::I64, translated_elems.len() as i64);
-                    builder.ins().store(MemFlags::new(), len, ptr, 0);
-
-                    // Store elements with actual element size
-                    for (i, val) in translated_elems.iter().enumerate() {
-                        let offset = 8 + (i * elem_size);
-                        builder
-                            .ins()
-                            .store(MemFlags::new(), *val, ptr, offset as i32);
-                    }
+            RValue::ArrayInit(elements) => self.translate_array_init(builder, elements, false),
 
-                    Ok(ptr)
-                }
-            }
+            RValue::StackArrayInit(elements) => self.translate_array_init(builder, elements, true),
 
             RValue::StrConcat(values) => {
                 if values.is_empty() {
-                    // Allocate an empty string via zaco_str_new
+                    // Use the static empty-string literal
                     if let Some(idx) = self.ir_module.string_literals.iter().position(|s| s.is_empty()) {
                         if let Some(&data_id) = self.string_data_map.get(&idx) {
-                            let gv = self.module.declare_data_in_func(data_id, builder.func);
-                            let raw_ptr = builder.ins().global_value(self.pointer_type, gv);
-                            let str_new_fn = self.runtime_funcs.zaco_str_new
-                                .ok_or_else(|| CodegenError::new("zaco_str_new not declared"))?;
-                            let func_ref = self.module.declare_func_in_func(str_new_fn, builder.func);
-                            let call = builder.ins().call(func_ref, &[raw_ptr]);
-                            return Ok(builder.inst_results(call)[0]);
+                            return Ok(self.string_literal_ptr(builder, data_id));
                         }
                     }
                     // Fallback: return null pointer if empty string not interned
@@ -595,6 +753,33 @@ impl<'a> FunctionTranslator<'a> {
         }
     }
 
+    /// Translate the address operand of a Load/Store. A constant string naming a
+    /// module global resolves to that global's address.
+    fn translate_address(
+        &mut self,
+        builder: &mut FunctionBuilder,
+        ptr: &IrValue,
+    ) -> Result<ClifValue, CodegenError> {
+        if let IrValue::Const(Constant::Str(name)) = ptr {
+            if let Some(&data_id) = self.global_data_map.get(name) {
+                let gv = self.module.declare_data_in_func(data_id, builder.func);
+                return Ok(builder.ins().global_value(self.pointer_type, gv));
+            }
+        }
+        self.translate_value(builder, ptr)
+    }
+
+    /// Pointer to the string bytes of a static literal (past its 16-byte header)
+    fn string_literal_ptr(
+        &mut self,
+        builder: &mut FunctionBuilder,
+        data_id: cranelift_module::DataId,
+    ) -> ClifValue {
+        let gv = self.module.declare_data_in_func(data_id, builder.func);
+        let base = builder.ins().global_value(self.pointer_type, gv);
+        builder.ins().iadd_imm(base, 16)
+    }
+
     /// Translate a constant
     fn translate_constant(
         &mut self,
@@ -607,24 +792,21 @@ impl<'a> FunctionTranslator<'a> {
             Constant::Bool(b) => builder.ins().iconst(types::I8, if *b { 1 } else { 0 }),
             Constant::Null => builder.ins().iconst(self.pointer_type, 0),
             Constant::Str(s) => {
+                // A compiler-generated function used as a value (a closure passed
+                // as a timer callback, an async resume function) is its code address
+                let func_id = s
+                    .starts_with("__")
+                    .then(|| self.ir_module.find_function(s).map(|f| f.id))
+                    .flatten();
+                if let Some(&clif_func_id) = func_id.and_then(|id| self.func_id_map.get(&id)) {
+                    let func_ref = self.module.declare_func_in_func(clif_func_id, builder.func);
+                    return Ok(builder.ins().func_addr(self.pointer_type, func_ref));
+                }
                 // Look up interned string in string_data_map
                 if let Some(idx) = self.ir_module.string_literals.iter().position(|lit| lit == s) {
                     if let Some(&data_id) = self.string_data_map.get(&idx) {
-                        // Get a pointer to the raw string data
-                        let gv = self
-                            .module
-                            .declare_data_in_func(data_id, builder.func);
-                        let raw_ptr = builder.ins().global_value(self.pointer_type, gv);
-
-                        // Call zaco_str_new to create a managed string from raw data
-                        let str_new_fn = self
-                            .runtime_funcs
-                            .zaco_str_new
-                            .ok_or_else(|| CodegenError::new("zaco_str_new not declared"))?;
-                        let func_ref =
-                            self.module.declare_func_in_func(str_new_fn, builder.func);
-                        let call = builder.ins().call(func_ref, &[raw_ptr]);
-                        builder.inst_results(call)[0]
+                        // Literals are static managed strings; no allocation needed
+                        self.string_literal_ptr(builder, data_id)
                     } else {
                         // String not in data map - shouldn't happen if lowering is correct
                         return Err(CodegenError::new(format!(
@@ -845,7 +1027,12 @@ impl<'a> FunctionTranslator<'a> {
                     }
                 }
 
-                // 2. Try runtime functions
+                // 2. Typed array access is expanded inline
+                if let Some(result) = self.translate_array_intrinsic(builder, name, &arg_vals)? {
+                    return Ok(Some(result));
+                }
+
+                // 3. Try runtime functions
                 if let Some(clif_func_id) = self.runtime_funcs.get_by_name(name) {
                     let func_ref =
                         self.module
@@ -853,7 +1040,7 @@ impl<'a> FunctionTranslator<'a> {
                     return self.call_with_coercion(builder, func_ref, arg_vals);
                 }
 
-                // 3. Try extern functions declared in the IR module
+                // 4. Try extern functions declared in the IR module
                 for ext in &self.ir_module.extern_functions {
                     if ext.name == *name {
                         let mut sig = self.module.make_signature();
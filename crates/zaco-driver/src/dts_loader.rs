@@ -3,11 +3,21 @@
 //! Extracts type declarations from .d.ts files for type checking.
 //! This is a simplified parser that extracts function signatures,
 //! interfaces, and type aliases.
+//!
+//! Declaration files are memory-mapped rather than read. A
+//! [`DeclarationCache`] loads each file once per build, however many modules
+//! import it, and reuses the summaries persisted by earlier builds for files
+//! whose contents have not changed.
+
+use std::collections::HashMap;
+use std::path::{Path, PathBuf};
+use std::sync::{Arc, Mutex};
 
-use std::fs;
-use std::path::Path;
+use crate::hash::{compiler_identity, StableHasher};
+use crate::incremental::IncrementalCache;
+use crate::mapped_file::MappedFile;
 
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, PartialEq)]
 pub enum DtsDeclaration {
     Function {
         name: String,
@@ -33,10 +43,16 @@ pub struct DtsLoader;
 impl DtsLoader {
     /// Load type declarations from a .d.ts file
     pub fn load_declarations(path: &Path) -> Result<Vec<DtsDeclaration>, String> {
-        let content = fs::read_to_string(path)
+        let file = Self::map(path)?;
+        let content = file
+            .as_str()
             .map_err(|e| format!("Failed to read .d.ts file {}: {}", path.display(), e))?;
 
-        Self::parse_declarations(&content)
+        Self::parse_declarations(content)
+    }
+
+    fn map(path: &Path) -> Result<MappedFile, String> {
+        MappedFile::open(path).map_err(|e| format!("Failed to read .d.ts file {}: {}", path.display(), e))
     }
 
     /// Parse declarations from .d.ts file content
@@ -338,6 +354,144 @@ impl DtsLoader {
     }
 }
 
+/// Declarations loaded during one build, shared by every discovery thread.
+pub struct DeclarationCache {
+    loaded: Mutex<HashMap<PathBuf, Arc<Vec<DtsDeclaration>>>>,
+    /// Where summaries of parsed files persist across builds.
+    persistent: Option<IncrementalCache>,
+}
+
+impl DeclarationCache {
+    pub fn new(persistent: Option<IncrementalCache>) -> Self {
+        DeclarationCache { loaded: Mutex::new(HashMap::new()), persistent }
+    }
+
+    /// Declarations of the .d.ts file at `path`, parsed at most once per
+    /// build and not at all when an earlier build saw the same contents.
+    pub fn load(&self, path: &Path) -> Result<Arc<Vec<DtsDeclaration>>, String> {
+        if let Some(decls) = self.loaded.lock().unwrap().get(path) {
+            return Ok(Arc::clone(decls));
+        }
+
+        // Two threads may race to load the same file; both get equal results
+        let file = DtsLoader::map(path)?;
+        let key = summary_key(&file);
+        let decls = match self.persistent.as_ref().and_then(|cache| cache.load_declarations(key)) {
+            Some(decls) => decls,
+            None => {
+                let content = file
+                    .as_str()
+                    .map_err(|e| format!("Failed to read .d.ts file {}: {}", path.display(), e))?;
+                let decls = DtsLoader::parse_declarations(content)?;
+                if let Some(cache) = &self.persistent {
+                    // A summary that fails to persist is only a missed speedup
+                    let _ = cache.store_declarations(key, &decls);
+                }
+                decls
+            }
+        };
+
+        let decls = Arc::new(decls);
+        self.loaded.lock().unwrap().insert(path.to_path_buf(), Arc::clone(&decls));
+        Ok(decls)
+    }
+}
+
+/// Summaries depend only on the file contents, so identical copies of a
+/// package in different `node_modules` directories share one.
+fn summary_key(contents: &[u8]) -> u64 {
+    let mut h = StableHasher::new();
+    h.str("dts").u64(compiler_identity()).field(contents);
+    h.finish()
+}
+
+/// Serialize declarations into the summary format read by
+/// [`decode_declarations`].
+pub fn encode_declarations(decls: &[DtsDeclaration]) -> Vec<u8> {
+    fn string(out: &mut Vec<u8>, s: &str) {
+        out.extend_from_slice(&(s.len() as u32).to_le_bytes());
+        out.extend_from_slice(s.as_bytes());
+    }
+    fn pairs(out: &mut Vec<u8>, pairs: &[(String, String)]) {
+        out.extend_from_slice(&(pairs.len() as u32).to_le_bytes());
+        for (a, b) in pairs {
+            string(out, a);
+            string(out, b);
+        }
+    }
+
+    let mut out = Vec::new();
+    out.extend_from_slice(&(decls.len() as u32).to_le_bytes());
+    for decl in decls {
+        match decl {
+            DtsDeclaration::Function { name, params, return_type } => {
+                out.push(0);
+                string(&mut out, name);
+                pairs(&mut out, params);
+                string(&mut out, return_type);
+            }
+            DtsDeclaration::Interface { name, members } => {
+                out.push(1);
+                string(&mut out, name);
+                pairs(&mut out, members);
+            }
+            DtsDeclaration::Variable { name, type_annotation } => {
+                out.push(2);
+                string(&mut out, name);
+                string(&mut out, type_annotation);
+            }
+            DtsDeclaration::TypeAlias { name, definition } => {
+                out.push(3);
+                string(&mut out, name);
+                string(&mut out, definition);
+            }
+        }
+    }
+    out
+}
+
+/// Inverse of [`encode_declarations`]. Malformed input yields `None`.
+pub fn decode_declarations(bytes: &[u8]) -> Option<Vec<DtsDeclaration>> {
+    struct Reader<'a>(&'a [u8]);
+
+    impl Reader<'_> {
+        fn take(&mut self, n: usize) -> Option<&[u8]> {
+            if self.0.len() < n {
+                return None;
+            }
+            let (head, rest) = self.0.split_at(n);
+            self.0 = rest;
+            Some(head)
+        }
+        fn u32(&mut self) -> Option<usize> {
+            Some(u32::from_le_bytes(self.take(4)?.try_into().ok()?) as usize)
+        }
+        fn string(&mut self) -> Option<String> {
+            let len = self.u32()?;
+            String::from_utf8(self.take(len)?.to_vec()).ok()
+        }
+        fn pairs(&mut self) -> Option<Vec<(String, String)>> {
+            let count = self.u32()?;
+            (0..count).map(|_| Some((self.string()?, self.string()?))).collect()
+        }
+    }
+
+    let mut r = Reader(bytes);
+    let count = r.u32()?;
+    let mut decls = Vec::new();
+    for _ in 0..count {
+        let decl = match r.take(1)?[0] {
+            0 => DtsDeclaration::Function { name: r.string()?, params: r.pairs()?, return_type: r.string()? },
+            1 => DtsDeclaration::Interface { name: r.string()?, members: r.pairs()? },
+            2 => DtsDeclaration::Variable { name: r.string()?, type_annotation: r.string()? },
+            3 => DtsDeclaration::TypeAlias { name: r.string()?, definition: r.string()? },
+            _ => return None,
+        };
+        decls.push(decl);
+    }
+    r.0.is_empty().then_some(decls)
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -409,4 +563,39 @@ mod tests {
             assert_eq!(type_annotation, "string");
         }
     }
+
+    #[test]
+    fn test_summary_round_trip() {
+        let decls = DtsLoader::parse_declarations(
+            "export declare function chunk(array: T[], size: number): T[][];\nexport declare const VERSION: string;\nexport type ID = string | number;\n",
+        )
+        .unwrap();
+        assert_eq!(decls.len(), 3);
+
+        let encoded = encode_declarations(&decls);
+        assert_eq!(decode_declarations(&encoded), Some(decls));
+        assert_eq!(decode_declarations(&encoded[..encoded.len() - 1]), None);
+    }
+
+    #[test]
+    fn test_declaration_cache_persists_summaries() {
+        use std::fs;
+
+        let dir = std::env::temp_dir().join(format!("zaco_dts_cache_{}", std::process::id()));
+        let _ = fs::remove_dir_all(&dir);
+        fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("index.d.ts");
+        fs::write(&path, "export declare const VERSION: string;\n").unwrap();
+
+        let persistent = IncrementalCache::open(&dir).unwrap();
+        let cache = DeclarationCache::new(Some(persistent.clone()));
+        let first = cache.load(&path).unwrap();
+        assert!(Arc::ptr_eq(&first, &cache.load(&path).unwrap()), "a build loads each file once");
+
+        // A later build finds the summary of the same contents
+        let key = summary_key(fs::read(&path).unwrap().as_slice());
+        assert_eq!(persistent.load_declarations(key).as_ref(), Some(&*first));
+        assert_eq!(*DeclarationCache::new(Some(persistent)).load(&path).unwrap(), *first);
+        let _ = fs::remove_dir_all(&dir);
+    }
 }
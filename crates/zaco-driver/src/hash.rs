@@ -0,0 +1,104 @@
+//! Stable content hashing for on-disk caches
+//!
+//! `std`'s `DefaultHasher` is randomly keyed per build and may change between
+//! Rust releases, so anything persisted across compiler invocations is keyed
+//! with 64-bit FNV-1a instead.
+
+use std::sync::OnceLock;
+use std::time::UNIX_EPOCH;
+
+/// 64-bit FNV-1a hasher over length-delimited fields.
+#[derive(Debug, Clone)]
+pub struct StableHasher {
+    state: u64,
+}
+
+impl StableHasher {
+    pub fn new() -> Self {
+        StableHasher { state: 0xcbf29ce484222325 }
+    }
+
+    fn bytes(&mut self, bytes: &[u8]) {
+        for &b in bytes {
+            self.state = (self.state ^ b as u64).wrapping_mul(0x100000001b3);
+        }
+    }
+
+    /// Add one field. Fields are length-prefixed so ("ab", "c") and
+    /// ("a", "bc") hash differently.
+    pub fn field(&mut self, bytes: &[u8]) -> &mut Self {
+        self.bytes(&(bytes.len() as u64).to_le_bytes());
+        self.bytes(bytes);
+        self
+    }
+
+    pub fn str(&mut self, s: &str) -> &mut Self {
+        self.field(s.as_bytes())
+    }
+
+    pub fn u64(&mut self, v: u64) -> &mut Self {
+        self.field(&v.to_le_bytes())
+    }
+
+    pub fn finish(&self) -> u64 {
+        self.state
+    }
+}
+
+impl Default for StableHasher {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Identity of the running compiler build, for keys of caches that hold
+/// compiler output (IR, objects, declaration summaries).
+///
+/// The package version is not bumped for every change to lowering,
+/// optimization or codegen, so the key also covers the size and
+/// modification time of the compiler executable: any rebuild gets fresh
+/// cache entries. Falls back to the version alone if the executable cannot
+/// be inspected.
+pub fn compiler_identity() -> u64 {
+    static IDENTITY: OnceLock<u64> = OnceLock::new();
+    *IDENTITY.get_or_init(|| {
+        let mut h = StableHasher::new();
+        h.str(env!("CARGO_PKG_VERSION"));
+        let exe = std::env::current_exe().and_then(std::fs::metadata);
+        if let Ok(meta) = exe {
+            let mtime = meta
+                .modified()
+                .ok()
+                .and_then(|t| t.duration_since(UNIX_EPOCH).ok())
+                .map_or(0, |d| d.as_nanos() as u64);
+            h.u64(meta.len()).u64(mtime);
+        }
+        h.finish()
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_known_value() {
+        // FNV-1a of the empty input is the offset basis
+        assert_eq!(StableHasher::new().finish(), 0xcbf29ce484222325);
+    }
+
+    #[test]
+    fn test_fields_are_delimited() {
+        let a = StableHasher::new().str("ab").str("c").finish();
+        let b = StableHasher::new().str("a").str("bc").finish();
+        assert_ne!(a, b);
+    }
+
+    #[test]
+    fn test_compiler_identity_is_stable_within_a_process() {
+        let id = compiler_identity();
+        assert_eq!(id, compiler_identity());
+        // Not just the version: the executable's metadata is included
+        assert_ne!(id, StableHasher::new().str(env!("CARGO_PKG_VERSION")).finish());
+    }
+}
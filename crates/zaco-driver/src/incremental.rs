@@ -0,0 +1,320 @@
+//! Incremental compilation cache
+//!
+//! Lowered IR for each module is persisted under `.zaco-cache/` next to the
+//! entry file. An entry is keyed by the module's source, its path and init
+//! name, and the *export signature hash* of every module it imports. The
+//! export signature hash covers the names an imported module exports and the
+//! IR signatures/layouts behind them, so editing a function body changes only
+//! that module's key, while changing an exported signature also invalidates
+//! exactly the modules that import it.
+//!
+//! Each module's object file is cached alongside its IR. An object depends
+//! on the module's own IR plus the declarations it links against (every
+//! function signature, global and extern in the program), so a body edit
+//! recompiles only the edited module's object.
+//!
+//! Summaries of parsed `.d.ts` files are kept too, keyed by file contents
+//! (see [`crate::dts_loader::DeclarationCache`]).
+
+use std::collections::HashSet;
+use std::fs;
+use std::io;
+use std::path::{Path, PathBuf};
+
+use zaco_ir::opt::OptLevel;
+use zaco_ir::IrModule;
+
+use crate::dts_loader::{decode_declarations, encode_declarations, DtsDeclaration};
+use crate::hash::{compiler_identity, StableHasher};
+
+/// Name of the cache directory created next to the entry module.
+pub const CACHE_DIR_NAME: &str = ".zaco-cache";
+
+/// Header of every cache entry; bump the version when the entry layout changes.
+const ENTRY_MAGIC: &[u8; 4] = b"ZCM\x02";
+
+/// Header of every declaration summary.
+const DTS_MAGIC: &[u8; 4] = b"ZCD\x01";
+
+/// A module restored from (or about to be written to) the cache.
+#[derive(Debug)]
+pub struct CachedModule {
+    /// Export signature hash, fed into the keys of importing modules.
+    pub export_hash: u64,
+    /// Lowered IR with function/struct ids starting at 0.
+    pub ir: IrModule,
+}
+
+/// Handle on a project's `.zaco-cache/` directory.
+#[derive(Debug, Clone)]
+pub struct IncrementalCache {
+    dir: PathBuf,
+    obj_dir: PathBuf,
+    dts_dir: PathBuf,
+}
+
+impl IncrementalCache {
+    /// Open (creating if needed) the cache for a project rooted at `project_dir`.
+    pub fn open(project_dir: &Path) -> io::Result<Self> {
+        let root = project_dir.join(CACHE_DIR_NAME);
+        let dir = root.join("ir");
+        let obj_dir = root.join("obj");
+        let dts_dir = root.join("dts");
+        fs::create_dir_all(&dir)?;
+        fs::create_dir_all(&obj_dir)?;
+        fs::create_dir_all(&dts_dir)?;
+        Ok(IncrementalCache { dir, obj_dir, dts_dir })
+    }
+
+    fn entry_path(&self, key: u64) -> PathBuf {
+        self.dir.join(format!("{:016x}.zir", key))
+    }
+
+    fn object_path(&self, key: u64) -> PathBuf {
+        self.obj_dir.join(format!("{:016x}.o", key))
+    }
+
+    fn declarations_path(&self, key: u64) -> PathBuf {
+        self.dts_dir.join(format!("{:016x}.zdts", key))
+    }
+
+    /// Look up a module by key. Missing, truncated or stale-format entries
+    /// are treated as misses.
+    pub fn load(&self, key: u64) -> Option<CachedModule> {
+        let bytes = fs::read(self.entry_path(key)).ok()?;
+        let body = bytes.strip_prefix(ENTRY_MAGIC.as_slice())?;
+        if body.len() < 8 {
+            return None;
+        }
+        let (hash, ir) = body.split_at(8);
+        let export_hash = u64::from_le_bytes(hash.try_into().ok()?);
+        let ir = IrModule::decode(ir).ok()?;
+        Some(CachedModule { export_hash, ir })
+    }
+
+    /// Store a module under `key`.
+    pub fn store(&self, key: u64, export_hash: u64, ir: &IrModule) -> io::Result<()> {
+        let encoded = ir.encode();
+        let mut bytes = Vec::with_capacity(ENTRY_MAGIC.len() + 8 + encoded.len());
+        bytes.extend_from_slice(ENTRY_MAGIC);
+        bytes.extend_from_slice(&export_hash.to_le_bytes());
+        bytes.extend_from_slice(&encoded);
+
+        write_atomic(&self.entry_path(key), &bytes)
+    }
+
+    /// Look up a cached object file by key (see [`object_key`]).
+    pub fn load_object(&self, key: u64) -> Option<Vec<u8>> {
+        fs::read(self.object_path(key)).ok().filter(|bytes| !bytes.is_empty())
+    }
+
+    /// Store an object file under `key`.
+    pub fn store_object(&self, key: u64, object: &[u8]) -> io::Result<()> {
+        write_atomic(&self.object_path(key), object)
+    }
+
+    /// Look up the summary of a parsed declaration file by key.
+    pub fn load_declarations(&self, key: u64) -> Option<Vec<DtsDeclaration>> {
+        let bytes = fs::read(self.declarations_path(key)).ok()?;
+        decode_declarations(bytes.strip_prefix(DTS_MAGIC.as_slice())?)
+    }
+
+    /// Store the summary of a parsed declaration file under `key`.
+    pub fn store_declarations(&self, key: u64, decls: &[DtsDeclaration]) -> io::Result<()> {
+        let mut bytes = DTS_MAGIC.to_vec();
+        bytes.extend_from_slice(&encode_declarations(decls));
+        write_atomic(&self.declarations_path(key), &bytes)
+    }
+}
+
+/// Write `bytes` to a temp file and rename it into place so concurrent
+/// compilers never read a partial entry.
+fn write_atomic(path: &Path, bytes: &[u8]) -> io::Result<()> {
+    let tmp = path.with_extension(format!("tmp{}", std::process::id()));
+    fs::write(&tmp, bytes)?;
+    fs::rename(&tmp, path).map_err(|e| {
+        let _ = fs::remove_file(&tmp);
+        e
+    })
+}
+
+/// Bumped whenever the encoding or meaning of cached IR or objects changes.
+/// Keys also include [`compiler_identity`], so entries written by another
+/// compiler build are never reused.
+const CACHE_FORMAT: u32 = 1;
+
+/// Cache key for one module's optimized IR.
+///
+/// `dep_export_hashes` must be in the module's import order so the key is
+/// deterministic. `profile` tells whether the IR carries profiling probes.
+pub fn module_key(
+    source: &str,
+    module_path: &Path,
+    module_name: Option<&str>,
+    dep_export_hashes: &[u64],
+    opt_level: OptLevel,
+    profile: bool,
+) -> u64 {
+    let mut h = StableHasher::new();
+    h.u64(CACHE_FORMAT as u64)
+        .u64(compiler_identity())
+        .str(opt_level.name())
+        .u64(profile as u64)
+        .str(&module_path.to_string_lossy())
+        .str(module_name.unwrap_or(""))
+        .str(source);
+    for &dep in dep_export_hashes {
+        h.u64(dep);
+    }
+    h.finish()
+}
+
+/// Hash of what importers can observe of a module: its export names and,
+/// for exports backed by an IR function or struct, their signature or field
+/// layout.
+pub fn export_signature_hash(exports: &HashSet<String>, ir: &IrModule) -> u64 {
+    let mut names: Vec<&String> = exports.iter().collect();
+    names.sort();
+
+    let mut h = StableHasher::new();
+    for name in names {
+        h.str(name);
+        if let Some(func) = ir.find_function(name) {
+            for (_, ty) in &func.params {
+                h.str(&ty.to_string());
+            }
+            h.str(&func.return_type.to_string());
+        }
+        if let Some(def) = ir.find_struct(name) {
+            for (field, ty) in &def.fields {
+                h.str(field).str(&ty.to_string());
+            }
+        }
+    }
+    h.finish()
+}
+
+/// Hash of the declarations every object of a merged program links against:
+/// function names and signatures, globals and extern declarations, in
+/// program order.
+pub fn link_interface_hash(ir: &IrModule) -> u64 {
+    let mut h = StableHasher::new();
+    for func in &ir.functions {
+        h.str(&func.name);
+        for (_, ty) in &func.params {
+            h.str(&ty.to_string());
+        }
+        h.str(&func.return_type.to_string());
+    }
+    for (name, ty, _) in &ir.globals {
+        h.str(name).str(&ty.to_string());
+    }
+    for ext in &ir.extern_functions {
+        h.str(&ext.name);
+        for ty in &ext.params {
+            h.str(&ty.to_string());
+        }
+        h.str(&ext.return_type.to_string());
+    }
+    h.finish()
+}
+
+/// Cache key for the object file of one module, given the module's IR key
+/// (from [`module_key`]) and the program's [`link_interface_hash`].
+pub fn object_key(module_key: u64, interface_hash: u64) -> u64 {
+    let mut h = StableHasher::new();
+    h.str("obj")
+        .u64(CACHE_FORMAT as u64)
+        .u64(compiler_identity())
+        .str(std::env::consts::ARCH)
+        .str(std::env::consts::OS)
+        .u64(module_key)
+        .u64(interface_hash);
+    h.finish()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use zaco_ir::{FuncId, IrFunction, IrType, LocalId};
+
+    fn module_with(name: &str, params: Vec<IrType>, body_blocks: usize) -> IrModule {
+        let mut module = IrModule::new();
+        let params = params.into_iter().enumerate().map(|(i, t)| (LocalId(i), t)).collect();
+        let mut func = IrFunction::new(FuncId(0), name.to_string(), params, IrType::F64);
+        for _ in 0..body_blocks {
+            func.new_block();
+        }
+        module.add_function(func);
+        module
+    }
+
+    fn temp_dir(tag: &str) -> PathBuf {
+        let dir = std::env::temp_dir().join(format!("zaco_incr_{}_{}", tag, std::process::id()));
+        let _ = fs::remove_dir_all(&dir);
+        dir
+    }
+
+    #[test]
+    fn test_store_and_load() {
+        let dir = temp_dir("store");
+        let cache = IncrementalCache::open(&dir).unwrap();
+        let ir = module_with("f", vec![IrType::F64], 2);
+
+        assert!(cache.load(42).is_none());
+        cache.store(42, 7, &ir).unwrap();
+        let hit = cache.load(42).unwrap();
+        assert_eq!(hit.export_hash, 7);
+        assert_eq!(hit.ir.functions, ir.functions);
+
+        // A corrupt entry is a miss, not an error
+        fs::write(cache.entry_path(42), b"ZCM\x02garbage").unwrap();
+        assert!(cache.load(42).is_none());
+        let _ = fs::remove_dir_all(&dir);
+    }
+
+    #[test]
+    fn test_object_store_and_load() {
+        let dir = temp_dir("obj");
+        let cache = IncrementalCache::open(&dir).unwrap();
+        let key = object_key(1, 2);
+        assert!(cache.load_object(key).is_none());
+        cache.store_object(key, b"\x7fELF").unwrap();
+        assert_eq!(cache.load_object(key).unwrap(), b"\x7fELF");
+        assert_ne!(key, object_key(1, 3));
+        assert_ne!(key, object_key(2, 2));
+        let _ = fs::remove_dir_all(&dir);
+    }
+
+    #[test]
+    fn test_link_interface_ignores_bodies() {
+        let a = link_interface_hash(&module_with("f", vec![IrType::F64], 1));
+        let b = link_interface_hash(&module_with("f", vec![IrType::F64], 3));
+        let c = link_interface_hash(&module_with("g", vec![IrType::F64], 1));
+        assert_eq!(a, b);
+        assert_ne!(a, c);
+    }
+
+    #[test]
+    fn test_module_key_depends_on_source_and_deps() {
+        let path = Path::new("/p/a.ts");
+        let base = module_key("let x = 1;", path, None, &[1, 2], OptLevel::O0, false);
+        assert_eq!(base, module_key("let x = 1;", path, None, &[1, 2], OptLevel::O0, false));
+        assert_ne!(base, module_key("let x = 2;", path, None, &[1, 2], OptLevel::O0, false));
+        assert_ne!(base, module_key("let x = 1;", path, None, &[1, 3], OptLevel::O0, false));
+        assert_ne!(base, module_key("let x = 1;", Path::new("/p/b.ts"), None, &[1, 2], OptLevel::O0, false));
+        assert_ne!(base, module_key("let x = 1;", path, Some("a"), &[1, 2], OptLevel::O0, false));
+        assert_ne!(base, module_key("let x = 1;", path, None, &[1, 2], OptLevel::O2, false));
+        assert_ne!(base, module_key("let x = 1;", path, None, &[1, 2], OptLevel::O0, true));
+    }
+
+    #[test]
+    fn test_export_hash_ignores_bodies() {
+        let exports: HashSet<String> = ["f".to_string()].into_iter().collect();
+        let a = export_signature_hash(&exports, &module_with("f", vec![IrType::F64], 1));
+        let b = export_signature_hash(&exports, &module_with("f", vec![IrType::F64], 5));
+        let c = export_signature_hash(&exports, &module_with("f", vec![IrType::Str], 1));
+        assert_eq!(a, b, "body changes must not change the export signature");
+        assert_ne!(a, c, "parameter type changes must change the export signature");
+    }
+}
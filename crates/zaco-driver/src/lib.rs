@@ -9,6 +9,12 @@ pub mod dep_graph;
 pub mod package_json;
 pub mod npm_resolver;
 pub mod dts_loader;
+pub mod mapped_file;
+pub mod hash;
+pub mod incremental;
+pub mod runtime_cache;
+pub mod scheduler;
+pub mod timings;
 
 pub use resolver::{ModuleResolver, ResolvedModule};
 pub use dep_graph::DepGraph;
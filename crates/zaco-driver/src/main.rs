@@ -6,10 +6,17 @@ use std::hash::{Hash, Hasher};
 use std::io;
 use std::path::PathBuf;
 use std::process::{Command, ExitCode};
+use std::sync::Mutex;
+use std::time::Instant;
 use zaco_lexer::{Lexer, Token, TokenKind};
 
 use zaco_driver::{ModuleResolver, ResolvedModule, DepGraph};
-use zaco_driver::dts_loader;
+use zaco_driver::dts_loader::DeclarationCache;
+use zaco_driver::incremental::{self, IncrementalCache};
+use zaco_driver::runtime_cache;
+use zaco_driver::scheduler::{self, JobOutcome};
+use zaco_driver::timings::{IrStats, Timings};
+use zaco_ir::opt::OptLevel;
 
 #[derive(Parser)]
 #[command(
@@ -42,9 +49,64 @@ enum Commands {
         #[arg(long)]
         target: Option<String>,
 
+        /// Number of parallel frontend jobs (default: $ZACO_JOBS or CPU count)
+        #[arg(short, long)]
+        jobs: Option<usize>,
+
+        /// Disable the incremental compilation cache (.zaco-cache/)
+        #[arg(long)]
+        no_cache: bool,
+
+        /// Optimization level: 0 (fastest compile), 1, 2 (adds inlining) or s (size)
+        #[arg(short = 'O', default_value = "0")]
+        opt_level: OptArg,
+
+        /// Add function entry/exit probes; run with ZACO_PROFILE=<file> to sample
+        #[arg(long)]
+        profile: bool,
+
+        /// Write per-phase and per-module timings, peak RSS and IR size as
+        /// JSON to FILE
+        #[arg(long, value_name = "FILE")]
+        timings: Option<PathBuf>,
+
+        /// Enable verbose output
+        #[arg(short, long)]
+        verbose: bool,
+    },
+
+    /// Compile a TypeScript file and run the executable
+    Run {
+        /// Input TypeScript file
+        input: PathBuf,
+
+        /// Number of parallel frontend jobs (default: $ZACO_JOBS or CPU count)
+        #[arg(short, long)]
+        jobs: Option<usize>,
+
+        /// Disable the incremental compilation cache (.zaco-cache/)
+        #[arg(long)]
+        no_cache: bool,
+
+        /// Optimization level: 0 (fastest compile), 1, 2 (adds inlining) or s (size)
+        #[arg(short = 'O', default_value = "0")]
+        opt_level: OptArg,
+
+        /// Sample the program and print runtime counters
+        #[arg(long)]
+        profile: bool,
+
+        /// Where --profile writes folded stacks (flamegraph.pl / speedscope)
+        #[arg(long, default_value = "zaco-profile.folded")]
+        profile_output: PathBuf,
+
         /// Enable verbose output
         #[arg(short, long)]
         verbose: bool,
+
+        /// Arguments passed to the program
+        #[arg(last = true)]
+        args: Vec<String>,
     },
 
     /// Type check a TypeScript file without compiling
@@ -90,6 +152,29 @@ enum EmitMode {
     Exe,
 }
 
+#[derive(Clone, Copy, Debug, ValueEnum)]
+enum OptArg {
+    #[value(name = "0")]
+    O0,
+    #[value(name = "1")]
+    O1,
+    #[value(name = "2")]
+    O2,
+    #[value(name = "s")]
+    Os,
+}
+
+impl From<OptArg> for OptLevel {
+    fn from(arg: OptArg) -> Self {
+        match arg {
+            OptArg::O0 => OptLevel::O0,
+            OptArg::O1 => OptLevel::O1,
+            OptArg::O2 => OptLevel::O2,
+            OptArg::Os => OptLevel::Os,
+        }
+    }
+}
+
 fn main() -> ExitCode {
     let cli = Cli::parse();
 
@@ -99,8 +184,26 @@ fn main() -> ExitCode {
             output,
             emit,
             target,
+            jobs,
+            no_cache,
+            opt_level,
+            profile,
+            timings,
+            verbose,
+        } => compile_command(input, output, emit, target, jobs, no_cache, opt_level.into(), profile, timings, verbose),
+        Commands::Run {
+            input,
+            jobs,
+            no_cache,
+            opt_level,
+            profile,
+            profile_output,
             verbose,
-        } => compile_command(input, output, emit, target, verbose),
+            args,
+        } => {
+            let profile_output = profile.then_some(profile_output);
+            run_command(input, jobs, no_cache, opt_level.into(), profile_output, verbose, &args)
+        }
         Commands::Check { input, verbose } => check_command(input, verbose),
         Commands::Lex { input, positions } => lex_command(input, positions),
         Commands::Parse { input, pretty } => parse_command(input, pretty),
@@ -112,6 +215,45 @@ fn compile_command(
     output: Option<PathBuf>,
     emit: EmitMode,
     target: Option<String>,
+    jobs: Option<usize>,
+    no_cache: bool,
+    opt_level: OptLevel,
+    profile: bool,
+    timings_output: Option<PathBuf>,
+    verbose: bool,
+) -> ExitCode {
+    // stdout already carries status messages and, with --emit ir, the IR
+    // itself, so the report always goes to a file
+    if timings_output.as_ref().is_some_and(|path| path.as_os_str() == "-") {
+        eprintln!("Error: --timings needs a file path; stdout is used for compiler output");
+        return ExitCode::FAILURE;
+    }
+    let jobs = jobs.filter(|&n| n > 0).unwrap_or_else(scheduler::default_jobs);
+    let timings = Timings::new();
+    let report_input = input.clone();
+    let status = compile_pipeline(input, output, emit, target, jobs, no_cache, opt_level, profile, &timings, verbose);
+
+    // The report is written for failed builds too, covering the phases that ran
+    if let Some(path) = timings_output {
+        let json = timings.to_json(&report_input, opt_level.name(), jobs);
+        if let Err(e) = fs::write(&path, json) {
+            eprintln!("Error writing timings to {}: {}", path.display(), e);
+            return ExitCode::FAILURE;
+        }
+    }
+    status
+}
+
+fn compile_pipeline(
+    input: PathBuf,
+    output: Option<PathBuf>,
+    emit: EmitMode,
+    target: Option<String>,
+    jobs: usize,
+    no_cache: bool,
+    opt_level: OptLevel,
+    profile: bool,
+    timings: &Timings,
     verbose: bool,
 ) -> ExitCode {
     if verbose {
@@ -120,6 +262,7 @@ fn compile_command(
             println!("Target: {}", t);
         }
         println!("Emit mode: {:?}", emit);
+        println!("Optimization level: -O{}", opt_level.name());
     }
 
     // Canonicalize input path
@@ -135,13 +278,32 @@ fn compile_command(
     if verbose {
         println!("\n[Phase 0] Discovering module dependencies...");
     }
+    let phase_start = Instant::now();
 
     let mut dep_graph = DepGraph::new();
     let base_dir = input.parent().unwrap_or_else(|| Path::new(".")).to_path_buf();
-    let resolver = ModuleResolver::new(base_dir);
+    let resolver = ModuleResolver::new(base_dir.clone());
     let mut parse_cache: HashMap<PathBuf, (String, Program)> = HashMap::new();
 
-    match discover_modules(&input, &resolver, &mut dep_graph, verbose, &mut parse_cache) {
+    // Modules whose source and imported export signatures are unchanged since
+    // the last build are restored from .zaco-cache/ instead of re-lowered.
+    // The AST/IR debug modes always run the full frontend.
+    let cache = if no_cache || matches!(emit, EmitMode::Ast) {
+        None
+    } else {
+        match IncrementalCache::open(&base_dir) {
+            Ok(cache) => Some(cache),
+            Err(e) => {
+                if verbose {
+                    println!("  Warning: incremental cache disabled: {}", e);
+                }
+                None
+            }
+        }
+    };
+    let declarations = DeclarationCache::new(cache.clone());
+
+    match discover_modules(&input, &resolver, &declarations, &mut dep_graph, verbose, jobs, timings, &mut parse_cache) {
         Ok(_) => {}
         Err(e) => {
             eprintln!("Module discovery error: {}", e);
@@ -165,6 +327,7 @@ fn compile_command(
             return ExitCode::FAILURE;
         }
     };
+    timings.record_phase("discovery", phase_start.elapsed());
 
     if verbose {
         println!("  Discovered {} modules", compilation_order.len());
@@ -173,43 +336,130 @@ fn compile_command(
         }
     }
 
-    // Compile each module in order and collect IR modules (preserving compilation order)
-    let mut module_irs: Vec<(PathBuf, zaco_ir::IrModule)> = Vec::new();
-    let mut func_id_offset: usize = 0;
-    let mut struct_id_offset: usize = 0;
+    if matches!(emit, EmitMode::Ast) {
+        for module_path in &compilation_order {
+            if let Some((_, program)) = parse_cache.get(module_path) {
+                println!("AST for {}:", module_path.display());
+                println!("{:#?}", program);
+            }
+        }
+    }
+
+    // Phases 3-4: type check and lower every module on the worker pool. A
+    // module starts as soon as all of its dependencies have finished.
+    if verbose {
+        println!(
+            "\n[Phase 3-4] Type checking and lowering {} modules (jobs: {})...",
+            compilation_order.len(),
+            jobs
+        );
+    }
 
+    let order_index: HashMap<&PathBuf, usize> = compilation_order
+        .iter()
+        .enumerate()
+        .map(|(i, path)| (path, i))
+        .collect();
+    let mut frontend_jobs = Vec::with_capacity(compilation_order.len());
     for module_path in &compilation_order {
-        if verbose {
-            println!("\n[Compiling] {}", module_path.display());
-        }
+        let (source, program) = match parse_cache.remove(module_path) {
+            Some(parsed) => parsed,
+            None => {
+                eprintln!("Error: module was not parsed: {}", module_path.display());
+                return ExitCode::FAILURE;
+            }
+        };
+        let deps: Vec<usize> = dep_graph
+            .get_module(module_path)
+            .map(|node| {
+                node.dependencies
+                    .iter()
+                    .filter_map(|dep| order_index.get(dep).copied())
+                    .collect()
+            })
+            .unwrap_or_default();
 
         // Entry module (the user's input file) gets "main" wrapper;
         // all other modules get "__module_init_<name>" wrappers.
-        let is_entry = *module_path == input;
-        let module_name = if is_entry {
+        let module_name = if *module_path == input {
             None
         } else {
             Some(module_path_to_init_name(module_path))
         };
 
-        let ir_module = match compile_single_module(
-            module_path,
-            &emit,
-            verbose,
-            &mut parse_cache,
-            module_name.as_deref(),
-            func_id_offset,
-            struct_id_offset,
-        ) {
-            Ok(ir) => ir,
-            Err(_) => return ExitCode::FAILURE,
-        };
+        let (dependencies, exports) = dep_graph
+            .get_module(module_path)
+            .map(|node| (node.dependencies.clone(), node.exports.clone()))
+            .unwrap_or_default();
+
+        frontend_jobs.push((
+            deps,
+            FrontendJob {
+                module_path: module_path.clone(),
+                source,
+                program,
+                module_name,
+                dependencies,
+                exports,
+            },
+        ));
+    }
+
+    let export_hashes: Mutex<HashMap<PathBuf, u64>> = Mutex::new(HashMap::new());
+
+    let phase_start = Instant::now();
+    let outcomes = scheduler::run_after_dependencies(frontend_jobs, jobs, |job| {
+        compile_module_cached(job, cache.as_ref(), &export_hashes, opt_level, profile, timings)
+    });
+    timings.record_phase("frontend", phase_start.elapsed());
 
-        // Update offsets for the next module to avoid FuncId/StructId collisions
-        func_id_offset = ir_module.next_func_id;
-        struct_id_offset = ir_module.next_struct_id;
+    // Collect IR modules in compilation order. Each module was lowered with
+    // ids starting at 0; rebase them so FuncId/StructId stay unique and dense
+    // across the merged module.
+    // Each module also becomes one codegen unit covering its functions and
+    // globals in the merged module.
+    let mut module_irs: Vec<(PathBuf, zaco_ir::IrModule)> = Vec::new();
+    let mut codegen_units: Vec<ObjectJob> = Vec::new();
+    let mut func_id_offset: usize = 0;
+    let mut struct_id_offset: usize = 0;
+    let mut global_offset: usize = 0;
+    let mut failed = false;
+
+    for (module_path, outcome) in compilation_order.iter().zip(outcomes) {
+        match outcome {
+            JobOutcome::Done((mut ir_module, from_cache, module_key)) => {
+                if verbose {
+                    println!(
+                        "  {}: {} ({} functions)",
+                        if from_cache { "Cached" } else { "Compiled" },
+                        module_path.display(),
+                        ir_module.functions.len()
+                    );
+                }
+                ir_module.rebase_ids(func_id_offset, struct_id_offset);
+                codegen_units.push(ObjectJob {
+                    module_path: module_path.clone(),
+                    unit: zaco_codegen::CodegenUnit {
+                        functions: func_id_offset..ir_module.next_func_id,
+                        globals: global_offset..global_offset + ir_module.globals.len(),
+                    },
+                    module_key,
+                });
+                func_id_offset = ir_module.next_func_id;
+                struct_id_offset = ir_module.next_struct_id;
+                global_offset += ir_module.globals.len();
+                module_irs.push((module_path.clone(), ir_module));
+            }
+            JobOutcome::Failed(errors) => {
+                errors.report();
+                failed = true;
+            }
+            JobOutcome::Skipped => {}
+        }
+    }
 
-        module_irs.push((module_path.clone(), ir_module));
+    if failed {
+        return ExitCode::FAILURE;
     }
 
     // Merge all IR modules into one
@@ -217,11 +467,14 @@ fn compile_command(
         println!("\n[Phase 4.5] Merging IR modules...");
     }
 
+    let phase_start = Instant::now();
     let mut merged_ir = merge_ir_modules(module_irs);
 
     // Inject calls to __module_init_* functions at the start of "main"'s entry block.
     // This ensures all dependency modules' top-level code runs before the entry module.
     inject_module_init_calls(&mut merged_ir);
+    timings.record_phase("merge", phase_start.elapsed());
+    timings.set_ir_stats(IrStats::of(&merged_ir));
 
     if verbose {
         println!(
@@ -241,26 +494,6 @@ fn compile_command(
         println!("\n[Phase 5] Generating native code...");
     }
 
-    let codegen = match zaco_codegen::CodeGenerator::new() {
-        Ok(cg) => cg,
-        Err(e) => {
-            eprintln!("Codegen initialization error: {}", e);
-            return ExitCode::FAILURE;
-        }
-    };
-
-    let object_bytes = match codegen.compile_module(&merged_ir) {
-        Ok(bytes) => bytes,
-        Err(e) => {
-            eprintln!("Codegen error: {}", e);
-            return ExitCode::FAILURE;
-        }
-    };
-
-    if verbose {
-        println!("  {} bytes of object code generated", object_bytes.len());
-    }
-
     // Determine output path
     let output_path = output.unwrap_or_else(|| {
         let stem = input.file_stem().unwrap_or_default().to_string_lossy();
@@ -268,6 +501,23 @@ fn compile_command(
     });
 
     if matches!(emit, EmitMode::Obj) {
+        // A single relocatable object is requested, so compile the merged
+        // module as one unit
+        let phase_start = Instant::now();
+        let object_bytes = match zaco_codegen::CodeGenerator::with_opt_level(opt_level)
+            .and_then(|codegen| codegen.compile_module(&merged_ir))
+        {
+            Ok(bytes) => bytes,
+            Err(e) => {
+                eprintln!("Codegen error: {}", e);
+                return ExitCode::FAILURE;
+            }
+        };
+        timings.record_phase("codegen", phase_start.elapsed());
+        if verbose {
+            println!("  {} bytes of object code generated", object_bytes.len());
+        }
+
         let obj_path = output_path.with_extension("o");
         match fs::write(&obj_path, &object_bytes) {
             Ok(_) => {
@@ -281,6 +531,15 @@ fn compile_command(
         }
     }
 
+    // Executables are linked from one object per source module, generated
+    // in parallel and reused from the cache when the module is unchanged.
+    let phase_start = Instant::now();
+    let objects = match emit_module_objects(&merged_ir, codegen_units, cache.as_ref(), jobs, opt_level, verbose) {
+        Some(objects) => objects,
+        None => return ExitCode::FAILURE,
+    };
+    timings.record_phase("codegen", phase_start.elapsed());
+
     // Phase 6: Linking
     if verbose {
         println!("\n[Phase 6] Linking...");
@@ -289,7 +548,7 @@ fn compile_command(
     // Find the runtime source
     let runtime_path = find_runtime_source(&input);
 
-    match link_executable(&object_bytes, &output_path, runtime_path.as_deref(), verbose) {
+    match link_executable(&objects, &output_path, runtime_path.as_deref(), timings, verbose) {
         Ok(_) => {
             println!("Executable written to: {}", output_path.display());
             ExitCode::SUCCESS
@@ -301,6 +560,67 @@ fn compile_command(
     }
 }
 
+/// Compile `input` into a temporary executable and run it with `args`,
+/// returning its exit status. With `profile_output`, the program is built
+/// with profiling probes and its samples are written there.
+fn run_command(
+    input: PathBuf,
+    jobs: Option<usize>,
+    no_cache: bool,
+    opt_level: OptLevel,
+    profile_output: Option<PathBuf>,
+    verbose: bool,
+    args: &[String],
+) -> ExitCode {
+    let run_dir = std::env::temp_dir().join(format!("zaco-run-{}", std::process::id()));
+    if let Err(e) = fs::create_dir_all(&run_dir) {
+        eprintln!("Error creating {}: {}", run_dir.display(), e);
+        return ExitCode::FAILURE;
+    }
+    let stem = input.file_stem().unwrap_or_default().to_string_lossy().to_string();
+    let executable = run_dir.join(stem);
+
+    let profile = profile_output.is_some();
+    let status = compile_command(
+        input,
+        Some(executable.clone()),
+        EmitMode::Exe,
+        None,
+        jobs,
+        no_cache,
+        opt_level,
+        profile,
+        None,
+        verbose,
+    );
+    if status != ExitCode::SUCCESS {
+        let _ = fs::remove_dir_all(&run_dir);
+        return status;
+    }
+
+    let mut command = Command::new(&executable);
+    command.args(args);
+    if let Some(path) = profile_output {
+        // The program may change its working directory
+        let path = std::env::current_dir().map(|cwd| cwd.join(&path)).unwrap_or(path);
+        command.env("ZACO_PROFILE", path);
+    }
+    let result = command.status();
+    let _ = fs::remove_dir_all(&run_dir);
+
+    match result {
+        Ok(status) => match status.code() {
+            Some(code) => ExitCode::from(code as u8),
+            // Killed by a signal
+            None => ExitCode::FAILURE,
+        },
+        Err(e) => {
+            eprintln!("Error running {}: {}", executable.display(), e);
+            ExitCode::FAILURE
+        }
+    }
+}
+
 fn check_command(input: PathBuf, verbose: bool) -> ExitCode {
     if verbose {
         println!("Type checking: {}", input.display());
@@ -316,19 +636,15 @@ fn check_command(input: PathBuf, verbose: bool) -> ExitCode {
 
     let filename = input.to_string_lossy().to_string();
 
-    // Lex
-    let mut lexer = Lexer::new(&source);
-    let tokens = lexer.tokenize();
-
-    let has_errors = tokens.iter().any(|t| t.kind == TokenKind::Error);
-    if has_errors {
-        report_lexer_errors(&tokens, &filename, &source);
+    // Lex and parse; the parser pulls tokens as it goes
+    let mut parser = zaco_parser::Parser::from_lexer(Lexer::new(&source));
+    let result = parser.parse_program();
+    if !parser.lex_errors().is_empty() {
+        report_lexer_errors(parser.lex_errors(), &filename, &source);
         return ExitCode::FAILURE;
     }
 
-    // Parse
-    let mut parser = zaco_parser::Parser::new(tokens);
-    let program = match parser.parse_program() {
+    let program = match result {
         Ok(prog) => prog,
         Err(errors) => {
             for err in &errors {
@@ -427,17 +743,14 @@ fn parse_command(input: PathBuf, _pretty: bool) -> ExitCode {
 
     let filename = input.to_string_lossy().to_string();
 
-    let mut lexer = Lexer::new(&source);
-    let tokens = lexer.tokenize();
-
-    let has_errors = tokens.iter().any(|t| t.kind == TokenKind::Error);
-    if has_errors {
-        report_lexer_errors(&tokens, &filename, &source);
+    let mut parser = zaco_parser::Parser::from_lexer(Lexer::new(&source));
+    let result = parser.parse_program();
+    if !parser.lex_errors().is_empty() {
+        report_lexer_errors(parser.lex_errors(), &filename, &source);
         return ExitCode::FAILURE;
     }
 
-    let mut parser = zaco_parser::Parser::new(tokens);
-    match parser.parse_program() {
+    match result {
         Ok(program) => {
             println!("{:#?}", program);
             ExitCode::SUCCESS
@@ -608,19 +921,29 @@ fn dump_ir(module: &zaco_ir::IrModule) {
 }
 
 fn link_executable(
-    object_bytes: &[u8],
+    objects: &[Vec<u8>],
     output_path: &PathBuf,
     runtime_path: Option<&std::path::Path>,
+    timings: &Timings,
     verbose: bool,
 ) -> io::Result<()> {
+    let link_start = Instant::now();
+    let mut runtime_build = std::time::Duration::ZERO;
     let temp_dir = std::env::temp_dir();
     let pid = std::process::id();
-    let temp_obj = temp_dir.join(format!("zaco_temp_{}.o", pid));
-    fs::write(&temp_obj, object_bytes)?;
+    let mut temp_objs = Vec::with_capacity(objects.len());
+    for (i, object_bytes) in objects.iter().enumerate() {
+        let temp_obj = temp_dir.join(format!("zaco_temp_{}_{}.o", pid, i));
+        if let Err(e) = fs::write(&temp_obj, object_bytes) {
+            remove_files(&temp_objs);
+            return Err(e);
+        }
+        temp_objs.push(temp_obj);
+    }
 
-    let linker = "cc";
+    let rt_opts = runtime_cache::RuntimeBuildOptions::from_env();
 
-    let mut cmd = Command::new(linker);
+    let mut cmd = Command::new(&rt_opts.cc);
     cmd.arg("-o").arg(output_path);
 
     // On macOS, suppress linker warnings about missing platform load
@@ -630,30 +953,30 @@ fn link_executable(
         cmd.arg("-Wl,-w");
     }
 
-    // Add the compiled object file
-    cmd.arg(&temp_obj);
+    // Add the compiled object files
+    cmd.args(&temp_objs);
 
-    // Compile and link the C runtime if available
+    // Link the prebuilt C runtime archive if available
     if let Some(rt_path) = runtime_path {
         if verbose {
             println!("  Using C runtime: {}", rt_path.display());
         }
-        // Compile runtime.c to .o and link together
-        let temp_rt_obj = temp_dir.join(format!("zaco_runtime_{}.o", pid));
-        let rt_status = Command::new("cc")
-            .args(["-c", "-o"])
-            .arg(&temp_rt_obj)
-            .arg(rt_path)
-            .status()?;
-
-        if !rt_status.success() {
-            let _ = fs::remove_file(&temp_obj);
-            return Err(io::Error::new(
-                io::ErrorKind::Other,
-                "Failed to compile runtime.c",
-            ));
+        // Reuse the cached archive for this runtime source, building it on
+        // first use instead of recompiling runtime.c on every link
+        let build_start = Instant::now();
+        let rt_archive = match runtime_cache::runtime_archive(rt_path, &rt_opts, verbose) {
+            Ok(archive) => archive,
+            Err(e) => {
+                remove_files(&temp_objs);
+                return Err(e);
+            }
+        };
+        runtime_build = build_start.elapsed();
+        timings.record_phase("runtime_build", runtime_build);
+        if rt_opts.lto {
+            cmd.arg("-flto");
         }
-        cmd.arg(&temp_rt_obj);
+        cmd.arg(&rt_archive);
 
         // Link the Rust runtime static library
         let rust_runtime_lib = find_rust_runtime(rt_path);
@@ -676,176 +999,252 @@ fn link_executable(
             eprintln!("Warning: Rust runtime library not found");
             eprintln!("To build it, run: cd runtime/zaco_runtime_rs && cargo build --release");
         }
-
-        let status = cmd.status()?;
-
-        // Clean up temp files
-        let _ = fs::remove_file(&temp_obj);
-        let _ = fs::remove_file(&temp_rt_obj);
-
-        if status.success() {
-            Ok(())
-        } else {
-            Err(io::Error::new(
-                io::ErrorKind::Other,
-                format!("Linker exited with status: {}", status),
-            ))
-        }
     } else {
         // No runtime — link just the object file (will fail if runtime symbols are referenced)
         if verbose {
             println!("  Warning: Runtime not found, linking without it");
         }
-        let status = cmd.status()?;
-        let _ = fs::remove_file(&temp_obj);
+    }
 
-        if status.success() {
-            Ok(())
-        } else {
-            Err(io::Error::new(
-                io::ErrorKind::Other,
-                format!("Linker exited with status: {}", status),
-            ))
+    let status = cmd.status();
+    remove_files(&temp_objs);
+    let status = status?;
+    // Everything in this function except building the runtime archive
+    timings.record_phase("link", link_start.elapsed().saturating_sub(runtime_build));
+
+    if status.success() {
+        Ok(())
+    } else {
+        Err(io::Error::new(
+            io::ErrorKind::Other,
+            format!("Linker exited with status: {}", status),
+        ))
+    }
+}
+
+fn remove_files(paths: &[PathBuf]) {
+    for path in paths {
+        let _ = fs::remove_file(path);
+    }
+}
+
+/// One source module's slice of the merged program, compiled to its own object.
+struct ObjectJob {
+    module_path: PathBuf,
+    unit: zaco_codegen::CodegenUnit,
+    /// The module's IR cache key, the basis of its object cache key
+    module_key: u64,
+}
+
+/// Generate one object file per codegen unit on `jobs` workers, reusing
+/// cached objects whose module and link interface are unchanged. Errors are
+/// reported here; returns the objects in unit order.
+fn emit_module_objects(
+    merged_ir: &zaco_ir::IrModule,
+    units: Vec<ObjectJob>,
+    cache: Option<&IncrementalCache>,
+    jobs: usize,
+    opt_level: OptLevel,
+    verbose: bool,
+) -> Option<Vec<Vec<u8>>> {
+    let interface_hash = incremental::link_interface_hash(merged_ir);
+    let paths: Vec<PathBuf> = units.iter().map(|job| job.module_path.clone()).collect();
+    let unit_jobs = units.into_iter().map(|job| (Vec::new(), job)).collect();
+
+    let outcomes = scheduler::run_after_dependencies(unit_jobs, jobs, |job: ObjectJob| -> Result<_, zaco_codegen::CodegenError> {
+        let key = incremental::object_key(job.module_key, interface_hash);
+        if let Some(object) = cache.and_then(|c| c.load_object(key)) {
+            return Ok((object, true));
+        }
+        let object = zaco_codegen::CodeGenerator::with_opt_level(opt_level)
+            .and_then(|codegen| codegen.compile_unit(merged_ir, &job.unit))?;
+        if let Some(cache) = cache {
+            // A failed write only costs a rebuild next time
+            let _ = cache.store_object(key, &object);
+        }
+        Ok((object, false))
+    });
+
+    let mut objects = Vec::with_capacity(outcomes.len());
+    let mut failed = false;
+    for (path, outcome) in paths.iter().zip(outcomes) {
+        match outcome {
+            JobOutcome::Done((object, from_cache)) => {
+                if verbose {
+                    println!(
+                        "  {}: {} ({} bytes)",
+                        if from_cache { "Cached object" } else { "Generated object" },
+                        path.display(),
+                        object.len()
+                    );
+                }
+                objects.push(object);
+            }
+            JobOutcome::Failed(e) => {
+                eprintln!("Codegen error in {}: {}", path.display(), e);
+                failed = true;
+            }
+            JobOutcome::Skipped => failed = true,
         }
     }
+    if failed { None } else { Some(objects) }
 }
 
 // ============================================================================
 // Module system helper functions
 // ============================================================================
 
-use std::collections::{HashMap, HashSet, VecDeque};
+use std::collections::{HashMap, HashSet};
 use std::path::Path;
 use zaco_ast::{ExportDecl, ImportDecl, ModuleItem, Program};
 
+/// A module read, parsed and import-resolved during discovery.
+struct DiscoveredModule {
+    source: String,
+    program: Program,
+    dependencies: Vec<PathBuf>,
+    exports: HashSet<String>,
+}
+
 /// Discover all modules starting from an entry point.
-/// Returns a cache of parsed programs to avoid re-parsing during compilation.
+/// Modules are read, lexed and parsed in parallel on `jobs` threads; the
+/// parsed programs are returned in `parse_cache` to avoid re-parsing during
+/// compilation.
 fn discover_modules(
     entry: &Path,
     resolver: &ModuleResolver,
+    declarations: &DeclarationCache,
     graph: &mut DepGraph,
     verbose: bool,
+    jobs: usize,
+    timings: &Timings,
     parse_cache: &mut HashMap<PathBuf, (String, Program)>,
 ) -> Result<(), String> {
-    let mut queue: VecDeque<PathBuf> = VecDeque::new();
-    let mut visited: HashSet<PathBuf> = HashSet::new();
+    let modules = scheduler::discover_parallel(vec![entry.to_path_buf()], jobs, |path| -> Result<_, String> {
+        let module = discover_module(path, resolver, declarations, verbose, timings)?;
+        let dependencies = module.dependencies.clone();
+        Ok((module, dependencies))
+    })?;
+
+    for (path, module) in modules {
+        graph.add_module(path.clone(), module.dependencies, module.exports);
+        parse_cache.insert(path, (module.source, module.program));
+    }
 
-    queue.push_back(entry.to_path_buf());
+    Ok(())
+}
 
-    while let Some(current_path) = queue.pop_front() {
-        if visited.contains(&current_path) {
-            continue;
-        }
-        visited.insert(current_path.clone());
-
-        // Read and parse the module
-        let source = fs::read_to_string(&current_path).map_err(|e| {
-            format!(
-                "Failed to read module {}: {}",
-                current_path.display(),
-                e
-            )
-        })?;
-
-        let mut lexer = Lexer::new(&source);
-        let tokens = lexer.tokenize();
-
-        let has_errors = tokens.iter().any(|t| t.kind == TokenKind::Error);
-        if has_errors {
-            return Err(format!(
-                "Lexer errors in module: {}",
-                current_path.display()
-            ));
-        }
+/// Read, lex and parse one module and resolve its imports.
+fn discover_module(
+    current_path: &Path,
+    resolver: &ModuleResolver,
+    declarations: &DeclarationCache,
+    verbose: bool,
+    timings: &Timings,
+) -> Result<DiscoveredModule, String> {
+    let source = fs::read_to_string(current_path).map_err(|e| {
+        format!(
+            "Failed to read module {}: {}",
+            current_path.display(),
+            e
+        )
+    })?;
+
+    let parse_start = Instant::now();
+    let mut parser = zaco_parser::Parser::from_lexer(Lexer::new(&source));
+    let result = parser.parse_program();
+    timings.module(current_path, |m| m.parse = parse_start.elapsed());
+    if !parser.lex_errors().is_empty() {
+        return Err(format!(
+            "Lexer errors in module: {}",
+            current_path.display()
+        ));
+    }
 
-        let mut parser = zaco_parser::Parser::new(tokens);
-        let program = parser.parse_program().map_err(|errors| {
-            format!(
-                "Parse errors in module {}: {}",
-                current_path.display(),
-                errors
-                    .iter()
-                    .map(|e| e.message.clone())
-                    .collect::<Vec<_>>()
-                    .join(", ")
-            )
-        })?;
-
-        // Extract imports and exports
-        let (imports, exports) = extract_imports_exports(&program);
-
-        // Resolve imports to module paths
-        let mut dependencies = Vec::new();
-        for import in &imports {
-            match resolver.resolve(&import.source, &current_path) {
-                Ok(ResolvedModule::LocalFile(path)) => {
-                    dependencies.push(path.clone());
-                    queue.push_back(path);
+    let program = result.map_err(|errors| {
+        format!(
+            "Parse errors in module {}: {}",
+            current_path.display(),
+            errors
+                .iter()
+                .map(|e| e.message.clone())
+                .collect::<Vec<_>>()
+                .join(", ")
+        )
+    })?;
+
+    // Extract imports and exports
+    let (imports, exports) = extract_imports_exports(&program);
+
+    // Resolve imports to module paths
+    let mut dependencies = Vec::new();
+    for import in &imports {
+        match resolver.resolve(&import.source, current_path) {
+            Ok(ResolvedModule::LocalFile(path)) => {
+                dependencies.push(path);
+            }
+            Ok(ResolvedModule::Builtin(name)) => {
+                if verbose {
+                    println!("  Note: Skipping built-in module: {}", name);
                 }
-                Ok(ResolvedModule::Builtin(name)) => {
-                    if verbose {
-                        println!("  Note: Skipping built-in module: {}", name);
-                    }
+            }
+            Ok(ResolvedModule::Package(path)) => {
+                // NPM package resolved successfully
+                if verbose {
+                    println!("  Resolved NPM package '{}' to: {}", import.source, path.display());
                 }
-                Ok(ResolvedModule::Package(path)) => {
-                    // NPM package resolved successfully
+
+                // If it's a .d.ts file, load type declarations but don't compile
+                if path.extension().and_then(|s| s.to_str()) == Some("ts")
+                    && path.to_string_lossy().ends_with(".d.ts") {
                     if verbose {
-                        println!("  Resolved NPM package '{}' to: {}", import.source, path.display());
+                        println!("  Loading type declarations from: {}", path.display());
                     }
-
-                    // If it's a .d.ts file, load type declarations but don't compile
-                    if path.extension().and_then(|s| s.to_str()) == Some("ts")
-                        && path.to_string_lossy().ends_with(".d.ts") {
-                        if verbose {
-                            println!("  Loading type declarations from: {}", path.display());
-                        }
-                        // Load declarations for type checking
-                        match dts_loader::DtsLoader::load_declarations(&path) {
-                            Ok(decls) => {
-                                if verbose {
-                                    println!("    Loaded {} type declarations", decls.len());
-                                }
-                                // Type declarations are loaded but not added to compilation queue
+                    // Load declarations for type checking
+                    match declarations.load(&path) {
+                        Ok(decls) => {
+                            if verbose {
+                                println!("    Loaded {} type declarations", decls.len());
                             }
-                            Err(e) => {
-                                if verbose {
-                                    println!("    Warning: Failed to load .d.ts: {}", e);
-                                }
+                            // Type declarations are loaded but not added to compilation queue
+                        }
+                        Err(e) => {
+                            if verbose {
+                                println!("    Warning: Failed to load .d.ts: {}", e);
                             }
                         }
-                    } else {
-                        // Regular package file - add to compilation queue
-                        dependencies.push(path.clone());
-                        queue.push_back(path);
                     }
+                } else {
+                    // Regular package file - add to compilation queue
+                    dependencies.push(path);
                 }
-                Ok(ResolvedModule::PackageNotFound { name: pkg_name, reason }) => {
-                    return Err(format!(
-                        "Cannot resolve import '{}' in {}: package '{}' not found ({})",
-                        import.source,
-                        current_path.display(),
-                        pkg_name,
-                        reason,
-                    ));
-                }
-                Err(e) => {
-                    return Err(format!(
-                        "Failed to resolve import '{}' in {}: {}",
-                        import.source,
-                        current_path.display(),
-                        e
-                    ));
-                }
+            }
+            Ok(ResolvedModule::PackageNotFound { name: pkg_name, reason }) => {
+                return Err(format!(
+                    "Cannot resolve import '{}' in {}: package '{}' not found ({})",
+                    import.source,
+                    current_path.display(),
+                    pkg_name,
+                    reason,
+                ));
+            }
+            Err(e) => {
+                return Err(format!(
+                    "Failed to resolve import '{}' in {}: {}",
+                    import.source,
+                    current_path.display(),
+                    e
+                ));
             }
         }
-
-        graph.add_module(current_path.clone(), dependencies, exports);
-
-        // Cache the parsed program to avoid re-parsing during compilation
-        parse_cache.insert(current_path, (source, program));
     }
 
-    Ok(())
+    Ok(DiscoveredModule {
+        source,
+        program,
+        dependencies,
+        exports,
+    })
 }
 
 /// Extract imports and exports from a program AST
@@ -878,7 +1277,7 @@ fn extract_export_names(export_decl: &ExportDecl, exports: &mut HashSet<String>)
                 } else {
                     spec.local.value.name.clone()
                 };
-                exports.insert(name);
+                exports.insert(name.to_string());
             }
         }
         ExportDecl::Default(_) | ExportDecl::DefaultDecl(_) => {
@@ -886,7 +1285,7 @@ fn extract_export_names(export_decl: &ExportDecl, exports: &mut HashSet<String>)
         }
         ExportDecl::All { as_name, .. } => {
             if let Some(ref name) = as_name {
-                exports.insert(name.value.name.clone());
+                exports.insert(name.value.name.to_string());
             }
         }
         ExportDecl::Decl(decl) => {
@@ -894,26 +1293,26 @@ fn extract_export_names(export_decl: &ExportDecl, exports: &mut HashSet<String>)
             use zaco_ast::Decl;
             match &decl.value {
                 Decl::Function(func) => {
-                    exports.insert(func.name.value.name.clone());
+                    exports.insert(func.name.value.name.to_string());
                 }
                 Decl::Var(var_decl) => {
                     for declarator in &var_decl.declarations {
                         if let zaco_ast::Pattern::Ident { name, .. } = &declarator.pattern.value {
-                            exports.insert(name.value.name.clone());
+                            exports.insert(name.value.name.to_string());
                         }
                     }
                 }
                 Decl::Class(class) => {
-                    exports.insert(class.name.value.name.clone());
+                    exports.insert(class.name.value.name.to_string());
                 }
                 Decl::TypeAlias(alias) => {
-                    exports.insert(alias.name.value.name.clone());
+                    exports.insert(alias.name.value.name.to_string());
                 }
                 Decl::Interface(iface) => {
-                    exports.insert(iface.name.value.name.clone());
+                    exports.insert(iface.name.value.name.to_string());
                 }
                 Decl::Enum(enum_decl) => {
-                    exports.insert(enum_decl.name.value.name.clone());
+                    exports.insert(enum_decl.name.value.name.to_string());
                 }
                 _ => {}
             }
@@ -921,90 +1320,144 @@ fn extract_export_names(export_decl: &ExportDecl, exports: &mut HashSet<String>)
     }
 }
 
-/// Compile a single module (typecheck, lower to IR).
-/// Uses cached parse results when available to avoid re-parsing.
-fn compile_single_module(
-    module_path: &Path,
-    emit: &EmitMode,
-    verbose: bool,
-    parse_cache: &mut HashMap<PathBuf, (String, Program)>,
-    module_name: Option<&str>,
-    func_id_offset: usize,
-    struct_id_offset: usize,
-) -> Result<zaco_ir::IrModule, ()> {
-    // Use cached parse result if available, otherwise parse from scratch
-    let (source, program) = if let Some(cached) = parse_cache.remove(module_path) {
-        cached
-    } else {
-        let source = fs::read_to_string(module_path).map_err(|e| {
-            eprintln!("Error reading {}: {}", module_path.display(), e);
-        })?;
-
-        let mut lexer = Lexer::new(&source);
-        let tokens = lexer.tokenize();
-
-        let has_errors = tokens.iter().any(|t| t.kind == TokenKind::Error);
-        if has_errors {
-            let filename = module_path.to_string_lossy().to_string();
-            report_lexer_errors(&tokens, &filename, &source);
-            return Err(());
+/// A diagnostic produced off the main thread, reported once the frontend
+/// workers have finished so output stays in compilation order.
+struct Diagnostic {
+    code: &'static str,
+    title: &'static str,
+    message: String,
+    start: usize,
+    end: usize,
+}
+
+/// All diagnostics for one module that failed to compile.
+struct ModuleErrors {
+    filename: String,
+    source: String,
+    diagnostics: Vec<Diagnostic>,
+}
+
+impl ModuleErrors {
+    fn report(&self) {
+        for d in &self.diagnostics {
+            report_error(d.code, d.title, &d.message, d.start, d.end, &self.filename, &self.source);
         }
+    }
+}
 
-        let mut parser = zaco_parser::Parser::new(tokens);
-        let program = match parser.parse_program() {
-            Ok(prog) => prog,
-            Err(errors) => {
-                let filename = module_path.to_string_lossy().to_string();
-                for err in &errors {
-                    report_error(
-                        "E1000",
-                        "Parse error",
-                        &err.message,
-                        err.span.start,
-                        err.span.end,
-                        &filename,
-                        &source,
-                    );
-                }
-                return Err(());
-            }
-        };
+/// One module's input to the parallel frontend.
+struct FrontendJob {
+    module_path: PathBuf,
+    source: String,
+    program: Program,
+    module_name: Option<String>,
+    dependencies: Vec<PathBuf>,
+    exports: HashSet<String>,
+}
 
-        (source, program)
+/// Compile and optimize one module, reusing its cached IR when the module
+/// source, the optimization level and the export signatures of everything it
+/// imports are unchanged. Publishes the
+/// module's own export signature hash for its dependents, which the
+/// scheduler only starts once this job has finished.
+///
+/// Returns the IR, whether it came from the cache, and the module's cache key.
+fn compile_module_cached(
+    job: FrontendJob,
+    cache: Option<&IncrementalCache>,
+    export_hashes: &Mutex<HashMap<PathBuf, u64>>,
+    opt_level: OptLevel,
+    profile: bool,
+    timings: &Timings,
+) -> Result<(zaco_ir::IrModule, bool, u64), ModuleErrors> {
+    let dep_hashes: Vec<u64> = {
+        let hashes = export_hashes.lock().unwrap();
+        job.dependencies
+            .iter()
+            .map(|dep| hashes.get(dep).copied().unwrap_or(0))
+            .collect()
+    };
+    let key = incremental::module_key(
+        &job.source,
+        &job.module_path,
+        job.module_name.as_deref(),
+        &dep_hashes,
+        opt_level,
+        profile,
+    );
+
+    let publish = |export_hash: u64| {
+        export_hashes
+            .lock()
+            .unwrap()
+            .insert(job.module_path.clone(), export_hash);
     };
 
-    let filename = module_path.to_string_lossy().to_string();
+    if let Some(hit) = cache.and_then(|c| c.load(key)) {
+        timings.module(&job.module_path, |m| m.cached = true);
+        publish(hit.export_hash);
+        return Ok((hit.ir, true, key));
+    }
 
-    if matches!(emit, EmitMode::Ast) {
-        println!("AST for {}:", filename);
-        println!("{:#?}", program);
+    let mut ir_module = compile_single_module(
+        &job.module_path,
+        job.source,
+        &job.program,
+        job.module_name.as_deref(),
+        timings,
+    )?;
+    // Optimizing per module keeps inlining within one codegen unit, so a
+    // module's cached object never embeds another module's function bodies
+    let optimize_start = Instant::now();
+    zaco_ir::opt::optimize_module(&mut ir_module, opt_level);
+    timings.module(&job.module_path, |m| m.optimize = optimize_start.elapsed());
+    if profile {
+        zaco_ir::profile::insert_profile_probes(&mut ir_module);
     }
+    let export_hash = incremental::export_signature_hash(&job.exports, &ir_module);
+    if let Some(cache) = cache {
+        // A failed write only costs a rebuild next time
+        let _ = cache.store(key, export_hash, &ir_module);
+    }
+    publish(export_hash);
+    Ok((ir_module, false, key))
+}
+
+/// Compile a single parsed module (typecheck, lower to IR).
+///
+/// Runs on a frontend worker thread, so errors are returned rather than
+/// printed. Function and struct ids start at 0; the caller rebases them.
+fn compile_single_module(
+    module_path: &Path,
+    source: String,
+    program: &Program,
+    module_name: Option<&str>,
+    timings: &Timings,
+) -> Result<zaco_ir::IrModule, ModuleErrors> {
+    let filename = module_path.to_string_lossy().to_string();
 
     // Phase 3: Type checking
-    let _typed_program = match zaco_typeck::check_program(&program) {
-        Ok(typed) => typed,
-        Err(errors) => {
-            for err in &errors {
-                let msg = err.kind.to_string();
-                report_error(
-                    "E2000",
-                    "Type error",
-                    &msg,
-                    err.span.start,
-                    err.span.end,
-                    &filename,
-                    &source,
-                );
-            }
-            return Err(());
-        }
-    };
+    let typeck_start = Instant::now();
+    let checked = zaco_typeck::check_program(program);
+    timings.module(module_path, |m| m.typeck = typeck_start.elapsed());
+    if let Err(errors) = checked {
+        let diagnostics = errors
+            .iter()
+            .map(|err| Diagnostic {
+                code: "E2000",
+                title: "Type error",
+                message: err.kind.to_string(),
+                start: err.span.start,
+                end: err.span.end,
+            })
+            .collect();
+        return Err(ModuleErrors { filename, source, diagnostics });
+    }
 
     // Phase 4: AST → IR lowering
+    let lower_start = Instant::now();
     let lowerer = {
         let l = zaco_ir::lower::Lowerer::new()
-            .with_func_id_offset(func_id_offset)
-            .with_struct_id_offset(struct_id_offset)
             .with_file_path(module_path.to_string_lossy().into_owned());
         if let Some(name) = module_name {
             l.with_module_name(name.to_string())
@@ -1012,33 +1465,21 @@ fn compile_single_module(
             l
         }
     };
-    let ir_module = match lowerer.lower_program(&program) {
-        Ok(module) => module,
-        Err(errors) => {
-            for err in &errors {
-                report_error(
-                    "E3000",
-                    "Lowering error",
-                    &err.message,
-                    err.span.start,
-                    err.span.end,
-                    &filename,
-                    &source,
-                );
-            }
-            return Err(());
-        }
-    };
-
-    if verbose {
-        println!(
-            "  Compiled: {} ({} functions)",
-            filename,
-            ir_module.functions.len()
-        );
-    }
-
-    Ok(ir_module)
+    let lowered = lowerer.lower_program(program);
+    timings.module(module_path, |m| m.lower = lower_start.elapsed());
+    lowered.map_err(|errors| {
+        let diagnostics = errors
+            .iter()
+            .map(|err| Diagnostic {
+                code: "E3000",
+                title: "Lowering error",
+                message: err.message.clone(),
+                start: err.span.start,
+                end: err.span.end,
+            })
+            .collect();
+        ModuleErrors { filename, source, diagnostics }
+    })
 }
 
 /// Merge multiple IR modules into a single module (order-preserving).
@@ -1069,7 +1510,7 @@ fn merge_ir_modules(
 
         // Merge string literals
         for lit in ir_module.string_literals {
-            merged.intern_string(lit);
+            merged.intern_string(&lit);
         }
 
         // Merge extern function declarations (deduplicate by name — safe for declarations)
@@ -1142,7 +1583,9 @@ fn inject_module_init_calls(module: &mut zaco_ir::IrModule) {
     if let Some(main_func) = module.functions.iter_mut().find(|f| f.name == "main") {
         let entry_block = main_func.entry_block;
 
-        // Build Call instructions for each init function
+        // Build Call instructions for each init function. The calls are added
+        // after exception checks were inserted, so report an exception that
+        // escapes a module's top level right away.
         let mut init_calls: Vec<zaco_ir::Instruction> = Vec::new();
         for name in &init_names {
             init_calls.push(zaco_ir::Instruction::Call {
@@ -1150,6 +1593,13 @@ fn inject_module_init_calls(module: &mut zaco_ir::IrModule) {
                 func: zaco_ir::Value::Const(zaco_ir::Constant::Str(name.clone())),
                 args: vec![],
             });
+            init_calls.push(zaco_ir::Instruction::Call {
+                dest: None,
+                func: zaco_ir::Value::Const(zaco_ir::Constant::Str(
+                    zaco_ir::exceptions::CHECK_UNCAUGHT.to_string(),
+                )),
+                args: vec![],
+            });
         }
 
         // Prepend init calls before existing instructions in the entry block
@@ -0,0 +1,117 @@
+//! Read-only memory-mapped files
+//!
+//! Large inputs that are only scanned, such as `.d.ts` files from
+//! `node_modules`, are mapped instead of copied into a heap buffer. The
+//! mapping is private and read-only; a file truncated by another process
+//! while mapped is outside what the compiler guards against.
+
+use std::fs::File;
+use std::io;
+use std::ops::Deref;
+use std::path::Path;
+
+/// The contents of a file, mapped into memory where the platform allows it.
+pub struct MappedFile {
+    inner: Inner,
+}
+
+enum Inner {
+    #[cfg(unix)]
+    Mapped { ptr: *mut libc::c_void, len: usize },
+    /// Empty files (which cannot be mapped) and non-unix platforms.
+    Owned(Vec<u8>),
+}
+
+// The mapping is read-only and owned by this value.
+unsafe impl Send for MappedFile {}
+unsafe impl Sync for MappedFile {}
+
+impl MappedFile {
+    /// Map `path` read-only.
+    #[cfg(unix)]
+    pub fn open(path: &Path) -> io::Result<Self> {
+        use std::os::unix::io::AsRawFd;
+
+        let file = File::open(path)?;
+        let len = file.metadata()?.len() as usize;
+        if len == 0 {
+            return Ok(MappedFile { inner: Inner::Owned(Vec::new()) });
+        }
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(MappedFile { inner: Inner::Mapped { ptr, len } })
+    }
+
+    /// Read `path` into memory.
+    #[cfg(not(unix))]
+    pub fn open(path: &Path) -> io::Result<Self> {
+        use std::io::Read;
+
+        let mut bytes = Vec::new();
+        File::open(path)?.read_to_end(&mut bytes)?;
+        Ok(MappedFile { inner: Inner::Owned(bytes) })
+    }
+
+    /// The contents as UTF-8 text.
+    pub fn as_str(&self) -> Result<&str, std::str::Utf8Error> {
+        std::str::from_utf8(self)
+    }
+}
+
+impl Deref for MappedFile {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        match &self.inner {
+            #[cfg(unix)]
+            Inner::Mapped { ptr, len } => unsafe { std::slice::from_raw_parts(*ptr as *const u8, *len) },
+            Inner::Owned(bytes) => bytes,
+        }
+    }
+}
+
+impl Drop for MappedFile {
+    fn drop(&mut self) {
+        #[cfg(unix)]
+        if let Inner::Mapped { ptr, len } = self.inner {
+            unsafe {
+                libc::munmap(ptr, len);
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::fs;
+
+    #[test]
+    fn test_maps_file_contents() {
+        let dir = std::env::temp_dir().join(format!("zaco_mmap_{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+
+        let path = dir.join("decl.d.ts");
+        fs::write(&path, "export declare const VERSION: string;\n").unwrap();
+        let mapped = MappedFile::open(&path).unwrap();
+        assert_eq!(mapped.as_str().unwrap(), "export declare const VERSION: string;\n");
+
+        let empty = dir.join("empty.d.ts");
+        fs::write(&empty, "").unwrap();
+        assert!(MappedFile::open(&empty).unwrap().is_empty());
+
+        assert!(MappedFile::open(&dir.join("missing.d.ts")).is_err());
+        let _ = fs::remove_dir_all(&dir);
+    }
+}
@@ -2,19 +2,34 @@
 //!
 //! Implements Node.js module resolution algorithm for resolving
 //! package names to their entry files.
+//!
+//! Results are memoized for the lifetime of the resolver, which spans one
+//! build: a specifier imported from many files in the same directory walks
+//! `node_modules` once, and each package's `package.json` is read once no
+//! matter how many directories import it.
 
+use std::collections::HashMap;
 use std::path::{Path, PathBuf};
+use std::sync::Mutex;
 
 use crate::package_json::parse_package_json;
 
 pub struct NpmResolver {
     project_root: PathBuf,
+    /// (specifier, importing directory) → resolved entry file
+    resolutions: Mutex<HashMap<(String, PathBuf), Result<PathBuf, String>>>,
+    /// (package directory, subpath) → resolved entry file
+    entries: Mutex<HashMap<(PathBuf, Option<String>), Result<PathBuf, String>>>,
 }
 
 impl NpmResolver {
     /// Create a new NPM resolver
     pub fn new(project_root: PathBuf) -> Self {
-        Self { project_root }
+        Self {
+            project_root,
+            resolutions: Mutex::new(HashMap::new()),
+            entries: Mutex::new(HashMap::new()),
+        }
     }
 
     /// Find the project root by searching for package.json
@@ -47,14 +62,25 @@ impl NpmResolver {
     /// 5. If not found, go up one directory and repeat
     /// 6. Stop at project root or filesystem root
     pub fn resolve(&self, package_name: &str, from_file: &Path) -> Result<PathBuf, String> {
+        // Start from the importing file's directory
+        let from_dir = from_file
+            .parent()
+            .ok_or_else(|| format!("Cannot resolve package from file: {}", from_file.display()))?;
+
+        let key = (package_name.to_string(), from_dir.to_path_buf());
+        if let Some(resolved) = self.resolutions.lock().unwrap().get(&key) {
+            return resolved.clone();
+        }
+        let resolved = self.resolve_uncached(package_name, from_dir);
+        self.resolutions.lock().unwrap().insert(key, resolved.clone());
+        resolved
+    }
+
+    fn resolve_uncached(&self, package_name: &str, from_dir: &Path) -> Result<PathBuf, String> {
         // Parse package name and subpath
         let (pkg_name, subpath) = Self::parse_package_specifier(package_name);
 
-        // Start from the importing file's directory
-        let mut current = from_file
-            .parent()
-            .ok_or_else(|| format!("Cannot resolve package from file: {}", from_file.display()))?
-            .to_path_buf();
+        let mut current = from_dir.to_path_buf();
 
         loop {
             let node_modules = current.join("node_modules");
@@ -62,7 +88,7 @@ impl NpmResolver {
 
             if package_dir.exists() && package_dir.is_dir() {
                 // Found the package directory
-                return self.resolve_package_entry(&package_dir, subpath);
+                return self.resolve_package_entry_cached(&package_dir, subpath);
             }
 
             // Stop at project root after checking it
@@ -129,6 +155,22 @@ impl NpmResolver {
         }
     }
 
+    /// Resolve the entry file for a package, reading its package.json at
+    /// most once
+    fn resolve_package_entry_cached(
+        &self,
+        package_dir: &Path,
+        subpath: Option<&str>,
+    ) -> Result<PathBuf, String> {
+        let key = (package_dir.to_path_buf(), subpath.map(str::to_string));
+        if let Some(resolved) = self.entries.lock().unwrap().get(&key) {
+            return resolved.clone();
+        }
+        let resolved = self.resolve_package_entry(package_dir, subpath);
+        self.entries.lock().unwrap().insert(key, resolved.clone());
+        resolved
+    }
+
     /// Resolve the entry file for a package
     fn resolve_package_entry(
         &self,
@@ -332,4 +374,32 @@ mod tests {
         // Cleanup
         let _ = fs::remove_dir_all(&temp_dir);
     }
+
+    #[test]
+    fn test_resolution_is_memoized() {
+        use std::fs;
+
+        let root = std::env::temp_dir().join(format!("zaco_npm_memo_{}", std::process::id()));
+        let _ = fs::remove_dir_all(&root);
+        let pkg = root.join("node_modules/left-pad");
+        fs::create_dir_all(&pkg).unwrap();
+        fs::create_dir_all(root.join("src/a")).unwrap();
+        fs::create_dir_all(root.join("src/b")).unwrap();
+        fs::write(root.join("package.json"), r#"{"name":"app","version":"1.0.0"}"#).unwrap();
+        fs::write(pkg.join("package.json"), r#"{"name":"left-pad","version":"1.0.0","main":"lib.ts"}"#).unwrap();
+        fs::write(pkg.join("lib.ts"), "export const pad = 1;").unwrap();
+
+        let resolver = NpmResolver::new(root.clone());
+        let first = resolver.resolve("left-pad", &root.join("src/a/x.ts")).unwrap();
+        assert_eq!(first, pkg.join("lib.ts"));
+
+        // Without package.json the entry can only come from the caches: the
+        // same directory hits the resolution cache, a new one the entry cache
+        fs::remove_file(pkg.join("package.json")).unwrap();
+        assert_eq!(resolver.resolve("left-pad", &root.join("src/a/y.ts")).unwrap(), first);
+        assert_eq!(resolver.resolve("left-pad", &root.join("src/b/z.ts")).unwrap(), first);
+        assert!(NpmResolver::new(root.clone()).resolve("left-pad", &root.join("src/b/z.ts")).is_err());
+
+        let _ = fs::remove_dir_all(&root);
+    }
 }
@@ -0,0 +1,244 @@
+//! Prebuilt C runtime archive cache
+//!
+//! Compiling `zaco_runtime.c` dominates link time for small programs, so the
+//! driver builds it once into an optimized static archive and reuses that
+//! archive on every later link. Archives live in a per-user cache directory
+//! and are keyed by a hash of the runtime source, the compiler flags, the
+//! target triple and the compiler version, so editing the runtime or switching
+//! toolchains transparently produces a fresh archive.
+
+use std::fs;
+use std::io;
+use std::path::{Path, PathBuf};
+use std::process::Command;
+
+use crate::hash::StableHasher;
+
+/// Bumped whenever the archive layout or build recipe changes.
+const CACHE_FORMAT: u32 = 1;
+
+/// Flags the runtime is always compiled with.
+const BASE_CFLAGS: &[&str] = &["-O2", "-fPIC"];
+
+/// How the runtime archive should be built.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct RuntimeBuildOptions {
+    /// C compiler used for the runtime (and later for linking).
+    pub cc: String,
+    /// Emit LTO bitcode (`-flto`) so the final link can optimize across
+    /// the runtime/program boundary. The link step must pass `-flto` too.
+    pub lto: bool,
+}
+
+impl RuntimeBuildOptions {
+    /// Options taken from the environment: `CC` selects the compiler and
+    /// `ZACO_RUNTIME_LTO=1` enables LTO bitcode.
+    pub fn from_env() -> Self {
+        let cc = std::env::var("CC")
+            .ok()
+            .filter(|cc| !cc.trim().is_empty())
+            .unwrap_or_else(|| "cc".to_string());
+        let lto = matches!(
+            std::env::var("ZACO_RUNTIME_LTO").as_deref(),
+            Ok("1") | Ok("true") | Ok("yes")
+        );
+        RuntimeBuildOptions { cc, lto }
+    }
+
+    /// Full flag list passed to the compiler for the runtime object.
+    pub fn cflags(&self) -> Vec<&'static str> {
+        let mut flags = BASE_CFLAGS.to_vec();
+        if self.lto {
+            flags.push("-flto");
+        }
+        flags
+    }
+}
+
+/// Directory holding cached runtime archives.
+///
+/// `ZACO_CACHE_DIR` wins, then `$XDG_CACHE_HOME/zaco`, then `~/.cache/zaco`,
+/// falling back to the system temp directory.
+pub fn cache_dir() -> PathBuf {
+    let base = if let Some(dir) = non_empty_env("ZACO_CACHE_DIR") {
+        PathBuf::from(dir)
+    } else if let Some(dir) = non_empty_env("XDG_CACHE_HOME") {
+        PathBuf::from(dir).join("zaco")
+    } else if let Some(home) = non_empty_env("HOME") {
+        PathBuf::from(home).join(".cache").join("zaco")
+    } else {
+        std::env::temp_dir().join("zaco-cache")
+    };
+    base.join("runtime")
+}
+
+fn non_empty_env(name: &str) -> Option<String> {
+    std::env::var(name).ok().filter(|v| !v.is_empty())
+}
+
+/// Target triple the runtime is compiled for, as reported by the compiler.
+/// Falls back to the host architecture and OS if the compiler can't say.
+pub fn target_triple(cc: &str) -> String {
+    Command::new(cc)
+        .arg("-dumpmachine")
+        .output()
+        .ok()
+        .filter(|out| out.status.success())
+        .and_then(|out| String::from_utf8(out.stdout).ok())
+        .map(|s| s.trim().to_string())
+        .filter(|s| !s.is_empty())
+        .unwrap_or_else(|| format!("{}-{}", std::env::consts::ARCH, std::env::consts::OS))
+}
+
+/// Compiler identification (`cc --version`, first line), part of the key so
+/// a toolchain upgrade doesn't reuse objects built by the old one.
+fn compiler_version(cc: &str) -> String {
+    Command::new(cc)
+        .arg("--version")
+        .output()
+        .ok()
+        .and_then(|out| String::from_utf8(out.stdout).ok())
+        .and_then(|s| s.lines().next().map(str::to_string))
+        .unwrap_or_default()
+}
+
+/// Cache key for a runtime source under the given flags and toolchain.
+pub fn cache_key(source: &[u8], cflags: &[&str], triple: &str, cc_version: &str) -> String {
+    let mut h = StableHasher::new();
+    h.u64(CACHE_FORMAT as u64)
+        .str(env!("CARGO_PKG_VERSION"))
+        .str(triple)
+        .str(cc_version);
+    for flag in cflags {
+        h.str(flag);
+    }
+    h.field(source);
+    format!("{:016x}", h.finish())
+}
+
+/// Return the cached runtime archive for `runtime_src`, building it first if
+/// no archive exists for the current key.
+///
+/// Builds go to a process-unique temp name inside the cache directory and
+/// are renamed into place, so concurrent `zaco` invocations never observe a
+/// half-written archive.
+pub fn runtime_archive(
+    runtime_src: &Path,
+    opts: &RuntimeBuildOptions,
+    verbose: bool,
+) -> io::Result<PathBuf> {
+    let source = fs::read(runtime_src)?;
+    let cflags = opts.cflags();
+    let triple = target_triple(&opts.cc);
+    let key = cache_key(&source, &cflags, &triple, &compiler_version(&opts.cc));
+
+    let dir = cache_dir();
+    let suffix = if opts.lto { "-lto" } else { "" };
+    let archive = dir.join(format!("libzaco_runtime-{}-{}{}.a", triple, key, suffix));
+    if archive.is_file() {
+        if verbose {
+            println!("  Using cached C runtime: {}", archive.display());
+        }
+        return Ok(archive);
+    }
+
+    fs::create_dir_all(&dir)?;
+    if verbose {
+        println!("  Building C runtime archive: {}", archive.display());
+    }
+
+    let tag = format!("{}-{}", key, std::process::id());
+    let obj = dir.join(format!("zaco_runtime-{}.o", tag));
+    let tmp_archive = dir.join(format!("libzaco_runtime-{}.a.tmp", tag));
+    let result = build_archive(runtime_src, opts, &cflags, &obj, &tmp_archive)
+        .and_then(|_| fs::rename(&tmp_archive, &archive));
+    let _ = fs::remove_file(&obj);
+    if result.is_err() {
+        let _ = fs::remove_file(&tmp_archive);
+    }
+    result.map(|_| archive)
+}
+
+fn build_archive(
+    runtime_src: &Path,
+    opts: &RuntimeBuildOptions,
+    cflags: &[&str],
+    obj: &Path,
+    archive: &Path,
+) -> io::Result<()> {
+    let status = Command::new(&opts.cc)
+        .args(cflags)
+        .arg("-c")
+        .arg("-o")
+        .arg(obj)
+        .arg(runtime_src)
+        .status()?;
+    if !status.success() {
+        return Err(io::Error::new(
+            io::ErrorKind::Other,
+            "Failed to compile runtime.c",
+        ));
+    }
+
+    // LTO objects carry compiler bitcode; plain `ar` needs the linker plugin
+    // to index them, which the compiler-specific wrappers load for us.
+    let ar = if opts.lto { lto_archiver(&opts.cc) } else { "ar".to_string() };
+    let status = Command::new(&ar).arg("rcs").arg(archive).arg(obj).status()?;
+    if !status.success() {
+        return Err(io::Error::new(
+            io::ErrorKind::Other,
+            format!("Failed to archive runtime object with {}", ar),
+        ));
+    }
+    Ok(())
+}
+
+/// Pick an archiver that understands LTO objects produced by `cc`.
+fn lto_archiver(cc: &str) -> String {
+    let version = compiler_version(cc);
+    let candidate = if version.contains("clang") { "llvm-ar" } else { "gcc-ar" };
+    let available = Command::new(candidate)
+        .arg("--version")
+        .output()
+        .map(|out| out.status.success())
+        .unwrap_or(false);
+    if available { candidate.to_string() } else { "ar".to_string() }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cache_key_is_stable() {
+        let a = cache_key(b"int x;", &["-O2"], "x86_64-linux-gnu", "cc 1.0");
+        let b = cache_key(b"int x;", &["-O2"], "x86_64-linux-gnu", "cc 1.0");
+        assert_eq!(a, b);
+        assert_eq!(a.len(), 16);
+    }
+
+    #[test]
+    fn test_cache_key_depends_on_inputs() {
+        let base = cache_key(b"int x;", &["-O2"], "x86_64-linux-gnu", "cc 1.0");
+        assert_ne!(base, cache_key(b"int y;", &["-O2"], "x86_64-linux-gnu", "cc 1.0"));
+        assert_ne!(base, cache_key(b"int x;", &["-O2", "-flto"], "x86_64-linux-gnu", "cc 1.0"));
+        assert_ne!(base, cache_key(b"int x;", &["-O2"], "aarch64-linux-gnu", "cc 1.0"));
+        assert_ne!(base, cache_key(b"int x;", &["-O2"], "x86_64-linux-gnu", "cc 2.0"));
+    }
+
+    #[test]
+    fn test_cache_key_fields_are_delimited() {
+        assert_ne!(
+            cache_key(b"", &["-Oa", "b"], "t", "v"),
+            cache_key(b"", &["-O", "ab"], "t", "v"),
+        );
+    }
+
+    #[test]
+    fn test_lto_adds_flag() {
+        let plain = RuntimeBuildOptions { cc: "cc".into(), lto: false };
+        let lto = RuntimeBuildOptions { cc: "cc".into(), lto: true };
+        assert!(!plain.cflags().contains(&"-flto"));
+        assert!(lto.cflags().contains(&"-flto"));
+    }
+}
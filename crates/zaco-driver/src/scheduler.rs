@@ -0,0 +1,316 @@
+//! Thread pool for the per-module frontend
+//!
+//! Module discovery (read, lex, parse, resolve imports) and the per-module
+//! type-check/lower stage are independent across modules, so the driver fans
+//! them out over a fixed set of scoped worker threads. Jobs are coarse (one
+//! whole module each), so a single shared ready queue keeps every core busy
+//! without measurable contention.
+
+use std::collections::{HashSet, VecDeque};
+use std::hash::Hash;
+use std::sync::{Condvar, Mutex};
+use std::thread;
+
+/// Stack size for frontend workers. The parser and lowerer recurse over the
+/// AST, so workers get the same headroom as the main thread.
+const WORKER_STACK_SIZE: usize = 8 * 1024 * 1024;
+
+/// Number of worker threads to use: `ZACO_JOBS` if set, otherwise the number
+/// of available cores.
+pub fn default_jobs() -> usize {
+    std::env::var("ZACO_JOBS")
+        .ok()
+        .and_then(|v| v.parse::<usize>().ok())
+        .filter(|&n| n > 0)
+        .unwrap_or_else(|| thread::available_parallelism().map(|n| n.get()).unwrap_or(1))
+}
+
+/// Result of a job run by [`run_after_dependencies`].
+#[derive(Debug)]
+pub enum JobOutcome<R, E> {
+    /// The job ran and succeeded.
+    Done(R),
+    /// The job ran and failed.
+    Failed(E),
+    /// The job never ran because one of its dependencies did not succeed.
+    Skipped,
+}
+
+/// Run `f` over `jobs` on `workers` threads, starting each job only after
+/// every job it depends on has completed successfully.
+///
+/// Each job is `(dependencies, input)` where dependencies are indices into
+/// `jobs`. The dependency relation must be acyclic. Outcomes are returned in
+/// job order regardless of completion order.
+pub fn run_after_dependencies<T, R, E, F>(
+    jobs: Vec<(Vec<usize>, T)>,
+    workers: usize,
+    f: F,
+) -> Vec<JobOutcome<R, E>>
+where
+    T: Send,
+    R: Send,
+    E: Send,
+    F: Fn(T) -> Result<R, E> + Sync,
+{
+    struct State<T, R, E> {
+        inputs: Vec<Option<T>>,
+        outcomes: Vec<Option<JobOutcome<R, E>>>,
+        waiting_on: Vec<usize>,
+        ready: VecDeque<usize>,
+        unfinished: usize,
+    }
+
+    let count = jobs.len();
+    let mut dependents: Vec<Vec<usize>> = vec![Vec::new(); count];
+    let mut waiting_on = vec![0; count];
+    let mut inputs = Vec::with_capacity(count);
+    for (index, (deps, input)) in jobs.into_iter().enumerate() {
+        let mut seen = HashSet::new();
+        for dep in deps {
+            if dep != index && dep < count && seen.insert(dep) {
+                dependents[dep].push(index);
+                waiting_on[index] += 1;
+            }
+        }
+        inputs.push(Some(input));
+    }
+    let ready = (0..count).filter(|&i| waiting_on[i] == 0).collect();
+
+    let state = Mutex::new(State {
+        inputs,
+        outcomes: (0..count).map(|_| None).collect(),
+        waiting_on,
+        ready,
+        unfinished: count,
+    });
+    let wakeup = Condvar::new();
+
+    // Record an outcome and release (or skip) the jobs waiting on it.
+    // Skips cascade, so dependents of a failed job finish without running.
+    let finish = |st: &mut State<T, R, E>, index: usize, outcome: JobOutcome<R, E>| {
+        let mut stack = vec![(index, outcome)];
+        while let Some((index, outcome)) = stack.pop() {
+            let succeeded = matches!(outcome, JobOutcome::Done(_));
+            st.outcomes[index] = Some(outcome);
+            st.unfinished -= 1;
+            for &dependent in &dependents[index] {
+                if st.outcomes[dependent].is_some() || st.waiting_on[dependent] == usize::MAX {
+                    continue;
+                }
+                if !succeeded {
+                    st.inputs[dependent] = None;
+                    st.waiting_on[dependent] = usize::MAX;
+                    stack.push((dependent, JobOutcome::Skipped));
+                } else {
+                    st.waiting_on[dependent] -= 1;
+                    if st.waiting_on[dependent] == 0 {
+                        st.ready.push_back(dependent);
+                    }
+                }
+            }
+        }
+    };
+
+    let worker = || loop {
+        let (index, input) = {
+            let mut st = state.lock().unwrap();
+            loop {
+                if let Some(index) = st.ready.pop_front() {
+                    match st.inputs[index].take() {
+                        Some(input) => break (index, input),
+                        None => continue,
+                    }
+                }
+                if st.unfinished == 0 {
+                    return;
+                }
+                st = wakeup.wait(st).unwrap();
+            }
+        };
+
+        let outcome = match f(input) {
+            Ok(result) => JobOutcome::Done(result),
+            Err(err) => JobOutcome::Failed(err),
+        };
+
+        let mut st = state.lock().unwrap();
+        finish(&mut st, index, outcome);
+        wakeup.notify_all();
+    };
+
+    run_workers(workers.min(count), &worker);
+
+    state
+        .into_inner()
+        .unwrap()
+        .outcomes
+        .into_iter()
+        .map(|outcome| outcome.unwrap_or(JobOutcome::Skipped))
+        .collect()
+}
+
+/// Visit every item reachable from `roots` on `workers` threads.
+///
+/// `visit` processes one item and returns its output together with the items
+/// it references; each distinct item is visited exactly once. The first error
+/// stops the walk and is returned. Results come back in an unspecified order.
+pub fn discover_parallel<K, R, E, F>(
+    roots: Vec<K>,
+    workers: usize,
+    visit: F,
+) -> Result<Vec<(K, R)>, E>
+where
+    K: Clone + Eq + Hash + Send,
+    R: Send,
+    E: Send,
+    F: Fn(&K) -> Result<(R, Vec<K>), E> + Sync,
+{
+    struct State<K, R, E> {
+        queue: VecDeque<K>,
+        seen: HashSet<K>,
+        in_flight: usize,
+        results: Vec<(K, R)>,
+        error: Option<E>,
+    }
+
+    let mut seen = HashSet::new();
+    let queue: VecDeque<K> = roots.into_iter().filter(|k| seen.insert(k.clone())).collect();
+    let state = Mutex::new(State {
+        queue,
+        seen,
+        in_flight: 0,
+        results: Vec::new(),
+        error: None,
+    });
+    let wakeup = Condvar::new();
+
+    let worker = || loop {
+        let key = {
+            let mut st = state.lock().unwrap();
+            loop {
+                if st.error.is_some() {
+                    return;
+                }
+                if let Some(key) = st.queue.pop_front() {
+                    st.in_flight += 1;
+                    break key;
+                }
+                if st.in_flight == 0 {
+                    return;
+                }
+                st = wakeup.wait(st).unwrap();
+            }
+        };
+
+        let visited = visit(&key);
+
+        let mut st = state.lock().unwrap();
+        st.in_flight -= 1;
+        match visited {
+            Ok((result, refs)) => {
+                for r in refs {
+                    if st.seen.insert(r.clone()) {
+                        st.queue.push_back(r);
+                    }
+                }
+                st.results.push((key, result));
+            }
+            Err(err) => {
+                if st.error.is_none() {
+                    st.error = Some(err);
+                }
+            }
+        }
+        wakeup.notify_all();
+    };
+
+    // The graph grows as it is walked, so start every worker even if only
+    // the roots are known up front.
+    run_workers(workers, &worker);
+
+    let st = state.into_inner().unwrap();
+    match st.error {
+        Some(err) => Err(err),
+        None => Ok(st.results),
+    }
+}
+
+/// Run `worker` on `count` threads (the calling thread included) and wait
+/// for all of them.
+fn run_workers<W: Fn() + Sync>(count: usize, worker: &W) {
+    if count <= 1 {
+        worker();
+        return;
+    }
+    thread::scope(|scope| {
+        for _ in 1..count {
+            thread::Builder::new()
+                .stack_size(WORKER_STACK_SIZE)
+                .spawn_scoped(scope, worker)
+                .expect("failed to spawn frontend worker");
+        }
+        worker();
+    });
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    #[test]
+    fn test_dependencies_finish_first() {
+        // 0 <- 1 <- 3, 0 <- 2 <- 3
+        let order = Mutex::new(Vec::new());
+        let jobs = vec![(vec![], 0), (vec![0], 1), (vec![0], 2), (vec![1, 2], 3)];
+        let outcomes = run_after_dependencies(jobs, 4, |n: usize| -> Result<usize, ()> {
+            order.lock().unwrap().push(n);
+            Ok(n * 10)
+        });
+
+        let order = order.into_inner().unwrap();
+        let pos = |n| order.iter().position(|&x| x == n).unwrap();
+        assert!(pos(0) < pos(1) && pos(0) < pos(2));
+        assert!(pos(1) < pos(3) && pos(2) < pos(3));
+        for (i, outcome) in outcomes.iter().enumerate() {
+            assert!(matches!(outcome, JobOutcome::Done(v) if *v == i * 10));
+        }
+    }
+
+    #[test]
+    fn test_failure_skips_dependents() {
+        let jobs = vec![(vec![], 0), (vec![0], 1), (vec![1], 2), (vec![], 3)];
+        let outcomes = run_after_dependencies(jobs, 2, |n: usize| {
+            if n == 0 { Err("boom") } else { Ok(n) }
+        });
+        assert!(matches!(outcomes[0], JobOutcome::Failed("boom")));
+        assert!(matches!(outcomes[1], JobOutcome::Skipped));
+        assert!(matches!(outcomes[2], JobOutcome::Skipped));
+        assert!(matches!(outcomes[3], JobOutcome::Done(3)));
+    }
+
+    #[test]
+    fn test_discover_visits_each_item_once() {
+        let visits = AtomicUsize::new(0);
+        // Every n < 64 references 2n+1 and 2n+2, plus a back-edge to 0.
+        let mut found = discover_parallel(vec![0usize], 4, |&n| -> Result<_, ()> {
+            visits.fetch_add(1, Ordering::SeqCst);
+            let refs = if n < 64 { vec![2 * n + 1, 2 * n + 2, 0] } else { vec![] };
+            Ok((n, refs))
+        })
+        .unwrap();
+        found.sort();
+        assert_eq!(found.len(), 129);
+        assert_eq!(visits.load(Ordering::SeqCst), 129);
+        assert!(found.iter().all(|(k, v)| k == v));
+    }
+
+    #[test]
+    fn test_discover_reports_error() {
+        let result = discover_parallel(vec![0usize], 3, |&n| {
+            if n == 5 { Err(format!("bad {}", n)) } else { Ok(((), vec![n + 1])) }
+        });
+        assert_eq!(result.unwrap_err(), "bad 5");
+    }
+}
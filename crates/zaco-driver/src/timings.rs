@@ -0,0 +1,231 @@
+//! Compile-time measurements for `zaco compile --timings`
+//!
+//! The driver records the wall time of each pipeline phase and, per module,
+//! of parsing, type checking, lowering and optimization (these run on the
+//! worker pool, so their sum can exceed the phase that contains them).
+//! Lexing happens on demand while parsing and is included in `parse_ms`.
+//! The report adds peak RSS and the size of the merged IR and is written as
+//! JSON, so CI can track compile-time regressions.
+
+use std::collections::BTreeMap;
+use std::fmt::Write;
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+use std::time::{Duration, Instant};
+
+use zaco_ir::IrModule;
+
+/// Time spent on one module.
+#[derive(Debug, Clone, Default)]
+pub struct ModuleTimings {
+    pub parse: Duration,
+    pub typeck: Duration,
+    pub lower: Duration,
+    pub optimize: Duration,
+    /// IR restored from the incremental cache; typeck and lowering skipped
+    pub cached: bool,
+}
+
+/// Size of an IR module.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct IrStats {
+    pub functions: usize,
+    pub blocks: usize,
+    pub instructions: usize,
+    pub string_literals: usize,
+}
+
+impl IrStats {
+    pub fn of(module: &IrModule) -> IrStats {
+        IrStats {
+            functions: module.functions.len(),
+            blocks: module.functions.iter().map(|f| f.blocks.len()).sum(),
+            instructions: module
+                .functions
+                .iter()
+                .flat_map(|f| &f.blocks)
+                .map(|b| b.instructions.len())
+                .sum(),
+            string_literals: module.string_literals.len(),
+        }
+    }
+}
+
+/// Measurements of one compilation. Safe to update from worker threads.
+pub struct Timings {
+    start: Instant,
+    phases: Mutex<Vec<(&'static str, Duration)>>,
+    modules: Mutex<BTreeMap<PathBuf, ModuleTimings>>,
+    ir: Mutex<Option<IrStats>>,
+}
+
+impl Timings {
+    pub fn new() -> Self {
+        Timings {
+            start: Instant::now(),
+            phases: Mutex::new(Vec::new()),
+            modules: Mutex::new(BTreeMap::new()),
+            ir: Mutex::new(None),
+        }
+    }
+
+    /// Record that phase `name` took `elapsed`. Phases are reported in the
+    /// order they are recorded; recording a name again adds to it.
+    pub fn record_phase(&self, name: &'static str, elapsed: Duration) {
+        let mut phases = self.phases.lock().unwrap();
+        match phases.iter_mut().find(|(phase, _)| *phase == name) {
+            Some((_, total)) => *total += elapsed,
+            None => phases.push((name, elapsed)),
+        }
+    }
+
+    /// Update the measurements of the module at `path`.
+    pub fn module(&self, path: &Path, update: impl FnOnce(&mut ModuleTimings)) {
+        let mut modules = self.modules.lock().unwrap();
+        update(modules.entry(path.to_path_buf()).or_default());
+    }
+
+    pub fn set_ir_stats(&self, stats: IrStats) {
+        *self.ir.lock().unwrap() = Some(stats);
+    }
+
+    /// The report as a JSON object.
+    pub fn to_json(&self, input: &Path, opt_level: &str, jobs: usize) -> String {
+        let mut out = String::new();
+        out.push_str("{\n");
+        let _ = writeln!(out, "  \"input\": {},", json_string(&input.to_string_lossy()));
+        let _ = writeln!(out, "  \"opt_level\": {},", json_string(opt_level));
+        let _ = writeln!(out, "  \"jobs\": {},", jobs);
+        let _ = writeln!(out, "  \"total_ms\": {},", millis(self.start.elapsed()));
+        match peak_rss_bytes() {
+            Some(bytes) => { let _ = writeln!(out, "  \"peak_rss_bytes\": {},", bytes); }
+            None => out.push_str("  \"peak_rss_bytes\": null,\n"),
+        }
+
+        out.push_str("  \"phases\": [");
+        let phases = self.phases.lock().unwrap();
+        for (i, (name, elapsed)) in phases.iter().enumerate() {
+            let sep = if i == 0 { "\n" } else { ",\n" };
+            let _ = write!(out, "{}    {{ \"name\": {}, \"ms\": {} }}", sep, json_string(name), millis(*elapsed));
+        }
+        out.push_str(if phases.is_empty() { "],\n" } else { "\n  ],\n" });
+
+        out.push_str("  \"modules\": [");
+        let modules = self.modules.lock().unwrap();
+        for (i, (path, m)) in modules.iter().enumerate() {
+            let sep = if i == 0 { "\n" } else { ",\n" };
+            let _ = write!(
+                out,
+                "{}    {{ \"path\": {}, \"cached\": {}, \"parse_ms\": {}, \"typeck_ms\": {}, \"lower_ms\": {}, \"optimize_ms\": {} }}",
+                sep,
+                json_string(&path.to_string_lossy()),
+                m.cached,
+                millis(m.parse),
+                millis(m.typeck),
+                millis(m.lower),
+                millis(m.optimize),
+            );
+        }
+        out.push_str(if modules.is_empty() { "],\n" } else { "\n  ],\n" });
+
+        match *self.ir.lock().unwrap() {
+            Some(ir) => {
+                let _ = writeln!(
+                    out,
+                    "  \"ir\": {{ \"functions\": {}, \"blocks\": {}, \"instructions\": {}, \"string_literals\": {} }}",
+                    ir.functions, ir.blocks, ir.instructions, ir.string_literals
+                );
+            }
+            None => out.push_str("  \"ir\": null\n"),
+        }
+        out.push_str("}\n");
+        out
+    }
+}
+
+impl Default for Timings {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Peak resident set size of this process.
+#[cfg(unix)]
+pub fn peak_rss_bytes() -> Option<u64> {
+    let mut usage: libc::rusage = unsafe { std::mem::zeroed() };
+    if unsafe { libc::getrusage(libc::RUSAGE_SELF, &mut usage) } != 0 {
+        return None;
+    }
+    let max_rss = usage.ru_maxrss as u64;
+    // Linux reports KiB, macOS bytes
+    if cfg!(target_os = "macos") {
+        Some(max_rss)
+    } else {
+        Some(max_rss * 1024)
+    }
+}
+
+#[cfg(not(unix))]
+pub fn peak_rss_bytes() -> Option<u64> {
+    None
+}
+
+fn millis(d: Duration) -> String {
+    format!("{:.3}", d.as_secs_f64() * 1000.0)
+}
+
+fn json_string(s: &str) -> String {
+    let mut out = String::with_capacity(s.len() + 2);
+    out.push('"');
+    for c in s.chars() {
+        match c {
+            '"' => out.push_str("\\\""),
+            '\\' => out.push_str("\\\\"),
+            '\n' => out.push_str("\\n"),
+            '\r' => out.push_str("\\r"),
+            '\t' => out.push_str("\\t"),
+            c if (c as u32) < 0x20 => { let _ = write!(out, "\\u{:04x}", c as u32); }
+            c => out.push(c),
+        }
+    }
+    out.push('"');
+    out
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use zaco_ir::{FuncId, IrFunction, IrType};
+
+    #[test]
+    fn test_report_lists_phases_modules_and_ir() {
+        let timings = Timings::new();
+        timings.record_phase("discovery", Duration::from_millis(2));
+        timings.record_phase("link", Duration::from_millis(5));
+        timings.record_phase("discovery", Duration::from_millis(1));
+        timings.module(Path::new("/p/a.ts"), |m| m.parse = Duration::from_micros(1500));
+        timings.module(Path::new("/p/a.ts"), |m| m.cached = true);
+
+        let mut module = IrModule::new();
+        let mut func = IrFunction::new(FuncId(0), "main".to_string(), vec![], IrType::Void);
+        func.new_block();
+        module.add_function(func);
+        module.intern_string("say \"hi\"");
+        let stats = IrStats::of(&module);
+        assert_eq!(stats, IrStats { functions: 1, blocks: 1, instructions: 0, string_literals: 1 });
+        timings.set_ir_stats(stats);
+
+        let json = timings.to_json(Path::new("/p/a.ts"), "O2", 4);
+        assert!(json.contains("{ \"name\": \"discovery\", \"ms\": 3.000 },\n    { \"name\": \"link\""), "{}", json);
+        assert!(json.contains("\"path\": \"/p/a.ts\", \"cached\": true, \"parse_ms\": 1.500"), "{}", json);
+        assert!(json.contains("\"ir\": { \"functions\": 1, \"blocks\": 1, \"instructions\": 0, \"string_literals\": 1 }"), "{}", json);
+        assert!(json.contains("\"opt_level\": \"O2\""), "{}", json);
+        #[cfg(unix)]
+        assert!(peak_rss_bytes().unwrap() > 0);
+    }
+
+    #[test]
+    fn test_json_string_escapes() {
+        assert_eq!(json_string("a\"b\\c\n\u{1}"), "\"a\\\"b\\\\c\\n\\u0001\"");
+    }
+}
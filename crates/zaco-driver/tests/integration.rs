@@ -405,6 +405,157 @@ switch (x) {
     assert!(ir.contains("Branch"), "Switch IR should contain Branch terminators");
 }
 
+// ============================================================================
+// String Concatenation
+// ============================================================================
+
+#[test]
+fn test_string_accumulator_loop() {
+    let output = compile_and_run(
+        r#"
+let s: string = "";
+for (let i: number = 0; i < 5; i = i + 1) {
+    s += "ab";
+}
+console.log(s);
+"#,
+    );
+    assert_eq!(output.trim(), "ababababab");
+}
+
+#[test]
+fn test_string_concat_chain() {
+    let output = compile_and_run(
+        r#"
+let a: string = "x";
+let b: string = a + "-" + a + "-" + a;
+console.log(b);
+"#,
+    );
+    assert_eq!(output.trim(), "x-x-x");
+}
+
+// ============================================================================
+// Object Literals
+// ============================================================================
+
+#[test]
+fn test_object_literal_property_access() {
+    let output = compile_and_run(
+        r#"
+let p = { x: 1, label: "pt" };
+p.x = p.x + 41;
+console.log(p.x);
+console.log(p.label);
+"#,
+    );
+    assert_eq!(output.trim(), "42\npt");
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+#[test]
+fn test_json_parse_scalars() {
+    let output = compile_and_run(
+        r#"
+console.log(JSON.parse("\"caf\\u00e9\""));
+console.log(JSON.parse(" 1.5e2 "));
+console.log(JSON.parse("true"));
+"#,
+    );
+    assert_eq!(output.trim(), "caf\u{e9}\n150\ntrue");
+}
+
+#[test]
+fn test_json_stringify_typed_values() {
+    let output = compile_and_run(
+        r#"
+interface User { name: string; age: number; admin: boolean }
+const u: User = JSON.parse("{\"admin\": true, \"name\": \"Ann \\\"A\\\"\", \"age\": 41}");
+console.log(u.age + 1);
+console.log(JSON.stringify(u));
+console.log(JSON.stringify({ id: 7, tags: { hot: true } }));
+console.log(JSON.stringify(JSON.parse("[1, 2.5, null, {\"k\": \"v\"}]")));
+"#,
+    );
+    assert_eq!(
+        output.trim(),
+        "42\n{\"name\":\"Ann \\\"A\\\"\",\"age\":41,\"admin\":true}\n{\"id\":7,\"tags\":{\"hot\":true}}\n[1,2.5,null,{\"k\":\"v\"}]"
+    );
+}
+
+#[test]
+fn test_json_stringify_untyped_values() {
+    let output = compile_and_run(
+        r#"
+const s: any = "plain";
+const n: any = JSON.parse("5");
+const items: any = [1, 2];
+console.log(JSON.stringify(s));
+console.log(JSON.stringify(n));
+console.log(JSON.stringify(items));
+"#,
+    );
+    assert_eq!(output.trim(), "\"plain\"\n5\n[1,2]");
+}
+
+// ============================================================================
+// Timers
+// ============================================================================
+
+#[test]
+fn test_timers_run_on_event_loop_in_deadline_order() {
+    let output = compile_and_run(
+        r#"
+const label = "late";
+setTimeout(() => console.log(label), 30);
+setTimeout(() => console.log("first"), 10);
+const cancelled = setTimeout(() => console.log("never"), 20);
+clearTimeout(cancelled);
+setTimeout(() => console.log("second"), 20);
+console.log("sync");
+"#,
+    );
+    assert_eq!(output.trim(), "sync\nfirst\nsecond\nlate");
+}
+
+#[test]
+fn test_promise_reactions_run_as_microtasks_before_timers() {
+    let output = compile_and_run(
+        r#"
+async function ready(): Promise<number> { return 1; }
+const p = ready();
+setTimeout(() => console.log("timer"), 1);
+p.then(() => console.log("then"));
+console.log("sync");
+"#,
+    );
+    assert_eq!(output.trim(), "sync\nthen\ntimer");
+}
+
+#[test]
+fn test_await_suspends_async_function_without_blocking_caller() {
+    let output = compile_and_run(
+        r#"
+async function step(label: string): Promise<number> {
+    console.log(label);
+    return 1;
+}
+async function run(): Promise<void> {
+    console.log("start");
+    const a = await step("a");
+    const b = await step("b");
+    console.log(a + b);
+}
+run();
+console.log("sync");
+"#,
+    );
+    assert_eq!(output.trim(), "start\na\nsync\nb\n2");
+}
+
 // ============================================================================
 // Module Resolution Failures
 // ============================================================================
@@ -475,3 +626,131 @@ console.log("ok");
     );
     assert!(ir.contains("fn main("), "Built-in import should compile to IR");
 }
+
+#[test]
+fn test_fs_streams_lower_to_runtime_calls() {
+    let ir = compile_to_ir(
+        r#"import { createReadStream, readChunk, closeStream } from "fs";
+const input = createReadStream("data.log", 65536);
+let chunk = readChunk(input);
+while (chunk !== "") {
+  console.log(chunk);
+  chunk = readChunk(input);
+}
+closeStream(input);
+"#,
+    );
+    assert!(ir.contains("zaco_fs_create_read_stream"), "IR:\n{}", ir);
+    assert!(ir.contains("zaco_fs_read_chunk"), "IR:\n{}", ir);
+    assert!(ir.contains("zaco_fs_close_stream"), "IR:\n{}", ir);
+}
+
+#[test]
+fn test_throw_propagates_through_calls_to_nearest_catch() {
+    let output = compile_and_run(
+        r#"
+function check(n: number): number {
+  if (n > 2) {
+    throw "too big";
+  }
+  return n * 2;
+}
+function twice(n: number): number {
+  return check(n) + check(n + 1);
+}
+try {
+  console.log(twice(1));
+  try {
+    console.log(twice(2));
+  } catch (e) {
+    console.log(e);
+  }
+  console.log(twice(5));
+  console.log("unreachable");
+} catch (e) {
+  console.log("outer");
+}
+"#,
+    );
+    assert_eq!(output.trim(), "6\ntoo big\nouter");
+}
+
+#[test]
+fn test_run_profile_writes_folded_stacks() {
+    let temp_dir = std::env::temp_dir().join(format!("zaco_test_profile_{}", std::process::id()));
+    let _ = fs::create_dir_all(&temp_dir);
+    let input_path = temp_dir.join("fib.ts");
+    let profile_path = temp_dir.join("fib.folded");
+    fs::write(
+        &input_path,
+        r#"function fib(n: number): number {
+  if (n < 2) {
+    return n;
+  }
+  return fib(n - 1) + fib(n - 2);
+}
+console.log(fib(30));
+"#,
+    )
+    .expect("Failed to write test input");
+
+    let output = Command::new(zaco_binary())
+        .arg("run")
+        .arg("--profile")
+        .arg("--profile-output")
+        .arg(&profile_path)
+        .arg(&input_path)
+        .current_dir(
+            PathBuf::from(env!("CARGO_MANIFEST_DIR"))
+                .parent()
+                .unwrap()
+                .parent()
+                .unwrap(),
+        )
+        .output()
+        .expect("Failed to run zaco");
+    let stdout = String::from_utf8_lossy(&output.stdout);
+    let stderr = String::from_utf8_lossy(&output.stderr);
+    assert!(stdout.contains("832040"), "stdout: {}\nstderr: {}", stdout, stderr);
+    assert!(stderr.contains("zaco profile counters"), "stderr: {}", stderr);
+
+    // Folded stacks: "main;fib;fib <count>"
+    let folded = fs::read_to_string(&profile_path).expect("profile was not written");
+    assert!(folded.lines().any(|line| line.starts_with("main;fib")), "profile:\n{}", folded);
+    let _ = fs::remove_dir_all(&temp_dir);
+}
+
+#[test]
+fn test_compile_timings_report() {
+    let temp_dir = std::env::temp_dir().join(format!("zaco_test_timings_{}", std::process::id()));
+    let _ = fs::create_dir_all(&temp_dir);
+    let input_path = temp_dir.join("main.ts");
+    let report_path = temp_dir.join("timings.json");
+    fs::write(&input_path, "let x: number = 40 + 2;\nconsole.log(x);\n").expect("Failed to write test input");
+
+    let output = Command::new(zaco_binary())
+        .arg("compile")
+        .arg(&input_path)
+        .arg("--emit")
+        .arg("ir")
+        .arg("--no-cache")
+        .arg("--timings")
+        .arg(&report_path)
+        .current_dir(
+            PathBuf::from(env!("CARGO_MANIFEST_DIR"))
+                .parent()
+                .unwrap()
+                .parent()
+                .unwrap(),
+        )
+        .output()
+        .expect("Failed to run zaco");
+    assert!(output.status.success(), "stderr: {}", String::from_utf8_lossy(&output.stderr));
+
+    let report = fs::read_to_string(&report_path).expect("timings report was not written");
+    for key in ["\"total_ms\"", "\"peak_rss_bytes\"", "\"name\": \"frontend\"", "\"parse_ms\"", "\"instructions\""] {
+        assert!(report.contains(key), "missing {} in:\n{}", key, report);
+    }
+    assert!(report.contains("\"cached\": false"), "report:\n{}", report);
+    let _ = fs::remove_dir_all(&temp_dir);
+}
@@ -0,0 +1,336 @@
+//! Exception propagation.
+//!
+//! A `throw` never unwinds the native stack. The runtime's `zaco_throw`
+//! stores the error and sets [`EXCEPTION_FLAG`]; compiled code tests the flag
+//! after every call that can throw and, when it is set, branches to the
+//! innermost enclosing catch block or returns to its caller, which runs the
+//! same test. Entering a try block therefore costs nothing, there is no
+//! nesting limit, and returning out of a try needs no bookkeeping.
+//!
+//! Lowering emits plain calls; [`insert_exception_checks`] adds the tests
+//! once a function body is complete.
+
+use std::collections::HashMap;
+
+use crate::lower::ASYNC_PROMISE_SLOT;
+use crate::{BinOp, BlockId, Constant, Instruction, IrFunction, IrType, Place, RValue, Terminator, Value};
+
+/// Runtime global that is non-zero while an exception is propagating.
+pub const EXCEPTION_FLAG: &str = "zaco_exception_pending";
+
+/// Runtime function that raises an exception.
+pub const THROW: &str = "zaco_throw";
+
+/// Runtime function that reports an exception that reached the top level
+/// and exits.
+pub const CHECK_UNCAUGHT: &str = "zaco_check_uncaught";
+
+/// Runtime functions an async resume function uses to turn an exception
+/// into a rejection of its promise.
+pub const GET_ERROR: &str = "zaco_get_error";
+pub const CLEAR_ERROR: &str = "zaco_clear_error";
+pub const PROMISE_REJECT: &str = "zaco_promise_reject";
+
+/// Runtime functions that can raise an exception themselves, or that run
+/// compiled callbacks before returning and so leave a callback's exception
+/// pending. Other runtime functions never do, so calls to them are not
+/// followed by a test. Callbacks run from the event loop (timers, tasks,
+/// microtasks) are reported there and never reach compiled code.
+const THROWING_RUNTIME_FNS: &[&str] = &[
+    THROW,
+    "zaco_json_parse",
+    "zaco_json_parser_finish",
+    "zaco_json_stringify",
+    "zaco_json_stringify_array",
+    "zaco_json_write_field",
+    // Run JS callbacks synchronously
+    "zaco_events_emit",
+    "zaco_async_spawn",
+    // Resumes an `await` whose promise rejected with the error pending
+    "zaco_async_resumed",
+];
+
+/// Whether `inst` is a call after which an exception may be pending.
+///
+/// `is_runtime` tells whether a direct callee is a runtime (extern) function.
+/// User functions and indirect calls through closures may always throw.
+pub fn may_throw(inst: &Instruction, is_runtime: impl Fn(&str) -> bool) -> bool {
+    match inst {
+        Instruction::Call { func: Value::Const(Constant::Str(name)), .. } => {
+            THROWING_RUNTIME_FNS.contains(&name.as_str()) || !is_runtime(name)
+        }
+        Instruction::Call { .. } => true,
+        _ => false,
+    }
+}
+
+/// Split every block of `func` after each call that may throw and test the
+/// exception flag there.
+///
+/// `handlers` maps blocks lowered inside a try body to the try's catch
+/// block; blocks split off a handled block inherit its handler. Outside any
+/// try the test branches to a shared block that returns a default value, so
+/// the caller sees the flag still set. In `main`, that block reports the
+/// uncaught exception first.
+pub fn insert_exception_checks(
+    func: &mut IrFunction,
+    handlers: &HashMap<BlockId, BlockId>,
+    is_runtime: impl Fn(&str) -> bool,
+) {
+    let mut handlers = handlers.clone();
+    let mut propagate = None;
+    let mut worklist: Vec<BlockId> = func.blocks.iter().map(|block| block.id).collect();
+
+    while let Some(id) = worklist.pop() {
+        let Some(split) = func
+            .block(id)
+            .instructions
+            .iter()
+            .position(|inst| may_throw(inst, &is_runtime))
+        else {
+            continue;
+        };
+        let is_throw = matches!(
+            &func.block(id).instructions[split],
+            Instruction::Call { func: Value::Const(Constant::Str(name)), .. } if name == THROW
+        );
+
+        // The rest of the block continues in a new one
+        let cont = func.new_block();
+        let block = func.block_mut(id);
+        let rest = block.instructions.split_off(split + 1);
+        let terminator = std::mem::replace(&mut block.terminator, Terminator::Unreachable);
+        let cont_block = func.block_mut(cont);
+        cont_block.instructions = rest;
+        cont_block.terminator = terminator;
+        worklist.push(cont);
+
+        let target = match handlers.get(&id).copied() {
+            Some(handler) => {
+                handlers.insert(cont, handler);
+                handler
+            }
+            None => *propagate.get_or_insert_with(|| propagate_block(func)),
+        };
+
+        // After a throw the flag is known to be set
+        if is_throw {
+            func.block_mut(id).set_terminator(Terminator::Jump(target));
+            continue;
+        }
+
+        let flag = func.add_temp(IrType::I64);
+        let pending = func.add_temp(IrType::Bool);
+        let block = func.block_mut(id);
+        block.push_instruction(Instruction::Load {
+            dest: Place::from_temp(flag),
+            ptr: Value::Const(Constant::Str(EXCEPTION_FLAG.to_string())),
+        });
+        block.push_instruction(Instruction::Assign {
+            dest: Place::from_temp(pending),
+            value: RValue::BinaryOp {
+                op: BinOp::Ne,
+                left: Value::Temp(flag),
+                right: Value::Const(Constant::I64(0)),
+            },
+        });
+        block.set_terminator(Terminator::Branch {
+            cond: Value::Temp(pending),
+            then_block: target,
+            else_block: cont,
+        });
+    }
+}
+
+/// Block that leaves `func` with the exception still pending.
+///
+/// An async resume function has no caller to propagate to: it runs from
+/// the event loop, or from the async function's entry, which has already
+/// handed out its promise. There the block rejects the promise in frame
+/// slot 1 with the error, clears the exception and frees the frame. An
+/// awaited promise's rejection that no try catches ends up here too.
+fn propagate_block(func: &mut IrFunction) -> BlockId {
+    if func.is_async_resume {
+        return reject_block(func);
+    }
+    let value = match func.return_type {
+        IrType::Void => None,
+        IrType::F64 => Some(Value::Const(Constant::F64(0.0))),
+        IrType::I64 => Some(Value::Const(Constant::I64(0))),
+        IrType::Bool => Some(Value::Const(Constant::Bool(false))),
+        _ => Some(Value::Const(Constant::Null)),
+    };
+    let is_entry = func.name == "main";
+    let id = func.new_block();
+    let block = func.block_mut(id);
+    if is_entry {
+        block.push_instruction(Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str(CHECK_UNCAUGHT.to_string())),
+            args: vec![],
+        });
+    }
+    block.set_terminator(Terminator::Return(value));
+    id
+}
+
+fn reject_block(func: &mut IrFunction) -> BlockId {
+    let frame = Value::Local(func.params[0].0);
+    let error = func.add_temp(IrType::Ptr);
+    let slot = func.add_temp(IrType::Ptr);
+    let promise = func.add_temp(IrType::Ptr);
+    let id = func.new_block();
+    let block = func.block_mut(id);
+    block.push_instruction(Instruction::Call {
+        dest: Some(Place::from_temp(error)),
+        func: Value::Const(Constant::Str(GET_ERROR.to_string())),
+        args: vec![],
+    });
+    block.push_instruction(Instruction::Call {
+        dest: None,
+        func: Value::Const(Constant::Str(CLEAR_ERROR.to_string())),
+        args: vec![],
+    });
+    block.push_instruction(Instruction::Assign {
+        dest: Place::from_temp(slot),
+        value: RValue::BinaryOp {
+            op: BinOp::Add,
+            left: frame.clone(),
+            right: Value::Const(Constant::I64(8 * ASYNC_PROMISE_SLOT as i64)),
+        },
+    });
+    block.push_instruction(Instruction::Load {
+        dest: Place::from_temp(promise),
+        ptr: Value::Temp(slot),
+    });
+    block.push_instruction(Instruction::Call {
+        dest: None,
+        func: Value::Const(Constant::Str(PROMISE_REJECT.to_string())),
+        args: vec![Value::Temp(promise), Value::Temp(error)],
+    });
+    block.push_instruction(Instruction::Free { value: frame });
+    block.set_terminator(Terminator::Return(None));
+    id
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{FuncId, LocalId};
+
+    fn call(name: &str) -> Instruction {
+        Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str(name.to_string())),
+            args: vec![],
+        }
+    }
+
+    fn is_runtime(name: &str) -> bool {
+        name.starts_with("zaco_")
+    }
+
+    fn function(name: &str, ret: IrType, body: Vec<Instruction>) -> IrFunction {
+        let mut func = IrFunction::new(FuncId(0), name.to_string(), vec![], ret);
+        let entry = func.new_block();
+        func.entry_block = entry;
+        func.block_mut(entry).instructions = body;
+        func.block_mut(entry).set_terminator(Terminator::Return(Some(Value::Const(Constant::F64(1.0)))));
+        func
+    }
+
+    fn branch_targets(func: &IrFunction, id: BlockId) -> (BlockId, BlockId) {
+        match func.block(id).terminator {
+            Terminator::Branch { then_block, else_block, .. } => (then_block, else_block),
+            ref other => panic!("expected a flag test, got {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_user_calls_propagate_to_caller() {
+        let mut func = function("f", IrType::F64, vec![call("zaco_str_len"), call("g"), call("zaco_console_log")]);
+        insert_exception_checks(&mut func, &HashMap::new(), is_runtime);
+
+        // Only the user call is tested; the runtime calls never throw
+        let entry = func.block(BlockId(0));
+        assert_eq!(entry.instructions.len(), 4);
+        assert!(matches!(&entry.instructions[2], Instruction::Load { ptr: Value::Const(Constant::Str(flag)), .. } if flag == EXCEPTION_FLAG));
+
+        let (pending, cont) = branch_targets(&func, BlockId(0));
+        assert_eq!(func.block(pending).terminator, Terminator::Return(Some(Value::Const(Constant::F64(0.0)))));
+        assert!(func.block(pending).instructions.is_empty());
+        assert_eq!(func.block(cont).instructions, vec![call("zaco_console_log")]);
+        assert_eq!(func.block(cont).terminator, Terminator::Return(Some(Value::Const(Constant::F64(1.0)))));
+    }
+
+    #[test]
+    fn test_calls_in_try_branch_to_catch() {
+        let mut func = function("f", IrType::Void, vec![call("g"), call("h")]);
+        let catch = func.new_block();
+        func.block_mut(catch).set_terminator(Terminator::Return(None));
+        let handlers = HashMap::from([(BlockId(0), catch)]);
+        insert_exception_checks(&mut func, &handlers, is_runtime);
+
+        // Both calls land in the catch block, the second from the continuation
+        let (first, cont) = branch_targets(&func, BlockId(0));
+        let (second, _) = branch_targets(&func, cont);
+        assert_eq!(first, catch);
+        assert_eq!(second, catch);
+        assert_eq!(func.blocks.len(), 4, "no propagate block is needed inside a try");
+    }
+
+    #[test]
+    fn test_throw_jumps_straight_to_handler() {
+        let mut func = function("main", IrType::I64, vec![call(THROW), call("g")]);
+        insert_exception_checks(&mut func, &HashMap::new(), is_runtime);
+
+        let Terminator::Jump(pending) = func.block(BlockId(0)).terminator else {
+            panic!("throw should jump straight to the handler");
+        };
+        // An exception leaving main is reported
+        assert_eq!(func.block(pending).instructions, vec![call(CHECK_UNCAUGHT)]);
+        assert_eq!(func.block(pending).terminator, Terminator::Return(Some(Value::Const(Constant::I64(0)))));
+    }
+
+    #[test]
+    fn test_async_resume_rejects_its_promise() {
+        let mut func = function("__async_main_f_resume", IrType::Void, vec![call("g")]);
+        func.params = vec![(LocalId(0), IrType::Ptr), (LocalId(1), IrType::Ptr)];
+        func.locals = func.params.clone();
+        let mut lookalike = func.clone();
+        func.is_async_resume = true;
+        insert_exception_checks(&mut func, &HashMap::new(), is_runtime);
+
+        // A user function that merely has a resume function's name propagates
+        insert_exception_checks(&mut lookalike, &HashMap::new(), is_runtime);
+        let (pending, _) = branch_targets(&lookalike, BlockId(0));
+        assert!(lookalike.block(pending).instructions.is_empty());
+
+        // The exception becomes a rejection instead of leaving the resume function
+        let (pending, _) = branch_targets(&func, BlockId(0));
+        let names: Vec<&str> = func
+            .block(pending)
+            .instructions
+            .iter()
+            .filter_map(|inst| match inst {
+                Instruction::Call { func: Value::Const(Constant::Str(name)), .. } => Some(name.as_str()),
+                _ => None,
+            })
+            .collect();
+        assert_eq!(names, vec![GET_ERROR, CLEAR_ERROR, PROMISE_REJECT]);
+        assert_eq!(
+            func.block(pending).instructions.last(),
+            Some(&Instruction::Free { value: Value::Local(LocalId(0)) })
+        );
+        assert_eq!(func.block(pending).terminator, Terminator::Return(None));
+    }
+
+    #[test]
+    fn test_indirect_calls_may_throw() {
+        let indirect = Instruction::Call { dest: None, func: Value::Temp(crate::TempId(0)), args: vec![] };
+        assert!(may_throw(&indirect, is_runtime));
+        assert!(may_throw(&call("zaco_json_parse"), is_runtime));
+        assert!(may_throw(&call("zaco_events_emit"), is_runtime), "listeners run synchronously");
+        assert!(!may_throw(&call("zaco_array_push"), is_runtime));
+    }
+}
@@ -34,6 +34,10 @@ pub struct IrFunction {
     /// Whether this function is public/exported
     pub is_public: bool,
 
+    /// Whether this is the resume function of an async function's state
+    /// machine: `(frame, resumed) -> void`, with its promise in frame slot 1
+    pub is_async_resume: bool,
+
     /// Optional source span for debugging
     pub span: Option<Span>,
 }
@@ -51,6 +55,7 @@ impl IrFunction {
             blocks: Vec::new(),
             entry_block: BlockId(0),
             is_public: false,
+            is_async_resume: false,
             span: None,
         }
     }
@@ -2,7 +2,7 @@
 
 use zaco_ast::Span;
 
-use crate::{BlockId, IrType, Place, RValue, Value};
+use crate::{BlockId, IrType, Place, RValue, TempId, Value};
 
 /// A single IR instruction within a basic block.
 #[derive(Debug, Clone, PartialEq)]
@@ -39,6 +39,13 @@ pub enum Instruction {
         ty: IrType,
     },
 
+    /// Stack allocation of a value that never escapes its function; the
+    /// object carries a static refcount header and is never freed
+    StackAlloc {
+        dest: Place,
+        ty: IrType,
+    },
+
     /// Deallocation (ownership drop)
     Free {
         value: Value,
@@ -69,6 +76,99 @@ pub enum Instruction {
     },
 }
 
+impl Instruction {
+    /// Values read by this instruction, in evaluation order.
+    pub fn operands(&self) -> Vec<&Value> {
+        match self {
+            Instruction::Assign { dest, value } => {
+                let mut operands = value.operands();
+                operands.extend(dest.operands());
+                operands
+            }
+            Instruction::Call { dest, func, args } => {
+                let mut operands = vec![func];
+                operands.extend(args.iter());
+                if let Some(dest) = dest {
+                    operands.extend(dest.operands());
+                }
+                operands
+            }
+            Instruction::Return(value) => value.iter().collect(),
+            Instruction::Branch { cond, .. } => vec![cond],
+            Instruction::Jump(_) => Vec::new(),
+            Instruction::Alloc { dest, .. } | Instruction::StackAlloc { dest, .. } => {
+                dest.operands()
+            }
+            Instruction::Free { value } | Instruction::RefCount { value, .. } => vec![value],
+            Instruction::Clone { dest, source } => {
+                let mut operands = vec![source];
+                operands.extend(dest.operands());
+                operands
+            }
+            Instruction::Store { ptr, value } => vec![ptr, value],
+            Instruction::Load { dest, ptr } => {
+                let mut operands = vec![ptr];
+                operands.extend(dest.operands());
+                operands
+            }
+        }
+    }
+
+    /// Mutable access to the values read by this instruction, in evaluation order.
+    pub fn operands_mut(&mut self) -> Vec<&mut Value> {
+        match self {
+            Instruction::Assign { dest, value } => {
+                let mut operands = value.operands_mut();
+                operands.extend(dest.operands_mut());
+                operands
+            }
+            Instruction::Call { dest, func, args } => {
+                let mut operands = vec![func];
+                operands.extend(args.iter_mut());
+                if let Some(dest) = dest {
+                    operands.extend(dest.operands_mut());
+                }
+                operands
+            }
+            Instruction::Return(value) => value.iter_mut().collect(),
+            Instruction::Branch { cond, .. } => vec![cond],
+            Instruction::Jump(_) => Vec::new(),
+            Instruction::Alloc { dest, .. } | Instruction::StackAlloc { dest, .. } => {
+                dest.operands_mut()
+            }
+            Instruction::Free { value } | Instruction::RefCount { value, .. } => vec![value],
+            Instruction::Clone { dest, source } => {
+                let mut operands = vec![source];
+                operands.extend(dest.operands_mut());
+                operands
+            }
+            Instruction::Store { ptr, value } => vec![ptr, value],
+            Instruction::Load { dest, ptr } => {
+                let mut operands = vec![ptr];
+                operands.extend(dest.operands_mut());
+                operands
+            }
+        }
+    }
+
+    /// The temporary this instruction defines, if its destination is one.
+    pub fn dest_temp(&self) -> Option<TempId> {
+        let dest = match self {
+            Instruction::Assign { dest, .. }
+            | Instruction::Alloc { dest, .. }
+            | Instruction::StackAlloc { dest, .. }
+            | Instruction::Clone { dest, .. }
+            | Instruction::Load { dest, .. } => dest,
+            Instruction::Call { dest: Some(dest), .. } => dest,
+            _ => return None,
+        };
+        match dest.base {
+            Value::Temp(temp) if dest.projections.is_empty() => Some(temp),
+            _ => None,
+        }
+    }
+}
+
 /// Terminator instruction that ends a basic block.
 #[derive(Debug, Clone, PartialEq)]
 pub enum Terminator {
@@ -89,6 +189,26 @@ pub enum Terminator {
     Unreachable,
 }
 
+impl Terminator {
+    /// Values read by this terminator.
+    pub fn operands(&self) -> Vec<&Value> {
+        match self {
+            Terminator::Return(value) => value.iter().collect(),
+            Terminator::Branch { cond, .. } => vec![cond],
+            Terminator::Jump(_) | Terminator::Unreachable => Vec::new(),
+        }
+    }
+
+    /// Mutable access to the values read by this terminator.
+    pub fn operands_mut(&mut self) -> Vec<&mut Value> {
+        match self {
+            Terminator::Return(value) => value.iter_mut().collect(),
+            Terminator::Branch { cond, .. } => vec![cond],
+            Terminator::Jump(_) | Terminator::Unreachable => Vec::new(),
+        }
+    }
+}
+
 /// A basic block in the control flow graph.
 #[derive(Debug, Clone, PartialEq)]
 pub struct Block {
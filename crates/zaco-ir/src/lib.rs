@@ -14,6 +14,10 @@ pub mod value;
 pub mod instruction;
 pub mod function;
 pub mod module;
+pub mod serialize;
+pub mod opt;
+pub mod exceptions;
+pub mod profile;
 
 // ============================================================================
 // ID Types (using newtype pattern for type safety)
@@ -156,9 +160,9 @@ mod tests {
     fn test_module_string_interning() {
         let mut module = IrModule::new();
 
-        let idx1 = module.intern_string("hello".to_string());
-        let idx2 = module.intern_string("world".to_string());
-        let idx3 = module.intern_string("hello".to_string());
+        let idx1 = module.intern_string("hello");
+        let idx2 = module.intern_string("world");
+        let idx3 = module.intern_string("hello");
 
         assert_eq!(idx1, 0);
         assert_eq!(idx2, 1);
@@ -219,4 +223,45 @@ mod tests {
         block.set_terminator(Terminator::Return(None));
         assert_eq!(block.successors(), Vec::<BlockId>::new());
     }
+
+    #[test]
+    fn test_module_rebase_ids() {
+        let mut module = IrModule::new();
+        let mut func = IrFunction::new(
+            FuncId(0),
+            "make".to_string(),
+            vec![],
+            IrType::Struct(StructId(0)),
+        );
+        let local = func.add_local(IrType::Array(Box::new(IrType::Struct(StructId(1)))));
+        let block = func.new_block();
+        func.block_mut(block).instructions.push(Instruction::Assign {
+            dest: Place::from_local(local),
+            value: RValue::StructInit {
+                struct_id: StructId(1),
+                fields: vec![],
+            },
+        });
+        module.add_function(func);
+        let mut point = IrStruct::new(StructId(0), "Point".to_string(), vec![]);
+        point.drop_fn = Some(FuncId(0));
+        module.add_struct(point);
+        module.next_func_id = 1;
+        module.next_struct_id = 2;
+
+        module.rebase_ids(10, 3);
+
+        let func = &module.functions[0];
+        assert_eq!(func.id, FuncId(10));
+        assert_eq!(func.return_type, IrType::Struct(StructId(3)));
+        assert_eq!(func.locals[0].1, IrType::Array(Box::new(IrType::Struct(StructId(4)))));
+        assert!(matches!(
+            &func.blocks[0].instructions[0],
+            Instruction::Assign { value: RValue::StructInit { struct_id: StructId(4), .. }, .. }
+        ));
+        assert_eq!(module.structs[0].id, StructId(3));
+        assert_eq!(module.structs[0].drop_fn, Some(FuncId(10)));
+        assert_eq!(module.next_func_id, 11);
+        assert_eq!(module.next_struct_id, 5);
+    }
 }
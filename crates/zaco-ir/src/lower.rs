@@ -11,6 +11,7 @@ use crate::{
     BinOp, BlockId, Constant, FuncId, IrFunction, IrModule, IrStruct, IrType, Instruction, LocalId,
     Place, RValue, StructId, TempId, Terminator, UnOp, Value,
 };
+use crate::exceptions;
 
 /// Errors produced during lowering.
 #[derive(Debug, Clone)]
@@ -83,15 +84,40 @@ struct ClosureInfo {
     env_local: Option<LocalId>,
 }
 
+/// An async function being lowered into its resume function.
+///
+/// The resume function takes `(frame, resumed)`. Slot `i` of the frame holds
+/// local `i` while the function is suspended; locals 0 and 1 are the resume
+/// function's own parameters, so those two slots hold the state index and the
+/// function's promise instead.
+struct AsyncFrame {
+    /// Function ID of the resume function (awaits in nested functions block)
+    resume_id: FuncId,
+    /// Resume function name, handed to the runtime as the continuation
+    resume_fn: String,
+    /// Per suspension point: (block ending in the await, block resumed into)
+    awaits: Vec<(BlockId, BlockId)>,
+}
+
+/// Resume function parameter holding the frame pointer.
+const ASYNC_FRAME: LocalId = LocalId(0);
+/// Resume function parameter holding the value the awaited promise settled with.
+const ASYNC_RESUMED: LocalId = LocalId(1);
+/// Frame slot of the promise returned to the async function's caller.
+pub(crate) const ASYNC_PROMISE_SLOT: usize = 1;
+
 /// Scope for tracking variable bindings.
 struct Scope {
     vars: HashMap<String, VarInfo>,
+    /// Variables initialized from an object literal: name → (key, slot type) in slot order
+    object_shapes: HashMap<String, Vec<(String, IrType)>>,
 }
 
 impl Scope {
     fn new() -> Self {
         Self {
             vars: HashMap::new(),
+            object_shapes: HashMap::new(),
         }
     }
 }
@@ -135,6 +161,19 @@ pub struct Lowerer {
     module_name: Option<String>,
     /// Source file path for __dirname/__filename resolution.
     file_path: Option<String>,
+    /// String accumulators of the loops being lowered: variable local → builder local.
+    /// While active, `s += e` appends to the builder instead of concatenating.
+    str_builders: HashMap<LocalId, LocalId>,
+    /// Next inline-cache cell ID for object property access sites
+    next_ic_id: usize,
+    /// Interface declarations: name → (key, slot type) in declaration order
+    interface_shapes: HashMap<String, Vec<(String, IrType)>>,
+    /// Generated JSON serializers: shape signature → function name
+    json_serializers: HashMap<String, String>,
+    /// Async function whose resume function is being lowered
+    async_frame: Option<AsyncFrame>,
+    /// Blocks lowered inside a try body → the try's catch block, per function
+    try_handlers: HashMap<FuncId, HashMap<BlockId, BlockId>>,
 }
 
 /// Context for lowering a single function body.
@@ -191,6 +230,12 @@ impl Lowerer {
             has_user_main: false,
             module_name: None,
             file_path: None,
+            str_builders: HashMap::new(),
+            next_ic_id: 0,
+            interface_shapes: HashMap::new(),
+            json_serializers: HashMap::new(),
+            async_frame: None,
+            try_handlers: HashMap::new(),
         }
     }
 
@@ -276,6 +321,19 @@ impl Lowerer {
             }
         }
 
+        // Collect interface shapes up front; interfaces may be used before
+        // they are declared.
+        for item in &program.items {
+            let decl = match &item.value {
+                ModuleItem::Decl(decl_node) => &decl_node.value,
+                ModuleItem::Export(ExportDecl::Decl(decl_node)) => &decl_node.value,
+                _ => continue,
+            };
+            if let Decl::Interface(iface) = decl {
+                self.collect_interface_shape(iface);
+            }
+        }
+
         // Determine wrapper function name and return type based on module context.
         // Entry module gets "main" (returns I64 exit code).
         // Non-entry modules get "__module_init_<name>" (returns void).
@@ -327,6 +385,18 @@ impl Lowerer {
         self.module.next_func_id = self.next_func_id;
         self.module.next_struct_id = self.next_struct_id;
 
+        // Test for pending exceptions after calls that may throw
+        if is_entry {
+            self.ensure_extern(exceptions::CHECK_UNCAUGHT, vec![], IrType::Void);
+        }
+        let no_handlers = HashMap::new();
+        for func in &mut self.module.functions {
+            let handlers = self.try_handlers.get(&func.id).unwrap_or(&no_handlers);
+            // Printing and other codegen intrinsics are not declared as externs
+            let is_runtime = |name: &str| name.starts_with("zaco_") || self.extern_set.contains(name);
+            exceptions::insert_exception_checks(func, handlers, is_runtime);
+        }
+
         if self.errors.is_empty() {
             Ok(self.module)
         } else {
@@ -357,13 +427,13 @@ impl Lowerer {
             match spec {
                 ImportSpecifier::Named { imported, local, .. } => {
                     let local_name = local.as_ref().unwrap_or(imported).value.name.clone();
-                    self.imported_bindings.insert(local_name, source.clone());
+                    self.imported_bindings.insert(local_name.to_string(), source.clone());
                 }
                 ImportSpecifier::Default(ident) => {
-                    self.imported_bindings.insert(ident.value.name.clone(), source.clone());
+                    self.imported_bindings.insert(ident.value.name.to_string(), source.clone());
                 }
                 ImportSpecifier::Namespace(ident) => {
-                    self.imported_bindings.insert(ident.value.name.clone(), source.clone());
+                    self.imported_bindings.insert(ident.value.name.to_string(), source.clone());
                 }
             }
         }
@@ -431,6 +501,13 @@ impl Lowerer {
             Stmt::VarDecl(var_decl) => {
                 self.lower_var_decl(ctx, var_decl, span);
             }
+            Stmt::Return(opt_expr) if self.in_async_resume(ctx) => {
+                let result = opt_expr.as_ref().and_then(|expr_node| {
+                    let ty = self.infer_expr_type(&expr_node.value);
+                    self.lower_expr(ctx, &expr_node.value, &expr_node.span).map(|val| (val, ty))
+                });
+                self.emit_async_return(ctx, result);
+            }
             Stmt::Return(opt_expr) => {
                 if let Some(expr_node) = opt_expr {
                     if let Some(val) = self.lower_expr(ctx, &expr_node.value, &expr_node.span) {
@@ -518,7 +595,7 @@ impl Lowerer {
     fn lower_var_decl(&mut self, ctx: &mut FuncCtx, var_decl: &VarDecl, _span: &Span) {
         for declarator in &var_decl.declarations {
             match &declarator.pattern.value {
-                Pattern::Ident { name, .. } => {
+                Pattern::Ident { name, type_annotation, .. } => {
                     let name = name.value.name.clone();
                     let ir_type = if let Some(ref init) = declarator.init {
                         self.infer_expr_type(&init.value)
@@ -527,11 +604,21 @@ impl Lowerer {
                     };
                     let local_id = ctx.add_local(ir_type.clone());
                     self.define_var(&name, VarInfo { local_id, ir_type, is_boxed: false });
+                    let shape = match declarator.init.as_ref().map(|i| &i.value) {
+                        Some(Expr::Object(props)) => self.object_literal_shape(props),
+                        _ => None,
+                    }
+                    .or_else(|| type_annotation.as_ref().and_then(|ty| self.annotation_shape(&ty.value)));
+                    if let Some(shape) = shape {
+                        if let Some(scope) = self.scopes.last_mut() {
+                            scope.object_shapes.insert(name.to_string(), shape);
+                        }
+                    }
                     if let Some(ref init) = declarator.init {
                         if let Some(val) = self.lower_expr(ctx, &init.value, &init.span) {
                             if let Value::Const(Constant::Str(ref func_name)) = val {
                                 if let Some(closure_info) = self.closure_bindings.get(func_name).cloned() {
-                                    self.closure_bindings.insert(name.clone(), closure_info);
+                                    self.closure_bindings.insert(name.to_string(), closure_info);
                                 }
                             }
                             ctx.emit(Instruction::Assign {
@@ -556,7 +643,7 @@ impl Lowerer {
                     });
                     for prop in properties {
                         let key_str = match &prop.key {
-                            PropertyName::Ident(ident) => ident.value.name.clone(),
+                            PropertyName::Ident(ident) => ident.value.name.to_string(),
                             PropertyName::String(s) => s.clone(),
                             PropertyName::Number(n) => format!("{}", n),
                             PropertyName::Computed(_) => continue,
@@ -567,7 +654,7 @@ impl Lowerer {
                         };
                         let ir_type = IrType::F64;
                         self.ensure_extern("zaco_object_get_f64", vec![IrType::Ptr, IrType::Ptr], ir_type.clone());
-                        self.module.intern_string(key_str.clone());
+                        self.module.intern_string(&key_str);
                         let key_val = Value::Const(Constant::Str(key_str));
                         let result_temp = ctx.add_temp(ir_type.clone());
                         ctx.emit(Instruction::Call {
@@ -706,12 +793,12 @@ impl Lowerer {
 
             Expr::This => self.lower_this_expr(),
 
-            Expr::Arrow { params, body, return_type, .. } => {
-                self.lower_arrow_expr(ctx, params, return_type.as_deref(), body, span)
+            Expr::Arrow { params, body, return_type, is_async, .. } => {
+                self.lower_arrow_expr(ctx, params, return_type.as_deref(), body, *is_async, span)
             }
 
-            Expr::Function { name, params, return_type, body, .. } => {
-                self.lower_function_expr(ctx, name.as_ref(), params, return_type.as_deref(), body, span)
+            Expr::Function { name, params, return_type, body, is_async, .. } => {
+                self.lower_function_expr(ctx, name.as_ref(), params, return_type.as_deref(), body, *is_async, span)
             }
 
             Expr::Ternary { condition, then_expr, else_expr } => {
@@ -734,6 +821,8 @@ impl Lowerer {
                 self.lower_optional_call(ctx, callee, args, span)
             }
 
+            Expr::Index { object, index } => self.lower_index_expr(ctx, object, index, span),
+
             Expr::OptionalIndex { object, index } => {
                 self.lower_optional_index(ctx, object, index, span)
             }
@@ -758,8 +847,8 @@ impl Lowerer {
             }
             Literal::String(s) => {
                 // Intern the string
-                self.module.intern_string(s.clone());
-                Some(Value::Const(Constant::Str(s.clone())))
+                self.module.intern_string(s);
+                Some(Value::Const(Constant::Str(s.to_string())))
             }
             Literal::Boolean(b) => Some(Value::Const(Constant::Bool(*b))),
             Literal::Null => Some(Value::Const(Constant::Null)),
@@ -786,48 +875,27 @@ impl Lowerer {
             return self.lower_nullish_coalesce(ctx, left, right);
         }
 
-        let lhs = self.lower_expr(ctx, &left.value, &left.span)?;
-        let rhs = self.lower_expr(ctx, &right.value, &right.span)?;
-
-        // Check if this is string concatenation
+        // String concatenation: flatten `a + b + c + ...` into one operand list
         if matches!(op, BinaryOp::Add) {
             let left_ty = self.infer_expr_type(&left.value);
             let right_ty = self.infer_expr_type(&right.value);
             if left_ty == IrType::Str || right_ty == IrType::Str {
-                // Convert non-string operands to strings
-                let lhs_str = if left_ty != IrType::Str {
-                    self.ensure_extern("zaco_f64_to_str", vec![IrType::F64], IrType::Str);
-                    let conv_temp = ctx.add_temp(IrType::Str);
-                    ctx.emit(Instruction::Call {
-                        dest: Some(Place::from_temp(conv_temp)),
-                        func: Value::Const(Constant::Str("zaco_f64_to_str".to_string())),
-                        args: vec![lhs],
-                    });
-                    Value::Temp(conv_temp)
-                } else {
-                    lhs
-                };
-                let rhs_str = if right_ty != IrType::Str {
-                    self.ensure_extern("zaco_f64_to_str", vec![IrType::F64], IrType::Str);
-                    let conv_temp = ctx.add_temp(IrType::Str);
-                    ctx.emit(Instruction::Call {
-                        dest: Some(Place::from_temp(conv_temp)),
-                        func: Value::Const(Constant::Str("zaco_f64_to_str".to_string())),
-                        args: vec![rhs],
-                    });
-                    Value::Temp(conv_temp)
-                } else {
-                    rhs
-                };
-                let temp = ctx.add_temp(IrType::Str);
-                ctx.emit(Instruction::Assign {
-                    dest: Place::from_temp(temp),
-                    value: RValue::StrConcat(vec![lhs_str, rhs_str]),
-                });
-                return Some(Value::Temp(temp));
+                let mut operands = Vec::new();
+                self.collect_concat_operands(left, &mut operands);
+                self.collect_concat_operands(right, &mut operands);
+                let mut values = Vec::with_capacity(operands.len());
+                for operand in operands {
+                    let val = self.lower_expr(ctx, &operand.value, &operand.span)?;
+                    let ty = self.infer_expr_type(&operand.value);
+                    values.push(self.emit_to_str(ctx, val, &ty));
+                }
+                return Some(self.emit_str_concat(ctx, values));
             }
         }
 
+        let lhs = self.lower_expr(ctx, &left.value, &left.span)?;
+        let rhs = self.lower_expr(ctx, &right.value, &right.span)?;
+
         // Handle string equality/inequality via runtime call
         if matches!(op, BinaryOp::Eq | BinaryOp::StrictEq | BinaryOp::NotEq | BinaryOp::StrictNotEq) {
             let left_ty = self.infer_expr_type(&left.value);
@@ -1070,8 +1138,15 @@ impl Lowerer {
         ctx: &mut FuncCtx,
         op: UnaryOp,
         operand: &Node<Expr>,
-        _span: &Span,
+        span: &Span,
     ) -> Option<Value> {
+        if matches!(
+            op,
+            UnaryOp::PreIncrement | UnaryOp::PreDecrement | UnaryOp::PostIncrement | UnaryOp::PostDecrement
+        ) {
+            return self.lower_update(ctx, op, operand, span);
+        }
+
         let val = self.lower_expr(ctx, &operand.value, &operand.span)?;
 
         // void: evaluate operand for side effects, return undefined (null)
@@ -1104,6 +1179,36 @@ impl Lowerer {
         Some(Value::Temp(temp))
     }
 
+    /// Lower `++x`/`x++`/`--x`/`x--` on a numeric variable as `x = x ± 1`,
+    /// yielding the new value for prefix forms and the old one for postfix.
+    fn lower_update(&mut self, ctx: &mut FuncCtx, op: UnaryOp, operand: &Node<Expr>, span: &Span) -> Option<Value> {
+        let Expr::Ident(ident) = &operand.value else {
+            return None; // Member/index targets not yet supported
+        };
+        if self.lookup_var(&ident.name)?.ir_type != IrType::F64 {
+            return None;
+        }
+        let old = match op {
+            UnaryOp::PostIncrement | UnaryOp::PostDecrement => {
+                let current = self.lower_expr(ctx, &operand.value, &operand.span)?;
+                let temp = ctx.add_temp(IrType::F64);
+                ctx.emit(Instruction::Assign {
+                    dest: Place::from_temp(temp),
+                    value: RValue::Use(current),
+                });
+                Some(Value::Temp(temp))
+            }
+            _ => None,
+        };
+        let assign_op = match op {
+            UnaryOp::PreIncrement | UnaryOp::PostIncrement => AssignmentOp::AddAssign,
+            _ => AssignmentOp::SubAssign,
+        };
+        let one = Node::new(Expr::Literal(Literal::Number(1.0)), span.clone());
+        let new = self.lower_assignment(ctx, operand, assign_op, &one, span)?;
+        old.or(Some(new))
+    }
+
     fn lower_assignment(
         &mut self,
         ctx: &mut FuncCtx,
@@ -1132,6 +1237,28 @@ impl Lowerer {
 
         let info = self.lookup_var(&target_name)?.clone();
 
+        // String `+=`: append to the loop's builder, or concatenate
+        if op == AssignmentOp::AddAssign && info.ir_type == IrType::Str && !info.is_boxed {
+            let rhs_ty = self.infer_expr_type(&value.value);
+            let rhs_str = self.emit_to_str(ctx, rhs, &rhs_ty);
+            if let Some(&builder) = self.str_builders.get(&info.local_id) {
+                self.ensure_extern("zaco_strbuf_append", vec![IrType::Ptr, IrType::Str], IrType::Void);
+                ctx.emit(Instruction::Call {
+                    dest: None,
+                    func: Value::Const(Constant::Str("zaco_strbuf_append".to_string())),
+                    args: vec![Value::Local(builder), rhs_str],
+                });
+                // Only reachable from expression statements; the value is unused
+                return Some(Value::Local(info.local_id));
+            }
+            let final_val = self.emit_str_concat(ctx, vec![Value::Local(info.local_id), rhs_str]);
+            ctx.emit(Instruction::Assign {
+                dest: Place::from_local(info.local_id),
+                value: RValue::Use(final_val.clone()),
+            });
+            return Some(final_val);
+        }
+
         let final_val = if op == AssignmentOp::Assign {
             rhs
         } else {
@@ -1253,21 +1380,78 @@ impl Lowerer {
         Some(Value::Local(result_local))
     }
 
+    /// Runtime getter and its return type for reading from an array of type
+    /// `array_type`. Elements are 8-byte slots: pointers for reference
+    /// types, doubles for everything else.
+    fn array_getter(array_type: &IrType) -> (&'static str, IrType) {
+        match array_type {
+            IrType::Array(elem) if matches!(**elem, IrType::Str | IrType::Ptr | IrType::Array(_) | IrType::Struct(_)) => {
+                ("zaco_array_get_ptr", IrType::Ptr)
+            }
+            _ => ("zaco_array_get_f64", IrType::F64),
+        }
+    }
+
+    /// Type of a value read from an array of type `array_type`.
+    fn array_elem_type(array_type: &IrType) -> IrType {
+        match (array_type, Self::array_getter(array_type)) {
+            (IrType::Array(elem), (_, IrType::Ptr)) => (**elem).clone(),
+            (_, (_, ret)) => ret,
+        }
+    }
+
+    /// Convert a lowered index expression to the `i64` the array getters take.
+    fn emit_array_index(&mut self, ctx: &mut FuncCtx, index: Value, index_expr: &Expr) -> Value {
+        if self.infer_expr_type(index_expr) == IrType::I64 {
+            return index;
+        }
+        let idx_temp = ctx.add_temp(IrType::I64);
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_temp(idx_temp),
+            value: RValue::Cast { value: index, ty: IrType::I64 },
+        });
+        Value::Temp(idx_temp)
+    }
+
+    /// Lower index access on an array (`arr[i]`).
+    fn lower_index_expr(&mut self, ctx: &mut FuncCtx, object: &Node<Expr>, index: &Node<Expr>, _span: &Span) -> Option<Value> {
+        let base_type = self.infer_expr_type(&object.value);
+        if !matches!(base_type, IrType::Array(_)) {
+            return None;
+        }
+        let base = self.lower_expr(ctx, &object.value, &object.span)?;
+        let idx_val = self.lower_expr(ctx, &index.value, &index.span)?;
+        let idx_val = self.emit_array_index(ctx, idx_val, &index.value);
+        let (getter, ret_type) = Self::array_getter(&base_type);
+        self.ensure_extern(getter, vec![IrType::Ptr, IrType::I64], ret_type);
+        let elem_temp = ctx.add_temp(Self::array_elem_type(&base_type));
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(elem_temp)),
+            func: Value::Const(Constant::Str(getter.to_string())),
+            args: vec![base, idx_val],
+        });
+        Some(Value::Temp(elem_temp))
+    }
+
     /// Lower optional index access (`obj?.[index]`).
     fn lower_optional_index(&mut self, ctx: &mut FuncCtx, object: &Node<Expr>, index: &Node<Expr>, _span: &Span) -> Option<Value> {
         let base = self.lower_expr(ctx, &object.value, &object.span)?;
         let base_type = self.infer_expr_type(&object.value);
-        let result_local = ctx.add_local(IrType::F64);
-        ctx.emit(Instruction::Assign { dest: Place::from_local(result_local), value: RValue::Use(Value::Const(Constant::I64(0))) });
+        let (getter, ret_type) = Self::array_getter(&base_type);
+        let elem_type = Self::array_elem_type(&base_type);
+        let result_local = ctx.add_local(elem_type.clone());
+        let default = if elem_type == IrType::F64 { Constant::F64(0.0) } else { Constant::Null };
+        ctx.emit(Instruction::Assign { dest: Place::from_local(result_local), value: RValue::Use(Value::Const(default)) });
         let then_block = ctx.new_block();
         let merge_block = ctx.new_block();
         let is_null = self.emit_null_check(ctx, base.clone(), &base_type);
         ctx.set_terminator(Terminator::Branch { cond: is_null, then_block: merge_block, else_block: then_block });
         ctx.switch_to(then_block);
         if let Some(idx_val) = self.lower_expr(ctx, &index.value, &index.span) {
-            self.ensure_extern("zaco_array_get", vec![IrType::Ptr, IrType::I64], IrType::F64);
-            let elem_temp = ctx.add_temp(IrType::F64);
-            ctx.emit(Instruction::Call { dest: Some(Place::from_temp(elem_temp)), func: Value::Const(Constant::Str("zaco_array_get".to_string())), args: vec![base, idx_val] });
+            let idx_val = self.emit_array_index(ctx, idx_val, &index.value);
+            self.ensure_extern(getter, vec![IrType::Ptr, IrType::I64], ret_type);
+            let elem_temp = ctx.add_temp(elem_type);
+            ctx.emit(Instruction::Call { dest: Some(Place::from_temp(elem_temp)), func: Value::Const(Constant::Str(getter.to_string())), args: vec![base, idx_val] });
             ctx.emit(Instruction::Assign { dest: Place::from_local(result_local), value: RValue::Use(Value::Temp(elem_temp)) });
         }
         ctx.set_terminator(Terminator::Jump(merge_block));
@@ -1294,7 +1478,7 @@ impl Lowerer {
         } = &callee.value
         {
             if let Expr::Ident(obj_ident) = &object.value {
-                let obj_name = &obj_ident.name;
+                let obj_name = obj_ident.name.as_str();
                 let method = &property.value.name;
 
                 // Handle console methods
@@ -1401,6 +1585,13 @@ impl Lowerer {
                 }
             }
 
+            // Typed array methods backed by runtime kernels
+            if let IrType::Array(elem) = self.infer_expr_type(&object.value) {
+                if let Some(result) = self.lower_typed_array_method(ctx, object, &property.value.name, &elem, args) {
+                    return Some(result);
+                }
+            }
+
             // Handle array.map/filter/forEach callbacks
             if let Expr::Ident(obj_ident) = &object.value {
                 let method = &property.value.name;
@@ -1416,7 +1607,7 @@ impl Lowerer {
 
         // Check for direct function calls (imported functions)
         let func_name = match &callee.value {
-            Expr::Ident(ident) => ident.name.clone(),
+            Expr::Ident(ident) => ident.name.to_string(),
             _ => return None, // Complex callees not yet supported
         };
 
@@ -1441,17 +1632,30 @@ impl Lowerer {
                 }
             }
 
-            // For setTimeout/setInterval: inject null context between callback and delay.
+            // For setTimeout/setInterval: inject the callback's closure environment
+            // (or null) as the context between callback and delay.
             // TS signature: setTimeout(callback, delay) → 2 args
             // Runtime signature: zaco_set_timeout(callback, context, delay) → 3 args
             if func_name == "setTimeout" || func_name == "setInterval" {
-                let null_ctx = ctx.add_temp(IrType::Ptr);
+                let closure_info = match args.first().map(|a| &a.value) {
+                    Some(Expr::Arrow { .. } | Expr::Function { .. }) => {
+                        let closure_name = format!("__closure_{}", self.next_closure_id - 1);
+                        self.closure_bindings.get(&closure_name).cloned()
+                    }
+                    Some(Expr::Ident(ident)) => self.closure_bindings.get(ident.name.as_str()).cloned(),
+                    _ => None,
+                };
+                let env_ctx = ctx.add_temp(IrType::Ptr);
                 ctx.emit(Instruction::Assign {
-                    dest: Place::from_temp(null_ctx),
-                    value: RValue::Use(Value::Const(Constant::Null)),
+                    dest: Place::from_temp(env_ctx),
+                    value: RValue::Use(
+                        closure_info
+                            .and_then(|ci| ci.env_local.map(Value::Local))
+                            .unwrap_or(Value::Const(Constant::Null)),
+                    ),
                 });
                 if arg_vals.len() >= 2 {
-                    arg_vals.insert(1, Value::Temp(null_ctx));
+                    arg_vals.insert(1, Value::Temp(env_ctx));
                 }
             }
 
@@ -1539,7 +1743,7 @@ impl Lowerer {
             // Print space separator between arguments (except first)
             if i > 0 {
                 let space_str = " ".to_string();
-                self.module.intern_string(space_str.clone());
+                self.module.intern_string(&space_str);
                 ctx.emit(Instruction::Call {
                     dest: None,
                     func: Value::Const(Constant::Str("zaco_print_str".to_string())),
@@ -1567,7 +1771,7 @@ impl Lowerer {
 
         // Print newline at end — emit empty string println to get the newline
         let empty = "".to_string();
-        self.module.intern_string(empty.clone());
+        self.module.intern_string(&empty);
         ctx.emit(Instruction::Call {
             dest: None,
             func: Value::Const(Constant::Str("zaco_println_str".to_string())),
@@ -1597,7 +1801,7 @@ impl Lowerer {
             // Print space separator between arguments (except first)
             if i > 0 {
                 let space_str = " ".to_string();
-                self.module.intern_string(space_str.clone());
+                self.module.intern_string(&space_str);
                 ctx.emit(Instruction::Call {
                     dest: None,
                     func: Value::Const(Constant::Str(format!("{}_str", prefix))),
@@ -1631,7 +1835,7 @@ impl Lowerer {
             _ => "zaco_println_str",
         };
         let empty = "".to_string();
-        self.module.intern_string(empty.clone());
+        self.module.intern_string(&empty);
         ctx.emit(Instruction::Call {
             dest: None,
             func: Value::Const(Constant::Str(println_fn.to_string())),
@@ -1699,8 +1903,8 @@ impl Lowerer {
         _span: &Span,
     ) -> Option<Value> {
         let (runtime_fn, param_types, return_type) = match method {
-            "parse" => ("zaco_json_parse", vec![IrType::Str], IrType::Str),
-            "stringify" => ("zaco_json_stringify", vec![IrType::Ptr], IrType::Str),
+            "parse" => ("zaco_json_parse", vec![IrType::Str], IrType::Ptr),
+            "stringify" => return self.lower_json_stringify(ctx, args),
             _ => return None,
         };
 
@@ -1780,6 +1984,12 @@ impl Lowerer {
             ("fs", "writeFileSync") => ("zaco_fs_write_file_sync", vec![IrType::Str, IrType::Str], IrType::Void),
             ("fs", "existsSync") => ("zaco_fs_exists_sync", vec![IrType::Str], IrType::Bool),
             ("fs", "mkdirSync") => ("zaco_fs_mkdir_sync", vec![IrType::Str, IrType::I64], IrType::Void),
+            // Chunked streams; handles are plain numbers
+            ("fs", "createReadStream") => ("zaco_fs_create_read_stream", vec![IrType::Str, IrType::F64], IrType::F64),
+            ("fs", "createWriteStream") => ("zaco_fs_create_write_stream", vec![IrType::Str, IrType::I64], IrType::F64),
+            ("fs", "readChunk") => ("zaco_fs_read_chunk", vec![IrType::F64], IrType::Str),
+            ("fs", "writeChunk") => ("zaco_fs_write_chunk", vec![IrType::F64, IrType::Str], IrType::Void),
+            ("fs", "closeStream") => ("zaco_fs_close_stream", vec![IrType::F64], IrType::Void),
             // TODO: fs.readFile async callback API not yet safely supported.
             // Closures are lowered as struct pointers, but the runtime expects
             // extern "C" fn(*const c_char, *const c_char). Needs a trampoline mechanism.
@@ -1920,7 +2130,7 @@ impl Lowerer {
 
         for (i, part) in parts.iter().enumerate() {
             if !part.is_empty() {
-                self.module.intern_string(part.clone());
+                self.module.intern_string(&part);
                 values.push(Value::Const(Constant::Str(part.clone())));
             }
             if i < exprs.len() {
@@ -1933,19 +2143,14 @@ impl Lowerer {
 
         if values.is_empty() {
             let empty = "".to_string();
-            self.module.intern_string(empty.clone());
+            self.module.intern_string(&empty);
             return Some(Value::Const(Constant::Str(empty)));
         }
         if values.len() == 1 {
             return Some(values.into_iter().next().unwrap());
         }
 
-        let temp = ctx.add_temp(IrType::Str);
-        ctx.emit(Instruction::Assign {
-            dest: Place::from_temp(temp),
-            value: RValue::StrConcat(values),
-        });
-        Some(Value::Temp(temp))
+        Some(self.emit_str_concat(ctx, values))
     }
 
     fn lower_array_literal(
@@ -1988,21 +2193,25 @@ impl Lowerer {
             match prop {
                 ObjectProperty::Property { key, value, .. } => {
                     let key_str = match key {
-                        PropertyName::Ident(ident) => ident.value.name.clone(),
+                        PropertyName::Ident(ident) => ident.value.name.to_string(),
                         PropertyName::String(s) => s.clone(),
                         PropertyName::Number(n) => format!("{}", n),
                         PropertyName::Computed(_) => continue,
                     };
 
-                    self.module.intern_string(key_str.clone());
+                    self.module.intern_string(&key_str);
                     let key_val = Value::Const(Constant::Str(key_str));
 
-                    if let Some(val) = self.lower_expr(ctx, &value.value, &value.span) {
+                    if let Some(mut val) = self.lower_expr(ctx, &value.value, &value.span) {
                         let val_type = self.infer_expr_type(&value.value);
+                        let is_object = matches!(&value.value, Expr::Object(_))
+                            || self.static_object_shape(&value.value).is_some();
                         let setter_name = match &val_type {
                             IrType::Str => "zaco_object_set_str",
                             IrType::F64 => "zaco_object_set_f64",
-                            IrType::I64 | IrType::Bool => "zaco_object_set_i64",
+                            IrType::I64 => "zaco_object_set_i64",
+                            IrType::Bool => "zaco_object_set_bool",
+                            IrType::Ptr if is_object => "zaco_object_set_obj",
                             _ => "zaco_object_set_ptr",
                         };
                         let setter_val_type = match &val_type {
@@ -2010,6 +2219,14 @@ impl Lowerer {
                             IrType::Bool => IrType::I64,
                             other => other.clone(),
                         };
+                        if val_type == IrType::Bool {
+                            let widened = ctx.add_temp(IrType::I64);
+                            ctx.emit(Instruction::Assign {
+                                dest: Place::from_temp(widened),
+                                value: RValue::Cast { value: val, ty: IrType::I64 },
+                            });
+                            val = Value::Temp(widened);
+                        }
                         self.ensure_extern(
                             setter_name,
                             vec![IrType::Ptr, IrType::Ptr, setter_val_type],
@@ -2089,6 +2306,8 @@ impl Lowerer {
         body: &Node<Stmt>,
         _span: &Span,
     ) {
+        let builders = self.begin_str_accumulators(ctx, &[condition], None, &body.value);
+
         let cond_block = ctx.new_block();
         let body_block = ctx.new_block();
         let exit_block = ctx.new_block();
@@ -2099,7 +2318,10 @@ impl Lowerer {
         ctx.switch_to(cond_block);
         let cond_val = match self.lower_expr(ctx, &condition.value, &condition.span) {
             Some(v) => v,
-            None => return,
+            None => {
+                self.end_str_accumulators(ctx, builders);
+                return;
+            }
         };
         ctx.set_terminator(Terminator::Branch {
             cond: cond_val,
@@ -2124,6 +2346,7 @@ impl Lowerer {
         }
 
         ctx.switch_to(exit_block);
+        self.end_str_accumulators(ctx, builders);
     }
 
     fn lower_for(
@@ -2147,6 +2370,9 @@ impl Lowerer {
             }
         }
 
+        let header: Vec<&Node<Expr>> = condition.into_iter().chain(update).collect();
+        let builders = self.begin_str_accumulators(ctx, &header, None, &body.value);
+
         let cond_block = ctx.new_block();
         let body_block = ctx.new_block();
         let update_block = ctx.new_block();
@@ -2160,6 +2386,7 @@ impl Lowerer {
             let cond_val = match self.lower_expr(ctx, &cond_expr.value, &cond_expr.span) {
                 Some(v) => v,
                 None => {
+                    self.end_str_accumulators(ctx, builders);
                     self.pop_scope();
                     return;
                 }
@@ -2196,6 +2423,7 @@ impl Lowerer {
         ctx.set_terminator(Terminator::Jump(cond_block));
 
         ctx.switch_to(exit_block);
+        self.end_str_accumulators(ctx, builders);
         self.pop_scope();
     }
 
@@ -2237,8 +2465,6 @@ impl Lowerer {
         _span: &Span,
     ) {
         // Ensure runtime functions are declared
-        self.ensure_extern("zaco_try_push", vec![], IrType::I64);
-        self.ensure_extern("zaco_try_pop", vec![], IrType::Void);
         self.ensure_extern("zaco_get_error", vec![], IrType::Ptr);
         self.ensure_extern("zaco_clear_error", vec![], IrType::Void);
 
@@ -2247,51 +2473,24 @@ impl Lowerer {
         let finally_block = ctx.new_block();
         let continue_block = ctx.new_block();
 
-        // Call zaco_try_push() → returns 0 normally, 1 on exception
-        let result_temp = ctx.add_temp(IrType::I64);
-        ctx.emit(Instruction::Call {
-            dest: Some(Place::from_temp(result_temp)),
-            func: Value::Const(Constant::Str("zaco_try_push".to_string())),
-            args: vec![],
-        });
-
-        // Compare result == 0 (normal path)
-        let zero_temp = ctx.add_temp(IrType::I64);
-        ctx.emit(Instruction::Assign {
-            dest: Place::from_temp(zero_temp),
-            value: RValue::Use(Value::Const(Constant::I64(0))),
-        });
-        let cond_temp = ctx.add_temp(IrType::Bool);
-        ctx.emit(Instruction::Assign {
-            dest: Place::from_temp(cond_temp),
-            value: RValue::BinaryOp {
-                op: BinOp::Eq,
-                left: Value::Temp(result_temp),
-                right: Value::Temp(zero_temp),
-            },
-        });
-
-        // Branch: if result == 0, go to try_block; else go to catch_block
-        ctx.set_terminator(Terminator::Branch {
-            cond: Value::Temp(cond_temp),
-            then_block: try_block,
-            else_block: catch_block,
-        });
+        // Entering the try is a plain jump; calls in its body branch to the
+        // catch block once the exception checks are inserted
+        ctx.set_terminator(Terminator::Jump(try_block));
 
         // === Try block ===
         ctx.switch_to(try_block);
+        let body_start = ctx.func.blocks.len();
         self.push_scope();
         for s in &block.value.stmts {
             self.lower_stmt(ctx, &s.value, &s.span);
         }
         self.pop_scope();
 
-        // Pop try context on normal exit
-        ctx.emit(Instruction::Call {
-            dest: None,
-            func: Value::Const(Constant::Str("zaco_try_pop".to_string())),
-            args: vec![],
-        });
+        // Nested trys recorded their own blocks first and keep them
+        let handlers = self.try_handlers.entry(ctx.func.id).or_default();
+        for id in std::iter::once(try_block.0).chain(body_start..ctx.func.blocks.len()) {
+            handlers.entry(BlockId(id)).or_insert(catch_block);
+        }
 
         // Jump to finally block
         if matches!(
@@ -2408,7 +2607,7 @@ impl Lowerer {
     }
 
     fn lower_sync_function_decl(&mut self, func_decl: &FunctionDecl) {
-        let mut func_name = func_decl.name.value.name.clone();
+        let mut func_name = func_decl.name.value.name.to_string();
         // Rename user-defined "main" to avoid conflict with compiler wrapper
         if func_name == "main" && self.has_user_main {
             func_name = "_user_main".to_string();
@@ -2448,7 +2647,7 @@ impl Lowerer {
         // Register params in scope
         for (i, param) in func_decl.params.iter().enumerate() {
             let param_name = match &param.pattern.value {
-                Pattern::Ident { name, .. } => name.value.name.clone(),
+                Pattern::Ident { name, .. } => name.value.name.to_string(),
                 _ => format!("_param{}", i),
             };
             let (local_id, ir_type) = &ir_params[i];
@@ -2460,6 +2659,15 @@ impl Lowerer {
                     is_boxed: false,
                 },
             );
+            let annotation = param.type_annotation.as_ref().or(match &param.pattern.value {
+                Pattern::Ident { type_annotation, .. } => type_annotation.as_ref(),
+                _ => None,
+            });
+            if let Some(shape) = annotation.and_then(|ty| self.annotation_shape(&ty.value)) {
+                if let Some(scope) = self.scopes.last_mut() {
+                    scope.object_shapes.insert(param_name, shape);
+                }
+            }
         }
 
         // Lower body
@@ -2498,117 +2706,469 @@ impl Lowerer {
         self.module.add_function(ir_func);
     }
 
+    /// Lower an async function into a state machine.
+    ///
+    /// The body becomes `__async_<module>_<name>_resume(frame, resumed)`, which
+    /// runs until the next `await`, saves its locals in the heap-allocated
+    /// frame and returns to the event loop. Once the awaited promise settles,
+    /// the runtime calls it again with the frame and the value, and its entry
+    /// block dispatches on the frame's state index to the code after that
+    /// `await`. `<name>(params)` builds the frame, runs the body up to its
+    /// first `await` and returns the promise.
     fn lower_async_function_decl(&mut self, func_decl: &FunctionDecl) {
         let func_name = func_decl.name.value.name.clone();
-        let func_id = self.alloc_func_id();
+        let param_types: Vec<IrType> = func_decl.params.iter().map(|p| self.infer_param_type(p)).collect();
+        let declared = func_decl.return_type.as_ref().map(|t| self.ast_type_to_ir(&t.value));
+        let return_type = Self::async_return_type(declared);
+        let body = func_decl.body.as_ref().map_or(&[][..], |b| &b.value.stmts[..]);
+
+        self.lower_async_body(&func_name, param_types.clone(), return_type, body, |this, _ctx, locals| {
+            for (i, param) in func_decl.params.iter().enumerate() {
+                let param_name = match &param.pattern.value {
+                    Pattern::Ident { name, .. } => name.value.name.to_string(),
+                    _ => format!("_param{}", i),
+                };
+                this.define_var(
+                    &param_name,
+                    VarInfo {
+                        local_id: locals[i],
+                        ir_type: param_types[i].clone(),
+                        is_boxed: false,
+                    },
+                );
+            }
+        });
+    }
 
-        // Build parameter list
-        let mut ir_params = Vec::new();
-        for (i, param) in func_decl.params.iter().enumerate() {
-            let ir_type = self.infer_param_type(param);
-            let local_id = LocalId(i);
-            ir_params.push((local_id, ir_type));
+    /// The promise type an async function returns: a declared `Promise<T>`
+    /// as-is, any other declared type wrapped in a promise, and
+    /// `Promise<void>` when nothing is declared.
+    fn async_return_type(declared: Option<IrType>) -> IrType {
+        match declared {
+            Some(promise @ IrType::Promise(_)) => promise,
+            Some(ir_type) => IrType::Promise(Box::new(ir_type)),
+            None => IrType::Promise(Box::new(IrType::Void)),
         }
+    }
 
-        // Infer inner return type (what the async function actually returns)
-        // If the user specified Promise<T>, extract T. Otherwise, wrap in Promise.
-        let return_type = if let Some(ref ret_ty) = func_decl.return_type {
-            let ir_type = self.ast_type_to_ir(&ret_ty.value);
-            // If it's already a Promise type, use it as-is
-            if matches!(ir_type, IrType::Promise(_)) {
-                ir_type
-            } else {
-                // Otherwise, wrap it in Promise
-                IrType::Promise(Box::new(ir_type))
-            }
-        } else {
-            // No return type specified → Promise<void>
-            IrType::Promise(Box::new(IrType::Void))
-        };
-
+    /// Lower the body of any async function — declaration, arrow, function
+    /// expression or method — into a state machine, and add its entry
+    /// function `func_name(params) -> return_type`.
+    ///
+    /// State 0 moves the entry's parameters out of the frame into locals;
+    /// `bind_params` then brings them into scope by name, or as `this` or a
+    /// closure's environment.
+    fn lower_async_body(
+        &mut self,
+        func_name: &str,
+        param_types: Vec<IrType>,
+        return_type: IrType,
+        body: &[Node<Stmt>],
+        bind_params: impl FnOnce(&mut Self, &mut FuncCtx, &[LocalId]),
+    ) {
         // Ensure all promise-related extern functions are declared up front
         self.ensure_extern("zaco_promise_new", vec![], IrType::Ptr);
         self.ensure_extern("zaco_promise_resolve", vec![IrType::Ptr, IrType::Ptr], IrType::Void);
+        self.ensure_extern("zaco_async_await", vec![IrType::Ptr, IrType::Ptr, IrType::Ptr], IrType::Void);
+        self.ensure_extern("zaco_async_resumed", vec![IrType::Ptr], IrType::Ptr);
+        self.ensure_extern("zaco_alloc", vec![IrType::I64], IrType::Ptr);
+        // An exception escaping the body rejects the promise (see exceptions.rs)
+        self.ensure_extern(exceptions::GET_ERROR, vec![], IrType::Ptr);
+        self.ensure_extern(exceptions::CLEAR_ERROR, vec![], IrType::Void);
+        self.ensure_extern(exceptions::PROMISE_REJECT, vec![IrType::Ptr, IrType::Ptr], IrType::Void);
+
+        // 1) Resume function: __async_<module>_<name>_resume(frame: Ptr, resumed: Ptr)
+        let resume_id = self.alloc_func_id();
+        let resume_name = format!("__async_{}_{}_resume", self.symbol_prefix(), func_name);
+        let mut resume_func = IrFunction::new(
+            resume_id,
+            resume_name.clone(),
+            vec![(ASYNC_FRAME, IrType::Ptr), (ASYNC_RESUMED, IrType::Ptr)],
+            IrType::Void,
+        );
+        resume_func.is_async_resume = true;
+        let dispatch = resume_func.new_block();
+        let start = resume_func.new_block();
+        resume_func.entry_block = dispatch;
+
+        let prev_frame = self.async_frame.replace(AsyncFrame {
+            resume_id,
+            resume_fn: resume_name.clone(),
+            awaits: Vec::new(),
+        });
+        let prev_function = self.current_function.replace((func_name.to_string(), return_type.clone()));
 
-        let mut ir_func = IrFunction::new(func_id, func_name.clone(), ir_params.clone(), return_type.clone());
-        let entry = ir_func.new_block();
-        ir_func.entry_block = entry;
+        let mut param_locals = Vec::new();
+        {
+            let mut func_ctx = FuncCtx {
+                func: &mut resume_func,
+                current_block: start,
+            };
 
-        let mut func_ctx = FuncCtx {
-            func: &mut ir_func,
-            current_block: entry,
-        };
+            self.push_scope();
 
-        self.push_scope();
+            // State 0: move the arguments out of the frame into locals
+            for ty in &param_types {
+                let local_id = func_ctx.add_local(ty.clone());
+                let mut instrs = Vec::new();
+                let addr = Self::frame_slot_addr(func_ctx.func, Value::Local(ASYNC_FRAME), local_id.0, &mut instrs);
+                instrs.push(Instruction::Load {
+                    dest: Place::from_local(local_id),
+                    ptr: addr,
+                });
+                instrs.into_iter().for_each(|instr| func_ctx.emit(instr));
+                param_locals.push(local_id);
+            }
+            bind_params(self, &mut func_ctx, &param_locals);
 
-        // Register params in scope
-        for (i, param) in func_decl.params.iter().enumerate() {
-            let param_name = match &param.pattern.value {
-                Pattern::Ident { name, .. } => name.value.name.clone(),
-                _ => format!("_param{}", i),
-            };
-            let (local_id, ir_type) = &ir_params[i];
-            self.define_var(
-                &param_name,
-                VarInfo {
-                    local_id: *local_id,
-                    ir_type: ir_type.clone(),
-                    is_boxed: false,
-                },
-            );
+            for s in body {
+                self.lower_stmt(&mut func_ctx, &s.value, &s.span);
+            }
+
+            // Falling off the end resolves with undefined
+            if matches!(
+                func_ctx.func.block(func_ctx.current_block).terminator,
+                Terminator::Unreachable
+            ) {
+                self.emit_async_return(&mut func_ctx, None);
+            }
+
+            self.pop_scope();
         }
 
-        // Create a new Promise
-        let promise_temp = func_ctx.add_temp(IrType::Ptr);
-        func_ctx.emit(Instruction::Call {
-            dest: Some(Place::from_temp(promise_temp)),
-            func: Value::Const(Constant::Str("zaco_promise_new".to_string())),
-            args: vec![],
-        });
+        let frame = std::mem::replace(&mut self.async_frame, prev_frame).expect("async frame");
+        self.current_function = prev_function;
 
-        // Lower body - for now we execute it synchronously and resolve the promise
-        // TODO: true async with task spawning
-        if let Some(ref body) = func_decl.body {
-            for s in &body.value.stmts {
-                self.lower_stmt(&mut func_ctx, &s.value, &s.span);
+        Self::demote_cross_block_temps(&mut resume_func);
+        Self::emit_frame_spills(&mut resume_func, &frame.awaits);
+        Self::emit_state_dispatch(&mut resume_func, dispatch, start, &frame.awaits);
+        let frame_size = 8 * resume_func.locals.len() as i64;
+        self.module.add_function(resume_func);
+
+        // 2) Entry function: <name>(params...) -> Promise
+        let entry_id = self.alloc_func_id();
+        let ir_params: Vec<(LocalId, IrType)> = param_types
+            .into_iter()
+            .enumerate()
+            .map(|(i, ty)| (LocalId(i), ty))
+            .collect();
+        let mut entry_func = IrFunction::new(entry_id, func_name.to_string(), ir_params, return_type);
+        let entry = entry_func.new_block();
+        entry_func.entry_block = entry;
+
+        {
+            let mut ectx = FuncCtx {
+                func: &mut entry_func,
+                current_block: entry,
+            };
+
+            let frame_local = ectx.add_local(IrType::Ptr);
+            ectx.emit(Instruction::Call {
+                dest: Some(Place::from_local(frame_local)),
+                func: Value::Const(Constant::Str("zaco_alloc".to_string())),
+                args: vec![Value::Const(Constant::I64(frame_size))],
+            });
+
+            let promise_temp = ectx.add_temp(IrType::Ptr);
+            ectx.emit(Instruction::Call {
+                dest: Some(Place::from_temp(promise_temp)),
+                func: Value::Const(Constant::Str("zaco_promise_new".to_string())),
+                args: vec![],
+            });
+
+            let mut instrs = Vec::new();
+            let addr = Self::frame_slot_addr(ectx.func, Value::Local(frame_local), ASYNC_PROMISE_SLOT, &mut instrs);
+            instrs.push(Instruction::Store {
+                ptr: addr,
+                value: Value::Temp(promise_temp),
+            });
+            for (i, local) in param_locals.iter().enumerate() {
+                let addr = Self::frame_slot_addr(ectx.func, Value::Local(frame_local), local.0, &mut instrs);
+                instrs.push(Instruction::Store {
+                    ptr: addr,
+                    value: Value::Local(LocalId(i)),
+                });
             }
-        }
+            instrs.into_iter().for_each(|instr| ectx.emit(instr));
 
-        // Get the return value and resolve the promise
-        // If the last statement was a return, we need to resolve the promise with that value
-        // For now, we'll just return the promise (simplified version)
-        if matches!(
-            func_ctx.func.block(func_ctx.current_block).terminator,
-            Terminator::Unreachable
-        ) {
-            // No explicit return, resolve with undefined/void
-            func_ctx.emit(Instruction::Call {
+            // Run the body up to its first await
+            ectx.emit(Instruction::Call {
                 dest: None,
-                func: Value::Const(Constant::Str("zaco_promise_resolve".to_string())),
-                args: vec![Value::Temp(promise_temp), Value::Const(Constant::Null)],
+                func: Value::Const(Constant::Str(resume_name)),
+                args: vec![Value::Local(frame_local), Value::Const(Constant::Null)],
             });
 
-            func_ctx.set_terminator(Terminator::Return(Some(Value::Temp(promise_temp))));
+            ectx.set_terminator(Terminator::Return(Some(Value::Temp(promise_temp))));
         }
 
-        self.pop_scope();
-
-        self.module.add_function(ir_func);
+        self.module.add_function(entry_func);
     }
 
+    /// True while lowering the body of an async function (not a function
+    /// nested in it).
+    fn in_async_resume(&self, ctx: &FuncCtx) -> bool {
+        self.async_frame.as_ref().map_or(false, |frame| frame.resume_id == ctx.func.id)
+    }
 
-    // =========================================================================
-    // Generator function lowering (function* / yield)
-    // =========================================================================
+    /// Suspend at an `await`: record the next state, hand the promise and the
+    /// continuation to the runtime and return to the event loop. Lowering
+    /// continues in the block the function resumes into; the frame saves and
+    /// restores around this point are added once the whole body is lowered.
+    fn emit_async_suspend(&mut self, ctx: &mut FuncCtx, promise: Value, result_type: IrType) -> Value {
+        let frame = self.async_frame.as_mut().expect("async frame");
+        let state = frame.awaits.len() as i64 + 1;
+
+        ctx.emit(Instruction::Store {
+            ptr: Value::Local(ASYNC_FRAME),
+            value: Value::Const(Constant::I64(state)),
+        });
+        ctx.emit(Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str("zaco_async_await".to_string())),
+            args: vec![
+                promise,
+                Value::Const(Constant::Str(frame.resume_fn.clone())),
+                Value::Local(ASYNC_FRAME),
+            ],
+        });
+        ctx.set_terminator(Terminator::Return(None));
+
+        let suspend = ctx.current_block;
+        let resume = ctx.new_block();
+        frame.awaits.push((suspend, resume));
+        ctx.switch_to(resume);
+
+        // A rejected promise resumes with its error pending, and the
+        // exception test after this call throws it at the `await`
+        let result_temp = ctx.add_temp(result_type.clone());
+        let resumed = if result_type == IrType::F64 {
+            ctx.add_temp(IrType::Ptr)
+        } else {
+            result_temp
+        };
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(resumed)),
+            func: Value::Const(Constant::Str("zaco_async_resumed".to_string())),
+            args: vec![Value::Local(ASYNC_RESUMED)],
+        });
+        if result_type == IrType::F64 {
+            // Recover a float's bits through the state slot, as on return
+            ctx.emit(Instruction::Store {
+                ptr: Value::Local(ASYNC_FRAME),
+                value: Value::Temp(resumed),
+            });
+            ctx.emit(Instruction::Load {
+                dest: Place::from_temp(result_temp),
+                ptr: Value::Local(ASYNC_FRAME),
+            });
+        }
+        Value::Temp(result_temp)
+    }
 
-    /// Lower a generator function (function*) using a state-machine transformation.
-    fn lower_generator_function_decl(&mut self, func_decl: &FunctionDecl) {
-        let func_name = func_decl.name.value.name.clone();
+    /// Settle the async function's promise with `result`, free the frame and
+    /// leave the resume function for good.
+    fn emit_async_return(&mut self, ctx: &mut FuncCtx, result: Option<(Value, IrType)>) {
+        let value = match result {
+            Some((val, IrType::F64)) => {
+                // Promises carry pointer-sized payloads: move the float's bits
+                // through the state slot, which is dead from here on
+                ctx.emit(Instruction::Store {
+                    ptr: Value::Local(ASYNC_FRAME),
+                    value: val,
+                });
+                let bits = ctx.add_temp(IrType::Ptr);
+                ctx.emit(Instruction::Load {
+                    dest: Place::from_temp(bits),
+                    ptr: Value::Local(ASYNC_FRAME),
+                });
+                Value::Temp(bits)
+            }
+            Some((val, _)) => val,
+            None => Value::Const(Constant::Null),
+        };
 
-        // Ensure generator runtime externs
-        self.ensure_extern("zaco_generator_new", vec![IrType::Ptr, IrType::Ptr], IrType::Ptr);
-        self.ensure_extern("zaco_generator_set_value", vec![IrType::Ptr, IrType::Ptr], IrType::Void);
-        self.ensure_extern("zaco_generator_set_done", vec![IrType::Ptr], IrType::Void);
+        let mut instrs = Vec::new();
+        let addr = Self::frame_slot_addr(ctx.func, Value::Local(ASYNC_FRAME), ASYNC_PROMISE_SLOT, &mut instrs);
+        instrs.into_iter().for_each(|instr| ctx.emit(instr));
+        let promise_temp = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Load {
+            dest: Place::from_temp(promise_temp),
+            ptr: addr,
+        });
+        ctx.emit(Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str("zaco_promise_resolve".to_string())),
+            args: vec![Value::Temp(promise_temp), value],
+        });
+        ctx.emit(Instruction::Free {
+            value: Value::Local(ASYNC_FRAME),
+        });
+        ctx.set_terminator(Terminator::Return(None));
+    }
+
+    /// Compute the address of 8-byte slot `slot` of an async frame.
+    fn frame_slot_addr(func: &mut IrFunction, frame: Value, slot: usize, out: &mut Vec<Instruction>) -> Value {
+        if slot == 0 {
+            return frame;
+        }
+        let addr_temp = func.add_temp(IrType::Ptr);
+        out.push(Instruction::Assign {
+            dest: Place::from_temp(addr_temp),
+            value: RValue::BinaryOp {
+                op: BinOp::Add,
+                left: frame,
+                right: Value::Const(Constant::I64(8 * slot as i64)),
+            },
+        });
+        Value::Temp(addr_temp)
+    }
+
+    /// Move temporaries read outside the block that defines them into locals.
+    /// A resume function is re-entered in the middle of its body, so only
+    /// values held in locals (and saved in the frame) survive an `await`.
+    fn demote_cross_block_temps(func: &mut IrFunction) {
+        let mut crossing = HashSet::new();
+        for block in &mut func.blocks {
+            let mut defined = HashSet::new();
+            for instr in &mut block.instructions {
+                for operand in instr.operands_mut() {
+                    if let Value::Temp(temp) = operand {
+                        if !defined.contains(temp) {
+                            crossing.insert(*temp);
+                        }
+                    }
+                }
+                if let Some(temp) = instr.dest_temp() {
+                    defined.insert(temp);
+                }
+            }
+            for operand in block.terminator.operands_mut() {
+                if let Value::Temp(temp) = operand {
+                    if !defined.contains(temp) {
+                        crossing.insert(*temp);
+                    }
+                }
+            }
+        }
+
+        let mut crossing: Vec<TempId> = crossing.into_iter().collect();
+        crossing.sort();
+        let mut demoted = HashMap::new();
+        for temp in crossing {
+            let ty = func.temps[temp.0].1.clone();
+            if ty != IrType::Void {
+                demoted.insert(temp, func.add_local(ty));
+            }
+        }
+        if demoted.is_empty() {
+            return;
+        }
+
+        let demote = |operand: &mut Value| {
+            if let Value::Temp(temp) = operand {
+                if let Some(&local) = demoted.get(temp) {
+                    *operand = Value::Local(local);
+                }
+            }
+        };
+        for block in &mut func.blocks {
+            for mut instr in std::mem::take(&mut block.instructions) {
+                instr.operands_mut().into_iter().for_each(demote);
+                let def = instr.dest_temp().and_then(|temp| demoted.get(&temp).map(|&local| (temp, local)));
+                block.instructions.push(instr);
+                if let Some((temp, local)) = def {
+                    block.instructions.push(Instruction::Assign {
+                        dest: Place::from_local(local),
+                        value: RValue::Use(Value::Temp(temp)),
+                    });
+                }
+            }
+            block.terminator.operands_mut().into_iter().for_each(demote);
+        }
+    }
+
+    /// Save every local into the frame before each suspension and restore it
+    /// where the function resumes.
+    fn emit_frame_spills(func: &mut IrFunction, awaits: &[(BlockId, BlockId)]) {
+        let saved: Vec<LocalId> = func
+            .locals
+            .iter()
+            .filter(|(id, ty)| *id > ASYNC_RESUMED && *ty != IrType::Void)
+            .map(|(id, _)| *id)
+            .collect();
+
+        for &(suspend, resume) in awaits {
+            let mut spills = Vec::new();
+            let mut reloads = Vec::new();
+            for &local in &saved {
+                let addr = Self::frame_slot_addr(func, Value::Local(ASYNC_FRAME), local.0, &mut spills);
+                spills.push(Instruction::Store {
+                    ptr: addr,
+                    value: Value::Local(local),
+                });
+                let addr = Self::frame_slot_addr(func, Value::Local(ASYNC_FRAME), local.0, &mut reloads);
+                reloads.push(Instruction::Load {
+                    dest: Place::from_local(local),
+                    ptr: addr,
+                });
+            }
+            // The state store and the zaco_async_await call end the block
+            let block = func.block_mut(suspend);
+            let at = block.instructions.len() - 2;
+            block.instructions.splice(at..at, spills);
+            func.block_mut(resume).instructions.splice(0..0, reloads);
+        }
+    }
+
+    /// Fill the resume function's entry block with a dispatch on the frame's
+    /// state index: 0 starts the body, `k` continues after the k-th `await`.
+    fn emit_state_dispatch(func: &mut IrFunction, dispatch: BlockId, start: BlockId, awaits: &[(BlockId, BlockId)]) {
+        if awaits.is_empty() {
+            func.block_mut(dispatch).set_terminator(Terminator::Jump(start));
+            return;
+        }
+
+        let state_temp = func.add_temp(IrType::I64);
+        func.block_mut(dispatch).push_instruction(Instruction::Load {
+            dest: Place::from_temp(state_temp),
+            ptr: Value::Local(ASYNC_FRAME),
+        });
+
+        // Chain of comparisons to dispatch to the right state
+        let mut check_block = dispatch;
+        for (i, &(_, resume)) in awaits.iter().enumerate() {
+            let cmp_temp = func.add_temp(IrType::Bool);
+            func.block_mut(check_block).push_instruction(Instruction::Assign {
+                dest: Place::from_temp(cmp_temp),
+                value: RValue::BinaryOp {
+                    op: BinOp::Eq,
+                    left: Value::Temp(state_temp),
+                    right: Value::Const(Constant::I64(i as i64 + 1)),
+                },
+            });
+            let next_check = if i + 1 < awaits.len() { func.new_block() } else { start };
+            func.block_mut(check_block).set_terminator(Terminator::Branch {
+                cond: Value::Temp(cmp_temp),
+                then_block: resume,
+                else_block: next_check,
+            });
+            check_block = next_check;
+        }
+    }
+
+
+    // =========================================================================
+    // Generator function lowering (function* / yield)
+    // =========================================================================
+
+    /// Lower a generator function (function*) using a state-machine transformation.
+    fn lower_generator_function_decl(&mut self, func_decl: &FunctionDecl) {
+        let func_name = func_decl.name.value.name.clone();
+
+        // Ensure generator runtime externs
+        self.ensure_extern("zaco_generator_new", vec![IrType::Ptr, IrType::Ptr], IrType::Ptr);
+        self.ensure_extern("zaco_generator_set_value", vec![IrType::Ptr, IrType::Ptr], IrType::Void);
+        self.ensure_extern("zaco_generator_set_done", vec![IrType::Ptr], IrType::Void);
 
         // Collect yield points from the function body
         let yield_values = self.collect_yield_values(func_decl);
@@ -2734,7 +3294,7 @@ impl Lowerer {
 
         let mut wrapper_func = IrFunction::new(
             wrapper_func_id,
-            func_name.clone(),
+            func_name.to_string(),
             ir_params,
             IrType::Ptr,
         );
@@ -2761,7 +3321,7 @@ impl Lowerer {
             });
 
             // Create generator object
-            self.module.intern_string(next_func_name.clone());
+            self.module.intern_string(&next_func_name);
             let gen_temp = wctx.add_temp(IrType::Ptr);
             wctx.emit(Instruction::Call {
                 dest: Some(Place::from_temp(gen_temp)),
@@ -2833,8 +3393,8 @@ impl Lowerer {
         match expr {
             Expr::Literal(Literal::Number(n)) => Value::Const(Constant::F64(*n)),
             Expr::Literal(Literal::String(s)) => {
-                self.module.intern_string(s.clone());
-                Value::Const(Constant::Str(s.clone()))
+                self.module.intern_string(s);
+                Value::Const(Constant::Str(s.to_string()))
             }
             Expr::Literal(Literal::Boolean(b)) => Value::Const(Constant::Bool(*b)),
             Expr::Literal(Literal::Null | Literal::Undefined) => Value::Const(Constant::Null),
@@ -2897,7 +3457,7 @@ impl Lowerer {
         // 1. Create an array of string parts (quasis)
         let mut string_vals = Vec::new();
         for part in parts {
-            self.module.intern_string(part.clone());
+            self.module.intern_string(&part);
             string_vals.push(Value::Const(Constant::Str(part.clone())));
         }
 
@@ -2932,7 +3492,7 @@ impl Lowerer {
             let result = ctx.add_temp(IrType::Ptr);
             ctx.emit(Instruction::Call {
                 dest: Some(Place::from_temp(result)),
-                func: Value::Const(Constant::Str(ident.name.clone())),
+                func: Value::Const(Constant::Str(ident.name.to_string())),
                 args: call_args,
             });
             Some(Value::Temp(result))
@@ -2949,7 +3509,16 @@ impl Lowerer {
         // Lower the expression that should produce a Promise
         let promise_val = self.lower_expr(ctx, &expr.value, &expr.span)?;
 
-        // Call zaco_async_block_on to wait for the promise to resolve
+        // Inside an async function, suspend until the promise settles
+        if self.in_async_resume(ctx) {
+            let result_type = match self.infer_expr_type(&expr.value) {
+                IrType::Promise(inner) if *inner != IrType::Void => *inner,
+                _ => IrType::Ptr,
+            };
+            return Some(self.emit_async_suspend(ctx, promise_val, result_type));
+        }
+
+        // Elsewhere (top level, sync functions), run the event loop until it settles
         self.ensure_extern("zaco_async_block_on", vec![IrType::Ptr], IrType::Ptr);
 
         let result_temp = ctx.add_temp(IrType::Ptr);
@@ -3080,14 +3649,14 @@ impl Lowerer {
             ForInLeft::VarDecl(vd) => {
                 if let Some(declarator) = vd.declarations.first() {
                     if let Pattern::Ident { name, .. } = &declarator.pattern.value {
-                        return Some(name.value.name.clone());
+                        return Some(name.value.name.to_string());
                     }
                 }
                 None
             }
             ForInLeft::Pattern(pat) => {
                 if let Pattern::Ident { name, .. } = &pat.value {
-                    Some(name.value.name.clone())
+                    Some(name.value.name.to_string())
                 } else {
                     None
                 }
@@ -3278,12 +3847,7 @@ impl Lowerer {
         };
 
         // Choose runtime getter based on element type
-        let (getter_name, getter_ret_type) = match &elem_type {
-            IrType::Str | IrType::Ptr | IrType::Array(_) | IrType::Struct(_) => {
-                ("zaco_array_get_ptr", IrType::Ptr)
-            }
-            _ => ("zaco_array_get_f64", IrType::F64),
-        };
+        let (getter_name, getter_ret_type) = Self::array_getter(&arr_type);
         self.ensure_extern(
             getter_name,
             vec![IrType::Ptr, IrType::I64],
@@ -3316,6 +3880,9 @@ impl Lowerer {
             );
         }
 
+        let builders =
+            self.begin_str_accumulators(ctx, &[right], var_name.as_deref(), &body.value);
+
         // Create loop blocks
         let cond_block = ctx.new_block();
         let body_block = ctx.new_block();
@@ -3391,6 +3958,7 @@ impl Lowerer {
         ctx.set_terminator(Terminator::Jump(cond_block));
 
         ctx.switch_to(exit_block);
+        self.end_str_accumulators(ctx, builders);
         self.pop_scope();
     }
 
@@ -3405,7 +3973,7 @@ impl Lowerer {
         // Step 0: Resolve parent class (if extends)
         let parent_name = class_decl.extends.as_ref().and_then(|ext| {
             if let Expr::Ident(ident) = &ext.base.value {
-                Some(ident.name.clone())
+                Some(ident.name.to_string())
             } else {
                 None
             }
@@ -3437,7 +4005,7 @@ impl Lowerer {
 
         // Step 2: Create IrStruct
         let struct_id = self.alloc_struct_id();
-        let struct_def = IrStruct::new(struct_id, class_name.clone(), fields.clone());
+        let struct_def = IrStruct::new(struct_id, class_name.to_string(), fields.clone());
         self.module.add_struct(struct_def);
 
         // Collect method names (own + inherited)
@@ -3500,7 +4068,7 @@ impl Lowerer {
         }
 
         // Register class info
-        self.class_info.insert(class_name.clone(), ClassInfo {
+        self.class_info.insert(class_name.to_string(), ClassInfo {
             struct_id,
             fields: fields.clone(),
             methods: method_names.clone(),
@@ -3518,7 +4086,7 @@ impl Lowerer {
         // Step 4: Lower own methods
         for member in &class_decl.members {
             if let ClassMember::Method {
-                name, params, return_type, body, is_static, ..
+                name, params, return_type, body, is_static, is_async, ..
             } = member
             {
                 if *is_static {
@@ -3533,6 +4101,7 @@ impl Lowerer {
                         params,
                         return_type.as_deref(),
                         body,
+                        *is_async,
                         &fields,
                         span,
                     );
@@ -3543,7 +4112,7 @@ impl Lowerer {
         // Step 5: Lower static methods (no self parameter)
         for member in &class_decl.members {
             if let ClassMember::Method {
-                name, params, return_type, body, is_static, ..
+                name, params, return_type, body, is_static, is_async, ..
             } = member
             {
                 if !*is_static {
@@ -3557,6 +4126,7 @@ impl Lowerer {
                         params,
                         return_type.as_deref(),
                         body,
+                        *is_async,
                         span,
                     );
                 }
@@ -3689,13 +4259,26 @@ impl Lowerer {
     }
 
     /// Lower a static method into a standalone function (no self parameter)
-    fn lower_static_method(&mut self, class_name: &str, method_name: &str, params: &[Param], return_type: Option<&Node<Type>>, body: &Node<BlockStmt>, _span: &Span) {
+    fn lower_static_method(&mut self, class_name: &str, method_name: &str, params: &[Param], return_type: Option<&Node<Type>>, body: &Node<BlockStmt>, is_async: bool, _span: &Span) {
         let func_name = format!("{}_{}", class_name, method_name);
-        let func_id = self.alloc_func_id();
         let mut ir_params: Vec<(LocalId, IrType)> = Vec::new();
         for (i, param) in params.iter().enumerate() {
             ir_params.push((LocalId(i), self.infer_param_type(param)));
         }
+        if is_async {
+            let param_types: Vec<IrType> = ir_params.iter().map(|(_, ty)| ty.clone()).collect();
+            let ret_type = Self::async_return_type(return_type.map(|t| self.ast_type_to_ir(&t.value)));
+            let prev_class = self.current_class.replace(class_name.to_string());
+            self.lower_async_body(&func_name, param_types.clone(), ret_type, &body.value.stmts, |this, _ctx, locals| {
+                for (i, param) in params.iter().enumerate() {
+                    let pn = match &param.pattern.value { Pattern::Ident { name, .. } => name.value.name.to_string(), _ => format!("_param{}", i) };
+                    this.define_var(&pn, VarInfo { local_id: locals[i], ir_type: param_types[i].clone(), is_boxed: false });
+                }
+            });
+            self.current_class = prev_class;
+            return;
+        }
+        let func_id = self.alloc_func_id();
         let ret_type = return_type.map(|t| self.ast_type_to_ir(&t.value)).unwrap_or(IrType::Void);
         let mut ir_func = IrFunction::new(func_id, func_name, ir_params.clone(), ret_type.clone());
         let entry = ir_func.new_block();
@@ -3703,7 +4286,7 @@ impl Lowerer {
         let mut func_ctx = FuncCtx { func: &mut ir_func, current_block: entry };
         self.push_scope();
         for (i, param) in params.iter().enumerate() {
-            let pn = match &param.pattern.value { Pattern::Ident { name, .. } => name.value.name.clone(), _ => format!("_param{}", i) };
+            let pn = match &param.pattern.value { Pattern::Ident { name, .. } => name.value.name.to_string(), _ => format!("_param{}", i) };
             let (lid, ty) = &ir_params[i];
             self.define_var(&pn, VarInfo { local_id: *lid, ir_type: ty.clone(), is_boxed: false });
         }
@@ -3723,7 +4306,7 @@ impl Lowerer {
     fn expr_to_constant(&self, expr: &Expr) -> Option<Constant> {
         match expr {
             Expr::Literal(Literal::Number(n)) => { if n.fract() == 0.0 && *n >= i64::MIN as f64 && *n <= i64::MAX as f64 { Some(Constant::I64(*n as i64)) } else { Some(Constant::F64(*n)) } }
-            Expr::Literal(Literal::String(s)) => Some(Constant::Str(s.clone())),
+            Expr::Literal(Literal::String(s)) => Some(Constant::Str(s.to_string())),
             Expr::Literal(Literal::Boolean(b)) => Some(Constant::Bool(*b)),
             _ => None,
         }
@@ -3770,7 +4353,7 @@ impl Lowerer {
         let prev_class = self.current_class.take();
         self.this_var = Some(VarInfo { local_id: LocalId(0), ir_type: IrType::Struct(struct_id), is_boxed: false });
         self.current_class = Some(class_name.to_string());
-        let pn = match &param.pattern.value { Pattern::Ident { name, .. } => name.value.name.clone(), _ => "_value".to_string() };
+        let pn = match &param.pattern.value { Pattern::Ident { name, .. } => name.value.name.to_string(), _ => "_value".to_string() };
         self.define_var(&pn, VarInfo { local_id: LocalId(1), ir_type: param_type, is_boxed: false });
         for s in &body.value.stmts { self.lower_stmt(&mut func_ctx, &s.value, &s.span); }
         if matches!(func_ctx.func.block(func_ctx.current_block).terminator, Terminator::Unreachable) {
@@ -3832,7 +4415,7 @@ impl Lowerer {
         // Register constructor params in scope
         for (i, param) in ctor_params.iter().enumerate() {
             let param_name = match &param.pattern.value {
-                Pattern::Ident { name, .. } => name.value.name.clone(),
+                Pattern::Ident { name, .. } => name.value.name.to_string(),
                 _ => format!("_param{}", i),
             };
             let (local_id, ir_type) = &ir_params[i];
@@ -3930,11 +4513,11 @@ impl Lowerer {
         params: &[Param],
         return_type: Option<&Node<Type>>,
         body: &Node<BlockStmt>,
+        is_async: bool,
         _fields: &[(String, IrType)],
         _span: &Span,
     ) {
         let func_name = format!("{}_{}", class_name, method_name);
-        let func_id = self.alloc_func_id();
 
         // First param is always `self` (pointer to struct)
         let mut ir_params: Vec<(LocalId, IrType)> = Vec::new();
@@ -3946,6 +4529,37 @@ impl Lowerer {
             ir_params.push((local_id, ir_type));
         }
 
+        if is_async {
+            let param_types: Vec<IrType> = ir_params.iter().map(|(_, ty)| ty.clone()).collect();
+            let ret_type = Self::async_return_type(return_type.map(|t| self.ast_type_to_ir(&t.value)));
+            let prev_this = self.this_var.take();
+            let prev_class = self.current_class.replace(class_name.to_string());
+            self.lower_async_body(&func_name, param_types.clone(), ret_type, &body.value.stmts, |this, _ctx, locals| {
+                // `this` is saved in the frame like any other argument
+                this.this_var = Some(VarInfo {
+                    local_id: locals[0],
+                    ir_type: IrType::Struct(struct_id),
+                    is_boxed: false,
+                });
+                for (i, param) in params.iter().enumerate() {
+                    let param_name = match &param.pattern.value {
+                        Pattern::Ident { name, .. } => name.value.name.to_string(),
+                        _ => format!("_param{}", i),
+                    };
+                    this.define_var(&param_name, VarInfo {
+                        local_id: locals[i + 1],
+                        ir_type: param_types[i + 1].clone(),
+                        is_boxed: false,
+                    });
+                }
+            });
+            self.this_var = prev_this;
+            self.current_class = prev_class;
+            return;
+        }
+
+        let func_id = self.alloc_func_id();
+
         let ret_type = return_type
             .map(|t| self.ast_type_to_ir(&t.value))
             .unwrap_or(IrType::Void);
@@ -3974,7 +4588,7 @@ impl Lowerer {
         // Register non-self params in scope
         for (i, param) in params.iter().enumerate() {
             let param_name = match &param.pattern.value {
-                Pattern::Ident { name, .. } => name.value.name.clone(),
+                Pattern::Ident { name, .. } => name.value.name.to_string(),
                 _ => format!("_param{}", i),
             };
             let (local_id, ir_type) = &ir_params[i + 1]; // +1 to skip self
@@ -4024,7 +4638,7 @@ impl Lowerer {
         _span: &Span,
     ) -> Option<Value> {
         let class_name = match &callee.value {
-            Expr::Ident(ident) => ident.name.clone(),
+            Expr::Ident(ident) => ident.name.to_string(),
             _ => return None,
         };
 
@@ -4079,7 +4693,7 @@ impl Lowerer {
 
         // Handle ClassName.staticProp — static property access
         if let Expr::Ident(obj_ident) = &object.value {
-            if let Some(ci) = self.class_info.get(&obj_ident.name).cloned() {
+            if let Some(ci) = self.class_info.get(obj_ident.name.as_str()).cloned() {
                 let prop = &property.value.name;
                 if let Some((_, prop_type)) = ci.static_properties.iter().find(|(n, _)| n == prop) {
                     let global_name = format!("{}_{}", obj_ident.name, prop);
@@ -4164,6 +4778,30 @@ impl Lowerer {
             }
         }
 
+        // Handle arr.length
+        if property.value.name == "length" && matches!(self.infer_expr_type(&object.value), IrType::Array(_)) {
+            let arr = self.lower_expr(ctx, &object.value, &object.span)?;
+            self.ensure_extern("zaco_array_length", vec![IrType::Ptr], IrType::I64);
+            let len_temp = ctx.add_temp(IrType::I64);
+            ctx.emit(Instruction::Call {
+                dest: Some(Place::from_temp(len_temp)),
+                func: Value::Const(Constant::Str("zaco_array_length".to_string())),
+                args: vec![arr],
+            });
+            let len_f64 = ctx.add_temp(IrType::F64);
+            ctx.emit(Instruction::Assign {
+                dest: Place::from_temp(len_f64),
+                value: RValue::Cast { value: Value::Temp(len_temp), ty: IrType::F64 },
+            });
+            return Some(Value::Temp(len_f64));
+        }
+
+        // Handle obj.key where obj holds an object literal of known shape
+        if let Some((slot, slot_type)) = self.object_slot(&object.value, &property.value.name) {
+            let obj = self.lower_expr(ctx, &object.value, &object.span)?;
+            return Some(self.emit_object_slot_load(ctx, obj, &property.value.name, slot, slot_type));
+        }
+
         // For other member expressions, fall through
         None
     }
@@ -4285,7 +4923,7 @@ impl Lowerer {
 
         // Handle ClassName.staticProp = value — static property write
         if let Expr::Ident(obj_ident) = &object.value {
-            if let Some(ci) = self.class_info.get(&obj_ident.name).cloned() {
+            if let Some(ci) = self.class_info.get(obj_ident.name.as_str()).cloned() {
                 if ci.static_properties.iter().any(|(n, _)| n == field_name) {
                     let global_name = format!("{}_{}", obj_ident.name, field_name);
                     ctx.emit(Instruction::Store {
@@ -4344,6 +4982,13 @@ impl Lowerer {
             }
         }
 
+        // Handle obj.key = value where obj holds an object literal of known shape
+        if let Some((slot, slot_type)) = self.object_slot(&object.value, field_name) {
+            let obj = self.lower_expr(ctx, &object.value, &object.span)?;
+            self.emit_object_slot_store(ctx, obj, field_name, slot, slot_type, rhs.clone());
+            return Some(rhs);
+        }
+
         None
     }
 
@@ -4395,7 +5040,7 @@ impl Lowerer {
     /// Extract string from PropertyName
     fn property_name_to_string(&self, name: &PropertyName) -> String {
         match name {
-            PropertyName::Ident(ident) => ident.value.name.clone(),
+            PropertyName::Ident(ident) => ident.value.name.to_string(),
             PropertyName::String(s) => s.clone(),
             PropertyName::Number(n) => format!("{}", n),
             PropertyName::Computed(_) => "_computed".to_string(),
@@ -4461,6 +5106,7 @@ impl Lowerer {
         params: &[Param],
         return_type: Option<&Node<Type>>,
         body: &ArrowBody,
+        is_async: bool,
         _span: &Span,
     ) -> Option<Value> {
         let closure_id = self.next_closure_id;
@@ -4483,7 +5129,7 @@ impl Lowerer {
         // Collect free variables
         let param_names: HashSet<String> = params.iter().filter_map(|p| {
             match &p.pattern.value {
-                Pattern::Ident { name, .. } => Some(name.value.name.clone()),
+                Pattern::Ident { name, .. } => Some(name.value.name.to_string()),
                 _ => None,
             }
         }).collect();
@@ -4602,92 +5248,103 @@ impl Lowerer {
                 }
             });
 
-        let func_id = self.alloc_func_id();
-        let mut ir_func = IrFunction::new(func_id, func_name.clone(), ir_params.clone(), ret_type.clone());
-        let entry = ir_func.new_block();
-        ir_func.entry_block = entry;
+        // Bring the environment's captures and the declared params into scope,
+        // given the locals holding the closure's arguments
+        let bind_params = |this: &mut Self, closure_ctx: &mut FuncCtx, locals: &[LocalId]| {
+            // Load captured vars from environment struct into local variables
+            if env_struct_id.is_some() {
+                let env_param_local = locals[0];
+                let env_name = format!("__env_{}", closure_id);
+
+                for cap_name in &captured_vars {
+                    if let Some(val) = this.load_struct_field(closure_ctx, Value::Local(env_param_local), &env_name, cap_name) {
+                        let cap_type = this.class_info.get(&env_name)
+                            .and_then(|ci| ci.fields.iter().find(|(n, _)| n == cap_name))
+                            .map(|(_, t)| t.clone())
+                            .unwrap_or(IrType::F64);
+                        let cap_local = closure_ctx.add_local(cap_type.clone());
+                        closure_ctx.emit(Instruction::Assign {
+                            dest: Place::from_local(cap_local),
+                            value: RValue::Use(val),
+                        });
+                        // If this variable was boxed (mutated capture), mark it as boxed
+                        // so reads/writes inside the closure go through box_get/box_set
+                        let is_boxed_cap = mutated_captured.contains(cap_name);
+                        let logical_type = if is_boxed_cap {
+                            original_types.get(cap_name).cloned().unwrap_or(cap_type)
+                        } else {
+                            cap_type
+                        };
+                        this.define_var(cap_name, VarInfo {
+                            local_id: cap_local,
+                            ir_type: logical_type,
+                            is_boxed: is_boxed_cap,
+                        });
+                    }
+                }
+            }
 
-        let mut closure_ctx = FuncCtx {
-            func: &mut ir_func,
-            current_block: entry,
+            // Register declared params in scope
+            let param_offset = if env_struct_id.is_some() { 1 } else { 0 };
+            for (i, param) in params.iter().enumerate() {
+                let param_name = match &param.pattern.value {
+                    Pattern::Ident { name, .. } => name.value.name.to_string(),
+                    _ => format!("_param{}", i),
+                };
+                let idx = param_offset + i;
+                this.define_var(&param_name, VarInfo {
+                    local_id: locals[idx],
+                    ir_type: ir_params[idx].1.clone(),
+                    is_boxed: false,
+                });
+            }
         };
 
-        self.push_scope();
+        if is_async {
+            let param_types = ir_params.iter().map(|(_, ty)| ty.clone()).collect();
+            let ret_type = Self::async_return_type(Some(ret_type));
+            self.lower_async_body(&func_name, param_types, ret_type, &body_stmts, bind_params);
+        } else {
+            let func_id = self.alloc_func_id();
+            let mut ir_func = IrFunction::new(func_id, func_name.clone(), ir_params.clone(), ret_type.clone());
+            let entry = ir_func.new_block();
+            ir_func.entry_block = entry;
+
+            let mut closure_ctx = FuncCtx {
+                func: &mut ir_func,
+                current_block: entry,
+            };
 
-        // Load captured vars from environment struct into local variables
-        if let Some(_env_id) = env_struct_id {
-            let env_param_local = LocalId(0);
-            let env_name = format!("__env_{}", closure_id);
+            self.push_scope();
+            let param_locals: Vec<LocalId> = ir_params.iter().map(|(id, _)| *id).collect();
+            bind_params(self, &mut closure_ctx, &param_locals);
 
-            for cap_name in &captured_vars {
-                if let Some(val) = self.load_struct_field(&mut closure_ctx, Value::Local(env_param_local), &env_name, cap_name) {
-                    let cap_type = self.class_info.get(&env_name)
-                        .and_then(|ci| ci.fields.iter().find(|(n, _)| n == cap_name))
-                        .map(|(_, t)| t.clone())
-                        .unwrap_or(IrType::F64);
-                    let cap_local = closure_ctx.add_local(cap_type.clone());
+            // Lower body
+            for s in &body_stmts {
+                self.lower_stmt(&mut closure_ctx, &s.value, &s.span);
+            }
+
+            // Add implicit return if needed
+            if matches!(
+                closure_ctx.func.block(closure_ctx.current_block).terminator,
+                Terminator::Unreachable
+            ) {
+                if ret_type == IrType::Void {
+                    closure_ctx.set_terminator(Terminator::Return(None));
+                } else {
+                    let temp = closure_ctx.add_temp(ret_type);
                     closure_ctx.emit(Instruction::Assign {
-                        dest: Place::from_local(cap_local),
-                        value: RValue::Use(val),
-                    });
-                    // If this variable was boxed (mutated capture), mark it as boxed
-                    // so reads/writes inside the closure go through box_get/box_set
-                    let is_boxed_cap = mutated_captured.contains(cap_name);
-                    let logical_type = if is_boxed_cap {
-                        original_types.get(cap_name).cloned().unwrap_or(cap_type)
-                    } else {
-                        cap_type
-                    };
-                    self.define_var(cap_name, VarInfo {
-                        local_id: cap_local,
-                        ir_type: logical_type,
-                        is_boxed: is_boxed_cap,
+                        dest: Place::from_temp(temp),
+                        value: RValue::Use(Value::Const(Constant::I64(0))),
                     });
+                    closure_ctx.set_terminator(Terminator::Return(Some(Value::Temp(temp))));
                 }
             }
-        }
-
-        // Register declared params in scope
-        let param_offset = if env_struct_id.is_some() { 1 } else { 0 };
-        for (i, param) in params.iter().enumerate() {
-            let param_name = match &param.pattern.value {
-                Pattern::Ident { name, .. } => name.value.name.clone(),
-                _ => format!("_param{}", i),
-            };
-            let idx = param_offset + i;
-            let (local_id, ir_type) = &ir_params[idx];
-            self.define_var(&param_name, VarInfo {
-                local_id: *local_id,
-                ir_type: ir_type.clone(),
-                is_boxed: false,
-            });
-        }
-
-        // Lower body
-        for s in &body_stmts {
-            self.lower_stmt(&mut closure_ctx, &s.value, &s.span);
-        }
 
-        // Add implicit return if needed
-        if matches!(
-            closure_ctx.func.block(closure_ctx.current_block).terminator,
-            Terminator::Unreachable
-        ) {
-            if ret_type == IrType::Void {
-                closure_ctx.set_terminator(Terminator::Return(None));
-            } else {
-                let temp = closure_ctx.add_temp(ret_type);
-                closure_ctx.emit(Instruction::Assign {
-                    dest: Place::from_temp(temp),
-                    value: RValue::Use(Value::Const(Constant::I64(0))),
-                });
-                closure_ctx.set_terminator(Terminator::Return(Some(Value::Temp(temp))));
-            }
+            self.pop_scope();
+            self.module.add_function(ir_func);
         }
 
-        self.pop_scope();
-        self.module.add_function(ir_func);
-
         // Store closure binding
         self.closure_bindings.insert(func_name.clone(), ClosureInfo {
             func_name: func_name.clone(),
@@ -4697,7 +5354,7 @@ impl Lowerer {
         });
 
         // Return the function name as a string constant
-        self.module.intern_string(func_name.clone());
+        self.module.intern_string(&func_name);
         Some(Value::Const(Constant::Str(func_name)))
     }
 
@@ -4709,11 +5366,12 @@ impl Lowerer {
         params: &[Param],
         return_type: Option<&Node<Type>>,
         body: &Node<BlockStmt>,
+        is_async: bool,
         span: &Span,
     ) -> Option<Value> {
         // Convert to arrow-like body and reuse arrow logic
         let arrow_body = ArrowBody::Block(Box::new(body.clone()));
-        self.lower_arrow_expr(ctx, params, return_type, &arrow_body, span)
+        self.lower_arrow_expr(ctx, params, return_type, &arrow_body, is_async, span)
     }
 
     /// Lower a closure call: prepend captured variable values to args
@@ -4792,7 +5450,7 @@ impl Lowerer {
                 self.closure_bindings.get(&func_name).cloned()
             }
             Expr::Ident(ident) => {
-                self.closure_bindings.get(&ident.name).cloned()
+                self.closure_bindings.get(ident.name.as_str()).cloned()
             }
             _ => None,
         };
@@ -4832,6 +5490,48 @@ impl Lowerer {
     // Array callback methods (map, filter, forEach, etc.)
     // =========================================================================
 
+    /// `indexOf` on `number[]` (strict equality) and in-place `reverse`,
+    /// both vectorized scans in the runtime.
+    fn lower_typed_array_method(
+        &mut self,
+        ctx: &mut FuncCtx,
+        object: &Node<Expr>,
+        method: &str,
+        elem: &IrType,
+        args: &[Node<Expr>],
+    ) -> Option<Value> {
+        match (method, args) {
+            ("indexOf", [needle]) if *elem == IrType::F64 => {
+                let array = self.lower_expr(ctx, &object.value, &object.span)?;
+                let value = self.lower_expr(ctx, &needle.value, &needle.span)?;
+                self.ensure_extern("zaco_array_index_of_f64", vec![IrType::Ptr, IrType::F64], IrType::I64);
+                let index = ctx.add_temp(IrType::I64);
+                ctx.emit(Instruction::Call {
+                    dest: Some(Place::from_temp(index)),
+                    func: Value::Const(Constant::Str("zaco_array_index_of_f64".to_string())),
+                    args: vec![array, value],
+                });
+                let result = ctx.add_temp(IrType::F64);
+                ctx.emit(Instruction::Assign {
+                    dest: Place::from_temp(result),
+                    value: RValue::Cast { value: Value::Temp(index), ty: IrType::F64 },
+                });
+                Some(Value::Temp(result))
+            }
+            ("reverse", []) => {
+                let array = self.lower_expr(ctx, &object.value, &object.span)?;
+                self.ensure_extern("zaco_array_reverse", vec![IrType::Ptr], IrType::Void);
+                ctx.emit(Instruction::Call {
+                    dest: None,
+                    func: Value::Const(Constant::Str("zaco_array_reverse".to_string())),
+                    args: vec![array.clone()],
+                });
+                Some(array)
+            }
+            _ => None,
+        }
+    }
+
     /// Lower array.map/filter/forEach(callback) — iterates array and calls closure
     fn lower_array_callback_method(
         &mut self,
@@ -4851,21 +5551,21 @@ impl Lowerer {
 
         // Check if it's an inline arrow or function expr — lower it first
         let callback_closure_info = match &callback_arg.value {
-            Expr::Arrow { params, return_type, body, .. } => {
-                self.lower_arrow_expr(ctx, params, return_type.as_deref(), body, &callback_arg.span);
+            Expr::Arrow { params, return_type, body, is_async, .. } => {
+                self.lower_arrow_expr(ctx, params, return_type.as_deref(), body, *is_async, &callback_arg.span);
                 // Get the closure info that was just registered
                 let func_name = format!("__closure_{}", self.next_closure_id - 1);
                 self.closure_bindings.get(&func_name).cloned()
             }
-            Expr::Function { params, return_type, body, .. } => {
+            Expr::Function { params, return_type, body, is_async, .. } => {
                 let arrow_body = ArrowBody::Block(Box::new(*body.clone()));
-                self.lower_arrow_expr(ctx, params, return_type.as_deref(), &arrow_body, &callback_arg.span);
+                self.lower_arrow_expr(ctx, params, return_type.as_deref(), &arrow_body, *is_async, &callback_arg.span);
                 let func_name = format!("__closure_{}", self.next_closure_id - 1);
                 self.closure_bindings.get(&func_name).cloned()
             }
             Expr::Ident(ident) => {
                 // Look up the closure by variable name
-                self.closure_bindings.get(&ident.name).cloned()
+                self.closure_bindings.get(ident.name.as_str()).cloned()
             }
             _ => None,
         };
@@ -4875,32 +5575,32 @@ impl Lowerer {
             None => return None,
         };
 
-        // Get array length: call zaco_array_len(arr)
-        self.ensure_extern("zaco_array_len", vec![IrType::Ptr], IrType::I64);
+        // Get array length: call zaco_array_length(arr)
+        self.ensure_extern("zaco_array_length", vec![IrType::Ptr], IrType::I64);
         let len_temp = ctx.add_temp(IrType::I64);
         ctx.emit(Instruction::Call {
             dest: Some(Place::from_temp(len_temp)),
-            func: Value::Const(Constant::Str("zaco_array_len".to_string())),
+            func: Value::Const(Constant::Str("zaco_array_length".to_string())),
             args: vec![Value::Local(array_info.local_id)],
         });
 
         // For map: allocate result array
         let result_array = if method == "map" {
-            self.ensure_extern("zaco_array_new", vec![IrType::I64], IrType::Ptr);
+            self.ensure_extern("zaco_array_new", vec![IrType::I64, IrType::I64], IrType::Ptr);
             let arr = ctx.add_local(IrType::Ptr);
             ctx.emit(Instruction::Call {
                 dest: Some(Place::from_local(arr)),
                 func: Value::Const(Constant::Str("zaco_array_new".to_string())),
-                args: vec![Value::Temp(len_temp)],
+                args: vec![Value::Const(Constant::I64(8)), Value::Temp(len_temp)],
             });
             Some(arr)
         } else if method == "filter" {
-            self.ensure_extern("zaco_array_new", vec![IrType::I64], IrType::Ptr);
+            self.ensure_extern("zaco_array_new", vec![IrType::I64, IrType::I64], IrType::Ptr);
             let arr = ctx.add_local(IrType::Ptr);
             ctx.emit(Instruction::Call {
                 dest: Some(Place::from_local(arr)),
                 func: Value::Const(Constant::Str("zaco_array_new".to_string())),
-                args: vec![Value::Const(Constant::I64(0))],
+                args: vec![Value::Const(Constant::I64(8)), Value::Const(Constant::I64(0))],
             });
             Some(arr)
         } else {
@@ -4940,11 +5640,11 @@ impl Lowerer {
         ctx.switch_to(loop_body);
 
         // Get element: arr[i]
-        self.ensure_extern("zaco_array_get", vec![IrType::Ptr, IrType::I64], IrType::F64);
+        self.ensure_extern("zaco_array_get_f64", vec![IrType::Ptr, IrType::I64], IrType::F64);
         let elem = ctx.add_temp(IrType::F64);
         ctx.emit(Instruction::Call {
             dest: Some(Place::from_temp(elem)),
-            func: Value::Const(Constant::Str("zaco_array_get".to_string())),
+            func: Value::Const(Constant::Str("zaco_array_get_f64".to_string())),
             args: vec![Value::Local(array_info.local_id), Value::Local(idx_local)],
         });
 
@@ -4981,10 +5681,10 @@ impl Lowerer {
         // For map: push result to result_array
         if method == "map" {
             if let (Some(result_arr), Some(cb_r)) = (result_array, cb_result) {
-                self.ensure_extern("zaco_array_push", vec![IrType::Ptr, IrType::F64], IrType::Void);
+                self.ensure_extern("zaco_array_push_f64", vec![IrType::Ptr, IrType::F64], IrType::Void);
                 ctx.emit(Instruction::Call {
                     dest: None,
-                    func: Value::Const(Constant::Str("zaco_array_push".to_string())),
+                    func: Value::Const(Constant::Str("zaco_array_push_f64".to_string())),
                     args: vec![Value::Local(result_arr), Value::Temp(cb_r)],
                 });
             }
@@ -5002,10 +5702,10 @@ impl Lowerer {
                 });
 
                 ctx.switch_to(push_block);
-                self.ensure_extern("zaco_array_push", vec![IrType::Ptr, IrType::F64], IrType::Void);
+                self.ensure_extern("zaco_array_push_f64", vec![IrType::Ptr, IrType::F64], IrType::Void);
                 ctx.emit(Instruction::Call {
                     dest: None,
-                    func: Value::Const(Constant::Str("zaco_array_push".to_string())),
+                    func: Value::Const(Constant::Str("zaco_array_push_f64".to_string())),
                     args: vec![Value::Local(result_arr), Value::Temp(elem)],
                 });
                 ctx.set_terminator(Terminator::Jump(skip_block));
@@ -5040,65 +5740,855 @@ impl Lowerer {
     }
 
     // =========================================================================
-    // Free variable collection
+    // Object property access (shape inline caches)
     // =========================================================================
 
-    /// Collect variables referenced in statements that are not locally defined
-    /// (i.e., captured from enclosing scope).
-    fn collect_captured_vars(&self, stmts: &[Node<Stmt>], local_names: &HashSet<String>) -> Vec<String> {
-        let mut captured = Vec::new();
-        let mut seen = HashSet::new();
-        for stmt in stmts {
-            self.collect_free_vars_in_stmt(&stmt.value, local_names, &mut captured, &mut seen);
+    /// Static key layout of an object literal: keys in slot order with the IR
+    /// type each value is stored as. `None` when a computed key, spread or
+    /// method means the runtime shape cannot be predicted.
+    fn object_literal_shape(&self, props: &[ObjectProperty]) -> Option<Vec<(String, IrType)>> {
+        let mut shape: Vec<(String, IrType)> = Vec::new();
+        for prop in props {
+            let (key, value) = match prop {
+                ObjectProperty::Property { key, value, .. } => (key, value),
+                ObjectProperty::Spread(_) | ObjectProperty::Method { .. } => return None,
+            };
+            let key_str = match key {
+                PropertyName::Ident(ident) => ident.value.name.to_string(),
+                PropertyName::String(s) => s.clone(),
+                PropertyName::Number(n) => format!("{}", n),
+                PropertyName::Computed(_) => return None,
+            };
+            let slot_type = Self::shape_slot_type(self.infer_expr_type(&value.value));
+            // A repeated key keeps its first slot
+            match shape.iter_mut().find(|(k, _)| *k == key_str) {
+                Some(entry) => entry.1 = slot_type,
+                None => shape.push((key_str, slot_type)),
+            }
         }
-        captured
+        Some(shape)
     }
 
-    /// Collect captured variables that are mutated (assigned to) inside the closure.
-    /// These need capture-by-reference (boxing) so mutations are visible outside.
-    fn collect_mutated_captured_vars(&self, stmts: &[Node<Stmt>], local_names: &HashSet<String>) -> HashSet<String> {
-        let mut mutated = HashSet::new();
-        for stmt in stmts {
-            self.collect_mutated_vars_in_stmt(&stmt.value, local_names, &mut mutated);
+    /// Known literal shape of the variable `name` in the innermost scope that
+    /// binds it.
+    fn lookup_object_shape(&self, name: &str) -> Option<&Vec<(String, IrType)>> {
+        for scope in self.scopes.iter().rev() {
+            if scope.vars.contains_key(name) {
+                return scope.object_shapes.get(name);
+            }
         }
-        mutated
+        None
     }
 
-    fn collect_mutated_vars_in_stmt(
-        &self,
-        stmt: &Stmt,
-        local_names: &HashSet<String>,
-        mutated: &mut HashSet<String>,
-    ) {
-        match stmt {
-            Stmt::Expr(expr) => self.collect_mutated_vars_in_expr(&expr.value, local_names, mutated),
-            Stmt::Return(Some(expr)) => self.collect_mutated_vars_in_expr(&expr.value, local_names, mutated),
-            Stmt::VarDecl(vd) => {
-                for decl in &vd.declarations {
-                    if let Some(ref init) = decl.init {
-                        self.collect_mutated_vars_in_expr(&init.value, local_names, mutated);
-                    }
-                }
-            }
-            Stmt::If { condition, then_stmt, else_stmt } => {
-                self.collect_mutated_vars_in_expr(&condition.value, local_names, mutated);
-                self.collect_mutated_vars_in_stmt(&then_stmt.value, local_names, mutated);
-                if let Some(else_s) = else_stmt {
-                    self.collect_mutated_vars_in_stmt(&else_s.value, local_names, mutated);
-                }
+    /// Slot type recorded in a shape. Booleans stay distinct so serializers
+    /// can tell them from integers; they are accessed as I64 (see `object_slot`).
+    fn shape_slot_type(ty: IrType) -> IrType {
+        match ty {
+            IrType::Str | IrType::F64 | IrType::I64 | IrType::Bool => ty,
+            _ => IrType::Ptr,
+        }
+    }
+
+    /// Shape of the object type `ty`: an interface name or an object type
+    /// literal with property members.
+    fn annotation_shape(&self, ty: &Type) -> Option<Vec<(String, IrType)>> {
+        match ty {
+            Type::TypeRef { name, .. } => self.interface_shapes.get(name.value.name.as_str()).cloned(),
+            Type::Object(obj) => Some(self.members_shape(&obj.members, Vec::new())),
+            Type::Paren(inner) => self.annotation_shape(&inner.value),
+            _ => None,
+        }
+    }
+
+    /// Append the property members to `shape`, in declaration order.
+    fn members_shape(&self, members: &[ObjectTypeMember], mut shape: Vec<(String, IrType)>) -> Vec<(String, IrType)> {
+        for member in members {
+            let ObjectTypeMember::Property { name, ty, .. } = member else { continue };
+            let key = match name {
+                PropertyName::Ident(ident) => ident.value.name.to_string(),
+                PropertyName::String(s) => s.clone(),
+                PropertyName::Number(n) => format!("{}", n),
+                PropertyName::Computed(_) => continue,
+            };
+            let slot_type = Self::shape_slot_type(self.ast_type_to_ir(&ty.value));
+            match shape.iter_mut().find(|(k, _)| *k == key) {
+                Some(entry) => entry.1 = slot_type,
+                None => shape.push((key, slot_type)),
             }
-            Stmt::Block(block) => {
-                for s in &block.stmts {
-                    self.collect_mutated_vars_in_stmt(&s.value, local_names, mutated);
-                }
+        }
+        shape
+    }
+
+    fn collect_interface_shape(&mut self, iface: &InterfaceDecl) {
+        // Inherited members come first; bases declared later are not yet known
+        let mut shape = Vec::new();
+        for base in &iface.extends {
+            if let Some(base_shape) = self.annotation_shape(&base.value) {
+                shape = self.members_shape(&[], base_shape);
             }
-            Stmt::For { init, update, body, condition } => {
-                if let Some(init_item) = init {
-                    if let ForInit::Expr(expr) = init_item {
-                        self.collect_mutated_vars_in_expr(&expr.value, local_names, mutated);
-                    }
-                }
-                if let Some(cond) = condition {
+        }
+        let shape = self.members_shape(&iface.members, shape);
+        self.interface_shapes.insert(iface.name.value.name.to_string(), shape);
+    }
+
+    /// Shape of `expr` when known statically: a variable with a recorded
+    /// shape or an object literal.
+    fn static_object_shape(&self, expr: &Expr) -> Option<Vec<(String, IrType)>> {
+        match expr {
+            Expr::Ident(ident) => self.lookup_object_shape(&ident.name).cloned(),
+            Expr::Object(props) => self.object_literal_shape(props),
+            Expr::Paren(inner) => self.static_object_shape(&inner.value),
+            _ => None,
+        }
+    }
+
+    /// Slot index and access type of `obj.key` when `obj` is a variable with a
+    /// known shape.
+    fn object_slot(&self, object: &Expr, key: &str) -> Option<(usize, IrType)> {
+        let Expr::Ident(ident) = object else { return None };
+        let shape = self.lookup_object_shape(&ident.name)?;
+        let slot = shape.iter().position(|(k, _)| k == key)?;
+        let access_type = match shape[slot].1 {
+            IrType::Bool => IrType::I64,
+            ref ty => ty.clone(),
+        };
+        Some((slot, access_type))
+    }
+
+    /// Module-unique prefix for generated symbols.
+    fn symbol_prefix(&self) -> String {
+        self.module_name
+            .as_deref()
+            .unwrap_or("main")
+            .chars()
+            .map(|c| if c.is_ascii_alphanumeric() { c } else { '_' })
+            .collect()
+    }
+
+    /// Allocate a zero-initialized module global holding the cached shape for
+    /// one property access site.
+    fn new_ic_cell(&mut self) -> String {
+        let name = format!("__zaco_ic_{}_{}", self.symbol_prefix(), self.next_ic_id);
+        self.next_ic_id += 1;
+        self.module.add_global(name.clone(), IrType::Ptr, None);
+        name
+    }
+
+    fn object_accessor(prefix: &str, slot_type: &IrType) -> String {
+        let suffix = match slot_type {
+            IrType::Str => "str",
+            IrType::F64 => "f64",
+            IrType::I64 => "i64",
+            _ => "ptr",
+        };
+        format!("{}_{}", prefix, suffix)
+    }
+
+    /// Branch on the site's inline cache: if `obj`'s shape is the cached one,
+    /// continue in the returned hit block with the address of `slots[slot]`;
+    /// otherwise continue in the miss block. Returns (hit, miss, slot address).
+    fn emit_ic_guard(
+        &mut self,
+        ctx: &mut FuncCtx,
+        obj: &Value,
+        ic_name: &str,
+        slot: usize,
+    ) -> (BlockId, BlockId, Value) {
+        // Object layout (runtime ABI): [shape*][slots*][capacity]
+        let shape = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Load {
+            dest: Place::from_temp(shape),
+            ptr: obj.clone(),
+        });
+        let cached = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Load {
+            dest: Place::from_temp(cached),
+            ptr: Value::Const(Constant::Str(ic_name.to_string())),
+        });
+        let is_hit = ctx.add_temp(IrType::Bool);
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_temp(is_hit),
+            value: RValue::BinaryOp {
+                op: BinOp::Eq,
+                left: Value::Temp(shape),
+                right: Value::Temp(cached),
+            },
+        });
+        let hit_block = ctx.new_block();
+        let miss_block = ctx.new_block();
+        ctx.set_terminator(Terminator::Branch {
+            cond: Value::Temp(is_hit),
+            then_block: hit_block,
+            else_block: miss_block,
+        });
+
+        ctx.switch_to(hit_block);
+        let slots_field = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_temp(slots_field),
+            value: RValue::BinaryOp {
+                op: BinOp::Add,
+                left: obj.clone(),
+                right: Value::Const(Constant::I64(8)),
+            },
+        });
+        let slots = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Load {
+            dest: Place::from_temp(slots),
+            ptr: Value::Temp(slots_field),
+        });
+        let slot_addr = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_temp(slot_addr),
+            value: RValue::BinaryOp {
+                op: BinOp::Add,
+                left: Value::Temp(slots),
+                right: Value::Const(Constant::I64(slot as i64 * 8)),
+            },
+        });
+
+        (hit_block, miss_block, Value::Temp(slot_addr))
+    }
+
+    /// On an inline-cache miss, ask the runtime whether `obj`'s shape keeps
+    /// `key` at `slot` and remember the answer in the site's cache cell.
+    fn emit_ic_refill(&mut self, ctx: &mut FuncCtx, obj: &Value, key: &Value, ic_name: &str, slot: usize) {
+        self.ensure_extern(
+            "zaco_object_cache_shape",
+            vec![IrType::Ptr, IrType::Ptr, IrType::I64],
+            IrType::Ptr,
+        );
+        let shape = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(shape)),
+            func: Value::Const(Constant::Str("zaco_object_cache_shape".to_string())),
+            args: vec![obj.clone(), key.clone(), Value::Const(Constant::I64(slot as i64))],
+        });
+        ctx.emit(Instruction::Store {
+            ptr: Value::Const(Constant::Str(ic_name.to_string())),
+            value: Value::Temp(shape),
+        });
+    }
+
+    /// Read `obj.key` through a shape inline cache. The hit path loads the slot
+    /// directly; the miss path does a keyed lookup and refills the cache.
+    fn emit_object_slot_load(
+        &mut self,
+        ctx: &mut FuncCtx,
+        obj: Value,
+        key: &str,
+        slot: usize,
+        slot_type: IrType,
+    ) -> Value {
+        self.module.intern_string(key);
+        let key_val = Value::Const(Constant::Str(key.to_string()));
+        let getter = Self::object_accessor("zaco_object_get", &slot_type);
+        self.ensure_extern(&getter, vec![IrType::Ptr, IrType::Ptr], slot_type.clone());
+        let ic_name = self.new_ic_cell();
+
+        let result = ctx.add_local(slot_type.clone());
+        let join_block = ctx.new_block();
+        let (hit_block, miss_block, slot_addr) = self.emit_ic_guard(ctx, &obj, &ic_name, slot);
+
+        ctx.switch_to(hit_block);
+        let loaded = ctx.add_temp(slot_type.clone());
+        ctx.emit(Instruction::Load {
+            dest: Place::from_temp(loaded),
+            ptr: slot_addr,
+        });
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_local(result),
+            value: RValue::Use(Value::Temp(loaded)),
+        });
+        ctx.set_terminator(Terminator::Jump(join_block));
+
+        ctx.switch_to(miss_block);
+        let fetched = ctx.add_temp(slot_type);
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(fetched)),
+            func: Value::Const(Constant::Str(getter)),
+            args: vec![obj.clone(), key_val.clone()],
+        });
+        self.emit_ic_refill(ctx, &obj, &key_val, &ic_name, slot);
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_local(result),
+            value: RValue::Use(Value::Temp(fetched)),
+        });
+        ctx.set_terminator(Terminator::Jump(join_block));
+
+        ctx.switch_to(join_block);
+        Value::Local(result)
+    }
+
+    /// Write `obj.key = value` through a shape inline cache.
+    fn emit_object_slot_store(
+        &mut self,
+        ctx: &mut FuncCtx,
+        obj: Value,
+        key: &str,
+        slot: usize,
+        slot_type: IrType,
+        value: Value,
+    ) {
+        self.module.intern_string(key);
+        let key_val = Value::Const(Constant::Str(key.to_string()));
+        let setter = Self::object_accessor("zaco_object_set", &slot_type);
+        let setter_val_type = if slot_type == IrType::Str { IrType::Ptr } else { slot_type.clone() };
+        self.ensure_extern(&setter, vec![IrType::Ptr, IrType::Ptr, setter_val_type], IrType::Void);
+        let ic_name = self.new_ic_cell();
+
+        // Widen the value to the slot's 8-byte representation
+        let stored = ctx.add_temp(slot_type.clone());
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_temp(stored),
+            value: RValue::Cast { value, ty: slot_type },
+        });
+
+        let join_block = ctx.new_block();
+        let (hit_block, miss_block, slot_addr) = self.emit_ic_guard(ctx, &obj, &ic_name, slot);
+
+        ctx.switch_to(hit_block);
+        ctx.emit(Instruction::Store {
+            ptr: slot_addr,
+            value: Value::Temp(stored),
+        });
+        ctx.set_terminator(Terminator::Jump(join_block));
+
+        ctx.switch_to(miss_block);
+        ctx.emit(Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str(setter)),
+            args: vec![obj.clone(), key_val.clone(), Value::Temp(stored)],
+        });
+        self.emit_ic_refill(ctx, &obj, &key_val, &ic_name, slot);
+        ctx.set_terminator(Terminator::Jump(join_block));
+
+        ctx.switch_to(join_block);
+    }
+
+    // =========================================================================
+    // JSON serialization
+    // =========================================================================
+
+    /// Lower `JSON.stringify(value)` by the value's static type. Objects of
+    /// known shape go through a generated serializer; other values use the
+    /// typed runtime entry points. Further arguments (replacer, indent) are
+    /// evaluated for their side effects only.
+    fn lower_json_stringify(&mut self, ctx: &mut FuncCtx, args: &[Node<Expr>]) -> Option<Value> {
+        let (first, rest) = args.split_first()?;
+        let shape = self.static_object_shape(&first.value);
+        let ty = self.infer_expr_type(&first.value);
+        let val = self.lower_expr(ctx, &first.value, &first.span)?;
+        for arg in rest {
+            let _ = self.lower_expr(ctx, &arg.value, &arg.span);
+        }
+
+        let result = ctx.add_temp(IrType::Str);
+        if let Some(shape) = shape {
+            let serializer = self.json_serializer(&shape);
+            self.ensure_strbuf_externs();
+            let builder = ctx.add_temp(IrType::Ptr);
+            ctx.emit(Instruction::Call {
+                dest: Some(Place::from_temp(builder)),
+                func: Value::Const(Constant::Str("zaco_strbuf_new".to_string())),
+                args: vec![Value::Const(Constant::Null)],
+            });
+            ctx.emit(Instruction::Call {
+                dest: None,
+                func: Value::Const(Constant::Str(serializer)),
+                args: vec![val, Value::Temp(builder)],
+            });
+            ctx.emit(Instruction::Call {
+                dest: Some(Place::from_temp(result)),
+                func: Value::Const(Constant::Str("zaco_strbuf_finish".to_string())),
+                args: vec![Value::Temp(builder)],
+            });
+            return Some(Value::Temp(result));
+        }
+
+        let (runtime_fn, param_type) = match ty {
+            IrType::Str => ("zaco_json_stringify_str", IrType::Str),
+            IrType::F64 | IrType::I64 => ("zaco_json_stringify_f64", IrType::F64),
+            IrType::Bool => ("zaco_json_stringify_bool", IrType::I64),
+            IrType::Array(_) => ("zaco_json_stringify_array", IrType::Ptr),
+            _ => ("zaco_json_stringify", IrType::Ptr),
+        };
+        let arg = if ty != param_type && matches!(ty, IrType::I64 | IrType::Bool) {
+            let widened = ctx.add_temp(param_type.clone());
+            ctx.emit(Instruction::Assign {
+                dest: Place::from_temp(widened),
+                value: RValue::Cast { value: val, ty: param_type.clone() },
+            });
+            Value::Temp(widened)
+        } else {
+            val
+        };
+        self.ensure_extern(runtime_fn, vec![param_type], IrType::Str);
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(result)),
+            func: Value::Const(Constant::Str(runtime_fn.to_string())),
+            args: vec![arg],
+        });
+        Some(Value::Temp(result))
+    }
+
+    /// Name of the serializer for objects of `shape`, generated on first use.
+    /// `fn(obj, builder)` appends `{"k1":v1,...}`: key fragments are
+    /// precomputed literals, typed fields are read through inline caches and
+    /// written by type, and other fields by the kind recorded at runtime.
+    fn json_serializer(&mut self, shape: &[(String, IrType)]) -> String {
+        let signature = shape
+            .iter()
+            .map(|(key, ty)| format!("{}:{:?}", key, ty))
+            .collect::<Vec<_>>()
+            .join(",");
+        if let Some(name) = self.json_serializers.get(&signature) {
+            return name.clone();
+        }
+        let name = format!("__zaco_json_write_{}_{}", self.symbol_prefix(), self.json_serializers.len());
+        self.json_serializers.insert(signature, name.clone());
+
+        let obj = LocalId(0);
+        let builder = LocalId(1);
+        let func_id = self.alloc_func_id();
+        let mut ir_func = IrFunction::new(
+            func_id,
+            name.clone(),
+            vec![(obj, IrType::Ptr), (builder, IrType::Ptr)],
+            IrType::Void,
+        );
+        let entry = ir_func.new_block();
+        ir_func.entry_block = entry;
+        let mut ctx = FuncCtx {
+            func: &mut ir_func,
+            current_block: entry,
+        };
+        self.ensure_strbuf_externs();
+
+        let is_null = ctx.add_temp(IrType::Bool);
+        ctx.emit(Instruction::Assign {
+            dest: Place::from_temp(is_null),
+            value: RValue::BinaryOp {
+                op: BinOp::Eq,
+                left: Value::Local(obj),
+                right: Value::Const(Constant::Null),
+            },
+        });
+        let null_block = ctx.new_block();
+        let body_block = ctx.new_block();
+        ctx.set_terminator(Terminator::Branch {
+            cond: Value::Temp(is_null),
+            then_block: null_block,
+            else_block: body_block,
+        });
+        ctx.switch_to(null_block);
+        self.emit_strbuf_append_literal(&mut ctx, builder, "null");
+        ctx.set_terminator(Terminator::Return(None));
+
+        ctx.switch_to(body_block);
+        for (slot, (key, slot_type)) in shape.iter().enumerate() {
+            let fragment = format!("{}{}:", if slot == 0 { "{" } else { "," }, Self::json_quote(key));
+            self.emit_strbuf_append_literal(&mut ctx, builder, &fragment);
+            let (writer, param_type) = match slot_type {
+                IrType::Str => ("zaco_json_write_str", IrType::Str),
+                IrType::F64 => ("zaco_json_write_f64", IrType::F64),
+                IrType::I64 => ("zaco_json_write_i64", IrType::I64),
+                IrType::Bool => ("zaco_json_write_bool", IrType::I64),
+                _ => {
+                    self.module.intern_string(key);
+                    self.ensure_extern(
+                        "zaco_json_write_field",
+                        vec![IrType::Ptr, IrType::Ptr, IrType::Ptr],
+                        IrType::Void,
+                    );
+                    ctx.emit(Instruction::Call {
+                        dest: None,
+                        func: Value::Const(Constant::Str("zaco_json_write_field".to_string())),
+                        args: vec![
+                            Value::Local(builder),
+                            Value::Local(obj),
+                            Value::Const(Constant::Str(key.clone())),
+                        ],
+                    });
+                    continue;
+                }
+            };
+            let field = self.emit_object_slot_load(&mut ctx, Value::Local(obj), key, slot, param_type.clone());
+            self.ensure_extern(writer, vec![IrType::Ptr, param_type], IrType::Void);
+            ctx.emit(Instruction::Call {
+                dest: None,
+                func: Value::Const(Constant::Str(writer.to_string())),
+                args: vec![Value::Local(builder), field],
+            });
+        }
+        self.emit_strbuf_append_literal(&mut ctx, builder, if shape.is_empty() { "{}" } else { "}" });
+        ctx.set_terminator(Terminator::Return(None));
+
+        self.module.add_function(ir_func);
+        name
+    }
+
+    fn emit_strbuf_append_literal(&mut self, ctx: &mut FuncCtx, builder: LocalId, text: &str) {
+        self.module.intern_string(text);
+        ctx.emit(Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str("zaco_strbuf_append".to_string())),
+            args: vec![Value::Local(builder), Value::Const(Constant::Str(text.to_string()))],
+        });
+    }
+
+    /// `s` as a JSON string literal.
+    fn json_quote(s: &str) -> String {
+        let mut out = String::with_capacity(s.len() + 2);
+        out.push('"');
+        for c in s.chars() {
+            match c {
+                '"' => out.push_str("\\\""),
+                '\\' => out.push_str("\\\\"),
+                '\n' => out.push_str("\\n"),
+                '\r' => out.push_str("\\r"),
+                '\t' => out.push_str("\\t"),
+                c if (c as u32) < 0x20 => out.push_str(&format!("\\u{:04x}", c as u32)),
+                c => out.push(c),
+            }
+        }
+        out.push('"');
+        out
+    }
+
+    // =========================================================================
+    // String concatenation
+    // =========================================================================
+
+    /// Flatten a left-to-right chain of string `+` into its operands.
+    /// Sub-expressions that are not themselves string concatenations (e.g. the
+    /// numeric `1 + 2` in `1 + 2 + "x"`) stay as single operands.
+    fn collect_concat_operands<'e>(&self, expr: &'e Node<Expr>, out: &mut Vec<&'e Node<Expr>>) {
+        match &expr.value {
+            Expr::Binary { left, op: BinaryOp::Add, right }
+                if self.infer_expr_type(&expr.value) == IrType::Str =>
+            {
+                self.collect_concat_operands(left, out);
+                self.collect_concat_operands(right, out);
+            }
+            _ => out.push(expr),
+        }
+    }
+
+    /// Convert a non-string operand of a concatenation to a string.
+    fn emit_to_str(&mut self, ctx: &mut FuncCtx, val: Value, ty: &IrType) -> Value {
+        if *ty == IrType::Str {
+            return val;
+        }
+        self.ensure_extern("zaco_f64_to_str", vec![IrType::F64], IrType::Str);
+        let conv_temp = ctx.add_temp(IrType::Str);
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(conv_temp)),
+            func: Value::Const(Constant::Str("zaco_f64_to_str".to_string())),
+            args: vec![val],
+        });
+        Value::Temp(conv_temp)
+    }
+
+    fn ensure_strbuf_externs(&mut self) {
+        self.ensure_extern("zaco_strbuf_new", vec![IrType::Str], IrType::Ptr);
+        self.ensure_extern("zaco_strbuf_append", vec![IrType::Ptr, IrType::Str], IrType::Void);
+        self.ensure_extern("zaco_strbuf_finish", vec![IrType::Ptr], IrType::Str);
+    }
+
+    /// Concatenate string values. Two operands use a single `StrConcat`; longer
+    /// chains go through a string builder so each byte is copied once instead
+    /// of once per intermediate result.
+    fn emit_str_concat(&mut self, ctx: &mut FuncCtx, values: Vec<Value>) -> Value {
+        if values.len() <= 2 {
+            let temp = ctx.add_temp(IrType::Str);
+            ctx.emit(Instruction::Assign {
+                dest: Place::from_temp(temp),
+                value: RValue::StrConcat(values),
+            });
+            return Value::Temp(temp);
+        }
+
+        self.ensure_strbuf_externs();
+        let mut values = values.into_iter();
+        let builder = ctx.add_temp(IrType::Ptr);
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(builder)),
+            func: Value::Const(Constant::Str("zaco_strbuf_new".to_string())),
+            args: vec![values.next().unwrap()],
+        });
+        for val in values {
+            ctx.emit(Instruction::Call {
+                dest: None,
+                func: Value::Const(Constant::Str("zaco_strbuf_append".to_string())),
+                args: vec![Value::Temp(builder), val],
+            });
+        }
+        let temp = ctx.add_temp(IrType::Str);
+        ctx.emit(Instruction::Call {
+            dest: Some(Place::from_temp(temp)),
+            func: Value::Const(Constant::Str("zaco_strbuf_finish".to_string())),
+            args: vec![Value::Temp(builder)],
+        });
+        Value::Temp(temp)
+    }
+
+    // =========================================================================
+    // String accumulator loops
+    // =========================================================================
+
+    /// Find string variables that a loop body only ever appends to (`s += e`)
+    /// and move them into string builders for the duration of the loop.
+    ///
+    /// `header` holds the loop's own expressions (condition, update, iterable)
+    /// and `bound` the name of its iteration variable, if any. Returns the
+    /// (variable, builder) locals to hand to `end_str_accumulators` once the
+    /// exit block is current.
+    fn begin_str_accumulators(
+        &mut self,
+        ctx: &mut FuncCtx,
+        header: &[&Node<Expr>],
+        bound: Option<&str>,
+        body: &Stmt,
+    ) -> Vec<(LocalId, LocalId)> {
+        let mut names = Vec::new();
+        Self::collect_append_targets(body, &mut names);
+
+        let mut builders = Vec::new();
+        for name in names {
+            if bound == Some(name.as_str()) {
+                continue;
+            }
+            let info = match self.lookup_var(&name) {
+                Some(info) => info.clone(),
+                None => continue,
+            };
+            if info.ir_type != IrType::Str
+                || info.is_boxed
+                || self.str_builders.contains_key(&info.local_id)
+                || header.iter().any(|e| Self::expr_may_observe(&e.value, &name))
+                || !Self::stmt_only_appends(body, &name)
+            {
+                continue;
+            }
+
+            self.ensure_strbuf_externs();
+            let builder = ctx.add_local(IrType::Ptr);
+            ctx.emit(Instruction::Call {
+                dest: Some(Place::from_local(builder)),
+                func: Value::Const(Constant::Str("zaco_strbuf_new".to_string())),
+                args: vec![Value::Local(info.local_id)],
+            });
+            self.str_builders.insert(info.local_id, builder);
+            builders.push((info.local_id, builder));
+        }
+        builders
+    }
+
+    /// Freeze the loop's string builders back into their variables.
+    fn end_str_accumulators(&mut self, ctx: &mut FuncCtx, builders: Vec<(LocalId, LocalId)>) {
+        for (var, builder) in builders {
+            self.str_builders.remove(&var);
+            ctx.emit(Instruction::Call {
+                dest: Some(Place::from_local(var)),
+                func: Value::Const(Constant::Str("zaco_strbuf_finish".to_string())),
+                args: vec![Value::Local(builder)],
+            });
+        }
+    }
+
+    /// Collect the targets of `name += e` expression statements in a loop body.
+    fn collect_append_targets(stmt: &Stmt, names: &mut Vec<String>) {
+        match stmt {
+            Stmt::Expr(expr) => {
+                if let Expr::Assignment { target, op: AssignmentOp::AddAssign, .. } = &expr.value {
+                    if let Expr::Ident(ident) = &target.value {
+                        if !names.iter().any(|n| *n == ident.name) {
+                            names.push(ident.name.to_string());
+                        }
+                    }
+                }
+            }
+            Stmt::If { then_stmt, else_stmt, .. } => {
+                Self::collect_append_targets(&then_stmt.value, names);
+                if let Some(else_s) = else_stmt {
+                    Self::collect_append_targets(&else_s.value, names);
+                }
+            }
+            Stmt::Block(block) => {
+                for s in &block.stmts {
+                    Self::collect_append_targets(&s.value, names);
+                }
+            }
+            Stmt::While { body, .. } | Stmt::For { body, .. } => {
+                Self::collect_append_targets(&body.value, names);
+            }
+            _ => {}
+        }
+    }
+
+    /// True if every use of `name` in `stmt` is the target of a `name += e`
+    /// statement whose right-hand side does not mention it. Anything that could
+    /// read, shadow or leave the loop without passing its exit block (return,
+    /// throw, labeled jumps, try, switch, nested functions) disqualifies.
+    fn stmt_only_appends(stmt: &Stmt, name: &str) -> bool {
+        let var_decl_ok = |vd: &VarDecl| {
+            vd.declarations.iter().all(|d| {
+                matches!(&d.pattern.value, Pattern::Ident { name: n, .. } if n.value.name != name)
+                    && d.init.as_ref().map_or(true, |i| !Self::expr_may_observe(&i.value, name))
+            })
+        };
+        match stmt {
+            Stmt::Expr(expr) => match &expr.value {
+                Expr::Assignment { target, op: AssignmentOp::AddAssign, value }
+                    if matches!(&target.value, Expr::Ident(ident) if ident.name == name) =>
+                {
+                    !Self::expr_may_observe(&value.value, name)
+                }
+                other => !Self::expr_may_observe(other, name),
+            },
+            Stmt::VarDecl(vd) => var_decl_ok(vd),
+            Stmt::If { condition, then_stmt, else_stmt } => {
+                !Self::expr_may_observe(&condition.value, name)
+                    && Self::stmt_only_appends(&then_stmt.value, name)
+                    && else_stmt
+                        .as_ref()
+                        .map_or(true, |e| Self::stmt_only_appends(&e.value, name))
+            }
+            Stmt::Block(block) => block.stmts.iter().all(|s| Self::stmt_only_appends(&s.value, name)),
+            Stmt::While { condition, body } => {
+                !Self::expr_may_observe(&condition.value, name)
+                    && Self::stmt_only_appends(&body.value, name)
+            }
+            Stmt::For { init, condition, update, body } => {
+                let init_ok = match init {
+                    Some(ForInit::VarDecl(vd)) => var_decl_ok(vd),
+                    Some(ForInit::Expr(e)) => !Self::expr_may_observe(&e.value, name),
+                    None => true,
+                };
+                init_ok
+                    && condition.as_ref().map_or(true, |c| !Self::expr_may_observe(&c.value, name))
+                    && update.as_ref().map_or(true, |u| !Self::expr_may_observe(&u.value, name))
+                    && Self::stmt_only_appends(&body.value, name)
+            }
+            Stmt::Break(None) | Stmt::Continue(None) | Stmt::Empty => true,
+            _ => false,
+        }
+    }
+
+    /// Conservatively decide whether evaluating `expr` may read or write `name`.
+    /// Closures, `await` and `yield` always count: they can observe the
+    /// variable outside the straight-line loop body.
+    fn expr_may_observe(expr: &Expr, name: &str) -> bool {
+        let any = |exprs: &[Node<Expr>]| exprs.iter().any(|e| Self::expr_may_observe(&e.value, name));
+        match expr {
+            Expr::Ident(ident) => ident.name == name,
+            Expr::Literal(_) | Expr::This | Expr::Super | Expr::MetaProperty { .. } => false,
+            Expr::Binary { left, right, .. } => {
+                Self::expr_may_observe(&left.value, name) || Self::expr_may_observe(&right.value, name)
+            }
+            Expr::Assignment { target, value, .. } => {
+                Self::expr_may_observe(&target.value, name) || Self::expr_may_observe(&value.value, name)
+            }
+            Expr::Unary { expr: inner, .. }
+            | Expr::TypeCast { expr: inner, .. }
+            | Expr::Satisfies { expr: inner, .. }
+            | Expr::Paren(inner)
+            | Expr::Clone(inner)
+            | Expr::Spread(inner)
+            | Expr::NonNullAssertion(inner) => Self::expr_may_observe(&inner.value, name),
+            Expr::Call { callee, args, .. }
+            | Expr::New { callee, args, .. }
+            | Expr::OptionalCall { callee, args, .. } => {
+                Self::expr_may_observe(&callee.value, name) || any(args)
+            }
+            Expr::Member { object, .. } | Expr::OptionalMember { object, .. } => {
+                Self::expr_may_observe(&object.value, name)
+            }
+            Expr::Index { object, index } | Expr::OptionalIndex { object, index } => {
+                Self::expr_may_observe(&object.value, name) || Self::expr_may_observe(&index.value, name)
+            }
+            Expr::Array(elements) => elements.iter().flatten().any(|e| Self::expr_may_observe(&e.value, name)),
+            Expr::Object(props) => props.iter().any(|prop| match prop {
+                ObjectProperty::Property { key, value, .. } => {
+                    matches!(key, PropertyName::Computed(_)) || Self::expr_may_observe(&value.value, name)
+                }
+                ObjectProperty::Spread(e) => Self::expr_may_observe(&e.value, name),
+                ObjectProperty::Method { .. } => true,
+            }),
+            Expr::Ternary { condition, then_expr, else_expr } => {
+                Self::expr_may_observe(&condition.value, name)
+                    || Self::expr_may_observe(&then_expr.value, name)
+                    || Self::expr_may_observe(&else_expr.value, name)
+            }
+            Expr::Template { exprs, .. } | Expr::Sequence(exprs) => any(exprs),
+            Expr::TaggedTemplate { tag, exprs, .. } => {
+                Self::expr_may_observe(&tag.value, name) || any(exprs)
+            }
+            Expr::Arrow { .. } | Expr::Function { .. } | Expr::Await(_) | Expr::Yield { .. } => true,
+        }
+    }
+
+    // =========================================================================
+    // Free variable collection
+    // =========================================================================
+
+    /// Collect variables referenced in statements that are not locally defined
+    /// (i.e., captured from enclosing scope).
+    fn collect_captured_vars(&self, stmts: &[Node<Stmt>], local_names: &HashSet<String>) -> Vec<String> {
+        let mut captured = Vec::new();
+        let mut seen = HashSet::new();
+        for stmt in stmts {
+            self.collect_free_vars_in_stmt(&stmt.value, local_names, &mut captured, &mut seen);
+        }
+        captured
+    }
+
+    /// Collect captured variables that are mutated (assigned to) inside the closure.
+    /// These need capture-by-reference (boxing) so mutations are visible outside.
+    fn collect_mutated_captured_vars(&self, stmts: &[Node<Stmt>], local_names: &HashSet<String>) -> HashSet<String> {
+        let mut mutated = HashSet::new();
+        for stmt in stmts {
+            self.collect_mutated_vars_in_stmt(&stmt.value, local_names, &mut mutated);
+        }
+        mutated
+    }
+
+    fn collect_mutated_vars_in_stmt(
+        &self,
+        stmt: &Stmt,
+        local_names: &HashSet<String>,
+        mutated: &mut HashSet<String>,
+    ) {
+        match stmt {
+            Stmt::Expr(expr) => self.collect_mutated_vars_in_expr(&expr.value, local_names, mutated),
+            Stmt::Return(Some(expr)) => self.collect_mutated_vars_in_expr(&expr.value, local_names, mutated),
+            Stmt::VarDecl(vd) => {
+                for decl in &vd.declarations {
+                    if let Some(ref init) = decl.init {
+                        self.collect_mutated_vars_in_expr(&init.value, local_names, mutated);
+                    }
+                }
+            }
+            Stmt::If { condition, then_stmt, else_stmt } => {
+                self.collect_mutated_vars_in_expr(&condition.value, local_names, mutated);
+                self.collect_mutated_vars_in_stmt(&then_stmt.value, local_names, mutated);
+                if let Some(else_s) = else_stmt {
+                    self.collect_mutated_vars_in_stmt(&else_s.value, local_names, mutated);
+                }
+            }
+            Stmt::Block(block) => {
+                for s in &block.stmts {
+                    self.collect_mutated_vars_in_stmt(&s.value, local_names, mutated);
+                }
+            }
+            Stmt::For { init, update, body, condition } => {
+                if let Some(init_item) = init {
+                    if let ForInit::Expr(expr) = init_item {
+                        self.collect_mutated_vars_in_expr(&expr.value, local_names, mutated);
+                    }
+                }
+                if let Some(cond) = condition {
                     self.collect_mutated_vars_in_expr(&cond.value, local_names, mutated);
                 }
                 if let Some(update_expr) = update {
@@ -5124,9 +6614,9 @@ impl Lowerer {
             Expr::Assignment { target, value, .. } => {
                 // Check if the target is a captured variable being mutated
                 if let Expr::Ident(ident) = &target.value {
-                    let name = &ident.name;
+                    let name = ident.name.as_str();
                     if !local_names.contains(name) && self.lookup_var(name).is_some() {
-                        mutated.insert(name.clone());
+                        mutated.insert(name.to_string());
                     }
                 }
                 self.collect_mutated_vars_in_expr(&value.value, local_names, mutated);
@@ -5201,12 +6691,12 @@ impl Lowerer {
     ) {
         match expr {
             Expr::Ident(ident) => {
-                let name = &ident.name;
+                let name = ident.name.as_str();
                 if !local_names.contains(name) && !seen.contains(name) {
                     // Check if it's a variable in scope (not a global/built-in)
                     if self.lookup_var(name).is_some() {
-                        seen.insert(name.clone());
-                        captured.push(name.clone());
+                        seen.insert(name.to_string());
+                        captured.push(name.to_string());
                     }
                 }
             }
@@ -5327,10 +6817,17 @@ impl Lowerer {
             Expr::Call { callee, .. } => {
                 // Infer return type from known built-in calls
                 if let Expr::Member { object, property, .. } = &callee.value {
+                    if let array_ty @ IrType::Array(_) = self.infer_expr_type(&object.value) {
+                        if property.value.name == "reverse" {
+                            return array_ty;
+                        }
+                    }
                     if let Expr::Ident(obj_ident) = &object.value {
                         match obj_ident.name.as_str() {
                             "Math" => IrType::F64, // All Math methods return f64
-                            "JSON" => IrType::Str, // JSON.parse/stringify return strings
+                            // JSON.parse builds native values, JSON.stringify returns a string
+                            "JSON" if property.value.name == "parse" => IrType::Ptr,
+                            "JSON" => IrType::Str,
                             _ if {
                                 // Check if it's a Promise method call
                                 if let Some(info) = self.lookup_var(&obj_ident.name) {
@@ -5367,7 +6864,7 @@ impl Lowerer {
                     let lookup_name = if func_ident.name == "main" && self.has_user_main {
                         "_user_main".to_string()
                     } else {
-                        func_ident.name.clone()
+                        func_ident.name.to_string()
                     };
                     self.module.find_function(&lookup_name)
                         .map(|f| f.return_type.clone())
@@ -5380,9 +6877,14 @@ impl Lowerer {
                             }
                             None
                         })
+                        .or_else(|| {
+                            // Timer ids
+                            matches!(func_ident.name.as_str(), "setTimeout" | "setInterval")
+                                .then_some(IrType::I64)
+                        })
                         .or_else(|| {
                             // Check if this is an imported function call
-                            if let Some(module) = self.imported_bindings.get(&func_ident.name) {
+                            if let Some(module) = self.imported_bindings.get(func_ident.name.as_str()) {
                                 if let Some((_, _, ret_type)) = Self::imported_func_signature(module, &func_ident.name) {
                                     return Some(ret_type);
                                 }
@@ -5403,13 +6905,17 @@ impl Lowerer {
                         ("process", _) => IrType::Str,
                         _ => {
                             // Check if it's a static property on a class
-                            if let Some(ci) = self.class_info.get(&obj_ident.name) {
+                            if let Some(ci) = self.class_info.get(obj_ident.name.as_str()) {
                                 if let Some((_, ty)) = ci.static_properties.iter()
                                     .find(|(n, _)| n == &property.value.name)
                                 {
                                     return ty.clone();
                                 }
                             }
+                            // Check if it's a field of an object literal of known shape
+                            if let Some((_, slot_type)) = self.object_slot(&object.value, &property.value.name) {
+                                return slot_type;
+                            }
                             // Check if it's a class instance field access
                             if let Some(info) = self.lookup_var(&obj_ident.name) {
                                 if let IrType::Struct(struct_id) = &info.ir_type {
@@ -5417,7 +6923,7 @@ impl Lowerer {
                                         .find(|(_, ci)| ci.struct_id == *struct_id)
                                     {
                                         // Check getters first
-                                        if ci.getters.contains(&property.value.name) {
+                                        if ci.getters.iter().any(|g| *g == property.value.name) {
                                             let getter_func = format!("{}_get_{}", ci.struct_id.0, property.value.name);
                                             if let Some(func) = self.module.find_function(&getter_func) {
                                                 return func.return_type.clone();
@@ -5453,7 +6959,7 @@ impl Lowerer {
             Expr::New { callee, .. } => {
                 // new ClassName() returns a class instance (struct pointer)
                 if let Expr::Ident(ident) = &callee.value {
-                    if let Some(ci) = self.class_info.get(&ident.name) {
+                    if let Some(ci) = self.class_info.get(ident.name.as_str()) {
                         return IrType::Struct(ci.struct_id);
                     }
                 }
@@ -5479,6 +6985,10 @@ impl Lowerer {
                     _ => self.infer_expr_type(&operand.value),
                 }
             }
+            Expr::Await(inner) => match self.infer_expr_type(&inner.value) {
+                IrType::Promise(t) if *t != IrType::Void => *t,
+                _ => IrType::F64,
+            },
             Expr::Ternary { then_expr, .. } => {
                 // Result type is the type of the then branch
                 self.infer_expr_type(&then_expr.value)
@@ -5497,7 +7007,7 @@ impl Lowerer {
                     args: args.clone(),
                 })
             }
-            Expr::OptionalIndex { object, .. } => {
+            Expr::Index { object, .. } | Expr::OptionalIndex { object, .. } => {
                 let obj_ty = self.infer_expr_type(&object.value);
                 if let IrType::Array(elem) = obj_ty {
                     *elem
@@ -5621,7 +7131,7 @@ mod tests {
             )),
             type_args: None,
             args: vec![Node::new(
-                Expr::Literal(Literal::String("Hello, World!".to_string())),
+                Expr::Literal(Literal::String("Hello, World!".into())),
                 dummy_span(),
             )],
         };
@@ -5865,8 +7375,8 @@ mod tests {
             )),
             type_args: None,
             args: vec![
-                Node::new(Expr::Literal(Literal::String("test.txt".to_string())), dummy_span()),
-                Node::new(Expr::Literal(Literal::String("utf-8".to_string())), dummy_span()),
+                Node::new(Expr::Literal(Literal::String("test.txt".into())), dummy_span()),
+                Node::new(Expr::Literal(Literal::String("utf-8".into())), dummy_span()),
             ],
         };
 
@@ -5932,7 +7442,7 @@ mod tests {
                         Stmt::Return(Some(Node::new(
                             Expr::Binary {
                                 left: Box::new(Node::new(
-                                    Expr::Literal(Literal::String("Hello ".to_string())),
+                                    Expr::Literal(Literal::String("Hello ".into())),
                                     dummy_span(),
                                 )),
                                 op: BinaryOp::Add,
@@ -5991,7 +7501,7 @@ mod tests {
                 BlockStmt {
                     stmts: vec![Node::new(
                         Stmt::Return(Some(Node::new(
-                            Expr::Literal(Literal::String("data".to_string())),
+                            Expr::Literal(Literal::String("data".into())),
                             dummy_span(),
                         ))),
                         dummy_span(),
@@ -6011,8 +7521,9 @@ mod tests {
         assert!(result.is_ok());
 
         let module = result.unwrap();
-        // Should have fetchData function + main function
-        assert_eq!(module.functions.len(), 2);
+        // Should have fetchData, its resume function and main
+        assert_eq!(module.functions.len(), 3);
+        assert!(module.find_function("__async_main_fetchData_resume").is_some_and(|f| f.is_async_resume));
         let fetch_fn = module.find_function("fetchData").expect("fetchData function not found");
 
         // Check return type is Promise<string>
@@ -6039,7 +7550,7 @@ mod tests {
                     dummy_span(),
                 ),
                 init: Some(Node::new(
-                    Expr::Literal(Literal::String("promise".to_string())),
+                    Expr::Literal(Literal::String("promise".into())),
                     dummy_span(),
                 )),
             }],
@@ -6104,11 +7615,38 @@ mod tests {
         // Should have asyncMain + main functions
         assert!(module.find_function("asyncMain").is_some());
 
-        // Should have extern function for zaco_async_block_on (called in await)
+        // The await suspends through zaco_async_await instead of blocking
+        assert!(
+            module.extern_functions.iter().any(|f| f.name == "zaco_async_await"),
+            "zaco_async_await should be in extern functions"
+        );
         assert!(
-            module.extern_functions.iter().any(|f| f.name == "zaco_async_block_on"),
-            "zaco_async_block_on should be in extern functions"
+            !module.extern_functions.iter().any(|f| f.name == "zaco_async_block_on"),
+            "await inside an async function should not block"
         );
+
+        // `p` lives in a local, so it is saved to the frame before suspending
+        // and restored in the block the function resumes into
+        let resume = module.find_function("__async_main_asyncMain_resume").expect("resume function");
+        let calls_await = |b: &crate::Block| b.instructions.iter().any(|i| matches!(
+            i,
+            Instruction::Call { func: Value::Const(Constant::Str(name)), .. } if name == "zaco_async_await"
+        ));
+        let suspend = resume.blocks.iter().find(|b| calls_await(b)).expect("suspend block");
+        assert!(suspend.instructions.iter().any(|i| matches!(i, Instruction::Store { value: Value::Local(_), .. })));
+        assert_eq!(suspend.terminator, Terminator::Return(None));
+        let resumed = resume
+            .blocks
+            .iter()
+            .find(|b| b.instructions.iter().any(|i| matches!(
+                i,
+                Instruction::Call { args, .. } if args == &[Value::Local(ASYNC_RESUMED)]
+            )))
+            .expect("resume block");
+        assert!(resumed.instructions.iter().any(|i| matches!(
+            i,
+            Instruction::Load { dest: Place { base: Value::Local(_), .. }, .. }
+        )));
     }
 
     #[test]
@@ -6310,6 +7848,7 @@ mod tests {
                         params: vec![],
                         return_type: None,
                         body: closure_body,
+                        is_async: false,
                     },
                     dummy_span(),
                 )),
@@ -6373,6 +7912,7 @@ mod tests {
                             Expr::Ident(Ident::new("x")),
                             dummy_span(),
                         ))),
+                        is_async: false,
                     },
                     dummy_span(),
                 )),
@@ -6420,7 +7960,7 @@ mod tests {
             body: Some(Node::new(BlockStmt {
                 stmts: vec![Node::new(
                     Stmt::Return(Some(Node::new(
-                        Expr::Literal(Literal::String("data".to_string())),
+                        Expr::Literal(Literal::String("data".into())),
                         dummy_span(),
                     ))),
                     dummy_span(),
@@ -6503,6 +8043,7 @@ mod tests {
                             BlockStmt { stmts: vec![] },
                             dummy_span(),
                         ))),
+                        is_async: false,
                     },
                     dummy_span(),
                 )],
@@ -6529,4 +8070,512 @@ mod tests {
         );
     }
 
+    fn expr(e: Expr) -> Node<Expr> {
+        Node::new(e, dummy_span())
+    }
+
+    fn str_lit(s: &str) -> Node<Expr> {
+        expr(Expr::Literal(Literal::String(s.into())))
+    }
+
+    fn ident(name: &str) -> Node<Expr> {
+        expr(Expr::Ident(Ident::new(name)))
+    }
+
+    fn let_decl(name: &str, init: Node<Expr>) -> Node<ModuleItem> {
+        make_decl_item(Decl::Var(VarDecl {
+            kind: VarDeclKind::Let,
+            declarations: vec![VarDeclarator {
+                pattern: Node::new(
+                    Pattern::Ident {
+                        name: Node::new(Ident::new(name), dummy_span()),
+                        type_annotation: None,
+                        ownership: None,
+                    },
+                    dummy_span(),
+                ),
+                init: Some(init),
+            }],
+        }))
+    }
+
+    fn append_stmt(name: &str, value: Node<Expr>) -> Node<Stmt> {
+        Node::new(
+            Stmt::Expr(expr(Expr::Assignment {
+                target: Box::new(ident(name)),
+                op: AssignmentOp::AddAssign,
+                value: Box::new(value),
+            })),
+            dummy_span(),
+        )
+    }
+
+    /// `while (flag) { <body> }` as a module item.
+    fn while_item(body: Vec<Node<Stmt>>) -> Node<ModuleItem> {
+        make_stmt_item(Stmt::While {
+            condition: ident("flag"),
+            body: Box::new(Node::new(Stmt::Block(BlockStmt { stmts: body }), dummy_span())),
+        })
+    }
+
+    fn called_funcs(module: &IrModule) -> Vec<String> {
+        let mut names = Vec::new();
+        for func in &module.functions {
+            for block in &func.blocks {
+                for instr in &block.instructions {
+                    if let Instruction::Call { func: Value::Const(Constant::Str(name)), .. } = instr {
+                        names.push(name.clone());
+                    }
+                }
+            }
+        }
+        names
+    }
+
+    fn has_str_concat(module: &IrModule) -> bool {
+        module.functions.iter().flat_map(|f| &f.blocks).flat_map(|b| &b.instructions).any(|i| {
+            matches!(i, Instruction::Assign { value: RValue::StrConcat(_), .. })
+        })
+    }
+
+    #[test]
+    fn test_str_accumulator_loop_uses_builder() {
+        // let s = ""; let flag = true; while (flag) { s += "x"; }
+        let program = make_program(vec![
+            let_decl("s", str_lit("")),
+            let_decl("flag", expr(Expr::Literal(Literal::Boolean(true)))),
+            while_item(vec![append_stmt("s", str_lit("x"))]),
+        ]);
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        let calls = called_funcs(&module);
+        assert_eq!(calls.iter().filter(|c| *c == "zaco_strbuf_new").count(), 1);
+        assert!(calls.iter().any(|c| c == "zaco_strbuf_append"));
+        assert_eq!(calls.iter().filter(|c| *c == "zaco_strbuf_finish").count(), 1);
+        assert!(!has_str_concat(&module), "loop append should not concatenate");
+    }
+
+    #[test]
+    fn test_str_accumulator_read_in_loop_keeps_concat() {
+        // let s = ""; let flag = true; while (flag) { s += "x"; console.log(s); }
+        let log = Node::new(
+            Stmt::Expr(expr(Expr::Call {
+                callee: Box::new(expr(Expr::Member {
+                    object: Box::new(ident("console")),
+                    property: Node::new(Ident::new("log"), dummy_span()),
+                    computed: false,
+                })),
+                type_args: None,
+                args: vec![ident("s")],
+            })),
+            dummy_span(),
+        );
+        let program = make_program(vec![
+            let_decl("s", str_lit("")),
+            let_decl("flag", expr(Expr::Literal(Literal::Boolean(true)))),
+            while_item(vec![append_stmt("s", str_lit("x")), log]),
+        ]);
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        assert!(!called_funcs(&module).iter().any(|c| c.starts_with("zaco_strbuf_")));
+        assert!(has_str_concat(&module), "s += x outside a builder is a concatenation");
+    }
+
+    #[test]
+    fn test_str_concat_chain_uses_builder() {
+        // let a = "a"; let t = a + "b" + "c" + "d";
+        let chain = ["b", "c", "d"].iter().fold(ident("a"), |acc, part| {
+            expr(Expr::Binary {
+                left: Box::new(acc),
+                op: BinaryOp::Add,
+                right: Box::new(str_lit(part)),
+            })
+        });
+        let program = make_program(vec![let_decl("a", str_lit("a")), let_decl("t", chain)]);
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        let calls = called_funcs(&module);
+        assert_eq!(calls.iter().filter(|c| *c == "zaco_strbuf_new").count(), 1);
+        assert_eq!(calls.iter().filter(|c| *c == "zaco_strbuf_append").count(), 3);
+        assert!(!has_str_concat(&module));
+    }
+
+    fn object_literal(props: &[(&str, Node<Expr>)]) -> Node<Expr> {
+        expr(Expr::Object(
+            props
+                .iter()
+                .map(|(key, value)| ObjectProperty::Property {
+                    key: PropertyName::Ident(Node::new(Ident::new(*key), dummy_span())),
+                    value: value.clone(),
+                    shorthand: false,
+                })
+                .collect(),
+        ))
+    }
+
+    fn member(object: &str, property: &str) -> Node<Expr> {
+        expr(Expr::Member {
+            object: Box::new(ident(object)),
+            property: Node::new(Ident::new(property), dummy_span()),
+            computed: false,
+        })
+    }
+
+    #[test]
+    fn test_object_literal_member_uses_inline_cache() {
+        // let p = { x: 1, name: "a" }; let n = p.name; p.x = 2;
+        let p = object_literal(&[
+            ("x", expr(Expr::Literal(Literal::Number(1.0)))),
+            ("name", str_lit("a")),
+        ]);
+        let store = make_stmt_item(Stmt::Expr(expr(Expr::Assignment {
+            target: Box::new(member("p", "x")),
+            op: AssignmentOp::Assign,
+            value: Box::new(expr(Expr::Literal(Literal::Number(2.0)))),
+        })));
+        let program = make_program(vec![let_decl("p", p), let_decl("n", member("p", "name")), store]);
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        let calls = called_funcs(&module);
+        // One cache cell per access site, refilled on the miss path
+        assert_eq!(module.globals.iter().filter(|(n, _, _)| n.starts_with("__zaco_ic_")).count(), 2);
+        assert_eq!(calls.iter().filter(|c| *c == "zaco_object_cache_shape").count(), 2);
+        assert!(calls.iter().any(|c| c == "zaco_object_get_str"));
+        assert!(calls.iter().any(|c| c == "zaco_object_set_f64"));
+
+        // `n` is typed from the literal's `name` slot
+        let main = &module.functions[0];
+        assert!(main.locals.iter().any(|(_, ty)| *ty == IrType::Str));
+    }
+
+    fn json_stringify(arg: Node<Expr>) -> Node<Expr> {
+        expr(Expr::Call {
+            callee: Box::new(member("JSON", "stringify")),
+            type_args: None,
+            args: vec![arg],
+        })
+    }
+
+    #[test]
+    fn test_json_stringify_known_shape_uses_serializer() {
+        // let p = { x: 1, name: "a" }; let a = JSON.stringify(p); let b = JSON.stringify(p);
+        let p = object_literal(&[
+            ("x", expr(Expr::Literal(Literal::Number(1.0)))),
+            ("name", str_lit("a")),
+        ]);
+        let program = make_program(vec![
+            let_decl("p", p),
+            let_decl("a", json_stringify(ident("p"))),
+            let_decl("b", json_stringify(ident("p"))),
+        ]);
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        // One serializer per shape, shared by both call sites
+        let serializers: Vec<_> = module
+            .functions
+            .iter()
+            .filter(|f| f.name.starts_with("__zaco_json_write_"))
+            .collect();
+        assert_eq!(serializers.len(), 1);
+        let calls = called_funcs(&module);
+        assert_eq!(calls.iter().filter(|c| **c == serializers[0].name).count(), 2);
+        assert!(calls.iter().any(|c| c == "zaco_json_write_f64"));
+        assert!(calls.iter().any(|c| c == "zaco_json_write_str"));
+        assert!(!calls.iter().any(|c| c == "zaco_json_stringify"));
+        // Keys are emitted as literal fragments
+        assert!(module.string_literals.iter().any(|s| s == "{\"x\":"));
+        assert!(module.string_literals.iter().any(|s| s == ",\"name\":"));
+    }
+
+    #[test]
+    fn test_json_stringify_primitive_dispatch() {
+        // JSON.stringify("s"); JSON.stringify(1)
+        let program = make_program(vec![
+            let_decl("a", json_stringify(str_lit("s"))),
+            let_decl("b", json_stringify(expr(Expr::Literal(Literal::Number(1.0))))),
+        ]);
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        let calls = called_funcs(&module);
+        assert!(calls.iter().any(|c| c == "zaco_json_stringify_str"));
+        assert!(calls.iter().any(|c| c == "zaco_json_stringify_f64"));
+    }
+
+    #[test]
+    fn test_json_stringify_array_uses_typed_entry_point() {
+        // JSON.stringify([1, 2])
+        let array = expr(Expr::Array(vec![
+            Some(expr(Expr::Literal(Literal::Number(1.0)))),
+            Some(expr(Expr::Literal(Literal::Number(2.0)))),
+        ]));
+        let program = make_program(vec![let_decl("a", json_stringify(array))]);
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        let calls = called_funcs(&module);
+        assert!(calls.iter().any(|c| c == "zaco_json_stringify_array"));
+        assert!(!calls.iter().any(|c| c == "zaco_json_stringify"));
+    }
+
+    #[test]
+    fn test_set_timeout_passes_closure_env_as_context() {
+        // let msg = "hi"; setTimeout(() => msg, 10);
+        let callback = expr(Expr::Arrow {
+            type_params: None,
+            params: vec![],
+            return_type: None,
+            body: ArrowBody::Expr(Box::new(ident("msg"))),
+            is_async: false,
+        });
+        let program = make_program(vec![
+            let_decl("msg", str_lit("hi")),
+            make_stmt_item(Stmt::Expr(expr(Expr::Call {
+                callee: Box::new(ident("setTimeout")),
+                type_args: None,
+                args: vec![callback, expr(Expr::Literal(Literal::Number(10.0)))],
+            }))),
+        ]);
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        let main = module.find_function("main").unwrap();
+        let instrs: Vec<_> = main.blocks.iter().flat_map(|b| &b.instructions).collect();
+        let args = instrs
+            .iter()
+            .find_map(|i| match i {
+                Instruction::Call { func: Value::Const(Constant::Str(name)), args, .. }
+                    if name == "zaco_set_timeout" => Some(args.clone()),
+                _ => None,
+            })
+            .expect("setTimeout should call zaco_set_timeout");
+        assert_eq!(args.len(), 3);
+        assert_eq!(args[0], Value::Const(Constant::Str("__closure_0".to_string())));
+        // The context is the closure's environment, not null
+        let ctx_temp = match &args[1] {
+            Value::Temp(t) => *t,
+            other => panic!("expected a temp context, got {:?}", other),
+        };
+        assert!(instrs.iter().any(|i| matches!(
+            i,
+            Instruction::Assign { dest, value: RValue::Use(Value::Local(_)) }
+                if *dest == Place::from_temp(ctx_temp)
+        )));
+    }
+
+    fn func_item(name: &str, is_async: bool, ret: Type, body: Vec<Node<Stmt>>) -> Node<ModuleItem> {
+        make_decl_item(Decl::Function(FunctionDecl {
+            name: Node::new(Ident::new(name), dummy_span()),
+            type_params: None,
+            params: vec![],
+            return_type: Some(Box::new(Node::new(ret, dummy_span()))),
+            body: Some(Node::new(BlockStmt { stmts: body }, dummy_span())),
+            is_async,
+            is_generator: false,
+            is_declare: false,
+        }))
+    }
+
+    fn call(name: &str) -> Node<Expr> {
+        expr(Expr::Call {
+            callee: Box::new(ident(name)),
+            type_args: None,
+            args: vec![],
+        })
+    }
+
+    #[test]
+    fn test_async_function_lowers_to_resumable_state_machine() {
+        // function one(): number { return 1; }
+        // async function run(): Promise<number> { return one() + await run(); }
+        let number = Type::Primitive(PrimitiveType::Number);
+        let promise = Type::TypeRef {
+            name: Node::new(Ident::new("Promise"), dummy_span()),
+            type_args: Some(vec![Node::new(number.clone(), dummy_span())]),
+        };
+        let sum = expr(Expr::Binary {
+            left: Box::new(call("one")),
+            op: BinaryOp::Add,
+            right: Box::new(expr(Expr::Await(Box::new(call("run"))))),
+        });
+        let program = make_program(vec![
+            func_item("one", false, number, vec![Node::new(
+                Stmt::Return(Some(expr(Expr::Literal(Literal::Number(1.0))))),
+                dummy_span(),
+            )]),
+            func_item("run", true, promise, vec![Node::new(Stmt::Return(Some(sum)), dummy_span())]),
+        ]);
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+
+        // The entry function builds the frame and runs the body to its first await
+        let entry = module.find_function("run").unwrap();
+        let entry_calls: Vec<_> = entry
+            .blocks
+            .iter()
+            .flat_map(|b| &b.instructions)
+            .filter_map(|i| match i {
+                Instruction::Call { func: Value::Const(Constant::Str(name)), .. } => Some(name.as_str()),
+                _ => None,
+            })
+            .collect();
+        assert_eq!(entry_calls, ["zaco_alloc", "zaco_promise_new", "__async_main_run_resume"]);
+
+        // The resume function dispatches on the frame's state index
+        let resume = module.find_function("__async_main_run_resume").unwrap();
+        assert_eq!(resume.params.len(), 2);
+        assert!(matches!(
+            resume.block(resume.entry_block).terminator,
+            Terminator::Branch { .. }
+        ));
+
+        // one()'s result is needed after the await, so it moves into a local
+        // that the frame saves across the suspension
+        let instrs: Vec<_> = resume.blocks.iter().flat_map(|b| &b.instructions).collect();
+        let one_temp = instrs
+            .iter()
+            .find_map(|i| match i {
+                Instruction::Call { func: Value::Const(Constant::Str(name)), dest: Some(dest), .. }
+                    if name == "one" => Some(dest.base.clone()),
+                _ => None,
+            })
+            .expect("call to one()");
+        assert!(instrs.iter().any(|i| matches!(
+            i,
+            Instruction::Assign { dest: Place { base: Value::Local(_), .. }, value: RValue::Use(v) }
+                if *v == one_temp
+        )));
+        assert!(!instrs.iter().any(|i| matches!(
+            i,
+            Instruction::Assign { value: RValue::BinaryOp { op: BinOp::Add, left, .. }, .. }
+                if *left == one_temp
+        )));
+    }
+    #[test]
+    fn test_await_rejection_branches_to_enclosing_catch() {
+        // async function guarded(): Promise<number> { try { await guarded(); } catch { return 1; } return 0; }
+        // async function bare(): Promise<number> { await bare(); return 0; }
+        let number = Type::Primitive(PrimitiveType::Number);
+        let promise = Type::TypeRef {
+            name: Node::new(Ident::new("Promise"), dummy_span()),
+            type_args: Some(vec![Node::new(number, dummy_span())]),
+        };
+        let await_stmt = |name: &str| Node::new(Stmt::Expr(expr(Expr::Await(Box::new(call(name))))), dummy_span());
+        let ret = |n: f64| Node::new(Stmt::Return(Some(expr(Expr::Literal(Literal::Number(n))))), dummy_span());
+        let guarded = Node::new(
+            Stmt::Try {
+                block: Node::new(BlockStmt { stmts: vec![await_stmt("guarded")] }, dummy_span()),
+                catch: Some(CatchClause {
+                    param: None,
+                    body: Node::new(BlockStmt { stmts: vec![ret(1.0)] }, dummy_span()),
+                }),
+                finally: None,
+            },
+            dummy_span(),
+        );
+        let program = make_program(vec![
+            func_item("guarded", true, promise.clone(), vec![guarded, ret(0.0)]),
+            func_item("bare", true, promise, vec![await_stmt("bare"), ret(0.0)]),
+        ]);
+        let module = Lowerer::new().lower_program(&program).unwrap();
+
+        // Where the exception test after the resumed await branches to
+        let rejection_target = |name: &str| {
+            let func = module.find_function(name).unwrap();
+            let block = func
+                .blocks
+                .iter()
+                .find(|b| b.instructions.iter().any(|i| matches!(
+                    i,
+                    Instruction::Call { func: Value::Const(Constant::Str(f)), .. } if f == "zaco_async_resumed"
+                )))
+                .expect("resume block calls zaco_async_resumed");
+            match &block.terminator {
+                Terminator::Branch { then_block, .. } => func.block(*then_block).clone(),
+                other => panic!("expected an exception test, got {:?}", other),
+            }
+        };
+        let rejects = |block: &crate::Block| block.instructions.iter().any(|i| matches!(
+            i,
+            Instruction::Call { func: Value::Const(Constant::Str(f)), .. } if f == "zaco_promise_reject"
+        ));
+
+        // Inside the try the rejection reaches the catch; outside it rejects
+        // the function's own promise
+        assert!(!rejects(&rejection_target("__async_main_guarded_resume")));
+        assert!(rejects(&rejection_target("__async_main_bare_resume")));
+    }
+
+    #[test]
+    fn test_async_arrows_and_methods_lower_to_state_machines() {
+        // async function tick(): Promise<number> { return 1; }
+        // class Clock { async now(): Promise<number> { return await tick(); } }
+        // let later = async () => await tick();
+        let number = Type::Primitive(PrimitiveType::Number);
+        let promise = Type::TypeRef {
+            name: Node::new(Ident::new("Promise"), dummy_span()),
+            type_args: Some(vec![Node::new(number, dummy_span())]),
+        };
+        let await_tick = || expr(Expr::Await(Box::new(call("tick"))));
+        let method = ClassMember::Method {
+            name: PropertyName::Ident(Node::new(Ident::new("now"), dummy_span())),
+            type_params: None,
+            params: vec![],
+            return_type: Some(Box::new(Node::new(promise.clone(), dummy_span()))),
+            body: Some(Node::new(
+                BlockStmt { stmts: vec![Node::new(Stmt::Return(Some(await_tick())), dummy_span())] },
+                dummy_span(),
+            )),
+            access: AccessModifier::Public,
+            is_static: false,
+            is_async: true,
+            is_abstract: false,
+            is_optional: false,
+            is_override: false,
+            decorators: vec![],
+        };
+        let program = make_program(vec![
+            func_item("tick", true, promise, vec![Node::new(
+                Stmt::Return(Some(expr(Expr::Literal(Literal::Number(1.0))))),
+                dummy_span(),
+            )]),
+            make_decl_item(Decl::Class(ClassDecl {
+                name: Node::new(Ident::new("Clock"), dummy_span()),
+                type_params: None,
+                extends: None,
+                implements: vec![],
+                members: vec![method],
+                is_abstract: false,
+                is_declare: false,
+                decorators: vec![],
+            })),
+            let_decl("later", expr(Expr::Arrow {
+                type_params: None,
+                params: vec![],
+                return_type: None,
+                body: ArrowBody::Expr(Box::new(await_tick())),
+                is_async: true,
+            })),
+        ]);
+        let module = Lowerer::new().lower_program(&program).unwrap();
+
+        // Neither blocks on the event loop: both suspend into a resume function
+        assert!(!module.extern_functions.iter().any(|f| f.name == "zaco_async_block_on"));
+        for (entry, resume) in [
+            ("Clock_now", "__async_main_Clock_now_resume"),
+            ("__closure_0", "__async_main___closure_0_resume"),
+        ] {
+            let resume_func = module.find_function(resume).expect("resume function");
+            assert!(resume_func.is_async_resume);
+            assert!(resume_func.blocks.iter().flat_map(|b| &b.instructions).any(|i| matches!(
+                i,
+                Instruction::Call { func: Value::Const(Constant::Str(f)), .. } if f == "zaco_async_await"
+            )));
+            let entry_func = module.find_function(entry).expect("entry function");
+            assert!(matches!(entry_func.return_type, IrType::Promise(_)));
+        }
+
+        // The method's entry passes `this` on to the resume function in the frame
+        let now = module.find_function("Clock_now").unwrap();
+        assert_eq!(now.params.len(), 1);
+        assert!(now.blocks.iter().flat_map(|b| &b.instructions).any(|i| matches!(
+            i,
+            Instruction::Store { value: Value::Local(LocalId(0)), .. }
+        )));
+    }
 }
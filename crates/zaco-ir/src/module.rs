@@ -2,7 +2,7 @@
 
 use std::collections::HashMap;
 
-use crate::{Constant, FuncId, IrFunction, IrStruct, IrType, StructId};
+use crate::{Constant, FuncId, Instruction, IrFunction, IrStruct, IrType, RValue, StructId};
 
 /// An extern (imported) function declaration.
 #[derive(Debug, Clone, PartialEq)]
@@ -89,17 +89,76 @@ impl IrModule {
     }
 
     /// Interns a string literal and returns its index.
-    pub fn intern_string(&mut self, s: String) -> usize {
-        if let Some(&index) = self.string_index_map.get(&s) {
+    ///
+    /// Only a literal seen for the first time is copied.
+    pub fn intern_string(&mut self, s: &str) -> usize {
+        if let Some(&index) = self.string_index_map.get(s) {
             index
         } else {
             let index = self.string_literals.len();
-            self.string_index_map.insert(s.clone(), index);
-            self.string_literals.push(s);
+            self.string_index_map.insert(s.to_string(), index);
+            self.string_literals.push(s.to_string());
             index
         }
     }
 
+    /// Shift every function and struct id in this module by the given offsets.
+    ///
+    /// Modules can then be lowered independently, each starting from id 0, and
+    /// rebased in compilation order so the merged module still has dense,
+    /// collision-free ids.
+    pub fn rebase_ids(&mut self, func_offset: usize, struct_offset: usize) {
+        if func_offset == 0 && struct_offset == 0 {
+            return;
+        }
+        self.next_func_id += func_offset;
+        self.next_struct_id += struct_offset;
+
+        for func in &mut self.functions {
+            func.id.0 += func_offset;
+            for (_, ty) in func.params.iter_mut().chain(&mut func.locals) {
+                ty.rebase_struct_ids(struct_offset);
+            }
+            for (_, ty) in &mut func.temps {
+                ty.rebase_struct_ids(struct_offset);
+            }
+            func.return_type.rebase_struct_ids(struct_offset);
+            for block in &mut func.blocks {
+                for inst in &mut block.instructions {
+                    match inst {
+                        Instruction::Alloc { ty, .. }
+                        | Instruction::StackAlloc { ty, .. }
+                        | Instruction::Assign { value: RValue::Cast { ty, .. }, .. } => {
+                            ty.rebase_struct_ids(struct_offset)
+                        }
+                        Instruction::Assign { value: RValue::StructInit { struct_id, .. }, .. } => {
+                            struct_id.0 += struct_offset
+                        }
+                        _ => {}
+                    }
+                }
+            }
+        }
+        for struct_def in &mut self.structs {
+            struct_def.id.0 += struct_offset;
+            if let Some(drop_fn) = &mut struct_def.drop_fn {
+                drop_fn.0 += func_offset;
+            }
+            for (_, ty) in &mut struct_def.fields {
+                ty.rebase_struct_ids(struct_offset);
+            }
+        }
+        for (_, ty, _) in &mut self.globals {
+            ty.rebase_struct_ids(struct_offset);
+        }
+        for ext in &mut self.extern_functions {
+            for ty in &mut ext.params {
+                ty.rebase_struct_ids(struct_offset);
+            }
+            ext.return_type.rebase_struct_ids(struct_offset);
+        }
+    }
+
     /// Gets a function by ID.
     pub fn function(&self, id: FuncId) -> Option<&IrFunction> {
         self.functions.get(id.0)
@@ -0,0 +1,1926 @@
+//! IR optimization pipeline.
+//!
+//! Passes run per module between lowering and code generation. Each pass
+//! works on `IrFunction` blocks and reports whether it changed anything; the
+//! [`PassManager`] repeats its pipeline until nothing changes (bounded by a
+//! small iteration limit so `-O` builds stay predictable).
+//!
+//! The passes only rewrite IR the translator treats identically before and
+//! after: temporaries are SSA values in the translator, so a temp with a
+//! single definition can be replaced by its source, but constants are only
+//! substituted where an operand is read purely as a value (a constant string
+//! in a call or load/store address position means a symbol, not a literal).
+
+use std::collections::{HashMap, HashSet};
+
+use crate::{
+    BinOp, Block, BlockId, Constant, Instruction, IrFunction, IrModule, IrType, LocalId,
+    Place, Projection, RValue, TempId, Terminator, UnOp, Value,
+};
+
+/// Optimization level selected by `-O`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+pub enum OptLevel {
+    /// No IR passes; fastest compile
+    #[default]
+    O0,
+    /// Cheap local cleanups: folding, copy propagation, stack promotion,
+    /// bounds-check elimination, dead code and blocks
+    O1,
+    /// `O1` plus inlining of small functions and vectorized reductions
+    O2,
+    /// `O1` plus inlining of functions no larger than a call and
+    /// vectorized reductions
+    Os,
+}
+
+impl OptLevel {
+    /// Short name used on the command line and in cache keys.
+    pub fn name(self) -> &'static str {
+        match self {
+            OptLevel::O0 => "0",
+            OptLevel::O1 => "1",
+            OptLevel::O2 => "2",
+            OptLevel::Os => "s",
+        }
+    }
+
+    /// Whether reduction loops are replaced with vectorized runtime kernels.
+    fn vectorizes_loops(self) -> bool {
+        matches!(self, OptLevel::O2 | OptLevel::Os)
+    }
+
+    /// Largest callee body (in instructions) the inliner will copy.
+    fn inline_threshold(self) -> Option<usize> {
+        match self {
+            OptLevel::O0 | OptLevel::O1 => None,
+            OptLevel::O2 => Some(12),
+            OptLevel::Os => Some(3),
+        }
+    }
+}
+
+/// A transformation over a whole module.
+pub trait Pass {
+    /// Name shown in pass statistics.
+    fn name(&self) -> &'static str;
+
+    /// Run the pass; returns whether the module changed.
+    fn run(&self, module: &mut IrModule) -> bool;
+}
+
+/// Runs an ordered list of passes to a fixed point.
+pub struct PassManager {
+    passes: Vec<Box<dyn Pass + Send + Sync>>,
+    max_iterations: usize,
+}
+
+impl PassManager {
+    /// Creates an empty pass manager.
+    pub fn new() -> Self {
+        PassManager { passes: Vec::new(), max_iterations: 4 }
+    }
+
+    /// The standard pipeline for an optimization level.
+    pub fn for_level(level: OptLevel) -> Self {
+        let mut pm = PassManager::new();
+        if level == OptLevel::O0 {
+            return pm;
+        }
+        if let Some(threshold) = level.inline_threshold() {
+            pm.add(Inline { max_instructions: threshold });
+        }
+        pm.add(ConstantFold);
+        pm.add(CopyPropagation);
+        pm.add(StackPromotion);
+        if level.vectorizes_loops() {
+            pm.add(LoopIdiomRecognition);
+        }
+        pm.add(BoundsCheckElimination);
+        pm.add(DeadCodeElimination);
+        pm.add(DeadBlockElimination);
+        pm
+    }
+
+    /// Appends a pass to the pipeline.
+    pub fn add(&mut self, pass: impl Pass + Send + Sync + 'static) {
+        self.passes.push(Box::new(pass));
+    }
+
+    /// Names of the passes in pipeline order.
+    pub fn pass_names(&self) -> Vec<&'static str> {
+        self.passes.iter().map(|p| p.name()).collect()
+    }
+
+    /// Runs the pipeline until no pass changes the module. Returns whether
+    /// anything changed.
+    pub fn run(&self, module: &mut IrModule) -> bool {
+        let mut changed_any = false;
+        for _ in 0..self.max_iterations {
+            let mut changed = false;
+            for pass in &self.passes {
+                changed |= pass.run(module);
+            }
+            changed_any |= changed;
+            if !changed {
+                break;
+            }
+        }
+        changed_any
+    }
+}
+
+impl Default for PassManager {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Optimizes `module` with the standard pipeline for `level`.
+pub fn optimize_module(module: &mut IrModule, level: OptLevel) {
+    PassManager::for_level(level).run(module);
+}
+
+fn run_on_functions(module: &mut IrModule, f: impl Fn(&mut IrFunction) -> bool) -> bool {
+    let mut changed = false;
+    for function in &mut module.functions {
+        changed |= f(function);
+    }
+    changed
+}
+
+// ============================================================================
+// Constant folding
+// ============================================================================
+
+/// Evaluates operators over constant operands, and branches on constant
+/// conditions become jumps. Folding follows the translator's semantics
+/// exactly (guarded integer division, floor-based float modulo).
+pub struct ConstantFold;
+
+impl Pass for ConstantFold {
+    fn name(&self) -> &'static str {
+        "constant-fold"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        run_on_functions(module, fold_function)
+    }
+}
+
+fn fold_function(function: &mut IrFunction) -> bool {
+    let mut changed = false;
+    for block in &mut function.blocks {
+        for inst in &mut block.instructions {
+            if let Instruction::Assign { value, .. } = inst {
+                if let Some(constant) = fold_rvalue(value) {
+                    *value = RValue::Use(Value::Const(constant));
+                    changed = true;
+                }
+            }
+        }
+
+        let folded = match &block.terminator {
+            Terminator::Branch { cond: Value::Const(c), then_block, else_block } => {
+                constant_truth(c).map(|taken| Terminator::Jump(if taken { *then_block } else { *else_block }))
+            }
+            Terminator::Branch { then_block, else_block, .. } if then_block == else_block => {
+                Some(Terminator::Jump(*then_block))
+            }
+            _ => None,
+        };
+        if let Some(terminator) = folded {
+            block.terminator = terminator;
+            changed = true;
+        }
+    }
+    changed
+}
+
+/// Whether a constant branch condition is taken, as `brif` sees it.
+fn constant_truth(c: &Constant) -> Option<bool> {
+    match c {
+        Constant::Bool(b) => Some(*b),
+        Constant::I64(n) => Some(*n != 0),
+        Constant::F64(f) => Some(*f != 0.0),
+        Constant::Null => Some(false),
+        Constant::Str(_) => None,
+    }
+}
+
+fn fold_rvalue(rvalue: &RValue) -> Option<Constant> {
+    match rvalue {
+        RValue::BinaryOp { op, left: Value::Const(l), right: Value::Const(r) } => fold_binary(*op, l, r),
+        RValue::UnaryOp { op, operand: Value::Const(c) } => fold_unary(*op, c),
+        RValue::Cast { value: Value::Const(c), ty } => fold_cast(c, ty),
+        _ => None,
+    }
+}
+
+fn fold_binary(op: BinOp, l: &Constant, r: &Constant) -> Option<Constant> {
+    use Constant::{Bool, F64, I64};
+    Some(match (l, r) {
+        (I64(a), I64(b)) => {
+            let (a, b) = (*a, *b);
+            match op {
+                BinOp::Add => I64(a.wrapping_add(b)),
+                BinOp::Sub => I64(a.wrapping_sub(b)),
+                BinOp::Mul => I64(a.wrapping_mul(b)),
+                // Division by zero yields 0; MIN / -1 traps at runtime, keep it
+                BinOp::Div if b == 0 => I64(0),
+                BinOp::Div if !(a == i64::MIN && b == -1) => I64(a / b),
+                BinOp::Mod if b == 0 => I64(0),
+                BinOp::Mod if !(a == i64::MIN && b == -1) => I64(a % b),
+                BinOp::Eq => Bool(a == b),
+                BinOp::Ne => Bool(a != b),
+                BinOp::Lt => Bool(a < b),
+                BinOp::Le => Bool(a <= b),
+                BinOp::Gt => Bool(a > b),
+                BinOp::Ge => Bool(a >= b),
+                BinOp::And | BinOp::BitAnd => I64(a & b),
+                BinOp::Or | BinOp::BitOr => I64(a | b),
+                BinOp::BitXor => I64(a ^ b),
+                BinOp::Shl => I64(a.wrapping_shl(b as u32)),
+                BinOp::Shr => I64(a.wrapping_shr(b as u32)),
+                _ => return None,
+            }
+        }
+        (F64(a), F64(b)) => {
+            let (a, b) = (*a, *b);
+            match op {
+                BinOp::Add => F64(a + b),
+                BinOp::Sub => F64(a - b),
+                BinOp::Mul => F64(a * b),
+                BinOp::Div => F64(a / b),
+                BinOp::Mod => F64(a - (a / b).floor() * b),
+                BinOp::Eq => Bool(a == b),
+                BinOp::Ne => Bool(a != b),
+                BinOp::Lt => Bool(a < b),
+                BinOp::Le => Bool(a <= b),
+                BinOp::Gt => Bool(a > b),
+                BinOp::Ge => Bool(a >= b),
+                _ => return None,
+            }
+        }
+        (Bool(a), Bool(b)) => {
+            let (a, b) = (*a, *b);
+            match op {
+                BinOp::And | BinOp::BitAnd => Bool(a && b),
+                BinOp::Or | BinOp::BitOr => Bool(a || b),
+                BinOp::BitXor | BinOp::Ne => Bool(a != b),
+                BinOp::Eq => Bool(a == b),
+                _ => return None,
+            }
+        }
+        _ => return None,
+    })
+}
+
+fn fold_unary(op: UnOp, c: &Constant) -> Option<Constant> {
+    Some(match (op, c) {
+        (UnOp::Neg, Constant::I64(n)) => Constant::I64(n.wrapping_neg()),
+        (UnOp::Neg, Constant::F64(f)) => Constant::F64(-f),
+        (UnOp::BitNot, Constant::I64(n)) => Constant::I64(!n),
+        (UnOp::Not, Constant::Bool(b)) => Constant::Bool(!b),
+        // `!x` on a float is true for 0.0 and NaN
+        (UnOp::Not, Constant::F64(f)) => Constant::Bool(*f == 0.0 || f.is_nan()),
+        _ => return None,
+    })
+}
+
+fn fold_cast(c: &Constant, ty: &IrType) -> Option<Constant> {
+    Some(match (c, ty) {
+        (Constant::I64(n), IrType::I64) => Constant::I64(*n),
+        (Constant::I64(n), IrType::F64) => Constant::F64(*n as f64),
+        // Saturating, NaN → 0, like fcvt_to_sint_sat
+        (Constant::F64(f), IrType::I64) => Constant::I64(*f as i64),
+        (Constant::F64(f), IrType::F64) => Constant::F64(*f),
+        (Constant::Bool(b), IrType::Bool) => Constant::Bool(*b),
+        (Constant::Bool(b), IrType::I64) => Constant::I64(*b as i64),
+        (Constant::Bool(b), IrType::F64) => Constant::F64(*b as i64 as f64),
+        _ => return None,
+    })
+}
+
+// ============================================================================
+// Copy propagation
+// ============================================================================
+
+/// Replaces uses of a single-definition temp `t = v` with `v`, where `v` is
+/// a constant or another single-definition temp of the same type.
+pub struct CopyPropagation;
+
+impl Pass for CopyPropagation {
+    fn name(&self) -> &'static str {
+        "copy-propagation"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        run_on_functions(module, propagate_copies)
+    }
+}
+
+fn definition_counts(function: &IrFunction) -> HashMap<TempId, usize> {
+    let mut defs = HashMap::new();
+    for block in &function.blocks {
+        for inst in &block.instructions {
+            if let Some(temp) = inst.dest_temp() {
+                *defs.entry(temp).or_insert(0) += 1;
+            }
+        }
+    }
+    defs
+}
+
+fn temp_type(function: &IrFunction, temp: TempId) -> Option<&IrType> {
+    function.temps.get(temp.0).filter(|(id, _)| *id == temp).map(|(_, ty)| ty)
+}
+
+fn propagate_copies(function: &mut IrFunction) -> bool {
+    let defs = definition_counts(function);
+    let single = |t: &TempId| defs.get(t) == Some(&1);
+
+    let mut copies: HashMap<TempId, Value> = HashMap::new();
+    for block in &function.blocks {
+        for inst in &block.instructions {
+            let Instruction::Assign { value: RValue::Use(source), .. } = inst else {
+                continue;
+            };
+            let Some(temp) = inst.dest_temp() else { continue };
+            if !single(&temp) {
+                continue;
+            }
+            let propagate = match source {
+                Value::Const(_) => true,
+                Value::Temp(src) => {
+                    *src != temp && single(src) && temp_type(function, *src) == temp_type(function, temp)
+                }
+                Value::Local(_) => false,
+            };
+            if propagate {
+                copies.insert(temp, source.clone());
+            }
+        }
+    }
+    if copies.is_empty() {
+        return false;
+    }
+
+    // Resolve chains (t2 = t1, t1 = 5) so one rewrite reaches the root
+    let resolve = |value: &Value| -> Option<Value> {
+        let mut current = value.clone();
+        let mut steps = 0;
+        while let Value::Temp(t) = current {
+            match copies.get(&t) {
+                Some(next) if steps < copies.len() => {
+                    current = next.clone();
+                    steps += 1;
+                }
+                _ => break,
+            }
+        }
+        (current != *value).then_some(current)
+    };
+
+    let mut changed = false;
+    let mut rewrite = |slot: &mut Value, allow_const: bool| {
+        if let Some(replacement) = resolve(slot) {
+            if allow_const || !matches!(replacement, Value::Const(_)) {
+                *slot = replacement;
+                changed = true;
+            }
+        }
+    };
+
+    for block in &mut function.blocks {
+        for inst in &mut block.instructions {
+            // Temps may replace temps anywhere; constants only in value positions
+            for slot in value_operands_mut(inst) {
+                rewrite(slot, true);
+            }
+            for slot in inst.operands_mut() {
+                rewrite(slot, false);
+            }
+        }
+        for slot in block.terminator.operands_mut() {
+            rewrite(slot, true);
+        }
+    }
+    changed
+}
+
+/// Operands the translator reads only as a value, so any equal value
+/// (including a constant) can stand in for them.
+fn value_operands_mut(inst: &mut Instruction) -> Vec<&mut Value> {
+    match inst {
+        Instruction::Assign { value, .. } => value.operands_mut(),
+        Instruction::Call { args, .. } => args.iter_mut().collect(),
+        Instruction::Return(value) => value.iter_mut().collect(),
+        Instruction::Branch { cond, .. } => vec![cond],
+        Instruction::Store { value, .. } => vec![value],
+        _ => Vec::new(),
+    }
+}
+
+/// Whether `inst` assigns `value` as a whole (not a field of it).
+fn redefines(inst: &Instruction, value: &Value) -> bool {
+    let dest = match inst {
+        Instruction::Assign { dest, .. }
+        | Instruction::Alloc { dest, .. }
+        | Instruction::StackAlloc { dest, .. }
+        | Instruction::Clone { dest, .. }
+        | Instruction::Load { dest, .. } => dest,
+        Instruction::Call { dest: Some(dest), .. } => dest,
+        _ => return false,
+    };
+    dest.projections.is_empty() && dest.base == *value
+}
+
+// ============================================================================
+// Stack promotion
+// ============================================================================
+
+/// Inline-array helpers that only read through the array pointer and never
+/// retain it.
+const NON_CAPTURING_ARRAY_FNS: &[&str] = &[
+    "zaco_array_length",
+    "zaco_array_get_f64",
+    "zaco_array_get_ptr",
+    "zaco_array_get_f64_unchecked",
+    "zaco_array_get_ptr_unchecked",
+    "zaco_array_index_of_f64",
+    "zaco_array_fold_max_f64",
+    "zaco_array_fold_min_f64",
+];
+
+/// Escape analysis: struct allocations and array literals whose pointer
+/// never leaves the function move to the stack.
+///
+/// The pointer may be copied into single-definition temps and locals and
+/// offset into field addresses, but every alias may only be loaded and
+/// stored through, compared, or passed to a non-capturing array helper.
+/// Storing it as a value, returning it, cloning it or passing it to any
+/// other call lets it escape. The promoted object needs no refcounting, so
+/// its `RefCount` and `Free` instructions are dropped.
+///
+/// An allocation inside a loop reuses one stack slot per iteration, so
+/// there every alias must be used in the allocating block after the
+/// allocation; otherwise a use could observe the next iteration's object.
+pub struct StackPromotion;
+
+impl Pass for StackPromotion {
+    fn name(&self) -> &'static str {
+        "stack-promotion"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        run_on_functions(module, promote_allocations)
+    }
+}
+
+/// A temp or local, the values that can hold an object pointer.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+enum Var {
+    Temp(TempId),
+    Local(LocalId),
+}
+
+impl Var {
+    fn value(self) -> Value {
+        match self {
+            Var::Temp(t) => Value::Temp(t),
+            Var::Local(l) => Value::Local(l),
+        }
+    }
+
+    fn of(value: &Value) -> Option<Var> {
+        match value {
+            Value::Temp(t) => Some(Var::Temp(*t)),
+            Value::Local(l) => Some(Var::Local(*l)),
+            Value::Const(_) => None,
+        }
+    }
+}
+
+fn promote_allocations(function: &mut IrFunction) -> bool {
+    if function.blocks.iter().enumerate().any(|(i, b)| b.id != BlockId(i)) {
+        return false;
+    }
+    let defs = whole_value_definitions(function);
+    let params: HashSet<Var> = function.params.iter().map(|(l, _)| Var::Local(*l)).collect();
+    let single = |v: Var| defs.get(&v) == Some(&1) && !params.contains(&v);
+
+    let mut candidates = Vec::new();
+    for (block_index, block) in function.blocks.iter().enumerate() {
+        for (inst_index, inst) in block.instructions.iter().enumerate() {
+            let (dest, is_array) = match inst {
+                Instruction::Alloc { dest, ty: IrType::Struct(_) } => (dest, false),
+                Instruction::Assign { dest, value: RValue::ArrayInit(_) } => (dest, true),
+                _ => continue,
+            };
+            match Var::of(&dest.base) {
+                Some(root) if dest.projections.is_empty() && single(root) => {
+                    candidates.push((block_index, inst_index, root, is_array));
+                }
+                _ => {}
+            }
+        }
+    }
+
+    let mut changed = false;
+    for (block_index, inst_index, root, is_array) in candidates {
+        let aliases = pointer_aliases(function, root, &single);
+        if !is_confined(function, &aliases, is_array) {
+            continue;
+        }
+        if in_cycle(function, block_index) && !used_after_in_block(function, block_index, inst_index, &aliases) {
+            continue;
+        }
+
+        let inst = &mut function.blocks[block_index].instructions[inst_index];
+        *inst = match std::mem::replace(inst, Instruction::Jump(BlockId(0))) {
+            Instruction::Alloc { dest, ty } => Instruction::StackAlloc { dest, ty },
+            Instruction::Assign { dest, value: RValue::ArrayInit(values) } => {
+                Instruction::Assign { dest, value: RValue::StackArrayInit(values) }
+            }
+            other => other,
+        };
+        let is_alias = |v: &Value| Var::of(v).is_some_and(|v| aliases.contains(&v));
+        for block in &mut function.blocks {
+            block.instructions.retain(|inst| {
+                !matches!(inst, Instruction::RefCount { value, .. } | Instruction::Free { value } if is_alias(value))
+            });
+        }
+        changed = true;
+    }
+    changed
+}
+
+/// How often each temp and local is assigned as a whole.
+fn whole_value_definitions(function: &IrFunction) -> HashMap<Var, usize> {
+    let mut defs = HashMap::new();
+    for block in &function.blocks {
+        for inst in &block.instructions {
+            let dest = match inst {
+                Instruction::Assign { dest, .. }
+                | Instruction::Alloc { dest, .. }
+                | Instruction::StackAlloc { dest, .. }
+                | Instruction::Clone { dest, .. }
+                | Instruction::Load { dest, .. } => dest,
+                Instruction::Call { dest: Some(dest), .. } => dest,
+                _ => continue,
+            };
+            if let Some(var) = Var::of(&dest.base).filter(|_| dest.projections.is_empty()) {
+                *defs.entry(var).or_insert(0) += 1;
+            }
+        }
+    }
+    defs
+}
+
+/// `root` plus every single-definition value that holds a copy of it or a
+/// pointer offset from it.
+fn pointer_aliases(function: &IrFunction, root: Var, single: &impl Fn(Var) -> bool) -> HashSet<Var> {
+    let mut aliases = HashSet::from([root]);
+    loop {
+        let before = aliases.len();
+        for inst in function.blocks.iter().flat_map(|b| &b.instructions) {
+            let Instruction::Assign { dest, value } = inst else { continue };
+            let is_alias = |v: &Value| Var::of(v).is_some_and(|v| aliases.contains(&v));
+            let source = match value {
+                RValue::Use(source) => source,
+                RValue::BinaryOp { op: BinOp::Add, left, right } if !is_alias(right) => left,
+                _ => continue,
+            };
+            if !is_alias(source) || !dest.projections.is_empty() {
+                continue;
+            }
+            if let Some(var) = Var::of(&dest.base).filter(|v| single(*v)) {
+                aliases.insert(var);
+            }
+        }
+        if aliases.len() == before {
+            return aliases;
+        }
+    }
+}
+
+/// Whether every mention of `aliases` only reads or writes through the
+/// pointer.
+fn is_confined(function: &IrFunction, aliases: &HashSet<Var>, is_array: bool) -> bool {
+    let is_alias = |v: &Value| Var::of(v).is_some_and(|v| aliases.contains(&v));
+    // Memory inside the object is fine; the pointer used as an index is not
+    let place_ok = |p: &Place| {
+        !p.projections.iter().any(|proj| matches!(proj, Projection::Index(v) if is_alias(v)))
+    };
+
+    function.blocks.iter().all(|block| {
+        let terminator_ok = match &block.terminator {
+            Terminator::Return(Some(v)) => !is_alias(v),
+            _ => true,
+        };
+        terminator_ok
+            && block.instructions.iter().all(|inst| match inst {
+                Instruction::Alloc { dest, .. } | Instruction::StackAlloc { dest, .. } => place_ok(dest),
+                Instruction::Assign { dest, value } => {
+                    place_ok(dest)
+                        && match value {
+                            // The alias definitions collected above
+                            RValue::Use(source) | RValue::BinaryOp { op: BinOp::Add, left: source, .. }
+                                if is_alias(source) =>
+                            {
+                                dest.projections.is_empty() && is_alias(&dest.base)
+                            }
+                            // Comparisons produce a bool, not a copy
+                            RValue::BinaryOp { op: BinOp::Eq | BinOp::Ne, .. } => !is_alias(&dest.base),
+                            _ => !value.operands().into_iter().any(is_alias),
+                        }
+                }
+                Instruction::Load { dest, .. } => place_ok(dest),
+                Instruction::Store { value, .. } => !is_alias(value),
+                Instruction::RefCount { .. } | Instruction::Free { .. } => true,
+                Instruction::Call { dest, func, args } => {
+                    let passes_alias = args.iter().any(is_alias);
+                    let non_capturing = is_array
+                        && matches!(func, Value::Const(Constant::Str(name)) if NON_CAPTURING_ARRAY_FNS.contains(&name.as_str()));
+                    !is_alias(func) && dest.as_ref().map_or(true, place_ok) && (!passes_alias || non_capturing)
+                }
+                Instruction::Clone { dest, source } => !is_alias(source) && place_ok(dest),
+                Instruction::Return(value) => !value.as_ref().is_some_and(is_alias),
+                Instruction::Branch { .. } | Instruction::Jump(_) => true,
+            })
+    })
+}
+
+/// Whether block `block_index` can reach itself.
+fn in_cycle(function: &IrFunction, block_index: usize) -> bool {
+    let mut seen = vec![false; function.blocks.len()];
+    let mut stack = block_targets(&function.blocks[block_index]);
+    while let Some(id) = stack.pop() {
+        if id.0 == block_index {
+            return true;
+        }
+        if id.0 >= seen.len() || seen[id.0] {
+            continue;
+        }
+        seen[id.0] = true;
+        stack.extend(block_targets(&function.blocks[id.0]));
+    }
+    false
+}
+
+/// Whether every mention of `aliases` is in block `block_index` after
+/// instruction `inst_index`.
+fn used_after_in_block(function: &IrFunction, block_index: usize, inst_index: usize, aliases: &HashSet<Var>) -> bool {
+    let is_alias = |v: &Value| Var::of(v).is_some_and(|v| aliases.contains(&v));
+    let mentions = |inst: &Instruction| {
+        inst.operands().into_iter().any(is_alias)
+            || aliases.iter().any(|alias| redefines(inst, &alias.value()))
+    };
+    function.blocks.iter().enumerate().all(|(index, block)| {
+        if index != block_index {
+            let in_terminator = block.terminator.operands().into_iter().any(is_alias);
+            return !in_terminator && !block.instructions.iter().any(mentions);
+        }
+        !block.instructions[..inst_index].iter().any(mentions)
+    })
+}
+
+// ============================================================================
+// Bounds-check elimination
+// ============================================================================
+
+/// Checked array getters and the unchecked form each is replaced with.
+const CHECKED_ARRAY_GETTERS: &[(&str, &str)] = &[
+    ("zaco_array_get_f64", "zaco_array_get_f64_unchecked"),
+    ("zaco_array_get_ptr", "zaco_array_get_ptr_unchecked"),
+];
+
+/// Runtime calls that never change the length of an existing array (nor
+/// call back into user code that could).
+fn preserves_array_lengths(name: &str) -> bool {
+    NON_CAPTURING_ARRAY_FNS.contains(&name)
+        || name == "zaco_array_reverse"
+        || ["zaco_print", "zaco_console_", "zaco_math_", "zaco_str_", "zaco_strbuf_"]
+            .iter()
+            .any(|prefix| name.starts_with(prefix))
+}
+
+/// Drops the bounds checks of array reads in counted loops.
+///
+/// A loop header that branches on `i < n`, where `n` is the length of an
+/// array `a` (`zaco_array_length(a)`, possibly cast to `f64`), proves every
+/// `a[i]` in the loop body in range as long as:
+///
+/// - `i` only ever holds non-negative integers (every assignment is a
+///   constant or `i + k`, both non-negative integers),
+/// - `i` is not reassigned between the check and the read,
+/// - neither `a` nor its length can change inside the loop (no
+///   reassignment and no calls other than length-preserving runtime
+///   helpers), and `n` is computed in the header or right before it.
+///
+/// Such reads become `zaco_array_get_*_unchecked`, which the translator
+/// expands to a plain indexed load. A null array has length 0, so the loop
+/// body never runs for it.
+pub struct BoundsCheckElimination;
+
+impl Pass for BoundsCheckElimination {
+    fn name(&self) -> &'static str {
+        "bounds-check-elimination"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        run_on_functions(module, eliminate_bounds_checks)
+    }
+}
+
+/// A counted loop `header: if i < length(array) { body... }`.
+struct CountedLoop {
+    counter: LocalId,
+    array: Value,
+    /// Blocks of the loop body, excluding the header
+    body: HashSet<usize>,
+}
+
+fn eliminate_bounds_checks(function: &mut IrFunction) -> bool {
+    if function.blocks.iter().enumerate().any(|(i, b)| b.id != BlockId(i)) {
+        return false;
+    }
+    let defs = definition_counts(function);
+    let mut changed = false;
+    for header in 0..function.blocks.len() {
+        let Some(counted) = counted_loop(function, header, &defs) else { continue };
+        for (block, index) in proven_reads(function, header, &counted, &defs) {
+            if let Instruction::Call { func: Value::Const(Constant::Str(name)), .. } =
+                &mut function.blocks[block].instructions[index]
+            {
+                if let Some((_, unchecked)) = CHECKED_ARRAY_GETTERS.iter().find(|(checked, _)| name == checked) {
+                    *name = unchecked.to_string();
+                    changed = true;
+                }
+            }
+        }
+    }
+    changed
+}
+
+/// The single instruction defining `temp`, as (block, index).
+fn temp_definition(function: &IrFunction, temp: TempId, defs: &HashMap<TempId, usize>) -> Option<(usize, usize)> {
+    if defs.get(&temp) != Some(&1) {
+        return None;
+    }
+    function.blocks.iter().enumerate().find_map(|(b, block)| {
+        block.instructions.iter().position(|inst| inst.dest_temp() == Some(temp)).map(|i| (b, i))
+    })
+}
+
+fn counted_loop(function: &IrFunction, header: usize, defs: &HashMap<TempId, usize>) -> Option<CountedLoop> {
+    let block = &function.blocks[header];
+    let Terminator::Branch { cond: Value::Temp(cond), then_block, else_block } = &block.terminator else {
+        return None;
+    };
+    let (cond_block, cond_index) = temp_definition(function, *cond, defs)?;
+    if cond_block != header {
+        return None;
+    }
+    let Instruction::Assign { value: RValue::BinaryOp { op: BinOp::Lt, left: Value::Local(counter), right: bound }, .. } =
+        &block.instructions[cond_index]
+    else {
+        return None;
+    };
+    let counter_ty = function.locals.iter().find(|(l, _)| l == counter).map(|(_, ty)| ty)?;
+    let counter_value = Value::Local(*counter);
+    if block.instructions[cond_index + 1..].iter().any(|inst| redefines(inst, &counter_value)) {
+        return None;
+    }
+
+    // The bound is the array length, cast to the counter's type if needed
+    let Value::Temp(bound) = bound else { return None };
+    let (mut len_block, mut len_index) = temp_definition(function, *bound, defs)?;
+    if *counter_ty == IrType::F64 {
+        let Instruction::Assign { value: RValue::Cast { value: Value::Temp(len), ty: IrType::F64 }, .. } =
+            &function.blocks[len_block].instructions[len_index]
+        else {
+            return None;
+        };
+        (len_block, len_index) = temp_definition(function, *len, defs)?;
+    } else if *counter_ty != IrType::I64 {
+        return None;
+    }
+    let Instruction::Call { func: Value::Const(Constant::Str(len_fn)), args, .. } =
+        &function.blocks[len_block].instructions[len_index]
+    else {
+        return None;
+    };
+    let [array] = args.as_slice() else { return None };
+    if len_fn != "zaco_array_length" || matches!(array, Value::Const(_)) {
+        return None;
+    }
+
+    let body = loop_body(function, header, then_block.0, else_block.0)?;
+    // Nothing between computing the length and the check may change it
+    let after_length: Vec<&Instruction> = if len_block == header {
+        block.instructions[len_index + 1..cond_index].iter().collect()
+    } else if block_targets(&function.blocks[len_block]) == [BlockId(header)] {
+        function.blocks[len_block].instructions[len_index + 1..]
+            .iter()
+            .chain(&block.instructions[..cond_index])
+            .collect()
+    } else {
+        return None;
+    };
+    let loop_insts = body.iter().flat_map(|&b| &function.blocks[b].instructions).chain(&block.instructions);
+    let stable = |inst: &Instruction| {
+        let keeps_length = match inst {
+            Instruction::Call { func: Value::Const(Constant::Str(name)), .. } => preserves_array_lengths(name),
+            Instruction::Call { .. } | Instruction::Free { .. } => false,
+            _ => true,
+        };
+        keeps_length && !redefines(inst, array)
+    };
+    if !after_length.into_iter().chain(loop_insts).all(stable) {
+        return None;
+    }
+    if !counter_is_non_negative_integer(function, *counter, defs) {
+        return None;
+    }
+    Some(CountedLoop { counter: *counter, array: array.clone(), body })
+}
+
+/// Blocks reachable from `entry` without passing through `header` or
+/// `exit`. `None` if `exit` leads back into them other than through the
+/// header, i.e. the loop isn't a simple counted loop.
+fn loop_body(function: &IrFunction, header: usize, entry: usize, exit: usize) -> Option<HashSet<usize>> {
+    let body = reachable_within(function, &[BlockId(entry)], &[header, exit]);
+    let after_exit = reachable_within(function, &block_targets(&function.blocks[exit]), &[header]);
+    if after_exit.iter().any(|b| body.contains(b)) {
+        return None;
+    }
+    Some(body)
+}
+
+/// Blocks reachable from `starts`, stopping at (and excluding) `stops`.
+fn reachable_within(function: &IrFunction, starts: &[BlockId], stops: &[usize]) -> HashSet<usize> {
+    let mut seen = HashSet::new();
+    let mut stack: Vec<BlockId> = starts.to_vec();
+    while let Some(id) = stack.pop() {
+        if id.0 >= function.blocks.len() || stops.contains(&id.0) || !seen.insert(id.0) {
+            continue;
+        }
+        stack.extend(block_targets(&function.blocks[id.0]));
+    }
+    seen
+}
+
+/// Whether every assignment to `counter` is a non-negative integer constant
+/// or `counter + k` for a non-negative integer `k`.
+fn counter_is_non_negative_integer(function: &IrFunction, counter: LocalId, defs: &HashMap<TempId, usize>) -> bool {
+    let counter_value = Value::Local(counter);
+    let non_negative_integer = |c: &Constant| match c {
+        Constant::I64(n) => *n >= 0,
+        Constant::F64(f) => *f >= 0.0 && f.fract() == 0.0 && *f < 9.0e15,
+        _ => false,
+    };
+    let is_increment = |rvalue: &RValue| {
+        matches!(rvalue, RValue::BinaryOp { op: BinOp::Add, left, right: Value::Const(k) }
+            if *left == counter_value && non_negative_integer(k))
+    };
+    function.blocks.iter().flat_map(|b| &b.instructions).all(|inst| {
+        if !redefines(inst, &counter_value) {
+            return true;
+        }
+        match inst {
+            Instruction::Assign { value: RValue::Use(Value::Const(c)), .. } => non_negative_integer(c),
+            Instruction::Assign { value, .. } if is_increment(value) => true,
+            Instruction::Assign { value: RValue::Use(Value::Temp(t)), .. } => {
+                temp_definition(function, *t, defs).is_some_and(|(b, i)| {
+                    matches!(&function.blocks[b].instructions[i], Instruction::Assign { value, .. } if is_increment(value))
+                })
+            }
+            _ => false,
+        }
+    })
+}
+
+/// Reads `array[counter]` in the loop body whose index provably still holds
+/// the value the header compared.
+fn proven_reads(
+    function: &IrFunction,
+    header: usize,
+    counted: &CountedLoop,
+    defs: &HashMap<TempId, usize>,
+) -> Vec<(usize, usize)> {
+    let counter_value = Value::Local(counted.counter);
+    let Terminator::Branch { else_block, .. } = &function.blocks[header].terminator else {
+        return Vec::new();
+    };
+
+    // Blocks where the counter may already have been changed since the check
+    let mut clobbered: HashSet<usize> = HashSet::new();
+    let mut clobbered_from: HashMap<usize, usize> = HashMap::new();
+    for &b in &counted.body {
+        if let Some(first) = function.blocks[b].instructions.iter().position(|inst| redefines(inst, &counter_value)) {
+            clobbered_from.insert(b, first);
+            let after = reachable_within(function, &block_targets(&function.blocks[b]), &[header, else_block.0]);
+            clobbered.extend(after);
+        }
+    }
+
+    let mut reads = Vec::new();
+    for &b in &counted.body {
+        if clobbered.contains(&b) {
+            continue;
+        }
+        let limit = clobbered_from.get(&b).copied().unwrap_or(usize::MAX);
+        for (index, inst) in function.blocks[b].instructions.iter().enumerate() {
+            let Instruction::Call { func: Value::Const(Constant::Str(name)), args, .. } = inst else { continue };
+            let [array, idx] = args.as_slice() else { continue };
+            let getter = CHECKED_ARRAY_GETTERS.iter().any(|(checked, unchecked)| name == checked || name == unchecked);
+            if !getter || *array != counted.array {
+                continue;
+            }
+            // Where the counter is read: directly, or through `t = (i64) i`
+            let read_at = match idx {
+                Value::Local(l) if *l == counted.counter => Some((b, index)),
+                Value::Temp(t) => temp_definition(function, *t, defs).filter(|&(tb, ti)| {
+                    matches!(
+                        &function.blocks[tb].instructions[ti],
+                        Instruction::Assign { value: RValue::Cast { value, ty: IrType::I64 }, .. } if *value == counter_value
+                    )
+                }),
+                _ => None,
+            };
+            if let Some((read_block, read_index)) = read_at {
+                if read_block == b && read_index <= index && read_index < limit {
+                    reads.push((b, index));
+                }
+            }
+        }
+    }
+    reads
+}
+
+// ============================================================================
+// Loop idiom recognition
+// ============================================================================
+
+/// Reductions recognized in counted loops and the runtime kernel computing
+/// each over a whole array.
+const FOLD_KERNELS: &[(&str, &str)] = &[
+    ("zaco_math_max", "zaco_array_fold_max_f64"),
+    ("zaco_math_min", "zaco_array_fold_min_f64"),
+];
+
+/// Replaces `Math.max`/`Math.min` reductions over `number[]` with the
+/// runtime's vectorized fold kernels.
+///
+/// The loop must be a counted loop (see [`BoundsCheckElimination`]) whose
+/// counter starts at 0 and steps by 1, and whose body only computes
+/// `acc = zaco_math_max(acc, a[i])` and the increment. The kernel gives
+/// exactly the sequential fold's result, so the loop becomes: compute the
+/// fold, set the counter to the length, skip the loop. Sums are left alone,
+/// as vectorizing them would reassociate floating-point addition.
+pub struct LoopIdiomRecognition;
+
+impl Pass for LoopIdiomRecognition {
+    fn name(&self) -> &'static str {
+        "loop-idiom"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        let mut kernels: Vec<&'static str> = Vec::new();
+        for function in &mut module.functions {
+            kernels.extend(recognize_folds(function));
+        }
+        for kernel in &kernels {
+            if !module.extern_functions.iter().any(|ext| ext.name == *kernel) {
+                module.add_extern_function(kernel.to_string(), vec![IrType::Ptr, IrType::F64], IrType::F64);
+            }
+        }
+        !kernels.is_empty()
+    }
+}
+
+/// A counted loop computing `acc = fold(acc, array[counter])`.
+struct FoldLoop {
+    preheader: usize,
+    exit: BlockId,
+    counter: LocalId,
+    counter_ty: IrType,
+    array: Value,
+    acc: LocalId,
+    kernel: &'static str,
+}
+
+/// Rewrites every fold loop in `function`; returns the kernels it now calls.
+fn recognize_folds(function: &mut IrFunction) -> Vec<&'static str> {
+    if function.blocks.iter().enumerate().any(|(i, b)| b.id != BlockId(i)) {
+        return Vec::new();
+    }
+    let mut kernels = Vec::new();
+    for header in 0..function.blocks.len() {
+        let defs = definition_counts(function);
+        let Some(fold) = fold_loop(function, header, &defs) else { continue };
+
+        let result = function.add_temp(IrType::F64);
+        let length = function.add_temp(IrType::I64);
+        let mut insts = vec![
+            Instruction::Call {
+                dest: Some(Place::from_temp(result)),
+                func: Value::Const(Constant::Str(fold.kernel.to_string())),
+                args: vec![fold.array.clone(), Value::Local(fold.acc)],
+            },
+            Instruction::Assign { dest: Place::from_local(fold.acc), value: RValue::Use(Value::Temp(result)) },
+            Instruction::Call {
+                dest: Some(Place::from_temp(length)),
+                func: Value::Const(Constant::Str("zaco_array_length".to_string())),
+                args: vec![fold.array.clone()],
+            },
+        ];
+        // The counter ends where the loop would have left it
+        let final_count = if fold.counter_ty == IrType::F64 {
+            let cast = function.add_temp(IrType::F64);
+            insts.push(Instruction::Assign {
+                dest: Place::from_temp(cast),
+                value: RValue::Cast { value: Value::Temp(length), ty: IrType::F64 },
+            });
+            cast
+        } else {
+            length
+        };
+        insts.push(Instruction::Assign {
+            dest: Place::from_local(fold.counter),
+            value: RValue::Use(Value::Temp(final_count)),
+        });
+        function.blocks[fold.preheader].instructions.extend(insts);
+        function.blocks[header].terminator = Terminator::Jump(fold.exit);
+        kernels.push(fold.kernel);
+    }
+    kernels
+}
+
+fn fold_loop(function: &IrFunction, header: usize, defs: &HashMap<TempId, usize>) -> Option<FoldLoop> {
+    let counted = counted_loop(function, header, defs)?;
+    let Terminator::Branch { else_block: exit, .. } = function.blocks[header].terminator else {
+        return None;
+    };
+    let counter_ty = function.locals.iter().find(|(l, _)| *l == counted.counter).map(|(_, ty)| ty.clone())?;
+    let counter = Value::Local(counted.counter);
+
+    // The header runs once instead of n + 1 times, so it must be pure
+    let pure_header = function.blocks[header].instructions.iter().all(|inst| match inst {
+        Instruction::Assign { .. } => inst.dest_temp().is_some(),
+        Instruction::Call { func: Value::Const(Constant::Str(name)), .. } => name == "zaco_array_length",
+        _ => false,
+    });
+    if !pure_header {
+        return None;
+    }
+
+    // A single outside predecessor that sets the counter to 0 last
+    let outside: Vec<usize> = (0..function.blocks.len())
+        .filter(|b| *b != header && !counted.body.contains(b))
+        .filter(|b| block_targets(&function.blocks[*b]).contains(&BlockId(header)))
+        .collect();
+    let [preheader] = outside.as_slice() else { return None };
+    if function.blocks[*preheader].terminator != Terminator::Jump(BlockId(header)) {
+        return None;
+    }
+    let starts_at_zero = function.blocks[*preheader].instructions.iter().rev().find(|inst| redefines(inst, &counter));
+    let zero = |c: &Constant| match c {
+        Constant::I64(n) => *n == 0,
+        Constant::F64(f) => *f == 0.0 && f.is_sign_positive(),
+        _ => false,
+    };
+    if !matches!(starts_at_zero, Some(Instruction::Assign { value: RValue::Use(Value::Const(c)), .. }) if zero(c)) {
+        return None;
+    }
+
+    // The body: one read, one fold into `acc`, the increment, nothing else
+    let is_one = |v: &Value| matches!(v, Value::Const(Constant::I64(1)) | Value::Const(Constant::F64(1.0)));
+    let mut read = None;
+    let mut step = None;
+    let mut store = None;
+    for &b in &counted.body {
+        let block = &function.blocks[b];
+        if !matches!(block.terminator, Terminator::Jump(_)) {
+            return None;
+        }
+        for (index, inst) in block.instructions.iter().enumerate() {
+            match inst {
+                Instruction::Call { dest: Some(dest), func: Value::Const(Constant::Str(name)), args } => {
+                    if let Some((_, kernel)) = FOLD_KERNELS.iter().find(|(f, _)| name == f) {
+                        let [Value::Local(acc), Value::Temp(elem)] = args.as_slice() else { return None };
+                        let Place { base: Value::Temp(result), .. } = dest else { return None };
+                        if step.replace((*acc, *elem, *result, *kernel)).is_some() {
+                            return None;
+                        }
+                    } else if name.starts_with("zaco_array_get_f64") {
+                        if read.replace((b, index)).is_some() {
+                            return None;
+                        }
+                    } else {
+                        return None;
+                    }
+                }
+                Instruction::Assign { dest, value } if dest.projections.is_empty() => match (&dest.base, value) {
+                    (Value::Temp(_), RValue::Cast { value, ty: IrType::I64 }) if *value == counter => {}
+                    (Value::Temp(_), RValue::BinaryOp { op: BinOp::Add, left, right }) if *left == counter && is_one(right) => {}
+                    (Value::Local(l), RValue::BinaryOp { op: BinOp::Add, left, right })
+                        if *l == counted.counter && *left == counter && is_one(right) => {}
+                    (Value::Local(l), RValue::Use(Value::Temp(_))) if *l == counted.counter => {}
+                    (Value::Local(l), RValue::Use(Value::Temp(t))) => {
+                        if store.replace((*l, *t)).is_some() {
+                            return None;
+                        }
+                    }
+                    _ => return None,
+                },
+                _ => return None,
+            }
+        }
+    }
+    let (acc, elem, result, kernel) = step?;
+    let (read_block, read_index) = read?;
+    if store != Some((acc, result)) || acc == counted.counter || Value::Local(acc) == counted.array {
+        return None;
+    }
+    if function.locals.iter().find(|(l, _)| *l == acc).map(|(_, ty)| ty) != Some(&IrType::F64) {
+        return None;
+    }
+    // Counter updates must all be `i + 1` (checked above for the direct
+    // form; `i = t` needs `t` to be one)
+    let increments = counted.body.iter().flat_map(|&b| &function.blocks[b].instructions).all(|inst| match inst {
+        Instruction::Assign { dest, value: RValue::Use(Value::Temp(t)) } if dest.base == counter => {
+            temp_definition(function, *t, defs).is_some_and(|(tb, ti)| {
+                matches!(&function.blocks[tb].instructions[ti],
+                    Instruction::Assign { value: RValue::BinaryOp { op: BinOp::Add, left, right }, .. }
+                        if *left == counter && is_one(right))
+            })
+        }
+        _ => true,
+    });
+    if !increments {
+        return None;
+    }
+    // The read is `array[counter]` in range, its value only feeds the fold,
+    // and the fold's result only feeds `acc`
+    if !proven_reads(function, header, &counted, defs).contains(&(read_block, read_index)) {
+        return None;
+    }
+    if function.blocks[read_block].instructions[read_index].dest_temp() != Some(elem) {
+        return None;
+    }
+    let reads_of = |temp: TempId| {
+        function
+            .blocks
+            .iter()
+            .flat_map(|block| block.instructions.iter().flat_map(|inst| inst.operands()).chain(block.terminator.operands()))
+            .filter(|value| **value == Value::Temp(temp))
+            .count()
+    };
+    if reads_of(elem) != 1 || reads_of(result) != 1 {
+        return None;
+    }
+
+    Some(FoldLoop {
+        preheader: *preheader,
+        exit,
+        counter: counted.counter,
+        counter_ty,
+        array: counted.array,
+        acc,
+        kernel,
+    })
+}
+
+// ============================================================================
+// Dead code elimination
+// ============================================================================
+
+/// Removes side-effect-free assignments to temps that are never read.
+pub struct DeadCodeElimination;
+
+impl Pass for DeadCodeElimination {
+    fn name(&self) -> &'static str {
+        "dead-code-elimination"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        run_on_functions(module, remove_dead_code)
+    }
+}
+
+fn remove_dead_code(function: &mut IrFunction) -> bool {
+    let mut changed = false;
+    loop {
+        let mut read: HashSet<TempId> = HashSet::new();
+        for block in &function.blocks {
+            let values = block
+                .instructions
+                .iter()
+                .flat_map(|inst| inst.operands())
+                .chain(block.terminator.operands());
+            for value in values {
+                if let Value::Temp(t) = value {
+                    read.insert(*t);
+                }
+            }
+        }
+
+        let mut removed = false;
+        for block in &mut function.blocks {
+            let before = block.instructions.len();
+            block.instructions.retain(|inst| {
+                let pure = matches!(
+                    inst,
+                    Instruction::Assign {
+                        value: RValue::Use(_) | RValue::BinaryOp { .. } | RValue::UnaryOp { .. } | RValue::Cast { .. },
+                        ..
+                    }
+                );
+                !(pure && inst.dest_temp().is_some_and(|t| !read.contains(&t)))
+            });
+            removed |= block.instructions.len() != before;
+        }
+        if !removed {
+            return changed;
+        }
+        changed = true;
+    }
+}
+
+// ============================================================================
+// Dead block elimination
+// ============================================================================
+
+/// Threads jumps through empty blocks and drops blocks unreachable from the
+/// entry block, renumbering the survivors so `BlockId`s stay dense.
+pub struct DeadBlockElimination;
+
+impl Pass for DeadBlockElimination {
+    fn name(&self) -> &'static str {
+        "dead-block-elimination"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        run_on_functions(module, remove_dead_blocks)
+    }
+}
+
+fn remove_dead_blocks(function: &mut IrFunction) -> bool {
+    // Block ids double as indices into `blocks`; leave anything else alone
+    if function.blocks.iter().enumerate().any(|(i, b)| b.id != BlockId(i)) {
+        return false;
+    }
+    let changed = thread_empty_blocks(function);
+
+    let mut reachable = vec![false; function.blocks.len()];
+    let mut stack = vec![function.entry_block];
+    while let Some(id) = stack.pop() {
+        if id.0 >= reachable.len() || reachable[id.0] {
+            continue;
+        }
+        reachable[id.0] = true;
+        stack.extend(block_targets(&function.blocks[id.0]));
+    }
+    if reachable.iter().all(|&r| r) {
+        return changed;
+    }
+
+    let mut remap = HashMap::new();
+    let mut kept = Vec::new();
+    for (block, live) in std::mem::take(&mut function.blocks).into_iter().zip(&reachable) {
+        if *live {
+            remap.insert(block.id, BlockId(kept.len()));
+            kept.push(block);
+        }
+    }
+    for block in &mut kept {
+        block.id = remap[&block.id];
+        retarget(block, |target| remap[&target]);
+    }
+    function.entry_block = remap[&function.entry_block];
+    function.blocks = kept;
+    true
+}
+
+/// Successors of a block, including jumps encoded as instructions.
+fn block_targets(block: &Block) -> Vec<BlockId> {
+    let mut targets = block.successors();
+    for inst in &block.instructions {
+        match inst {
+            Instruction::Jump(target) => targets.push(*target),
+            Instruction::Branch { then_block, else_block, .. } => {
+                targets.push(*then_block);
+                targets.push(*else_block);
+            }
+            _ => {}
+        }
+    }
+    targets
+}
+
+fn retarget(block: &mut Block, mut map: impl FnMut(BlockId) -> BlockId) {
+    for inst in &mut block.instructions {
+        match inst {
+            Instruction::Jump(target) => *target = map(*target),
+            Instruction::Branch { then_block, else_block, .. } => {
+                *then_block = map(*then_block);
+                *else_block = map(*else_block);
+            }
+            _ => {}
+        }
+    }
+    match &mut block.terminator {
+        Terminator::Jump(target) => *target = map(*target),
+        Terminator::Branch { then_block, else_block, .. } => {
+            *then_block = map(*then_block);
+            *else_block = map(*else_block);
+        }
+        Terminator::Return(_) | Terminator::Unreachable => {}
+    }
+}
+
+/// Redirect edges into blocks that only jump elsewhere.
+fn thread_empty_blocks(function: &mut IrFunction) -> bool {
+    let forward: HashMap<BlockId, BlockId> = function
+        .blocks
+        .iter()
+        .filter_map(|b| match b.terminator {
+            Terminator::Jump(target) if b.instructions.is_empty() && target != b.id => Some((b.id, target)),
+            _ => None,
+        })
+        .collect();
+    if forward.is_empty() {
+        return false;
+    }
+    // Chase chains, stopping on cycles of empty blocks (an empty infinite loop)
+    let limit = forward.len();
+    let chase = |mut id: BlockId| {
+        for _ in 0..limit {
+            match forward.get(&id) {
+                Some(&next) => id = next,
+                None => break,
+            }
+        }
+        id
+    };
+
+    let mut changed = false;
+    for block in &mut function.blocks {
+        retarget(block, |target| {
+            let threaded = chase(target);
+            changed |= threaded != target;
+            threaded
+        });
+    }
+    let entry = chase(function.entry_block);
+    changed |= entry != function.entry_block;
+    function.entry_block = entry;
+    changed
+}
+
+// ============================================================================
+// Inlining
+// ============================================================================
+
+/// Inlines direct calls to small straight-line functions defined in the
+/// same module.
+pub struct Inline {
+    /// Largest callee body, in instructions
+    pub max_instructions: usize,
+}
+
+impl Pass for Inline {
+    fn name(&self) -> &'static str {
+        "inline"
+    }
+
+    fn run(&self, module: &mut IrModule) -> bool {
+        let candidates: HashMap<String, IrFunction> = module
+            .functions
+            .iter()
+            .filter(|f| is_inline_candidate(f, self.max_instructions))
+            .map(|f| (f.name.clone(), f.clone()))
+            .collect();
+        if candidates.is_empty() {
+            return false;
+        }
+
+        let mut changed = false;
+        for function in &mut module.functions {
+            changed |= inline_calls(function, &candidates);
+        }
+        changed
+    }
+}
+
+fn is_inline_candidate(function: &IrFunction, max_instructions: usize) -> bool {
+    // `main` and module initializers carry runtime setup; keep them as calls
+    if function.name == "main" || function.name.starts_with("__module_init_") {
+        return false;
+    }
+    let [block] = function.blocks.as_slice() else {
+        return false;
+    };
+    block.id == function.entry_block
+        && matches!(block.terminator, Terminator::Return(_))
+        && block.instructions.len() <= max_instructions
+        && block.instructions.iter().all(|inst| match inst {
+            Instruction::Return(_) | Instruction::Branch { .. } | Instruction::Jump(_) => false,
+            // Recursion would inline forever
+            Instruction::Call { func: Value::Const(Constant::Str(name)), .. } => *name != function.name,
+            _ => true,
+        })
+}
+
+fn inline_calls(function: &mut IrFunction, candidates: &HashMap<String, IrFunction>) -> bool {
+    let mut changed = false;
+    for block_index in 0..function.blocks.len() {
+        let instructions = std::mem::take(&mut function.blocks[block_index].instructions);
+        let mut rewritten = Vec::with_capacity(instructions.len());
+        for inst in instructions {
+            let callee = match &inst {
+                Instruction::Call { func: Value::Const(Constant::Str(name)), args, .. } => candidates
+                    .get(name)
+                    .filter(|callee| callee.name != function.name && callee.params.len() == args.len()),
+                _ => None,
+            };
+            match (callee, inst) {
+                (Some(callee), Instruction::Call { dest, args, .. }) => {
+                    inline_body(function, callee, dest, args, &mut rewritten);
+                    changed = true;
+                }
+                (_, inst) => rewritten.push(inst),
+            }
+        }
+        function.blocks[block_index].instructions = rewritten;
+    }
+    changed
+}
+
+/// Append a copy of `callee`'s body to `out`, with its params bound to
+/// `args` and its locals and temps renamed into `caller`.
+fn inline_body(
+    caller: &mut IrFunction,
+    callee: &IrFunction,
+    dest: Option<Place>,
+    args: Vec<Value>,
+    out: &mut Vec<Instruction>,
+) {
+    let mut locals: HashMap<LocalId, Value> = HashMap::new();
+    let mut temps: HashMap<TempId, TempId> = HashMap::new();
+
+    // Params become temps of the declared type; the cast mirrors the
+    // argument coercion a real call applies
+    for ((param, ty), arg) in callee.params.iter().zip(args) {
+        let temp = caller.add_temp(ty.clone());
+        out.push(Instruction::Assign {
+            dest: Place::from_temp(temp),
+            value: RValue::Cast { value: arg, ty: ty.clone() },
+        });
+        locals.insert(*param, Value::Temp(temp));
+    }
+    for (local, ty) in &callee.locals {
+        if !locals.contains_key(local) {
+            locals.insert(*local, Value::Local(caller.add_local(ty.clone())));
+        }
+    }
+    for (temp, ty) in &callee.temps {
+        temps.insert(*temp, caller.add_temp(ty.clone()));
+    }
+
+    let rename = |value: &mut Value| match value {
+        Value::Local(l) => {
+            if let Some(mapped) = locals.get(l) {
+                *value = mapped.clone();
+            }
+        }
+        Value::Temp(t) => {
+            if let Some(mapped) = temps.get(t) {
+                *t = *mapped;
+            }
+        }
+        Value::Const(_) => {}
+    };
+
+    let block = callee.block(callee.entry_block);
+    for inst in &block.instructions {
+        let mut inst = inst.clone();
+        for slot in all_values_mut(&mut inst) {
+            rename(slot);
+        }
+        out.push(inst);
+    }
+
+    if let (Some(dest), Terminator::Return(Some(value))) = (dest, &block.terminator) {
+        let mut value = value.clone();
+        rename(&mut value);
+        out.push(Instruction::Assign { dest, value: RValue::Use(value) });
+    }
+}
+
+/// Every value an instruction mentions, destinations included, each once.
+fn all_values_mut(inst: &mut Instruction) -> Vec<&mut Value> {
+    fn place_values(place: &mut Place) -> Vec<&mut Value> {
+        let mut values = vec![&mut place.base];
+        for projection in &mut place.projections {
+            if let Projection::Index(index) = projection {
+                values.push(index);
+            }
+        }
+        values
+    }
+
+    match inst {
+        Instruction::Assign { dest, value } => {
+            let mut values = value.operands_mut();
+            values.extend(place_values(dest));
+            values
+        }
+        Instruction::Call { dest, func, args } => {
+            let mut values = vec![func];
+            values.extend(args.iter_mut());
+            if let Some(dest) = dest {
+                values.extend(place_values(dest));
+            }
+            values
+        }
+        Instruction::Alloc { dest, .. } | Instruction::StackAlloc { dest, .. } => place_values(dest),
+        Instruction::Clone { dest, source } | Instruction::Load { dest, ptr: source } => {
+            let mut values = vec![source];
+            values.extend(place_values(dest));
+            values
+        }
+        // No destination: the read operands are everything
+        _ => inst.operands_mut(),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::FuncId;
+
+    fn function_with_entry(name: &str, ret: IrType) -> (IrFunction, BlockId) {
+        let mut func = IrFunction::new(FuncId(0), name.to_string(), vec![], ret);
+        let entry = func.new_block();
+        func.entry_block = entry;
+        (func, entry)
+    }
+
+    fn assign(dest: TempId, value: RValue) -> Instruction {
+        Instruction::Assign { dest: Place::from_temp(dest), value }
+    }
+
+    #[test]
+    fn test_fold_and_propagate_constants() {
+        // t0 = 2 * 21; t1 = t0; return t1  =>  return 42
+        let (mut func, entry) = function_with_entry("f", IrType::I64);
+        let t0 = func.add_temp(IrType::I64);
+        let t1 = func.add_temp(IrType::I64);
+        let block = func.block_mut(entry);
+        block.push_instruction(assign(t0, RValue::BinaryOp {
+            op: BinOp::Mul,
+            left: Value::Const(Constant::I64(2)),
+            right: Value::Const(Constant::I64(21)),
+        }));
+        block.push_instruction(assign(t1, RValue::Use(Value::Temp(t0))));
+        block.set_terminator(Terminator::Return(Some(Value::Temp(t1))));
+
+        let mut module = IrModule::new();
+        module.add_function(func);
+        optimize_module(&mut module, OptLevel::O1);
+
+        let block = &module.functions[0].blocks[0];
+        assert!(block.instructions.is_empty());
+        assert_eq!(block.terminator, Terminator::Return(Some(Value::Const(Constant::I64(42)))));
+    }
+
+    #[test]
+    fn test_fold_matches_translator_semantics() {
+        use Constant::*;
+        assert_eq!(fold_binary(BinOp::Div, &I64(7), &I64(0)), Some(I64(0)));
+        assert_eq!(fold_binary(BinOp::Div, &I64(i64::MIN), &I64(-1)), None);
+        assert_eq!(fold_binary(BinOp::Mod, &F64(-1.0), &F64(3.0)), Some(F64(2.0)));
+        assert_eq!(fold_binary(BinOp::Lt, &F64(f64::NAN), &F64(1.0)), Some(Bool(false)));
+        assert_eq!(fold_binary(BinOp::Add, &I64(1), &F64(1.0)), None);
+        assert_eq!(fold_unary(UnOp::Not, &F64(f64::NAN)), Some(Bool(true)));
+    }
+
+    #[test]
+    fn test_string_constant_not_propagated_into_call_target() {
+        // t0 = "callback"; call t0()  — an indirect call, not a call to `callback`
+        let (mut func, entry) = function_with_entry("f", IrType::Void);
+        let t0 = func.add_temp(IrType::Ptr);
+        let block = func.block_mut(entry);
+        block.push_instruction(assign(t0, RValue::Use(Value::Const(Constant::Str("callback".into())))));
+        block.push_instruction(Instruction::Call { dest: None, func: Value::Temp(t0), args: vec![] });
+        block.set_terminator(Terminator::Return(None));
+
+        let mut module = IrModule::new();
+        module.add_function(func);
+        optimize_module(&mut module, OptLevel::O2);
+        let block = &module.functions[0].blocks[0];
+        assert!(matches!(block.instructions[1], Instruction::Call { func: Value::Temp(_), .. }));
+    }
+
+    #[test]
+    fn test_dead_blocks_removed_and_renumbered() {
+        // entry: tick(); branch false -> b1, b2.  b1 is dead, b2 becomes block 1
+        let (mut func, entry) = function_with_entry("f", IrType::Void);
+        let b1 = func.new_block();
+        let b2 = func.new_block();
+        func.block_mut(entry).push_instruction(Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str("tick".into())),
+            args: vec![],
+        });
+        func.block_mut(entry).set_terminator(Terminator::Branch {
+            cond: Value::Const(Constant::Bool(false)),
+            then_block: b1,
+            else_block: b2,
+        });
+        func.block_mut(b1).set_terminator(Terminator::Return(None));
+        func.block_mut(b2).set_terminator(Terminator::Return(None));
+
+        let mut module = IrModule::new();
+        module.add_function(func);
+        optimize_module(&mut module, OptLevel::O1);
+
+        let func = &module.functions[0];
+        assert_eq!(func.blocks.len(), 2);
+        assert_eq!(func.blocks[0].terminator, Terminator::Jump(BlockId(1)));
+        assert!(func.blocks.iter().enumerate().all(|(i, b)| b.id == BlockId(i)));
+    }
+
+    #[test]
+    fn test_inline_small_function() {
+        // add1(x) { return x + 1 }  main() { return add1(41) }
+        let mut module = IrModule::new();
+        let mut add1 = IrFunction::new(FuncId(0), "add1".into(), vec![(LocalId(0), IrType::I64)], IrType::I64);
+        let entry = add1.new_block();
+        add1.entry_block = entry;
+        let sum = add1.add_temp(IrType::I64);
+        add1.block_mut(entry).push_instruction(assign(sum, RValue::BinaryOp {
+            op: BinOp::Add,
+            left: Value::Local(LocalId(0)),
+            right: Value::Const(Constant::I64(1)),
+        }));
+        add1.block_mut(entry).set_terminator(Terminator::Return(Some(Value::Temp(sum))));
+        module.add_function(add1);
+
+        let (mut main, entry) = function_with_entry("main", IrType::I64);
+        main.id = FuncId(1);
+        let result = main.add_temp(IrType::I64);
+        main.block_mut(entry).push_instruction(Instruction::Call {
+            dest: Some(Place::from_temp(result)),
+            func: Value::Const(Constant::Str("add1".into())),
+            args: vec![Value::Const(Constant::I64(41))],
+        });
+        main.block_mut(entry).set_terminator(Terminator::Return(Some(Value::Temp(result))));
+        module.add_function(main);
+
+        optimize_module(&mut module, OptLevel::O2);
+        let main = module.find_function("main").unwrap();
+        assert_eq!(main.blocks[0].terminator, Terminator::Return(Some(Value::Const(Constant::I64(42)))));
+
+        // -O1 never inlines
+        assert!(!PassManager::for_level(OptLevel::O1).pass_names().contains(&"inline"));
+    }
+
+    fn rc(value: Value, delta: i32) -> Instruction {
+        Instruction::RefCount { value, delta }
+    }
+
+    /// `local = alloc Struct(0); addr = local + 8; *addr = 1.0; x = *local`
+    fn point_function(ret_point: bool) -> IrFunction {
+        let (mut func, entry) = function_with_entry("f", IrType::F64);
+        let p = func.add_local(IrType::Struct(crate::StructId(0)));
+        let addr = func.add_temp(IrType::Ptr);
+        let x = func.add_temp(IrType::F64);
+        let block = func.block_mut(entry);
+        block.push_instruction(Instruction::Alloc { dest: Place::from_local(p), ty: IrType::Struct(crate::StructId(0)) });
+        block.push_instruction(assign(addr, RValue::BinaryOp {
+            op: BinOp::Add,
+            left: Value::Local(p),
+            right: Value::Const(Constant::I64(8)),
+        }));
+        block.push_instruction(Instruction::Store { ptr: Value::Temp(addr), value: Value::Const(Constant::F64(1.0)) });
+        block.push_instruction(Instruction::Load { dest: Place::from_temp(x), ptr: Value::Local(p) });
+        block.push_instruction(rc(Value::Local(p), -1));
+        let result = if ret_point { Value::Local(p) } else { Value::Temp(x) };
+        block.set_terminator(Terminator::Return(Some(result)));
+        func
+    }
+
+    #[test]
+    fn test_non_escaping_struct_moves_to_stack() {
+        let mut func = point_function(false);
+        assert!(promote_allocations(&mut func));
+        let insts = &func.blocks[0].instructions;
+        assert!(matches!(insts[0], Instruction::StackAlloc { .. }));
+        assert!(!insts.iter().any(|i| matches!(i, Instruction::RefCount { .. })), "no RC on stack objects");
+
+        let mut escaping = point_function(true);
+        assert!(!promote_allocations(&mut escaping));
+        assert!(matches!(escaping.blocks[0].instructions[0], Instruction::Alloc { .. }));
+    }
+
+    #[test]
+    fn test_array_escapes_only_through_capturing_calls() {
+        let build = |callee: &str| {
+            let (mut func, entry) = function_with_entry("f", IrType::Void);
+            let arr = func.add_temp(IrType::Array(Box::new(IrType::F64)));
+            let block = func.block_mut(entry);
+            block.push_instruction(assign(arr, RValue::ArrayInit(vec![Value::Const(Constant::F64(1.0))])));
+            block.push_instruction(Instruction::Call {
+                dest: None,
+                func: Value::Const(Constant::Str(callee.into())),
+                args: vec![Value::Temp(arr), Value::Const(Constant::I64(0))],
+            });
+            block.set_terminator(Terminator::Return(None));
+            func
+        };
+
+        let mut reads = build("zaco_array_get_f64");
+        assert!(promote_allocations(&mut reads));
+        assert!(matches!(
+            reads.blocks[0].instructions[0],
+            Instruction::Assign { value: RValue::StackArrayInit(_), .. }
+        ));
+        let mut captures = build("remember");
+        assert!(!promote_allocations(&mut captures));
+    }
+
+    #[test]
+    fn test_loop_allocation_must_not_outlive_iteration() {
+        // loop: p = alloc; jump loop — with a read of p in another block
+        // the read could see the next iteration's object
+        let (mut func, entry) = function_with_entry("f", IrType::Void);
+        let body = func.new_block();
+        let p = func.add_local(IrType::Struct(crate::StructId(0)));
+        let x = func.add_temp(IrType::F64);
+        func.block_mut(entry).set_terminator(Terminator::Jump(body));
+        func.block_mut(body).push_instruction(Instruction::Alloc {
+            dest: Place::from_local(p),
+            ty: IrType::Struct(crate::StructId(0)),
+        });
+        func.block_mut(body).set_terminator(Terminator::Jump(entry));
+        func.block_mut(entry).push_instruction(Instruction::Load { dest: Place::from_temp(x), ptr: Value::Local(p) });
+        assert!(!promote_allocations(&mut func));
+
+        // Reading it only after the allocation in the same block is fine
+        let insts = std::mem::take(&mut func.block_mut(entry).instructions);
+        func.block_mut(body).instructions.extend(insts);
+        assert!(promote_allocations(&mut func));
+    }
+
+    fn call_with(dest: Option<TempId>, name: &str, args: Vec<Value>) -> Instruction {
+        Instruction::Call {
+            dest: dest.map(Place::from_temp),
+            func: Value::Const(Constant::Str(name.to_string())),
+            args,
+        }
+    }
+
+    /// `for (i = 0; i < length(a); i = i + step) { x = a[i]; extra }`, with
+    /// an I64 counter. Returns the function and the body block.
+    fn counted_loop_function(step: i64, extra: Option<Instruction>) -> (IrFunction, BlockId) {
+        let (mut func, entry) = function_with_entry("f", IrType::Void);
+        let header = func.new_block();
+        let body = func.new_block();
+        let exit = func.new_block();
+        let a = func.add_local(IrType::Array(Box::new(IrType::F64)));
+        let i = func.add_local(IrType::I64);
+        let n = func.add_temp(IrType::I64);
+        let c = func.add_temp(IrType::Bool);
+        let x = func.add_temp(IrType::F64);
+
+        let block = func.block_mut(entry);
+        block.push_instruction(Instruction::Assign {
+            dest: Place::from_local(i),
+            value: RValue::Use(Value::Const(Constant::I64(0))),
+        });
+        block.set_terminator(Terminator::Jump(header));
+
+        let block = func.block_mut(header);
+        block.push_instruction(call_with(Some(n), "zaco_array_length", vec![Value::Local(a)]));
+        block.push_instruction(assign(c, RValue::BinaryOp {
+            op: BinOp::Lt,
+            left: Value::Local(i),
+            right: Value::Temp(n),
+        }));
+        block.set_terminator(Terminator::Branch { cond: Value::Temp(c), then_block: body, else_block: exit });
+
+        let block = func.block_mut(body);
+        block.push_instruction(call_with(Some(x), "zaco_array_get_f64", vec![Value::Local(a), Value::Local(i)]));
+        block.instructions.extend(extra);
+        block.push_instruction(Instruction::Assign {
+            dest: Place::from_local(i),
+            value: RValue::BinaryOp { op: BinOp::Add, left: Value::Local(i), right: Value::Const(Constant::I64(step)) },
+        });
+        block.set_terminator(Terminator::Jump(header));
+
+        func.block_mut(exit).set_terminator(Terminator::Return(None));
+        (func, body)
+    }
+
+    fn read_getter(func: &IrFunction, body: BlockId) -> &str {
+        match &func.blocks[body.0].instructions[0] {
+            Instruction::Call { func: Value::Const(Constant::Str(name)), .. } => name,
+            other => panic!("expected getter call, found {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_counted_loop_reads_drop_bounds_checks() {
+        let (mut func, body) = counted_loop_function(1, None);
+        assert!(eliminate_bounds_checks(&mut func));
+        assert_eq!(read_getter(&func, body), "zaco_array_get_f64_unchecked");
+
+        // Printing doesn't change the array's length
+        let print = call_with(None, "zaco_print_f64", vec![Value::Const(Constant::F64(1.0))]);
+        let (mut func, body) = counted_loop_function(1, Some(print));
+        assert!(eliminate_bounds_checks(&mut func));
+        assert_eq!(read_getter(&func, body), "zaco_array_get_f64_unchecked");
+    }
+
+    #[test]
+    fn test_bounds_checks_kept_when_loop_is_not_provably_in_range() {
+        // Pushing may reallocate and grow the array
+        let push = call_with(None, "zaco_array_push_f64", vec![Value::Local(LocalId(0)), Value::Const(Constant::F64(1.0))]);
+        let (mut func, body) = counted_loop_function(1, Some(push));
+        assert!(!eliminate_bounds_checks(&mut func));
+        assert_eq!(read_getter(&func, body), "zaco_array_get_f64");
+
+        // An unknown call could do anything to the array
+        let (mut func, body) = counted_loop_function(1, Some(call_with(None, "user_fn", vec![])));
+        assert!(!eliminate_bounds_checks(&mut func));
+        assert_eq!(read_getter(&func, body), "zaco_array_get_f64");
+
+        // A decrementing counter can go negative
+        let (mut func, body) = counted_loop_function(-1, None);
+        assert!(!eliminate_bounds_checks(&mut func));
+        assert_eq!(read_getter(&func, body), "zaco_array_get_f64");
+    }
+
+    /// Adds `acc = fold(acc, x)` after the read of [`counted_loop_function`],
+    /// or `acc = acc + x` without a fold function.
+    fn with_reduction(func: &mut IrFunction, body: BlockId, fold: Option<&str>) -> LocalId {
+        let acc = func.add_local(IrType::F64);
+        let r = func.add_temp(IrType::F64);
+        let x = Value::Temp(TempId(2));
+        let step = match fold {
+            Some(name) => call_with(Some(r), name, vec![Value::Local(acc), x]),
+            None => assign(r, RValue::BinaryOp { op: BinOp::Add, left: Value::Local(acc), right: x }),
+        };
+        func.blocks[body.0].instructions.splice(1..1, [
+            step,
+            Instruction::Assign { dest: Place::from_local(acc), value: RValue::Use(Value::Temp(r)) },
+        ]);
+        acc
+    }
+
+    #[test]
+    fn test_max_reduction_becomes_fold_kernel() {
+        let (mut func, body) = counted_loop_function(1, None);
+        let acc = with_reduction(&mut func, body, Some("zaco_math_max"));
+        assert_eq!(recognize_folds(&mut func), vec!["zaco_array_fold_max_f64"]);
+
+        // The preheader folds the whole array and leaves the counter at the
+        // length; the header skips the loop
+        let preheader = &func.blocks[0].instructions;
+        assert!(matches!(&preheader[1], Instruction::Call { func: Value::Const(Constant::Str(name)), args, .. }
+            if name == "zaco_array_fold_max_f64" && args[1] == Value::Local(acc)));
+        assert!(matches!(&preheader[4], Instruction::Assign { dest, .. } if dest.base == Value::Local(LocalId(1))));
+        assert_eq!(func.blocks[1].terminator, Terminator::Jump(BlockId(3)));
+
+        let mut module = IrModule::new();
+        let (mut func, body) = counted_loop_function(1, None);
+        with_reduction(&mut func, body, Some("zaco_math_min"));
+        module.add_function(func);
+        assert!(LoopIdiomRecognition.run(&mut module));
+        assert!(module.extern_functions.iter().any(|ext| ext.name == "zaco_array_fold_min_f64"));
+    }
+
+    #[test]
+    fn test_non_fold_loops_are_kept() {
+        // Vectorizing a sum would reassociate the additions
+        let (mut func, body) = counted_loop_function(1, None);
+        with_reduction(&mut func, body, None);
+        assert!(recognize_folds(&mut func).is_empty());
+
+        // A stride of 2 visits only half the elements
+        let (mut func, body) = counted_loop_function(2, None);
+        with_reduction(&mut func, body, Some("zaco_math_max"));
+        assert!(recognize_folds(&mut func).is_empty());
+
+        // Anything else in the body must keep running per element
+        let print = call_with(None, "zaco_print_f64", vec![Value::Const(Constant::F64(1.0))]);
+        let (mut func, body) = counted_loop_function(1, Some(print));
+        with_reduction(&mut func, body, Some("zaco_math_max"));
+        assert!(recognize_folds(&mut func).is_empty());
+    }
+}
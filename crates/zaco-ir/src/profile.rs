@@ -0,0 +1,122 @@
+//! Profiling probes.
+//!
+//! With `--profile`, every function calls [`PROFILE_ENTER`] with its name on
+//! entry and [`PROFILE_EXIT`] before each return. The runtime keeps the
+//! names on a shadow stack that its sampler records, so samples are
+//! attributed to source-level functions without unwinding native frames.
+//! `main` first calls [`PROFILE_START`], which starts the sampler.
+//!
+//! Probes are inserted after optimization: a function inlined into its
+//! caller is attributed to the caller.
+
+use crate::{Constant, Instruction, IrModule, IrType, Terminator, Value};
+
+/// Runtime function called on function entry with the function's name.
+pub const PROFILE_ENTER: &str = "zaco_profile_enter";
+
+/// Runtime function called before every return.
+pub const PROFILE_EXIT: &str = "zaco_profile_exit";
+
+/// Runtime function called once on entry to `main`, before its probe.
+pub const PROFILE_START: &str = "zaco_profile_start";
+
+/// Whether `module` has been instrumented by [`insert_profile_probes`].
+pub fn has_profile_probes(module: &IrModule) -> bool {
+    module.extern_functions.iter().any(|ext| ext.name == PROFILE_ENTER)
+}
+
+/// Insert entry and exit probes into every function of `module`.
+pub fn insert_profile_probes(module: &mut IrModule) {
+    for (name, params) in [(PROFILE_ENTER, vec![IrType::Ptr]), (PROFILE_EXIT, vec![]), (PROFILE_START, vec![])] {
+        if !module.extern_functions.iter().any(|ext| ext.name == name) {
+            module.add_extern_function(name.to_string(), params, IrType::Void);
+        }
+    }
+
+    let names: Vec<String> = module.functions.iter().map(|func| func.name.clone()).collect();
+    for name in &names {
+        module.intern_string(name);
+    }
+
+    for (func, name) in module.functions.iter_mut().zip(names) {
+        if func.blocks.is_empty() {
+            continue;
+        }
+        for block in &mut func.blocks {
+            if matches!(block.terminator, Terminator::Return(_)) {
+                block.push_instruction(probe(PROFILE_EXIT, vec![]));
+            }
+        }
+        let entry = func.entry_block;
+        let is_main = name == "main";
+        let enter = probe(PROFILE_ENTER, vec![Value::Const(Constant::Str(name))]);
+        func.block_mut(entry).instructions.insert(0, enter);
+        if is_main {
+            func.block_mut(entry).instructions.insert(0, probe(PROFILE_START, vec![]));
+        }
+    }
+}
+
+fn probe(runtime_fn: &str, args: Vec<Value>) -> Instruction {
+    Instruction::Call {
+        dest: None,
+        func: Value::Const(Constant::Str(runtime_fn.to_string())),
+        args,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{BlockId, FuncId, IrFunction};
+
+    #[test]
+    fn test_probes_wrap_every_return() {
+        let mut module = IrModule::new();
+        let mut func = IrFunction::new(FuncId(0), "f".to_string(), vec![], IrType::Void);
+        let entry = func.new_block();
+        let other = func.new_block();
+        func.entry_block = entry;
+        func.block_mut(entry).set_terminator(Terminator::Branch {
+            cond: Value::Const(Constant::Bool(true)),
+            then_block: other,
+            else_block: other,
+        });
+        func.block_mut(other).set_terminator(Terminator::Return(None));
+        module.add_function(func);
+
+        insert_profile_probes(&mut module);
+
+        let func = &module.functions[0];
+        assert_eq!(
+            func.block(BlockId(0)).instructions,
+            vec![probe(PROFILE_ENTER, vec![Value::Const(Constant::Str("f".to_string()))])]
+        );
+        assert_eq!(func.block(BlockId(1)).instructions, vec![probe(PROFILE_EXIT, vec![])]);
+        assert!(module.string_literals.contains(&"f".to_string()));
+        assert_eq!(module.extern_functions.len(), 3);
+        assert!(has_profile_probes(&module));
+
+        // Running the pass on a module that already declares the probes
+        // does not declare them twice
+        insert_profile_probes(&mut module);
+        assert_eq!(module.extern_functions.len(), 3);
+    }
+
+    #[test]
+    fn test_main_starts_the_profiler_before_its_probe() {
+        let mut module = IrModule::new();
+        let mut main = IrFunction::new(FuncId(0), "main".to_string(), vec![], IrType::Void);
+        let entry = main.new_block();
+        main.entry_block = entry;
+        main.block_mut(entry).set_terminator(Terminator::Return(None));
+        module.add_function(main);
+        assert!(!has_profile_probes(&module));
+
+        insert_profile_probes(&mut module);
+
+        let instrs = &module.functions[0].block(BlockId(0)).instructions;
+        assert_eq!(instrs[0], probe(PROFILE_START, vec![]));
+        assert_eq!(instrs[1], probe(PROFILE_ENTER, vec![Value::Const(Constant::Str("main".to_string()))]));
+    }
+}
@@ -0,0 +1,796 @@
+//! Compact binary encoding of IR modules.
+//!
+//! Used by the driver's incremental cache to persist lowered modules between
+//! compiler invocations. The format is private to this crate version: every
+//! buffer starts with a magic/version header and decoding rejects anything
+//! else, so a compiler upgrade simply misses the cache instead of misreading it.
+//!
+//! Integers are LEB128 varints, floats are their IEEE bit patterns, strings
+//! are length-prefixed UTF-8 and enums are a one-byte tag followed by fields.
+
+use std::fmt;
+
+use zaco_ast::Span;
+
+use crate::{
+    BinOp, Block, BlockId, Constant, ExternFunction, FuncId, FuncSignature, Instruction,
+    IrFunction, IrModule, IrStruct, IrType, LocalId, Place, Projection, RValue, StructId, TempId,
+    Terminator, UnOp, Value,
+};
+
+/// Magic bytes and format version at the start of every encoded module.
+const MAGIC: &[u8; 4] = b"ZIR\x02";
+
+/// Error produced when a buffer is not a valid encoded module.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct DecodeError {
+    pub message: String,
+}
+
+impl fmt::Display for DecodeError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        write!(f, "invalid IR encoding: {}", self.message)
+    }
+}
+
+impl std::error::Error for DecodeError {}
+
+type DecodeResult<T> = Result<T, DecodeError>;
+
+impl IrModule {
+    /// Encode this module into a self-describing byte buffer.
+    pub fn encode(&self) -> Vec<u8> {
+        let mut w = Writer { buf: Vec::with_capacity(4096) };
+        w.buf.extend_from_slice(MAGIC);
+
+        w.seq(&self.functions, |w, f| w.function(f));
+        w.seq(&self.structs, |w, s| w.struct_def(s));
+        w.seq(&self.globals, |w, (name, ty, init)| {
+            w.str(name);
+            w.ty(ty);
+            w.opt(init, |w, c| w.constant(c));
+        });
+        w.seq(&self.string_literals, |w, s| w.str(s));
+        w.seq(&self.extern_functions, |w, ext| {
+            w.str(&ext.name);
+            w.seq(&ext.params, |w, t| w.ty(t));
+            w.ty(&ext.return_type);
+        });
+        w.uint(self.next_func_id);
+        w.uint(self.next_struct_id);
+        w.buf
+    }
+
+    /// Decode a module produced by [`IrModule::encode`].
+    pub fn decode(bytes: &[u8]) -> Result<IrModule, DecodeError> {
+        if bytes.len() < MAGIC.len() || &bytes[..MAGIC.len()] != MAGIC {
+            return Err(DecodeError { message: "bad header".to_string() });
+        }
+        let mut r = Reader { data: bytes, pos: MAGIC.len() };
+
+        let mut module = IrModule::new();
+        module.functions = r.seq(|r| r.function())?;
+        module.structs = r.seq(|r| r.struct_def())?;
+        module.globals = r.seq(|r| Ok((r.string()?, r.ty()?, r.opt(|r| r.constant())?)))?;
+        for lit in r.seq(|r| r.string())? {
+            module.intern_string(&lit);
+        }
+        module.extern_functions = r.seq(|r| {
+            Ok(ExternFunction {
+                name: r.string()?,
+                params: r.seq(|r| r.ty())?,
+                return_type: r.ty()?,
+            })
+        })?;
+        module.next_func_id = r.uint()?;
+        module.next_struct_id = r.uint()?;
+
+        if r.pos != bytes.len() {
+            return Err(r.error("trailing bytes"));
+        }
+        Ok(module)
+    }
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+struct Writer {
+    buf: Vec<u8>,
+}
+
+impl Writer {
+    fn u8(&mut self, v: u8) {
+        self.buf.push(v);
+    }
+
+    fn uint(&mut self, v: usize) {
+        self.u64(v as u64);
+    }
+
+    fn u64(&mut self, mut v: u64) {
+        loop {
+            let byte = (v & 0x7f) as u8;
+            v >>= 7;
+            if v == 0 {
+                self.buf.push(byte);
+                return;
+            }
+            self.buf.push(byte | 0x80);
+        }
+    }
+
+    fn i64(&mut self, v: i64) {
+        // Zigzag so small negative numbers stay short
+        self.u64(((v << 1) ^ (v >> 63)) as u64);
+    }
+
+    fn bool(&mut self, v: bool) {
+        self.u8(v as u8);
+    }
+
+    fn str(&mut self, s: &str) {
+        self.uint(s.len());
+        self.buf.extend_from_slice(s.as_bytes());
+    }
+
+    fn seq<T>(&mut self, items: &[T], mut each: impl FnMut(&mut Self, &T)) {
+        self.uint(items.len());
+        for item in items {
+            each(self, item);
+        }
+    }
+
+    fn opt<T>(&mut self, item: &Option<T>, each: impl FnOnce(&mut Self, &T)) {
+        match item {
+            Some(v) => {
+                self.u8(1);
+                each(self, v);
+            }
+            None => self.u8(0),
+        }
+    }
+
+    fn span(&mut self, span: &Option<Span>) {
+        self.opt(span, |w, s| {
+            w.uint(s.start);
+            w.uint(s.end);
+            w.uint(s.file_id);
+        });
+    }
+
+    fn ty(&mut self, ty: &IrType) {
+        match ty {
+            IrType::I64 => self.u8(0),
+            IrType::F64 => self.u8(1),
+            IrType::Bool => self.u8(2),
+            IrType::Ptr => self.u8(3),
+            IrType::Void => self.u8(4),
+            IrType::Str => self.u8(5),
+            IrType::Array(elem) => {
+                self.u8(6);
+                self.ty(elem);
+            }
+            IrType::Struct(id) => {
+                self.u8(7);
+                self.uint(id.0);
+            }
+            IrType::FuncPtr(sig) => {
+                self.u8(8);
+                self.seq(&sig.params, |w, t| w.ty(t));
+                self.ty(&sig.return_type);
+            }
+            IrType::Promise(inner) => {
+                self.u8(9);
+                self.ty(inner);
+            }
+        }
+    }
+
+    fn constant(&mut self, c: &Constant) {
+        match c {
+            Constant::I64(v) => {
+                self.u8(0);
+                self.i64(*v);
+            }
+            Constant::F64(v) => {
+                self.u8(1);
+                self.buf.extend_from_slice(&v.to_bits().to_le_bytes());
+            }
+            Constant::Bool(v) => {
+                self.u8(2);
+                self.bool(*v);
+            }
+            Constant::Str(s) => {
+                self.u8(3);
+                self.str(s);
+            }
+            Constant::Null => self.u8(4),
+        }
+    }
+
+    fn value(&mut self, v: &Value) {
+        match v {
+            Value::Const(c) => {
+                self.u8(0);
+                self.constant(c);
+            }
+            Value::Local(id) => {
+                self.u8(1);
+                self.uint(id.0);
+            }
+            Value::Temp(id) => {
+                self.u8(2);
+                self.uint(id.0);
+            }
+        }
+    }
+
+    fn place(&mut self, p: &Place) {
+        self.value(&p.base);
+        self.seq(&p.projections, |w, proj| match proj {
+            Projection::Field(i) => {
+                w.u8(0);
+                w.uint(*i);
+            }
+            Projection::Index(v) => {
+                w.u8(1);
+                w.value(v);
+            }
+            Projection::Deref => w.u8(2),
+        });
+    }
+
+    fn rvalue(&mut self, rv: &RValue) {
+        match rv {
+            RValue::Use(v) => {
+                self.u8(0);
+                self.value(v);
+            }
+            RValue::BinaryOp { op, left, right } => {
+                self.u8(1);
+                self.u8(*op as u8);
+                self.value(left);
+                self.value(right);
+            }
+            RValue::UnaryOp { op, operand } => {
+                self.u8(2);
+                self.u8(*op as u8);
+                self.value(operand);
+            }
+            RValue::Cast { value, ty } => {
+                self.u8(3);
+                self.value(value);
+                self.ty(ty);
+            }
+            RValue::StructInit { struct_id, fields } => {
+                self.u8(4);
+                self.uint(struct_id.0);
+                self.seq(fields, |w, v| w.value(v));
+            }
+            RValue::ArrayInit(values) => {
+                self.u8(5);
+                self.seq(values, |w, v| w.value(v));
+            }
+            RValue::StrConcat(values) => {
+                self.u8(6);
+                self.seq(values, |w, v| w.value(v));
+            }
+            RValue::StackArrayInit(values) => {
+                self.u8(7);
+                self.seq(values, |w, v| w.value(v));
+            }
+        }
+    }
+
+    fn instruction(&mut self, inst: &Instruction) {
+        match inst {
+            Instruction::Assign { dest, value } => {
+                self.u8(0);
+                self.place(dest);
+                self.rvalue(value);
+            }
+            Instruction::Call { dest, func, args } => {
+                self.u8(1);
+                self.opt(dest, |w, p| w.place(p));
+                self.value(func);
+                self.seq(args, |w, v| w.value(v));
+            }
+            Instruction::Return(value) => {
+                self.u8(2);
+                self.opt(value, |w, v| w.value(v));
+            }
+            Instruction::Branch { cond, then_block, else_block } => {
+                self.u8(3);
+                self.value(cond);
+                self.uint(then_block.0);
+                self.uint(else_block.0);
+            }
+            Instruction::Jump(block) => {
+                self.u8(4);
+                self.uint(block.0);
+            }
+            Instruction::Alloc { dest, ty } => {
+                self.u8(5);
+                self.place(dest);
+                self.ty(ty);
+            }
+            Instruction::Free { value } => {
+                self.u8(6);
+                self.value(value);
+            }
+            Instruction::RefCount { value, delta } => {
+                self.u8(7);
+                self.value(value);
+                self.i64(*delta as i64);
+            }
+            Instruction::Clone { dest, source } => {
+                self.u8(8);
+                self.place(dest);
+                self.value(source);
+            }
+            Instruction::Store { ptr, value } => {
+                self.u8(9);
+                self.value(ptr);
+                self.value(value);
+            }
+            Instruction::Load { dest, ptr } => {
+                self.u8(10);
+                self.place(dest);
+                self.value(ptr);
+            }
+            Instruction::StackAlloc { dest, ty } => {
+                self.u8(11);
+                self.place(dest);
+                self.ty(ty);
+            }
+        }
+    }
+
+    fn terminator(&mut self, term: &Terminator) {
+        match term {
+            Terminator::Return(value) => {
+                self.u8(0);
+                self.opt(value, |w, v| w.value(v));
+            }
+            Terminator::Branch { cond, then_block, else_block } => {
+                self.u8(1);
+                self.value(cond);
+                self.uint(then_block.0);
+                self.uint(else_block.0);
+            }
+            Terminator::Jump(block) => {
+                self.u8(2);
+                self.uint(block.0);
+            }
+            Terminator::Unreachable => self.u8(3),
+        }
+    }
+
+    fn function(&mut self, f: &IrFunction) {
+        self.uint(f.id.0);
+        self.str(&f.name);
+        self.seq(&f.params, |w, (id, ty)| {
+            w.uint(id.0);
+            w.ty(ty);
+        });
+        self.ty(&f.return_type);
+        self.seq(&f.locals, |w, (id, ty)| {
+            w.uint(id.0);
+            w.ty(ty);
+        });
+        self.seq(&f.temps, |w, (id, ty)| {
+            w.uint(id.0);
+            w.ty(ty);
+        });
+        self.seq(&f.blocks, |w, b| {
+            w.uint(b.id.0);
+            w.seq(&b.instructions, |w, i| w.instruction(i));
+            w.terminator(&b.terminator);
+            w.span(&b.span);
+        });
+        self.uint(f.entry_block.0);
+        self.bool(f.is_public);
+        self.bool(f.is_async_resume);
+        self.span(&f.span);
+    }
+
+    fn struct_def(&mut self, s: &IrStruct) {
+        self.uint(s.id.0);
+        self.str(&s.name);
+        self.seq(&s.fields, |w, (name, ty)| {
+            w.str(name);
+            w.ty(ty);
+        });
+        self.opt(&s.drop_fn, |w, id| w.uint(id.0));
+        self.span(&s.span);
+    }
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+const BIN_OPS: [BinOp; 18] = [
+    BinOp::Add, BinOp::Sub, BinOp::Mul, BinOp::Div, BinOp::Mod,
+    BinOp::Eq, BinOp::Ne, BinOp::Lt, BinOp::Le, BinOp::Gt, BinOp::Ge,
+    BinOp::And, BinOp::Or,
+    BinOp::BitAnd, BinOp::BitOr, BinOp::BitXor, BinOp::Shl, BinOp::Shr,
+];
+
+const UN_OPS: [UnOp; 3] = [UnOp::Neg, UnOp::Not, UnOp::BitNot];
+
+struct Reader<'a> {
+    data: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn error(&self, what: &str) -> DecodeError {
+        DecodeError { message: format!("{} at offset {}", what, self.pos) }
+    }
+
+    fn u8(&mut self) -> DecodeResult<u8> {
+        let byte = *self.data.get(self.pos).ok_or_else(|| self.error("unexpected end"))?;
+        self.pos += 1;
+        Ok(byte)
+    }
+
+    fn u64(&mut self) -> DecodeResult<u64> {
+        let mut value = 0u64;
+        let mut shift = 0;
+        loop {
+            let byte = self.u8()?;
+            if shift >= 64 {
+                return Err(self.error("varint overflow"));
+            }
+            value |= ((byte & 0x7f) as u64) << shift;
+            if byte & 0x80 == 0 {
+                return Ok(value);
+            }
+            shift += 7;
+        }
+    }
+
+    fn uint(&mut self) -> DecodeResult<usize> {
+        usize::try_from(self.u64()?).map_err(|_| self.error("integer out of range"))
+    }
+
+    fn i64(&mut self) -> DecodeResult<i64> {
+        let v = self.u64()?;
+        Ok(((v >> 1) as i64) ^ -((v & 1) as i64))
+    }
+
+    fn bool(&mut self) -> DecodeResult<bool> {
+        match self.u8()? {
+            0 => Ok(false),
+            1 => Ok(true),
+            _ => Err(self.error("bad bool")),
+        }
+    }
+
+    fn bytes(&mut self, len: usize) -> DecodeResult<&'a [u8]> {
+        let end = self.pos.checked_add(len).filter(|&e| e <= self.data.len());
+        let end = end.ok_or_else(|| self.error("unexpected end"))?;
+        let slice = &self.data[self.pos..end];
+        self.pos = end;
+        Ok(slice)
+    }
+
+    fn string(&mut self) -> DecodeResult<String> {
+        let len = self.uint()?;
+        let bytes = self.bytes(len)?;
+        String::from_utf8(bytes.to_vec()).map_err(|_| self.error("bad utf-8"))
+    }
+
+    fn seq<T>(&mut self, mut each: impl FnMut(&mut Self) -> DecodeResult<T>) -> DecodeResult<Vec<T>> {
+        let len = self.uint()?;
+        // Every element takes at least one byte; don't trust huge lengths.
+        if len > self.data.len() - self.pos {
+            return Err(self.error("sequence too long"));
+        }
+        let mut items = Vec::with_capacity(len);
+        for _ in 0..len {
+            items.push(each(self)?);
+        }
+        Ok(items)
+    }
+
+    fn opt<T>(&mut self, each: impl FnOnce(&mut Self) -> DecodeResult<T>) -> DecodeResult<Option<T>> {
+        match self.u8()? {
+            0 => Ok(None),
+            1 => Ok(Some(each(self)?)),
+            _ => Err(self.error("bad option tag")),
+        }
+    }
+
+    fn span(&mut self) -> DecodeResult<Option<Span>> {
+        self.opt(|r| Ok(Span::new(r.uint()?, r.uint()?, r.uint()?)))
+    }
+
+    fn ty(&mut self) -> DecodeResult<IrType> {
+        Ok(match self.u8()? {
+            0 => IrType::I64,
+            1 => IrType::F64,
+            2 => IrType::Bool,
+            3 => IrType::Ptr,
+            4 => IrType::Void,
+            5 => IrType::Str,
+            6 => IrType::Array(Box::new(self.ty()?)),
+            7 => IrType::Struct(StructId(self.uint()?)),
+            8 => {
+                let params = self.seq(|r| r.ty())?;
+                let return_type = Box::new(self.ty()?);
+                IrType::FuncPtr(FuncSignature { params, return_type })
+            }
+            9 => IrType::Promise(Box::new(self.ty()?)),
+            _ => return Err(self.error("bad type tag")),
+        })
+    }
+
+    fn constant(&mut self) -> DecodeResult<Constant> {
+        Ok(match self.u8()? {
+            0 => Constant::I64(self.i64()?),
+            1 => {
+                let bits = self.bytes(8)?;
+                Constant::F64(f64::from_bits(u64::from_le_bytes(bits.try_into().unwrap())))
+            }
+            2 => Constant::Bool(self.bool()?),
+            3 => Constant::Str(self.string()?),
+            4 => Constant::Null,
+            _ => return Err(self.error("bad constant tag")),
+        })
+    }
+
+    fn value(&mut self) -> DecodeResult<Value> {
+        Ok(match self.u8()? {
+            0 => Value::Const(self.constant()?),
+            1 => Value::Local(LocalId(self.uint()?)),
+            2 => Value::Temp(TempId(self.uint()?)),
+            _ => return Err(self.error("bad value tag")),
+        })
+    }
+
+    fn place(&mut self) -> DecodeResult<Place> {
+        let base = self.value()?;
+        let projections = self.seq(|r| {
+            Ok(match r.u8()? {
+                0 => Projection::Field(r.uint()?),
+                1 => Projection::Index(r.value()?),
+                2 => Projection::Deref,
+                _ => return Err(r.error("bad projection tag")),
+            })
+        })?;
+        Ok(Place { base, projections })
+    }
+
+    fn bin_op(&mut self) -> DecodeResult<BinOp> {
+        let tag = self.u8()? as usize;
+        BIN_OPS.get(tag).copied().ok_or_else(|| self.error("bad binary operator"))
+    }
+
+    fn un_op(&mut self) -> DecodeResult<UnOp> {
+        let tag = self.u8()? as usize;
+        UN_OPS.get(tag).copied().ok_or_else(|| self.error("bad unary operator"))
+    }
+
+    fn values(&mut self) -> DecodeResult<Vec<Value>> {
+        self.seq(|r| r.value())
+    }
+
+    fn rvalue(&mut self) -> DecodeResult<RValue> {
+        Ok(match self.u8()? {
+            0 => RValue::Use(self.value()?),
+            1 => RValue::BinaryOp { op: self.bin_op()?, left: self.value()?, right: self.value()? },
+            2 => RValue::UnaryOp { op: self.un_op()?, operand: self.value()? },
+            3 => RValue::Cast { value: self.value()?, ty: self.ty()? },
+            4 => RValue::StructInit { struct_id: StructId(self.uint()?), fields: self.values()? },
+            5 => RValue::ArrayInit(self.values()?),
+            6 => RValue::StrConcat(self.values()?),
+            7 => RValue::StackArrayInit(self.values()?),
+            _ => return Err(self.error("bad rvalue tag")),
+        })
+    }
+
+    fn instruction(&mut self) -> DecodeResult<Instruction> {
+        Ok(match self.u8()? {
+            0 => Instruction::Assign { dest: self.place()?, value: self.rvalue()? },
+            1 => Instruction::Call {
+                dest: self.opt(|r| r.place())?,
+                func: self.value()?,
+                args: self.values()?,
+            },
+            2 => Instruction::Return(self.opt(|r| r.value())?),
+            3 => Instruction::Branch {
+                cond: self.value()?,
+                then_block: BlockId(self.uint()?),
+                else_block: BlockId(self.uint()?),
+            },
+            4 => Instruction::Jump(BlockId(self.uint()?)),
+            5 => Instruction::Alloc { dest: self.place()?, ty: self.ty()? },
+            6 => Instruction::Free { value: self.value()? },
+            7 => {
+                let value = self.value()?;
+                let delta = i32::try_from(self.i64()?).map_err(|_| self.error("bad refcount delta"))?;
+                Instruction::RefCount { value, delta }
+            }
+            8 => Instruction::Clone { dest: self.place()?, source: self.value()? },
+            9 => Instruction::Store { ptr: self.value()?, value: self.value()? },
+            10 => Instruction::Load { dest: self.place()?, ptr: self.value()? },
+            11 => Instruction::StackAlloc { dest: self.place()?, ty: self.ty()? },
+            _ => return Err(self.error("bad instruction tag")),
+        })
+    }
+
+    fn terminator(&mut self) -> DecodeResult<Terminator> {
+        Ok(match self.u8()? {
+            0 => Terminator::Return(self.opt(|r| r.value())?),
+            1 => Terminator::Branch {
+                cond: self.value()?,
+                then_block: BlockId(self.uint()?),
+                else_block: BlockId(self.uint()?),
+            },
+            2 => Terminator::Jump(BlockId(self.uint()?)),
+            3 => Terminator::Unreachable,
+            _ => return Err(self.error("bad terminator tag")),
+        })
+    }
+
+    fn function(&mut self) -> DecodeResult<IrFunction> {
+        let id = FuncId(self.uint()?);
+        let name = self.string()?;
+        let params = self.seq(|r| Ok((LocalId(r.uint()?), r.ty()?)))?;
+        let return_type = self.ty()?;
+        let mut func = IrFunction::new(id, name, params, return_type);
+        func.locals = self.seq(|r| Ok((LocalId(r.uint()?), r.ty()?)))?;
+        func.temps = self.seq(|r| Ok((TempId(r.uint()?), r.ty()?)))?;
+        func.blocks = self.seq(|r| {
+            Ok(Block {
+                id: BlockId(r.uint()?),
+                instructions: r.seq(|r| r.instruction())?,
+                terminator: r.terminator()?,
+                span: r.span()?,
+            })
+        })?;
+        func.entry_block = BlockId(self.uint()?);
+        func.is_public = self.bool()?;
+        func.is_async_resume = self.bool()?;
+        func.span = self.span()?;
+        Ok(func)
+    }
+
+    fn struct_def(&mut self) -> DecodeResult<IrStruct> {
+        let id = StructId(self.uint()?);
+        let name = self.string()?;
+        let fields = self.seq(|r| Ok((r.string()?, r.ty()?)))?;
+        let mut def = IrStruct::new(id, name, fields);
+        def.drop_fn = self.opt(|r| Ok(FuncId(r.uint()?)))?;
+        def.span = self.span()?;
+        Ok(def)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::lower::Lowerer;
+    use zaco_ast::*;
+
+    #[test]
+    fn test_round_trip_preserves_module() {
+        let mut module = IrModule::new();
+        let mut func = IrFunction::new(
+            FuncId(3),
+            "f".to_string(),
+            vec![(LocalId(0), IrType::F64)],
+            IrType::Promise(Box::new(IrType::Str)),
+        );
+        let tmp = func.add_temp(IrType::FuncPtr(FuncSignature {
+            params: vec![IrType::Struct(StructId(1)), IrType::Array(Box::new(IrType::Bool))],
+            return_type: Box::new(IrType::Void),
+        }));
+        let entry = func.new_block();
+        let exit = func.new_block();
+        let block = func.block_mut(entry);
+        block.push_instruction(Instruction::Assign {
+            dest: Place::from_temp(tmp).field(2).index(Value::Const(Constant::I64(-7))).deref(),
+            value: RValue::BinaryOp {
+                op: BinOp::Shr,
+                left: Value::Const(Constant::F64(-0.5)),
+                right: Value::Local(LocalId(0)),
+            },
+        });
+        block.push_instruction(Instruction::Call {
+            dest: None,
+            func: Value::Const(Constant::Str("zaco_print_str".to_string())),
+            args: vec![Value::Const(Constant::Str("héllo".to_string())), Value::Const(Constant::Null)],
+        });
+        block.push_instruction(Instruction::RefCount { value: Value::Temp(tmp), delta: -1 });
+        block.push_instruction(Instruction::StackAlloc {
+            dest: Place::from_local(LocalId(0)),
+            ty: IrType::Struct(StructId(1)),
+        });
+        block.push_instruction(Instruction::Assign {
+            dest: Place::from_temp(tmp),
+            value: RValue::StackArrayInit(vec![Value::Const(Constant::F64(1.0))]),
+        });
+        block.set_terminator(Terminator::Branch {
+            cond: Value::Const(Constant::Bool(true)),
+            then_block: exit,
+            else_block: exit,
+        });
+        block.span = Some(Span::new(4, 9, 2));
+        func.block_mut(exit).set_terminator(Terminator::Return(None));
+        func.is_public = true;
+        module.add_function(func);
+
+        let mut def = IrStruct::new(StructId(1), "P".to_string(), vec![("x".to_string(), IrType::F64)]);
+        def.drop_fn = Some(FuncId(3));
+        module.add_struct(def);
+        module.add_global("g".to_string(), IrType::I64, Some(Constant::I64(i64::MIN)));
+        module.intern_string("lit");
+        module.add_extern_function("zaco_print_str".to_string(), vec![IrType::Str], IrType::Void);
+        module.next_func_id = 4;
+        module.next_struct_id = 2;
+
+        let decoded = IrModule::decode(&module.encode()).unwrap();
+        assert_eq!(decoded.functions, module.functions);
+        assert_eq!(decoded.structs, module.structs);
+        assert_eq!(decoded.globals, module.globals);
+        assert_eq!(decoded.string_literals, module.string_literals);
+        assert_eq!(decoded.extern_functions, module.extern_functions);
+        assert_eq!(decoded.next_func_id, 4);
+        assert_eq!(decoded.next_struct_id, 2);
+    }
+
+    #[test]
+    fn test_round_trip_lowered_program() {
+        // console.log("hi" + 1);
+        let span = Span::new(0, 0, 0);
+        let e = |expr: Expr| Node::new(expr, span);
+        let log = Stmt::Expr(e(Expr::Call {
+            callee: Box::new(e(Expr::Member {
+                object: Box::new(e(Expr::Ident(Ident::new("console")))),
+                property: Node::new(Ident::new("log"), span),
+                computed: false,
+            })),
+            type_args: None,
+            args: vec![e(Expr::Binary {
+                left: Box::new(e(Expr::Literal(Literal::String("hi".into())))),
+                op: BinaryOp::Add,
+                right: Box::new(e(Expr::Literal(Literal::Number(1.0)))),
+            })],
+        }));
+        let program = Program {
+            items: vec![Node::new(ModuleItem::Stmt(Node::new(log, span)), span)],
+            span,
+        };
+
+        let module = Lowerer::new().lower_program(&program).unwrap();
+        let decoded = IrModule::decode(&module.encode()).unwrap();
+        assert_eq!(decoded.functions, module.functions);
+        assert_eq!(decoded.string_literals, module.string_literals);
+        assert_eq!(decoded.extern_functions, module.extern_functions);
+    }
+
+    #[test]
+    fn test_operator_tags_match_declaration_order() {
+        for (i, op) in BIN_OPS.iter().enumerate() {
+            assert_eq!(*op as usize, i);
+        }
+        for (i, op) in UN_OPS.iter().enumerate() {
+            assert_eq!(*op as usize, i);
+        }
+    }
+
+    #[test]
+    fn test_decode_rejects_bad_input() {
+        assert!(IrModule::decode(b"nope").is_err());
+        let mut bytes = IrModule::new().encode();
+        bytes.push(0);
+        assert!(IrModule::decode(&bytes).is_err());
+        let bytes = IrModule::new().encode();
+        assert!(IrModule::decode(&bytes[..bytes.len() - 1]).is_err());
+    }
+}
@@ -43,6 +43,21 @@ impl IrType {
         matches!(self, IrType::Ptr | IrType::Str | IrType::Array(_) | IrType::Struct(_) | IrType::FuncPtr(_) | IrType::Promise(_))
     }
 
+    /// Shift every struct id mentioned by this type by `offset`.
+    pub fn rebase_struct_ids(&mut self, offset: usize) {
+        match self {
+            IrType::Struct(id) => id.0 += offset,
+            IrType::Array(elem) | IrType::Promise(elem) => elem.rebase_struct_ids(offset),
+            IrType::FuncPtr(sig) => {
+                for param in &mut sig.params {
+                    param.rebase_struct_ids(offset);
+                }
+                sig.return_type.rebase_struct_ids(offset);
+            }
+            _ => {}
+        }
+    }
+
     /// Returns the size in bytes of this type (approximate for IR purposes).
     pub fn size_bytes(&self) -> usize {
         match self {
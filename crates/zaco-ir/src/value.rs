@@ -76,6 +76,35 @@ impl Place {
         self.projections.push(Projection::Deref);
         self
     }
+
+    /// Values read when this place is written to: the base of a projected
+    /// place and any index operands. A bare local or temp is only written.
+    pub fn operands(&self) -> Vec<&Value> {
+        let mut operands = Vec::new();
+        if !self.projections.is_empty() {
+            operands.push(&self.base);
+        }
+        for projection in &self.projections {
+            if let Projection::Index(index) = projection {
+                operands.push(index);
+            }
+        }
+        operands
+    }
+
+    /// Mutable access to the values read when this place is written to.
+    pub fn operands_mut(&mut self) -> Vec<&mut Value> {
+        let mut operands = Vec::new();
+        if !self.projections.is_empty() {
+            operands.push(&mut self.base);
+        }
+        for projection in &mut self.projections {
+            if let Projection::Index(index) = projection {
+                operands.push(index);
+            }
+        }
+        operands
+    }
 }
 
 /// Right-hand side of an assignment - represents a computation.
@@ -112,6 +141,38 @@ pub enum RValue {
     /// Array initialization
     ArrayInit(Vec<Value>),
 
+    /// Array initialization into a function-local stack slot (see
+    /// [`Instruction::StackAlloc`](crate::Instruction::StackAlloc))
+    StackArrayInit(Vec<Value>),
+
     /// String concatenation
     StrConcat(Vec<Value>),
 }
+
+impl RValue {
+    /// Values read by this computation.
+    pub fn operands(&self) -> Vec<&Value> {
+        match self {
+            RValue::Use(value) | RValue::Cast { value, .. } => vec![value],
+            RValue::BinaryOp { left, right, .. } => vec![left, right],
+            RValue::UnaryOp { operand, .. } => vec![operand],
+            RValue::StructInit { fields: values, .. }
+            | RValue::ArrayInit(values)
+            | RValue::StackArrayInit(values)
+            | RValue::StrConcat(values) => values.iter().collect(),
+        }
+    }
+
+    /// Mutable access to the values read by this computation.
+    pub fn operands_mut(&mut self) -> Vec<&mut Value> {
+        match self {
+            RValue::Use(value) | RValue::Cast { value, .. } => vec![value],
+            RValue::BinaryOp { left, right, .. } => vec![left, right],
+            RValue::UnaryOp { operand, .. } => vec![operand],
+            RValue::StructInit { fields: values, .. }
+            | RValue::ArrayInit(values)
+            | RValue::StackArrayInit(values)
+            | RValue::StrConcat(values) => values.iter_mut().collect(),
+        }
+    }
+}
@@ -1,13 +1,88 @@
+use std::borrow::Cow;
+
 use zaco_ast::Span;
 use crate::token::{Token, TokenKind};
 
+// Byte classes for the ASCII fast path. Bytes >= 0x80 have no class and are
+// decoded as UTF-8 on the slow path.
+const WHITESPACE: u8 = 1 << 0;
+const IDENT_START: u8 = 1 << 1;
+const IDENT_CONTINUE: u8 = 1 << 2;
+const DIGIT: u8 = 1 << 3;
+
+static BYTE_CLASS: [u8; 256] = byte_class_table();
+
+const fn byte_class_table() -> [u8; 256] {
+    let mut table = [0u8; 256];
+    let mut i = 0;
+    while i < 128 {
+        let b = i as u8;
+        let mut class = 0;
+        // Same set as `char::is_whitespace` below 0x80
+        if matches!(b, b' ' | b'\t' | b'\n' | b'\r' | 0x0b | 0x0c) {
+            class |= WHITESPACE;
+        }
+        if b.is_ascii_alphabetic() || b == b'_' || b == b'$' {
+            class |= IDENT_START | IDENT_CONTINUE;
+        }
+        if b.is_ascii_digit() {
+            class |= IDENT_CONTINUE | DIGIT;
+        }
+        table[i] = class;
+        i += 1;
+    }
+    table
+}
+
+#[inline]
+fn has_class(b: u8, class: u8) -> bool {
+    BYTE_CLASS[b as usize] & class != 0
+}
+
+const LOW_BITS: u64 = 0x0101_0101_0101_0101;
+const HIGH_BITS: u64 = 0x8080_8080_8080_8080;
+
+/// Position of the first byte in `bytes[from..]` that is one of `needles`,
+/// or `bytes.len()` if there is none.
+///
+/// Scans eight bytes per step: XOR-ing a word with a needle splatted across
+/// all lanes zeroes the matching lanes, and the zero-lane test below sets
+/// the high bit of each of them. Lanes above a true match can be flagged
+/// spuriously by the borrow, so only the lowest flag is trusted.
+fn find_any(bytes: &[u8], from: usize, needles: &[u8]) -> usize {
+    let mut i = from;
+    while i + 8 <= bytes.len() {
+        let word = u64::from_le_bytes(bytes[i..i + 8].try_into().unwrap());
+        let mut hits = 0;
+        for &needle in needles {
+            let x = word ^ (LOW_BITS * needle as u64);
+            hits |= x.wrapping_sub(LOW_BITS) & !x & HIGH_BITS;
+        }
+        if hits != 0 {
+            return i + (hits.trailing_zeros() / 8) as usize;
+        }
+        i += 8;
+    }
+    bytes[i..]
+        .iter()
+        .position(|b| needles.contains(b))
+        .map_or(bytes.len(), |p| i + p)
+}
+
 /// The lexer/tokenizer for TypeScript/Zaco.
+///
+/// Scans the source as bytes. ASCII is classified through a lookup table and
+/// comment and string bodies are skipped a word at a time; only non-ASCII
+/// characters are decoded. Tokens borrow their text from the source.
+///
+/// The lexer is also an iterator that yields tokens up to and including
+/// `Eof`, so the parser can pull them as it goes.
 pub struct Lexer<'a> {
     source: &'a str,
-    chars: std::str::CharIndices<'a>,
-    current_pos: usize,
-    current_char: Option<char>,
+    bytes: &'a [u8],
+    pos: usize,
     file_id: usize,
+    finished: bool,
 }
 
 impl<'a> Lexer<'a> {
@@ -18,873 +93,552 @@ impl<'a> Lexer<'a> {
 
     /// Creates a new lexer with a specific file ID.
     pub fn with_file_id(source: &'a str, file_id: usize) -> Self {
-        let mut chars = source.char_indices();
-        let current_char = chars.next().map(|(_, c)| c);
         Self {
             source,
-            chars,
-            current_pos: 0,
-            current_char,
+            bytes: source.as_bytes(),
+            pos: 0,
             file_id,
+            finished: false,
         }
     }
 
     /// Tokenizes the entire source code and returns all tokens.
-    pub fn tokenize(&mut self) -> Vec<Token> {
-        let mut tokens = Vec::new();
-        loop {
-            let token = self.next_token();
-            let is_eof = token.kind == TokenKind::Eof;
-            tokens.push(token);
-            if is_eof {
-                break;
-            }
-        }
+    pub fn tokenize(&mut self) -> Vec<Token<'a>> {
+        let mut tokens = Vec::with_capacity(self.bytes.len() / 4 + 1);
+        tokens.extend(self.by_ref());
         tokens
     }
 
     /// Gets the next token from the source.
-    pub fn next_token(&mut self) -> Token {
+    pub fn next_token(&mut self) -> Token<'a> {
         if let Some(error_token) = self.skip_whitespace_and_comments() {
             return error_token;
         }
 
-        let start = self.current_pos;
-
-        match self.current_char {
-            None => Token::new(TokenKind::Eof, Span::new(start, start, self.file_id), String::new()),
-            Some(ch) => {
-                let token = match ch {
-                    // String literals
-                    '"' | '\'' => self.read_string_literal(ch),
-                    '`' => self.read_template_literal(),
-
-                    // Numbers
-                    '0'..='9' => self.read_number(),
-
-                    // Identifiers and keywords
-                    'a'..='z' | 'A'..='Z' | '_' | '$' => self.read_identifier_or_keyword(),
-
-                    // Operators and delimiters
-                    '+' => self.read_plus(),
-                    '-' => self.read_minus(),
-                    '*' => self.read_star(),
-                    '/' => self.read_slash_or_regex(),
-                    '%' => self.read_percent(),
-                    '=' => self.read_eq(),
-                    '!' => self.read_bang(),
-                    '<' => self.read_lt(),
-                    '>' => self.read_gt(),
-                    '&' => self.read_amp(),
-                    '|' => self.read_pipe(),
-                    '^' => {
-                        self.advance();
-                        if self.current_char == Some('=') {
-                            self.advance();
-                            Token::new(TokenKind::CaretEq, Span::new(start, self.current_pos, self.file_id), "^=".to_string())
-                        } else {
-                            Token::new(TokenKind::Caret, Span::new(start, self.current_pos, self.file_id), "^".to_string())
-                        }
-                    }
-                    '~' => {
-                        self.advance();
-                        Token::new(TokenKind::Tilde, Span::new(start, self.current_pos, self.file_id), "~".to_string())
-                    }
-                    '?' => self.read_question(),
-                    '.' => self.read_dot(),
+        let start = self.pos;
+        let Some(b) = self.byte_at(start) else {
+            return Token::new(TokenKind::Eof, Span::new(start, start, self.file_id), "");
+        };
 
-                    // Delimiters
-                    '(' => {
-                        self.advance();
-                        Token::new(TokenKind::LParen, Span::new(start, self.current_pos, self.file_id), "(".to_string())
-                    }
-                    ')' => {
-                        self.advance();
-                        Token::new(TokenKind::RParen, Span::new(start, self.current_pos, self.file_id), ")".to_string())
-                    }
-                    '{' => {
-                        self.advance();
-                        Token::new(TokenKind::LBrace, Span::new(start, self.current_pos, self.file_id), "{".to_string())
-                    }
-                    '}' => {
-                        self.advance();
-                        Token::new(TokenKind::RBrace, Span::new(start, self.current_pos, self.file_id), "}".to_string())
-                    }
-                    '[' => {
-                        self.advance();
-                        Token::new(TokenKind::LBracket, Span::new(start, self.current_pos, self.file_id), "[".to_string())
-                    }
-                    ']' => {
-                        self.advance();
-                        Token::new(TokenKind::RBracket, Span::new(start, self.current_pos, self.file_id), "]".to_string())
-                    }
-                    ';' => {
-                        self.advance();
-                        Token::new(TokenKind::Semicolon, Span::new(start, self.current_pos, self.file_id), ";".to_string())
-                    }
-                    ',' => {
-                        self.advance();
-                        Token::new(TokenKind::Comma, Span::new(start, self.current_pos, self.file_id), ",".to_string())
-                    }
-                    ':' => {
-                        self.advance();
-                        Token::new(TokenKind::Colon, Span::new(start, self.current_pos, self.file_id), ":".to_string())
-                    }
-                    '@' => {
-                        self.advance();
-                        Token::new(TokenKind::At, Span::new(start, self.current_pos, self.file_id), "@".to_string())
-                    }
+        match b {
+            // String literals
+            b'"' | b'\'' => self.read_string_literal(b),
+            b'`' => self.read_template_literal(),
 
-                    // Unicode identifiers
-                    _ if ch.is_alphabetic() || ch == '_' => self.read_identifier_or_keyword(),
-
-                    // Error
-                    _ => {
-                        self.advance();
-                        Token::new(
-                            TokenKind::Error,
-                            Span::new(start, self.current_pos, self.file_id),
-                            format!("Unexpected character: {}", ch),
-                        )
-                    }
-                };
-                token
+            // Numbers
+            b'0'..=b'9' => self.read_number(),
+
+            // Identifiers and keywords
+            _ if has_class(b, IDENT_START) => self.read_identifier_or_keyword(),
+
+            // Unicode identifiers
+            0x80.. => {
+                let ch = self.char_at(start);
+                if ch.is_alphabetic() {
+                    self.read_identifier_or_keyword()
+                } else {
+                    self.pos += ch.len_utf8();
+                    self.error(start, format!("Unexpected character: {}", ch))
+                }
             }
+
+            // Operators and delimiters
+            _ => match self.punctuator(b) {
+                Some((kind, len)) => {
+                    self.pos += len;
+                    self.token(kind, start)
+                }
+                None if b == b'.' => self.read_fraction(start),
+                None => {
+                    self.pos += 1;
+                    self.error(start, format!("Unexpected character: {}", b as char))
+                }
+            },
         }
     }
 
     // Helper methods
 
-    fn advance(&mut self) {
-        if let Some((pos, ch)) = self.chars.next() {
-            self.current_pos = pos;
-            self.current_char = Some(ch);
-        } else {
-            self.current_pos = self.source.len();
-            self.current_char = None;
-        }
+    #[inline]
+    fn byte_at(&self, pos: usize) -> Option<u8> {
+        self.bytes.get(pos).copied()
     }
 
-    fn peek(&self) -> Option<char> {
-        self.chars.clone().next().map(|(_, c)| c)
+    /// Decode the character starting at `pos` (slow path for non-ASCII).
+    fn char_at(&self, pos: usize) -> char {
+        self.source[pos..].chars().next().unwrap_or('\u{FFFD}')
     }
 
-    #[allow(dead_code)]
-    fn peek_nth(&self, n: usize) -> Option<char> {
-        self.chars.clone().nth(n).map(|(_, c)| c)
+    /// Token whose value is the source text from `start` to the current position.
+    fn token(&self, kind: TokenKind, start: usize) -> Token<'a> {
+        Token::new(kind, Span::new(start, self.pos, self.file_id), &self.source[start..self.pos])
     }
 
-    fn skip_whitespace_and_comments(&mut self) -> Option<Token> {
-        loop {
-            match self.current_char {
-                Some(ch) if ch.is_whitespace() => {
-                    self.advance();
-                }
-                Some('/') => {
-                    if self.peek() == Some('/') {
-                        // Single-line comment
-                        self.skip_single_line_comment();
-                    } else if self.peek() == Some('*') {
-                        // Multi-line comment
-                        let start = self.current_pos;
-                        if !self.skip_multi_line_comment() {
-                            return Some(Token::new(
-                                TokenKind::Error,
-                                Span::new(start, self.current_pos, self.file_id),
-                                "Unterminated multi-line comment".to_string(),
-                            ));
-                        }
-                    } else {
-                        break;
-                    }
-                }
-                _ => break,
-            }
-        }
-        None
+    fn error(&self, start: usize, message: impl Into<Cow<'a, str>>) -> Token<'a> {
+        Token::new(TokenKind::Error, Span::new(start, self.pos, self.file_id), message)
     }
 
-    fn skip_single_line_comment(&mut self) {
-        // Skip //
-        self.advance();
-        self.advance();
-
-        while let Some(ch) = self.current_char {
-            if ch == '\n' {
-                self.advance();
+    fn skip_whitespace_and_comments(&mut self) -> Option<Token<'a>> {
+        while let Some(b) = self.byte_at(self.pos) {
+            if has_class(b, WHITESPACE) {
+                self.pos += 1;
+            } else if b == b'/' && self.byte_at(self.pos + 1) == Some(b'/') {
+                // Single-line comment, including its newline
+                self.pos = (find_any(self.bytes, self.pos + 2, b"\n") + 1).min(self.bytes.len());
+            } else if b == b'/' && self.byte_at(self.pos + 1) == Some(b'*') {
+                let start = self.pos;
+                if !self.skip_multi_line_comment() {
+                    return Some(self.error(start, "Unterminated multi-line comment"));
+                }
+            } else if b >= 0x80 && self.char_at(self.pos).is_whitespace() {
+                self.pos += self.char_at(self.pos).len_utf8();
+            } else {
                 break;
             }
-            self.advance();
         }
+        None
     }
 
     fn skip_multi_line_comment(&mut self) -> bool {
-        // Skip /*
-        self.advance();
-        self.advance();
-
-        while let Some(ch) = self.current_char {
-            if ch == '*' && self.peek() == Some('/') {
-                self.advance(); // *
-                self.advance(); // /
+        let mut pos = self.pos + 2;
+        loop {
+            pos = find_any(self.bytes, pos, b"*");
+            if pos >= self.bytes.len() {
+                self.pos = self.bytes.len();
+                return false; // Unterminated
+            }
+            if self.byte_at(pos + 1) == Some(b'/') {
+                self.pos = pos + 2;
                 return true;
             }
-            self.advance();
+            pos += 1;
         }
-        false // Unterminated
     }
 
-    fn read_string_literal(&mut self, quote: char) -> Token {
-        let start = self.current_pos;
-        self.advance(); // Skip opening quote
+    fn read_string_literal(&mut self, quote: u8) -> Token<'a> {
+        let start = self.pos;
+        let body = start + 1;
+        let stops = [quote, b'\\', b'\n'];
 
-        let mut value = String::new();
+        // Fast path: no escapes, so the value is a slice of the source
+        let end = find_any(self.bytes, body, &stops);
+        if self.byte_at(end) == Some(quote) {
+            self.pos = end + 1;
+            return Token::new(
+                TokenKind::StringLiteral,
+                Span::new(start, self.pos, self.file_id),
+                &self.source[body..end],
+            );
+        }
 
-        while let Some(ch) = self.current_char {
-            if ch == quote {
-                self.advance(); // Skip closing quote
-                return Token::new(
-                    TokenKind::StringLiteral,
-                    Span::new(start, self.current_pos, self.file_id),
-                    value,
-                );
-            } else if ch == '\\' {
-                self.advance();
-                if let Some(escaped) = self.current_char {
+        let mut value = String::new();
+        self.pos = body;
+        loop {
+            let end = find_any(self.bytes, self.pos, &stops);
+            value.push_str(&self.source[self.pos..end]);
+            self.pos = end;
+            match self.byte_at(end) {
+                Some(b) if b == quote => {
+                    self.pos += 1; // Skip closing quote
+                    return Token::new(
+                        TokenKind::StringLiteral,
+                        Span::new(start, self.pos, self.file_id),
+                        value,
+                    );
+                }
+                Some(b'\\') => {
+                    self.pos += 1;
+                    let Some(escaped) = self.byte_at(self.pos) else { break };
                     match escaped {
-                        'u' => {
-                            self.advance();
-                            value.push(self.read_unicode_escape());
-                            // read_unicode_escape already advanced past all hex digits
+                        b'u' => {
+                            self.pos += 1;
+                            value.push(self.read_hex_escape(4));
+                        }
+                        b'x' => {
+                            self.pos += 1;
+                            value.push(self.read_hex_escape(2));
                         }
-                        'x' => {
-                            self.advance();
-                            value.push(self.read_hex_escape());
-                            // read_hex_escape already advanced past all hex digits
+                        b'n' | b'r' | b't' | b'0' => {
+                            value.push(match escaped {
+                                b'n' => '\n',
+                                b'r' => '\r',
+                                b't' => '\t',
+                                _ => '\0',
+                            });
+                            self.pos += 1;
                         }
                         _ => {
-                            let unescaped = match escaped {
-                                'n' => '\n',
-                                'r' => '\r',
-                                't' => '\t',
-                                '\\' => '\\',
-                                '\'' => '\'',
-                                '"' => '"',
-                                '0' => '\0',
-                                _ => escaped,
-                            };
-                            value.push(unescaped);
-                            self.advance();
+                            let ch = self.char_at(self.pos);
+                            value.push(ch);
+                            self.pos += ch.len_utf8();
                         }
                     }
                 }
-            } else if ch == '\n' {
-                // Unterminated string
-                return Token::new(
-                    TokenKind::Error,
-                    Span::new(start, self.current_pos, self.file_id),
-                    "Unterminated string literal".to_string(),
-                );
-            } else {
-                value.push(ch);
-                self.advance();
+                // Newline or end of input
+                _ => break,
             }
         }
 
-        Token::new(
-            TokenKind::Error,
-            Span::new(start, self.current_pos, self.file_id),
-            "Unterminated string literal".to_string(),
-        )
-    }
-
-    fn read_unicode_escape(&mut self) -> char {
-        let mut code = 0u32;
-        for _ in 0..4 {
-            if let Some(ch) = self.current_char {
-                if let Some(digit) = ch.to_digit(16) {
-                    code = code * 16 + digit;
-                    self.advance();
-                } else {
-                    break;
-                }
-            }
-        }
-        char::from_u32(code).unwrap_or('\u{FFFD}')
+        self.error(start, "Unterminated string literal")
     }
 
-    fn read_hex_escape(&mut self) -> char {
+    /// Read up to `digits` hex digits as a code point.
+    fn read_hex_escape(&mut self, digits: usize) -> char {
         let mut code = 0u32;
-        for _ in 0..2 {
-            if let Some(ch) = self.current_char {
-                if let Some(digit) = ch.to_digit(16) {
+        for _ in 0..digits {
+            match self.byte_at(self.pos).and_then(|b| (b as char).to_digit(16)) {
+                Some(digit) => {
                     code = code * 16 + digit;
-                    self.advance();
-                } else {
-                    break;
+                    self.pos += 1;
                 }
+                None => break,
             }
         }
         char::from_u32(code).unwrap_or('\u{FFFD}')
     }
 
-    fn read_template_literal(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance(); // Skip opening backtick
-
-        let mut value = String::new();
-
-        while let Some(ch) = self.current_char {
-            if ch == '`' {
-                self.advance(); // Skip closing backtick
-                return Token::new(
-                    TokenKind::TemplateLiteral,
-                    Span::new(start, self.current_pos, self.file_id),
-                    value,
-                );
-            } else if ch == '\\' {
-                self.advance();
-                if let Some(escaped) = self.current_char {
-                    let unescaped = match escaped {
-                        'n' => '\n',
-                        'r' => '\r',
-                        't' => '\t',
-                        '\\' => '\\',
-                        '`' => '`',
-                        _ => escaped,
-                    };
-                    value.push(unescaped);
-                    self.advance();
-                }
-            } else {
-                value.push(ch);
-                self.advance();
-            }
-        }
-
-        Token::new(
-            TokenKind::Error,
-            Span::new(start, self.current_pos, self.file_id),
-            "Unterminated template literal".to_string(),
-        )
-    }
-
-    fn read_number(&mut self) -> Token {
-        let start = self.current_pos;
+    fn read_template_literal(&mut self) -> Token<'a> {
+        let start = self.pos;
+        let body = start + 1;
+        let stops = *b"`\\";
 
-        // Check for special number formats
-        if self.current_char == Some('0') {
-            match self.peek() {
-                Some('x') | Some('X') => return self.read_hex_number(start),
-                Some('o') | Some('O') => return self.read_octal_number(start),
-                Some('b') | Some('B') => return self.read_binary_number(start),
-                _ => {}
-            }
+        let end = find_any(self.bytes, body, &stops);
+        if self.byte_at(end) == Some(b'`') {
+            self.pos = end + 1;
+            return Token::new(
+                TokenKind::TemplateLiteral,
+                Span::new(start, self.pos, self.file_id),
+                &self.source[body..end],
+            );
         }
 
         let mut value = String::new();
-
-        // Read integer part
-        while let Some(ch) = self.current_char {
-            if ch.is_ascii_digit() || ch == '_' {
-                if ch != '_' {
-                    value.push(ch);
-                }
-                self.advance();
-            } else {
-                break;
-            }
-        }
-
-        // Check for decimal point
-        if self.current_char == Some('.') && self.peek().map_or(false, |c| c.is_ascii_digit()) {
-            value.push('.');
-            self.advance();
-
-            while let Some(ch) = self.current_char {
-                if ch.is_ascii_digit() || ch == '_' {
-                    if ch != '_' {
-                        value.push(ch);
-                    }
-                    self.advance();
-                } else {
-                    break;
+        self.pos = body;
+        loop {
+            let end = find_any(self.bytes, self.pos, &stops);
+            value.push_str(&self.source[self.pos..end]);
+            self.pos = end;
+            match self.byte_at(end) {
+                Some(b'`') => {
+                    self.pos += 1; // Skip closing backtick
+                    return Token::new(
+                        TokenKind::TemplateLiteral,
+                        Span::new(start, self.pos, self.file_id),
+                        value,
+                    );
                 }
-            }
-        }
-
-        // Check for exponent
-        if matches!(self.current_char, Some('e') | Some('E')) {
-            value.push('e');
-            self.advance();
-
-            if matches!(self.current_char, Some('+') | Some('-')) {
-                value.push(self.current_char.unwrap());
-                self.advance();
-            }
-
-            while let Some(ch) = self.current_char {
-                if ch.is_ascii_digit() || ch == '_' {
-                    if ch != '_' {
-                        value.push(ch);
+                Some(b'\\') => {
+                    self.pos += 1;
+                    if self.pos >= self.bytes.len() {
+                        break;
                     }
-                    self.advance();
-                } else {
-                    break;
-                }
-            }
-        }
-
-        // Check for BigInt suffix
-        if self.current_char == Some('n') {
-            self.advance();
-            return Token::new(TokenKind::BigIntLiteral, Span::new(start, self.current_pos, self.file_id), value);
-        }
-
-        Token::new(TokenKind::NumberLiteral, Span::new(start, self.current_pos, self.file_id), value)
-    }
-
-    fn read_hex_number(&mut self, start: usize) -> Token {
-        let mut value = String::from("0x");
-        self.advance(); // 0
-        self.advance(); // x
-
-        while let Some(ch) = self.current_char {
-            if ch.is_ascii_hexdigit() || ch == '_' {
-                if ch != '_' {
-                    value.push(ch);
-                }
-                self.advance();
-            } else {
-                break;
-            }
-        }
-
-        Token::new(TokenKind::NumberLiteral, Span::new(start, self.current_pos, self.file_id), value)
-    }
-
-    fn read_octal_number(&mut self, start: usize) -> Token {
-        let mut value = String::from("0o");
-        self.advance(); // 0
-        self.advance(); // o
-
-        while let Some(ch) = self.current_char {
-            if ('0'..='7').contains(&ch) || ch == '_' {
-                if ch != '_' {
-                    value.push(ch);
-                }
-                self.advance();
-            } else {
-                break;
-            }
-        }
-
-        Token::new(TokenKind::NumberLiteral, Span::new(start, self.current_pos, self.file_id), value)
-    }
-
-    fn read_binary_number(&mut self, start: usize) -> Token {
-        let mut value = String::from("0b");
-        self.advance(); // 0
-        self.advance(); // b
-
-        while let Some(ch) = self.current_char {
-            if ch == '0' || ch == '1' || ch == '_' {
-                if ch != '_' {
-                    value.push(ch);
+                    let ch = self.char_at(self.pos);
+                    value.push(match ch {
+                        'n' => '\n',
+                        'r' => '\r',
+                        't' => '\t',
+                        _ => ch,
+                    });
+                    self.pos += ch.len_utf8();
                 }
-                self.advance();
-            } else {
-                break;
+                _ => break,
             }
         }
 
-        Token::new(TokenKind::NumberLiteral, Span::new(start, self.current_pos, self.file_id), value)
+        self.error(start, "Unterminated template literal")
     }
 
-    fn read_identifier_or_keyword(&mut self) -> Token {
-        let start = self.current_pos;
-        let mut value = String::new();
-
-        while let Some(ch) = self.current_char {
-            if ch.is_alphanumeric() || ch == '_' || ch == '$' {
-                value.push(ch);
-                self.advance();
+    /// Advance over digits (and `_` separators) accepted by `is_digit`.
+    fn skip_digits(&mut self, is_digit: impl Fn(u8) -> bool) {
+        while let Some(b) = self.byte_at(self.pos) {
+            if is_digit(b) || b == b'_' {
+                self.pos += 1;
             } else {
                 break;
             }
         }
-
-        let kind = match value.as_str() {
-            "let" => TokenKind::Let,
-            "const" => TokenKind::Const,
-            "var" => TokenKind::Var,
-            "function" => TokenKind::Function,
-            "return" => TokenKind::Return,
-            "if" => TokenKind::If,
-            "else" => TokenKind::Else,
-            "for" => TokenKind::For,
-            "while" => TokenKind::While,
-            "do" => TokenKind::Do,
-            "break" => TokenKind::Break,
-            "continue" => TokenKind::Continue,
-            "switch" => TokenKind::Switch,
-            "case" => TokenKind::Case,
-            "default" => TokenKind::Default,
-            "class" => TokenKind::Class,
-            "extends" => TokenKind::Extends,
-            "implements" => TokenKind::Implements,
-            "interface" => TokenKind::Interface,
-            "type" => TokenKind::Type,
-            "enum" => TokenKind::Enum,
-            "import" => TokenKind::Import,
-            "export" => TokenKind::Export,
-            "from" => TokenKind::From,
-            "as" => TokenKind::As,
-            "new" => TokenKind::New,
-            "this" => TokenKind::This,
-            "super" => TokenKind::Super,
-            "typeof" => TokenKind::Typeof,
-            "instanceof" => TokenKind::Instanceof,
-            "in" => TokenKind::In,
-            "of" => TokenKind::Of,
-            "void" => TokenKind::Void,
-            "null" => TokenKind::Null,
-            "undefined" => TokenKind::Undefined,
-            "true" => TokenKind::True,
-            "false" => TokenKind::False,
-            "async" => TokenKind::Async,
-            "await" => TokenKind::Await,
-            "yield" => TokenKind::Yield,
-            "try" => TokenKind::Try,
-            "catch" => TokenKind::Catch,
-            "finally" => TokenKind::Finally,
-            "throw" => TokenKind::Throw,
-            "static" => TokenKind::Static,
-            "public" => TokenKind::Public,
-            "private" => TokenKind::Private,
-            "protected" => TokenKind::Protected,
-            "readonly" => TokenKind::Readonly,
-            "abstract" => TokenKind::Abstract,
-            "declare" => TokenKind::Declare,
-            "module" => TokenKind::Module,
-            "namespace" => TokenKind::Namespace,
-            "require" => TokenKind::Require,
-            "keyof" => TokenKind::Keyof,
-            "infer" => TokenKind::Infer,
-            "never" => TokenKind::Never,
-            "unknown" => TokenKind::Unknown,
-            "any" => TokenKind::Any,
-            "satisfies" => TokenKind::Satisfies,
-            "override" => TokenKind::Override,
-            "is" => TokenKind::Is,
-            "asserts" => TokenKind::Asserts,
-            "out" => TokenKind::Out,
-            "accessor" => TokenKind::Accessor,
-            "using" => TokenKind::Using,
-            "debugger" => TokenKind::Debugger,
-            "with" => TokenKind::With,
-            "owned" => TokenKind::Owned,
-            "ref" => TokenKind::Ref,
-            "clone" => TokenKind::Clone,
-            "mut" => TokenKind::Mut,
-            _ => TokenKind::Identifier,
-        };
-
-        Token::new(kind, Span::new(start, self.current_pos, self.file_id), value)
-    }
-
-    fn read_plus(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        match self.current_char {
-            Some('+') => {
-                self.advance();
-                Token::new(TokenKind::PlusPlus, Span::new(start, self.current_pos, self.file_id), "++".to_string())
-            }
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::PlusEq, Span::new(start, self.current_pos, self.file_id), "+=".to_string())
-            }
-            _ => Token::new(TokenKind::Plus, Span::new(start, self.current_pos, self.file_id), "+".to_string()),
-        }
     }
 
-    fn read_minus(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        match self.current_char {
-            Some('-') => {
-                self.advance();
-                Token::new(TokenKind::MinusMinus, Span::new(start, self.current_pos, self.file_id), "--".to_string())
+    fn skip_exponent(&mut self) {
+        if matches!(self.byte_at(self.pos), Some(b'e') | Some(b'E')) {
+            self.pos += 1;
+            if matches!(self.byte_at(self.pos), Some(b'+') | Some(b'-')) {
+                self.pos += 1;
             }
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::MinusEq, Span::new(start, self.current_pos, self.file_id), "-=".to_string())
-            }
-            _ => Token::new(TokenKind::Minus, Span::new(start, self.current_pos, self.file_id), "-".to_string()),
+            self.skip_digits(|b| b.is_ascii_digit());
         }
     }
 
-    fn read_star(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
+    fn read_number(&mut self) -> Token<'a> {
+        let start = self.pos;
 
-        match self.current_char {
-            Some('*') => {
-                self.advance();
-                if self.current_char == Some('=') {
-                    self.advance();
-                    Token::new(TokenKind::StarStarEq, Span::new(start, self.current_pos, self.file_id), "**=".to_string())
+        // Check for special number formats
+        if self.byte_at(start) == Some(b'0') {
+            let is_digit: Option<fn(u8) -> bool> = match self.byte_at(start + 1) {
+                Some(b'x') | Some(b'X') => Some(|b: u8| b.is_ascii_hexdigit()),
+                Some(b'o') | Some(b'O') => Some(|b: u8| (b'0'..=b'7').contains(&b)),
+                Some(b'b') | Some(b'B') => Some(|b: u8| b == b'0' || b == b'1'),
+                _ => None,
+            };
+            if let Some(is_digit) = is_digit {
+                self.pos += 2;
+                self.skip_digits(is_digit);
+                let raw = &self.source[start..self.pos];
+                let value = if raw.as_bytes()[1].is_ascii_lowercase() && !raw.contains('_') {
+                    Cow::Borrowed(raw)
                 } else {
-                    Token::new(TokenKind::StarStar, Span::new(start, self.current_pos, self.file_id), "**".to_string())
-                }
-            }
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::StarEq, Span::new(start, self.current_pos, self.file_id), "*=".to_string())
+                    let mut value = format!("0{}", raw[1..2].to_ascii_lowercase());
+                    value.extend(raw[2..].chars().filter(|&c| c != '_'));
+                    Cow::Owned(value)
+                };
+                return Token::new(TokenKind::NumberLiteral, Span::new(start, self.pos, self.file_id), value);
             }
-            _ => Token::new(TokenKind::Star, Span::new(start, self.current_pos, self.file_id), "*".to_string()),
         }
-    }
 
-    fn read_slash_or_regex(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        match self.current_char {
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::SlashEq, Span::new(start, self.current_pos, self.file_id), "/=".to_string())
-            }
-            _ => Token::new(TokenKind::Slash, Span::new(start, self.current_pos, self.file_id), "/".to_string()),
+        // Integer part, then a fraction only when a digit follows the dot
+        self.skip_digits(|b| b.is_ascii_digit());
+        if self.byte_at(self.pos) == Some(b'.') && self.byte_at(self.pos + 1).map_or(false, |b| has_class(b, DIGIT)) {
+            self.pos += 1;
+            self.skip_digits(|b| b.is_ascii_digit());
         }
-    }
+        self.skip_exponent();
 
-    fn read_percent(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
+        let value = decimal_value(&self.source[start..self.pos], "");
 
-        if self.current_char == Some('=') {
-            self.advance();
-            Token::new(TokenKind::PercentEq, Span::new(start, self.current_pos, self.file_id), "%=".to_string())
-        } else {
-            Token::new(TokenKind::Percent, Span::new(start, self.current_pos, self.file_id), "%".to_string())
+        // Check for BigInt suffix
+        if self.byte_at(self.pos) == Some(b'n') {
+            self.pos += 1;
+            return Token::new(TokenKind::BigIntLiteral, Span::new(start, self.pos, self.file_id), value);
         }
-    }
-
-    fn read_eq(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
 
-        match self.current_char {
-            Some('=') => {
-                self.advance();
-                if self.current_char == Some('=') {
-                    self.advance();
-                    Token::new(TokenKind::EqEqEq, Span::new(start, self.current_pos, self.file_id), "===".to_string())
-                } else {
-                    Token::new(TokenKind::EqEq, Span::new(start, self.current_pos, self.file_id), "==".to_string())
-                }
-            }
-            Some('>') => {
-                self.advance();
-                Token::new(TokenKind::FatArrow, Span::new(start, self.current_pos, self.file_id), "=>".to_string())
-            }
-            _ => Token::new(TokenKind::Eq, Span::new(start, self.current_pos, self.file_id), "=".to_string()),
-        }
+        Token::new(TokenKind::NumberLiteral, Span::new(start, self.pos, self.file_id), value)
     }
 
-    fn read_bang(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        match self.current_char {
-            Some('=') => {
-                self.advance();
-                if self.current_char == Some('=') {
-                    self.advance();
-                    Token::new(TokenKind::BangEqEq, Span::new(start, self.current_pos, self.file_id), "!==".to_string())
-                } else {
-                    Token::new(TokenKind::BangEq, Span::new(start, self.current_pos, self.file_id), "!=".to_string())
-                }
-            }
-            _ => Token::new(TokenKind::Bang, Span::new(start, self.current_pos, self.file_id), "!".to_string()),
-        }
+    /// Number starting with a dot (e.g. `.5`), valued with a leading zero.
+    fn read_fraction(&mut self, start: usize) -> Token<'a> {
+        self.pos += 1;
+        self.skip_digits(|b| b.is_ascii_digit());
+        self.skip_exponent();
+        let value = decimal_value(&self.source[start..self.pos], "0");
+        Token::new(TokenKind::NumberLiteral, Span::new(start, self.pos, self.file_id), value)
     }
 
-    fn read_lt(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        match self.current_char {
-            Some('<') => {
-                self.advance();
-                if self.current_char == Some('=') {
-                    self.advance();
-                    Token::new(TokenKind::LtLtEq, Span::new(start, self.current_pos, self.file_id), "<<=".to_string())
-                } else {
-                    Token::new(TokenKind::LtLt, Span::new(start, self.current_pos, self.file_id), "<<".to_string())
-                }
-            }
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::LtEq, Span::new(start, self.current_pos, self.file_id), "<=".to_string())
-            }
-            _ => Token::new(TokenKind::Lt, Span::new(start, self.current_pos, self.file_id), "<".to_string()),
-        }
-    }
-
-    fn read_gt(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        match self.current_char {
-            Some('>') => {
-                self.advance();
-                match self.current_char {
-                    Some('>') => {
-                        self.advance();
-                        if self.current_char == Some('=') {
-                            self.advance();
-                            Token::new(TokenKind::GtGtGtEq, Span::new(start, self.current_pos, self.file_id), ">>>=".to_string())
-                        } else {
-                            Token::new(TokenKind::GtGtGt, Span::new(start, self.current_pos, self.file_id), ">>>".to_string())
-                        }
-                    }
-                    Some('=') => {
-                        self.advance();
-                        Token::new(TokenKind::GtGtEq, Span::new(start, self.current_pos, self.file_id), ">>=".to_string())
+    fn read_identifier_or_keyword(&mut self) -> Token<'a> {
+        let start = self.pos;
+        loop {
+            match self.byte_at(self.pos) {
+                Some(b) if has_class(b, IDENT_CONTINUE) => self.pos += 1,
+                Some(0x80..) => {
+                    let ch = self.char_at(self.pos);
+                    if !ch.is_alphanumeric() {
+                        break;
                     }
-                    _ => Token::new(TokenKind::GtGt, Span::new(start, self.current_pos, self.file_id), ">>".to_string()),
+                    self.pos += ch.len_utf8();
                 }
+                _ => break,
             }
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::GtEq, Span::new(start, self.current_pos, self.file_id), ">=".to_string())
-            }
-            _ => Token::new(TokenKind::Gt, Span::new(start, self.current_pos, self.file_id), ">".to_string()),
         }
-    }
 
-    fn read_amp(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        match self.current_char {
-            Some('&') => {
-                self.advance();
-                if self.current_char == Some('=') {
-                    self.advance();
-                    Token::new(TokenKind::AmpAmpEq, Span::new(start, self.current_pos, self.file_id), "&&=".to_string())
-                } else {
-                    Token::new(TokenKind::AmpAmp, Span::new(start, self.current_pos, self.file_id), "&&".to_string())
-                }
-            }
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::AmpEq, Span::new(start, self.current_pos, self.file_id), "&=".to_string())
-            }
-            _ => Token::new(TokenKind::Amp, Span::new(start, self.current_pos, self.file_id), "&".to_string()),
-        }
+        let text = &self.source[start..self.pos];
+        let kind = keyword(text).unwrap_or(TokenKind::Identifier);
+        Token::new(kind, Span::new(start, self.pos, self.file_id), text)
     }
 
-    fn read_pipe(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
+    /// Operator or delimiter starting with `b`, with its length in bytes.
+    fn punctuator(&self, b: u8) -> Option<(TokenKind, usize)> {
+        let next = self.byte_at(self.pos + 1);
+        let third = self.byte_at(self.pos + 2);
+        let fourth = self.byte_at(self.pos + 3);
 
-        match self.current_char {
-            Some('|') => {
-                self.advance();
-                if self.current_char == Some('=') {
-                    self.advance();
-                    Token::new(TokenKind::PipePipeEq, Span::new(start, self.current_pos, self.file_id), "||=".to_string())
-                } else {
-                    Token::new(TokenKind::PipePipe, Span::new(start, self.current_pos, self.file_id), "||".to_string())
-                }
-            }
-            Some('=') => {
-                self.advance();
-                Token::new(TokenKind::PipeEq, Span::new(start, self.current_pos, self.file_id), "|=".to_string())
-            }
-            _ => Token::new(TokenKind::Pipe, Span::new(start, self.current_pos, self.file_id), "|".to_string()),
-        }
+        // Operator whose `=`-suffixed form is the compound assignment
+        let with_eq = |plain, assign| {
+            if next == Some(b'=') { (assign, 2) } else { (plain, 1) }
+        };
+
+        let op = match b {
+            b'+' if next == Some(b'+') => (TokenKind::PlusPlus, 2),
+            b'+' => with_eq(TokenKind::Plus, TokenKind::PlusEq),
+            b'-' if next == Some(b'-') => (TokenKind::MinusMinus, 2),
+            b'-' => with_eq(TokenKind::Minus, TokenKind::MinusEq),
+            b'*' if next == Some(b'*') => {
+                if third == Some(b'=') { (TokenKind::StarStarEq, 3) } else { (TokenKind::StarStar, 2) }
+            }
+            b'*' => with_eq(TokenKind::Star, TokenKind::StarEq),
+            b'/' => with_eq(TokenKind::Slash, TokenKind::SlashEq),
+            b'%' => with_eq(TokenKind::Percent, TokenKind::PercentEq),
+            b'^' => with_eq(TokenKind::Caret, TokenKind::CaretEq),
+            b'=' => match (next, third) {
+                (Some(b'='), Some(b'=')) => (TokenKind::EqEqEq, 3),
+                (Some(b'='), _) => (TokenKind::EqEq, 2),
+                (Some(b'>'), _) => (TokenKind::FatArrow, 2),
+                _ => (TokenKind::Eq, 1),
+            },
+            b'!' => match (next, third) {
+                (Some(b'='), Some(b'=')) => (TokenKind::BangEqEq, 3),
+                (Some(b'='), _) => (TokenKind::BangEq, 2),
+                _ => (TokenKind::Bang, 1),
+            },
+            b'<' => match (next, third) {
+                (Some(b'<'), Some(b'=')) => (TokenKind::LtLtEq, 3),
+                (Some(b'<'), _) => (TokenKind::LtLt, 2),
+                (Some(b'='), _) => (TokenKind::LtEq, 2),
+                _ => (TokenKind::Lt, 1),
+            },
+            b'>' => match (next, third, fourth) {
+                (Some(b'>'), Some(b'>'), Some(b'=')) => (TokenKind::GtGtGtEq, 4),
+                (Some(b'>'), Some(b'>'), _) => (TokenKind::GtGtGt, 3),
+                (Some(b'>'), Some(b'='), _) => (TokenKind::GtGtEq, 3),
+                (Some(b'>'), _, _) => (TokenKind::GtGt, 2),
+                (Some(b'='), _, _) => (TokenKind::GtEq, 2),
+                _ => (TokenKind::Gt, 1),
+            },
+            b'&' => match (next, third) {
+                (Some(b'&'), Some(b'=')) => (TokenKind::AmpAmpEq, 3),
+                (Some(b'&'), _) => (TokenKind::AmpAmp, 2),
+                (Some(b'='), _) => (TokenKind::AmpEq, 2),
+                _ => (TokenKind::Amp, 1),
+            },
+            b'|' => match (next, third) {
+                (Some(b'|'), Some(b'=')) => (TokenKind::PipePipeEq, 3),
+                (Some(b'|'), _) => (TokenKind::PipePipe, 2),
+                (Some(b'='), _) => (TokenKind::PipeEq, 2),
+                _ => (TokenKind::Pipe, 1),
+            },
+            b'?' => match (next, third) {
+                (Some(b'?'), Some(b'=')) => (TokenKind::QuestionQuestionEq, 3),
+                (Some(b'?'), _) => (TokenKind::QuestionQuestion, 2),
+                (Some(b'.'), _) => (TokenKind::QuestionDot, 2),
+                _ => (TokenKind::Question, 1),
+            },
+            b'.' if next == Some(b'.') && third == Some(b'.') => (TokenKind::DotDotDot, 3),
+            // A digit after the dot starts a number
+            b'.' if next.map_or(false, |b| has_class(b, DIGIT)) => return None,
+            b'.' => (TokenKind::Dot, 1),
+            b'~' => (TokenKind::Tilde, 1),
+            b'(' => (TokenKind::LParen, 1),
+            b')' => (TokenKind::RParen, 1),
+            b'{' => (TokenKind::LBrace, 1),
+            b'}' => (TokenKind::RBrace, 1),
+            b'[' => (TokenKind::LBracket, 1),
+            b']' => (TokenKind::RBracket, 1),
+            b';' => (TokenKind::Semicolon, 1),
+            b',' => (TokenKind::Comma, 1),
+            b':' => (TokenKind::Colon, 1),
+            b'@' => (TokenKind::At, 1),
+            _ => return None,
+        };
+        Some(op)
     }
+}
 
-    fn read_question(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
+impl<'a> Iterator for Lexer<'a> {
+    type Item = Token<'a>;
 
-        match self.current_char {
-            Some('?') => {
-                self.advance();
-                if self.current_char == Some('=') {
-                    self.advance();
-                    Token::new(TokenKind::QuestionQuestionEq, Span::new(start, self.current_pos, self.file_id), "??=".to_string())
-                } else {
-                    Token::new(TokenKind::QuestionQuestion, Span::new(start, self.current_pos, self.file_id), "??".to_string())
-                }
-            }
-            Some('.') => {
-                self.advance();
-                Token::new(TokenKind::QuestionDot, Span::new(start, self.current_pos, self.file_id), "?.".to_string())
-            }
-            _ => Token::new(TokenKind::Question, Span::new(start, self.current_pos, self.file_id), "?".to_string()),
+    /// Yields every token, ending with a single `Eof`.
+    fn next(&mut self) -> Option<Token<'a>> {
+        if self.finished {
+            return None;
         }
+        let token = self.next_token();
+        self.finished = token.kind == TokenKind::Eof;
+        Some(token)
     }
+}
 
-    fn read_dot(&mut self) -> Token {
-        let start = self.current_pos;
-        self.advance();
-
-        if self.current_char == Some('.') && self.peek() == Some('.') {
-            self.advance();
-            self.advance();
-            Token::new(TokenKind::DotDotDot, Span::new(start, self.current_pos, self.file_id), "...".to_string())
-        } else if self.current_char.map_or(false, |c| c.is_ascii_digit()) {
-            // Number starting with dot (e.g., .5)
-            // Read fractional part directly — don't rewind the iterator
-            let mut value = String::from("0.");
-
-            while let Some(ch) = self.current_char {
-                if ch.is_ascii_digit() || ch == '_' {
-                    if ch != '_' {
-                        value.push(ch);
-                    }
-                    self.advance();
-                } else {
-                    break;
-                }
-            }
-
-            // Check for exponent
-            if matches!(self.current_char, Some('e') | Some('E')) {
-                value.push('e');
-                self.advance();
-
-                if matches!(self.current_char, Some('+') | Some('-')) {
-                    value.push(self.current_char.unwrap());
-                    self.advance();
-                }
-
-                while let Some(ch) = self.current_char {
-                    if ch.is_ascii_digit() || ch == '_' {
-                        if ch != '_' {
-                            value.push(ch);
-                        }
-                        self.advance();
-                    } else {
-                        break;
-                    }
-                }
-            }
+/// Value of a decimal literal: `raw` without `_` separators and with a
+/// lowercase exponent marker, after `prefix`. Borrows `raw` when that is
+/// already the value.
+fn decimal_value<'a>(raw: &'a str, prefix: &str) -> Cow<'a, str> {
+    if prefix.is_empty() && !raw.bytes().any(|b| b == b'_' || b == b'E') {
+        return Cow::Borrowed(raw);
+    }
+    let mut value = String::with_capacity(prefix.len() + raw.len());
+    value.push_str(prefix);
+    value.extend(raw.chars().filter(|&c| c != '_').map(|c| if c == 'E' { 'e' } else { c }));
+    Cow::Owned(value)
+}
 
-            Token::new(TokenKind::NumberLiteral, Span::new(start, self.current_pos, self.file_id), value)
-        } else {
-            Token::new(TokenKind::Dot, Span::new(start, self.current_pos, self.file_id), ".".to_string())
-        }
-    }
+fn keyword(text: &str) -> Option<TokenKind> {
+    // No keyword is shorter than 2 or longer than 10 bytes
+    if !(2..=10).contains(&text.len()) {
+        return None;
+    }
+    let kind = match text {
+        "let" => TokenKind::Let,
+        "const" => TokenKind::Const,
+        "var" => TokenKind::Var,
+        "function" => TokenKind::Function,
+        "return" => TokenKind::Return,
+        "if" => TokenKind::If,
+        "else" => TokenKind::Else,
+        "for" => TokenKind::For,
+        "while" => TokenKind::While,
+        "do" => TokenKind::Do,
+        "break" => TokenKind::Break,
+        "continue" => TokenKind::Continue,
+        "switch" => TokenKind::Switch,
+        "case" => TokenKind::Case,
+        "default" => TokenKind::Default,
+        "class" => TokenKind::Class,
+        "extends" => TokenKind::Extends,
+        "implements" => TokenKind::Implements,
+        "interface" => TokenKind::Interface,
+        "type" => TokenKind::Type,
+        "enum" => TokenKind::Enum,
+        "import" => TokenKind::Import,
+        "export" => TokenKind::Export,
+        "from" => TokenKind::From,
+        "as" => TokenKind::As,
+        "new" => TokenKind::New,
+        "this" => TokenKind::This,
+        "super" => TokenKind::Super,
+        "typeof" => TokenKind::Typeof,
+        "instanceof" => TokenKind::Instanceof,
+        "in" => TokenKind::In,
+        "of" => TokenKind::Of,
+        "void" => TokenKind::Void,
+        "null" => TokenKind::Null,
+        "undefined" => TokenKind::Undefined,
+        "true" => TokenKind::True,
+        "false" => TokenKind::False,
+        "async" => TokenKind::Async,
+        "await" => TokenKind::Await,
+        "yield" => TokenKind::Yield,
+        "try" => TokenKind::Try,
+        "catch" => TokenKind::Catch,
+        "finally" => TokenKind::Finally,
+        "throw" => TokenKind::Throw,
+        "static" => TokenKind::Static,
+        "public" => TokenKind::Public,
+        "private" => TokenKind::Private,
+        "protected" => TokenKind::Protected,
+        "readonly" => TokenKind::Readonly,
+        "abstract" => TokenKind::Abstract,
+        "declare" => TokenKind::Declare,
+        "module" => TokenKind::Module,
+        "namespace" => TokenKind::Namespace,
+        "require" => TokenKind::Require,
+        "keyof" => TokenKind::Keyof,
+        "infer" => TokenKind::Infer,
+        "never" => TokenKind::Never,
+        "unknown" => TokenKind::Unknown,
+        "any" => TokenKind::Any,
+        "satisfies" => TokenKind::Satisfies,
+        "override" => TokenKind::Override,
+        "is" => TokenKind::Is,
+        "asserts" => TokenKind::Asserts,
+        "out" => TokenKind::Out,
+        "accessor" => TokenKind::Accessor,
+        "using" => TokenKind::Using,
+        "debugger" => TokenKind::Debugger,
+        "with" => TokenKind::With,
+        "owned" => TokenKind::Owned,
+        "ref" => TokenKind::Ref,
+        "clone" => TokenKind::Clone,
+        "mut" => TokenKind::Mut,
+        _ => return None,
+    };
+    Some(kind)
 }
 
 #[cfg(test)]
@@ -1069,4 +823,68 @@ mod tests {
         assert_eq!(tokens[5].kind, TokenKind::CaretEq);
         assert_eq!(tokens[5].value, "^=");
     }
+
+    #[test]
+    fn test_values_borrow_from_source() {
+        let source = r#"name "plain" "esc\n" 1_000 0x1F 2E3"#;
+        let tokens = Lexer::new(source).tokenize();
+
+        assert!(matches!(tokens[0].value, Cow::Borrowed("name")));
+        assert!(matches!(tokens[1].value, Cow::Borrowed("plain")));
+        assert_eq!(tokens[2].value, "esc\n");
+        assert!(matches!(tokens[2].value, Cow::Owned(_)));
+        assert_eq!(tokens[3].value, "1000");
+        assert!(matches!(tokens[4].value, Cow::Borrowed("0x1F")));
+        assert_eq!(tokens[5].value, "2e3");
+    }
+
+    #[test]
+    fn test_escapes_and_unicode() {
+        let source = "'a\\tb\\u0041\\x42' `x\\`y` caf\u{e9} ünï .5e2";
+        let tokens = Lexer::new(source).tokenize();
+
+        assert_eq!(tokens[0].value, "a\tbAB");
+        assert_eq!(tokens[1].kind, TokenKind::TemplateLiteral);
+        assert_eq!(tokens[1].value, "x`y");
+        assert_eq!(tokens[2].kind, TokenKind::Identifier);
+        assert_eq!(tokens[2].value, "caf\u{e9}");
+        assert_eq!(tokens[3].value, "ünï");
+        assert_eq!(tokens[4].value, "0.5e2");
+        assert_eq!(tokens[4].span, Span::new(source.len() - 4, source.len(), 0));
+    }
+
+    #[test]
+    fn test_unterminated_literals_and_comments() {
+        let tokens = Lexer::new("\"abc\nx").tokenize();
+        assert_eq!(tokens[0].kind, TokenKind::Error);
+        assert_eq!(tokens[0].value, "Unterminated string literal");
+        assert_eq!(tokens[0].span.end, 4);
+
+        let tokens = Lexer::new("x /* never closed").tokenize();
+        assert_eq!(tokens[1].kind, TokenKind::Error);
+        assert_eq!(tokens[1].value, "Unterminated multi-line comment");
+        assert_eq!(tokens[2].kind, TokenKind::Eof);
+    }
+
+    #[test]
+    fn test_find_any_matches_scalar_search() {
+        let text = b"0123456789abcdef*/ \"tail\n";
+        for from in 0..text.len() {
+            for needles in [&b"*"[..], b"\n", b"\"\\\n", b"z"] {
+                let expected = text[from..]
+                    .iter()
+                    .position(|b| needles.contains(b))
+                    .map_or(text.len(), |p| from + p);
+                assert_eq!(find_any(text, from, needles), expected, "from {} needles {:?}", from, needles);
+            }
+        }
+    }
+
+    #[test]
+    fn test_iterator_ends_after_eof() {
+        let mut lexer = Lexer::new("a // trailing comment");
+        assert_eq!(lexer.next().unwrap().kind, TokenKind::Identifier);
+        assert_eq!(lexer.next().unwrap().kind, TokenKind::Eof);
+        assert!(lexer.next().is_none());
+    }
 }
@@ -1,3 +1,5 @@
+use std::borrow::Cow;
+
 use zaco_ast::Span;
 
 /// Represents the different kinds of tokens in TypeScript/Zaco.
@@ -157,15 +159,20 @@ pub enum TokenKind {
 }
 
 /// Represents a token with its kind, span, and value.
+///
+/// `value` borrows from the source whenever the token's text appears there
+/// verbatim: identifiers, keywords, operators, plain numbers and the body of
+/// strings without escapes. Only unescaped strings, normalized numbers and
+/// error messages own their text.
 #[derive(Debug, Clone, PartialEq, Eq)]
-pub struct Token {
+pub struct Token<'a> {
     pub kind: TokenKind,
     pub span: Span,
-    pub value: String,
+    pub value: Cow<'a, str>,
 }
 
-impl Token {
-    pub(crate) fn new(kind: TokenKind, span: Span, value: String) -> Self {
-        Self { kind, span, value }
+impl<'a> Token<'a> {
+    pub(crate) fn new(kind: TokenKind, span: Span, value: impl Into<Cow<'a, str>>) -> Self {
+        Self { kind, span, value: value.into() }
     }
 }
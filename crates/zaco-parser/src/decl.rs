@@ -2,7 +2,7 @@
 
 use super::*;
 
-impl Parser {
+impl<'a> Parser<'a> {
     pub(crate) fn parse_declaration(&mut self) -> ParseResult<Node<Decl>> {
         let start = self.current_token().span;
 
@@ -173,6 +173,7 @@ impl Parser {
         let mut is_readonly = false;
         let mut is_abstract = false;
         let mut is_override = false;
+        let mut is_async = false;
 
         loop {
             match self.current_token().kind {
@@ -204,6 +205,10 @@ impl Parser {
                     self.advance();
                     is_override = true;
                 }
+                TokenKind::Async => {
+                    self.advance();
+                    is_async = true;
+                }
                 _ => break,
             }
         }
@@ -354,7 +359,7 @@ impl Parser {
                 body,
                 access,
                 is_static,
-                is_async: false,
+                is_async,
                 is_abstract,
                 is_optional,
                 is_override,
@@ -511,7 +516,7 @@ impl Parser {
         }
 
         let name = if self.check(&TokenKind::StringLiteral) {
-            ModuleName::String(self.advance().value.clone())
+            ModuleName::String(self.advance().value.to_string())
         } else {
             ModuleName::Ident(self.parse_identifier()?)
         };
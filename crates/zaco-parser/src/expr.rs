@@ -2,7 +2,7 @@
 
 use super::*;
 
-impl Parser {
+impl<'a> Parser<'a> {
     pub(crate) fn parse_expression(&mut self) -> ParseResult<Node<Expr>> {
         self.parse_expression_with_precedence(0)
     }
@@ -378,12 +378,12 @@ impl Parser {
         let expr = match self.current_token().kind {
             // Literals
             TokenKind::NumberLiteral => {
-                let value = self.advance().value.clone();
+                let value = self.advance().value.to_string();
                 let num = value.parse::<f64>().unwrap_or(0.0);
                 Expr::Literal(Literal::Number(num))
             }
             TokenKind::StringLiteral => {
-                let value = self.advance().value.clone();
+                let value = Symbol::intern(&self.advance().value);
                 Expr::Literal(Literal::String(value))
             }
             TokenKind::True => {
@@ -405,7 +405,7 @@ impl Parser {
 
             // Template literal
             TokenKind::TemplateLiteral => {
-                let value = self.advance().value.clone();
+                let value = self.advance().value.to_string();
                 // Simple template without expressions
                 Expr::Template {
                     parts: vec![value],
@@ -415,7 +415,7 @@ impl Parser {
 
             // Identifiers
             TokenKind::Identifier => {
-                let name = self.advance().value.clone();
+                let name = self.advance().value.to_string();
                 Expr::Ident(Ident::new(name))
             }
 
@@ -524,7 +524,7 @@ impl Parser {
 
             // Parenthesized expression or arrow function
             TokenKind::LParen => {
-                return self.parse_paren_or_arrow();
+                return self.parse_paren_or_arrow(false);
             }
 
             // Function expression
@@ -635,8 +635,11 @@ impl Parser {
                         body,
                         is_async: true,
                     }
+                } else if self.check(&TokenKind::LParen) {
+                    // async (params) => body
+                    return self.parse_paren_or_arrow(true);
                 } else {
-                    // async arrow function
+                    // async x => body
                     return self.parse_arrow_function(None, None, true);
                 }
             }
@@ -653,14 +656,22 @@ impl Parser {
         Ok(Node::new(expr, span))
     }
 
-    fn parse_paren_or_arrow(&mut self) -> ParseResult<Node<Expr>> {
+    /// `is_async` is set after an `async` keyword, where only an arrow
+    /// function may follow.
+    fn parse_paren_or_arrow(&mut self, is_async: bool) -> ParseResult<Node<Expr>> {
         let start = self.current_token().span;
         self.consume(TokenKind::LParen)?;
 
         // Empty params arrow function
         if self.check(&TokenKind::RParen) {
             self.advance();
-            return self.parse_arrow_function(Some(Vec::new()), None, false);
+            let return_type = if self.check(&TokenKind::Colon) {
+                self.advance();
+                Some(Box::new(self.parse_type()?))
+            } else {
+                None
+            };
+            return self.parse_arrow_function(Some(Vec::new()), return_type, is_async);
         }
 
         // Try to determine if this is an arrow function or parenthesized expression
@@ -680,11 +691,15 @@ impl Parser {
                 };
 
                 if self.check(&TokenKind::FatArrow) {
-                    return self.parse_arrow_function(Some(params), return_type, false);
+                    return self.parse_arrow_function(Some(params), return_type, is_async);
                 }
             }
         }
 
+        if is_async {
+            return Err(self.error("Expected an arrow function after 'async'".to_string()));
+        }
+
         // Reset and parse as parenthesized expression
         self.current = checkpoint;
 
@@ -706,7 +721,7 @@ impl Parser {
         &mut self,
         params: Option<Vec<Param>>,
         return_type: Option<Box<Node<Type>>>,
-        _is_async: bool,
+        is_async: bool,
     ) -> ParseResult<Node<Expr>> {
         let start = self.current_token().span;
 
@@ -744,6 +759,7 @@ impl Parser {
                 params,
                 return_type,
                 body,
+                is_async,
             },
             span,
         ))
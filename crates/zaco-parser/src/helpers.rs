@@ -2,11 +2,11 @@
 
 use super::*;
 
-impl Parser {
+impl<'a> Parser<'a> {
     pub(crate) fn parse_identifier(&mut self) -> ParseResult<Node<Ident>> {
         let token = self.consume(TokenKind::Identifier)?;
         Ok(Node::new(
-            Ident::new(token.value.clone()),
+            Ident::new(token.value.to_string()),
             token.span,
         ))
     }
@@ -18,11 +18,11 @@ impl Parser {
                 Ok(PropertyName::Ident(ident))
             }
             TokenKind::StringLiteral => {
-                let value = self.advance().value.clone();
+                let value = self.advance().value.to_string();
                 Ok(PropertyName::String(value))
             }
             TokenKind::NumberLiteral => {
-                let value = self.advance().value.clone();
+                let value = self.advance().value.to_string();
                 let num = value.parse::<f64>().unwrap_or(0.0);
                 Ok(PropertyName::Number(num))
             }
@@ -283,17 +283,18 @@ impl Parser {
     // Utility Methods (Token Manipulation)
     // =========================================================================
 
-    pub(crate) fn current_token(&self) -> &Token {
+    pub(crate) fn current_token(&self) -> &Token<'a> {
         &self.tokens[self.current.min(self.tokens.len() - 1)]
     }
 
-    pub(crate) fn previous_token(&self) -> &Token {
+    pub(crate) fn previous_token(&self) -> &Token<'a> {
         &self.tokens[(self.current.saturating_sub(1)).min(self.tokens.len() - 1)]
     }
 
-    pub(crate) fn advance(&mut self) -> &Token {
+    pub(crate) fn advance(&mut self) -> &Token<'a> {
         if !self.is_at_end() {
             self.current += 1;
+            self.fill();
         }
         self.previous_token()
     }
@@ -315,7 +316,7 @@ impl Parser {
         self.current >= self.tokens.len() || self.current_token().kind == TokenKind::Eof
     }
 
-    pub(crate) fn consume(&mut self, kind: TokenKind) -> ParseResult<&Token> {
+    pub(crate) fn consume(&mut self, kind: TokenKind) -> ParseResult<&Token<'a>> {
         if self.check(&kind) {
             Ok(self.advance())
         } else {
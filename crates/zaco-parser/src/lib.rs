@@ -4,7 +4,7 @@
 //! Uses Pratt parsing for expressions with proper operator precedence.
 
 use zaco_ast::*;
-use zaco_lexer::{Token, TokenKind};
+use zaco_lexer::{Lexer, Token, TokenKind};
 
 // Module declarations
 mod error;
@@ -27,12 +27,9 @@ pub use parser::Parser;
 #[cfg(test)]
 mod tests {
     use super::*;
-    use zaco_lexer::Lexer;
 
     fn parse(source: &str) -> Result<Program, Vec<ParseError>> {
-        let mut lexer = Lexer::new(source);
-        let tokens = lexer.tokenize();
-        let mut parser = Parser::new(tokens);
+        let mut parser = Parser::from_lexer(Lexer::new(source));
         parser.parse_program()
     }
 
@@ -64,6 +61,41 @@ mod tests {
         assert_eq!(program.items.len(), 1);
     }
 
+    #[test]
+    fn test_parse_async_arrow_and_method() {
+        let arrow_is_async = |source: &str| {
+            let program = parse(source).unwrap();
+            match &program.items[0].value {
+                ModuleItem::Stmt(stmt) => match &stmt.value {
+                    Stmt::VarDecl(decl) => match decl.declarations[0].init.as_ref().map(|e| &e.value) {
+                        Some(Expr::Arrow { is_async, .. }) => *is_async,
+                        other => panic!("expected an arrow, got {:?}", other),
+                    },
+                    other => panic!("expected a declaration, got {:?}", other),
+                },
+                other => panic!("expected a statement, got {:?}", other),
+            }
+        };
+        assert!(arrow_is_async("const f = async (a: number): Promise<number> => a;"));
+        assert!(arrow_is_async("const f = async () => { await g(); };"));
+        assert!(arrow_is_async("const f = async x => x;"));
+        assert!(!arrow_is_async("const f = (a: number) => a;"));
+
+        let source = "class C { async load(): Promise<void> {} static async make() {} run() {} }";
+        let program = parse(source).unwrap();
+        let ModuleItem::Decl(decl) = &program.items[0].value else { panic!("expected a class") };
+        let Decl::Class(class) = &decl.value else { panic!("expected a class") };
+        let asyncs: Vec<_> = class
+            .members
+            .iter()
+            .filter_map(|m| match m {
+                ClassMember::Method { is_async, .. } => Some(*is_async),
+                _ => None,
+            })
+            .collect();
+        assert_eq!(asyncs, [true, true, false]);
+    }
+
     #[test]
     fn test_parse_class_declaration() {
         let source = r#"
@@ -248,4 +280,21 @@ mod tests {
             }
         }
     }
+
+    #[test]
+    fn test_lazy_parse_matches_token_vector() {
+        let source = "function f(a: number) { return a < 2 ? a : f(a - 1); }\nlet s = `x${1}`;";
+        let eager = Parser::new(Lexer::new(source).tokenize()).parse_program().unwrap();
+        let mut lazy = Parser::from_lexer(Lexer::new(source));
+        assert_eq!(format!("{:?}", lazy.parse_program().unwrap()), format!("{:?}", eager));
+        assert!(lazy.lex_errors().is_empty());
+    }
+
+    #[test]
+    fn test_lazy_parse_collects_lex_errors() {
+        let mut parser = Parser::from_lexer(Lexer::new("let a = 1; let b = #;"));
+        let _ = parser.parse_program();
+        assert_eq!(parser.lex_errors().len(), 1);
+        assert_eq!(parser.lex_errors()[0].value, "Unexpected character: #");
+    }
 }
@@ -2,16 +2,59 @@
 
 use super::*;
 
+/// Tokens the parser looks at past the current one (`peek_kind(1)`).
+const LOOKAHEAD: usize = 1;
+
 /// Recursive descent parser for TypeScript/Zaco
-pub struct Parser {
-    pub(crate) tokens: Vec<Token>,
+pub struct Parser<'a> {
+    /// Tokens lexed so far; kept so backtracking can rewind `current`
+    pub(crate) tokens: Vec<Token<'a>>,
     pub(crate) current: usize,
+    /// Source of further tokens when parsing lazily
+    lexer: Option<Lexer<'a>>,
+    /// `Error` tokens pulled from `lexer`
+    lex_errors: Vec<Token<'a>>,
 }
 
-impl Parser {
+impl<'a> Parser<'a> {
     /// Creates a new parser from a token stream
-    pub fn new(tokens: Vec<Token>) -> Self {
-        Self { tokens, current: 0 }
+    pub fn new(tokens: Vec<Token<'a>>) -> Self {
+        Self { tokens, current: 0, lexer: None, lex_errors: Vec::new() }
+    }
+
+    /// Creates a parser that pulls tokens from `lexer` as it advances, so
+    /// lexing and parsing interleave instead of lexing the whole file first.
+    /// Check [`Parser::lex_errors`] after parsing.
+    pub fn from_lexer(lexer: Lexer<'a>) -> Self {
+        let mut parser = Self { tokens: Vec::new(), current: 0, lexer: Some(lexer), lex_errors: Vec::new() };
+        parser.fill();
+        parser
+    }
+
+    /// Lexer errors met while parsing from a lexer, in source order.
+    pub fn lex_errors(&self) -> &[Token<'a>] {
+        &self.lex_errors
+    }
+
+    /// Lex until the current token and its lookahead are buffered.
+    pub(crate) fn fill(&mut self) {
+        let Some(lexer) = self.lexer.as_mut() else {
+            return;
+        };
+        while self.tokens.len() <= self.current + LOOKAHEAD {
+            match lexer.next() {
+                Some(token) => {
+                    if token.kind == TokenKind::Error {
+                        self.lex_errors.push(token.clone());
+                    }
+                    self.tokens.push(token);
+                }
+                None => {
+                    self.lexer = None;
+                    return;
+                }
+            }
+        }
     }
 
     /// Parses a complete program
@@ -115,7 +158,7 @@ impl Parser {
 
         // import "module"
         if self.check(&TokenKind::StringLiteral) {
-            let source = self.advance().value.clone();
+            let source = self.advance().value.to_string();
             self.consume_semicolon();
             return Ok(ImportDecl {
                 specifiers,
@@ -133,7 +176,7 @@ impl Parser {
                 self.advance();
             } else {
                 self.consume(TokenKind::From)?;
-                let source = self.consume(TokenKind::StringLiteral)?.value.clone();
+                let source = self.consume(TokenKind::StringLiteral)?.value.to_string();
                 self.consume_semicolon();
                 return Ok(ImportDecl {
                     specifiers,
@@ -185,7 +228,7 @@ impl Parser {
         }
 
         self.consume(TokenKind::From)?;
-        let source = self.consume(TokenKind::StringLiteral)?.value.clone();
+        let source = self.consume(TokenKind::StringLiteral)?.value.to_string();
         self.consume_semicolon();
 
         Ok(ImportDecl {
@@ -233,7 +276,7 @@ impl Parser {
             };
 
             self.consume(TokenKind::From)?;
-            let source = self.consume(TokenKind::StringLiteral)?.value.clone();
+            let source = self.consume(TokenKind::StringLiteral)?.value.to_string();
             self.consume_semicolon();
 
             return Ok(ExportDecl::All {
@@ -279,7 +322,7 @@ impl Parser {
 
             let source = if self.check(&TokenKind::From) {
                 self.advance();
-                Some(self.consume(TokenKind::StringLiteral)?.value.clone())
+                Some(self.consume(TokenKind::StringLiteral)?.value.to_string())
             } else {
                 None
             };
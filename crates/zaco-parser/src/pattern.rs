@@ -2,7 +2,7 @@
 
 use super::*;
 
-impl Parser {
+impl<'a> Parser<'a> {
     pub(crate) fn parse_pattern(&mut self) -> ParseResult<Node<Pattern>> {
         let start = self.current_token().span;
 
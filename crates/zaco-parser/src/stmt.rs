@@ -2,7 +2,7 @@
 
 use super::*;
 
-impl Parser {
+impl<'a> Parser<'a> {
     pub(crate) fn parse_statement(&mut self) -> ParseResult<Node<Stmt>> {
         let start = self.current_token().span;
 
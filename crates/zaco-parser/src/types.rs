@@ -2,7 +2,7 @@
 
 use super::*;
 
-impl Parser {
+impl<'a> Parser<'a> {
     pub(crate) fn parse_type(&mut self) -> ParseResult<Node<Type>> {
         self.parse_union_type()
     }
@@ -108,7 +108,7 @@ impl Parser {
         let ty = match self.current_token().kind {
             // Primitive types
             TokenKind::Identifier => {
-                let name = self.current_token().value.clone();
+                let name = self.current_token().value.to_string();
                 let primitive = match name.as_str() {
                     "number" => Some(PrimitiveType::Number),
                     "string" => Some(PrimitiveType::String),
@@ -365,16 +365,16 @@ impl Parser {
 
             // Literal types
             TokenKind::StringLiteral => {
-                let value = self.advance().value.clone();
+                let value = self.advance().value.to_string();
                 Type::Literal(LiteralType::String(value))
             }
             TokenKind::NumberLiteral => {
-                let value = self.advance().value.clone();
+                let value = self.advance().value.to_string();
                 let num = value.parse::<f64>().unwrap_or(0.0);
                 Type::Literal(LiteralType::Number(num))
             }
             TokenKind::TemplateLiteral => {
-                let value = self.advance().value.clone();
+                let value = self.advance().value.to_string();
                 Type::TemplateLiteral {
                     parts: vec![value],
                     types: vec![],
@@ -416,7 +416,7 @@ impl Parser {
             TokenKind::Import => {
                 self.advance();
                 self.consume(TokenKind::LParen)?;
-                let argument = self.consume(TokenKind::StringLiteral)?.value.clone();
+                let argument = self.consume(TokenKind::StringLiteral)?.value.to_string();
                 self.consume(TokenKind::RParen)?;
                 let qualifier = if self.check(&TokenKind::Dot) {
                     self.advance();
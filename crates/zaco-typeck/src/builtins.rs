@@ -123,6 +123,51 @@ impl BuiltinRegistry {
             },
         );
 
+        // createReadStream(path: string, chunkSize: number) => number (stream handle)
+        exports.insert(
+            "createReadStream".to_string(),
+            Type::Function {
+                params: vec![Type::String, Type::Number],
+                return_type: Box::new(Type::Number),
+            },
+        );
+
+        // createWriteStream(path: string, append: boolean) => number (stream handle)
+        exports.insert(
+            "createWriteStream".to_string(),
+            Type::Function {
+                params: vec![Type::String, Type::Boolean],
+                return_type: Box::new(Type::Number),
+            },
+        );
+
+        // readChunk(stream: number) => string ("" at end of file)
+        exports.insert(
+            "readChunk".to_string(),
+            Type::Function {
+                params: vec![Type::Number],
+                return_type: Box::new(Type::String),
+            },
+        );
+
+        // writeChunk(stream: number, data: string) => void
+        exports.insert(
+            "writeChunk".to_string(),
+            Type::Function {
+                params: vec![Type::Number, Type::String],
+                return_type: Box::new(Type::Void),
+            },
+        );
+
+        // closeStream(stream: number) => void
+        exports.insert(
+            "closeStream".to_string(),
+            Type::Function {
+                params: vec![Type::Number],
+                return_type: Box::new(Type::Void),
+            },
+        );
+
         self.register_module("fs", exports);
     }
 
@@ -328,7 +328,7 @@ impl TypeChecker {
                                 .map(|n| n.value.name.clone())
                                 .unwrap_or_else(|| imported.value.name.clone());
 
-                            self.env.declare(local_name, VarInfo {
+                            self.env.declare(local_name.to_string(), VarInfo {
                                 ty: symbol_type.clone(),
                                 ownership: OwnershipState::Borrowed,
                                 is_mutable: false,
@@ -348,7 +348,7 @@ impl TypeChecker {
                     ImportSpecifier::Default(ident) => {
                         // For now, treat default imports from built-in modules as Any
                         // This could be improved with a default export registry
-                        self.env.declare(ident.value.name.clone(), VarInfo {
+                        self.env.declare(ident.value.name.to_string(), VarInfo {
                             ty: Type::Any,
                             ownership: OwnershipState::Borrowed,
                             is_mutable: false,
@@ -364,7 +364,7 @@ impl TypeChecker {
                                 .map(|(name, ty)| (name.clone(), ty.clone(), false))
                                 .collect();
 
-                            self.env.declare(ident.value.name.clone(), VarInfo {
+                            self.env.declare(ident.value.name.to_string(), VarInfo {
                                 ty: Type::Object { properties },
                                 ownership: OwnershipState::Borrowed,
                                 is_mutable: false,
@@ -386,7 +386,7 @@ impl TypeChecker {
                             .map(|n| n.value.name.clone())
                             .unwrap_or_else(|| imported.value.name.clone());
 
-                        self.env.declare(local_name, VarInfo {
+                        self.env.declare(local_name.to_string(), VarInfo {
                             ty: Type::Any,
                             ownership: OwnershipState::Borrowed,
                             is_mutable: false,
@@ -394,7 +394,7 @@ impl TypeChecker {
                         });
                     }
                     ImportSpecifier::Default(ident) => {
-                        self.env.declare(ident.value.name.clone(), VarInfo {
+                        self.env.declare(ident.value.name.to_string(), VarInfo {
                             ty: Type::Any,
                             ownership: OwnershipState::Borrowed,
                             is_mutable: false,
@@ -402,7 +402,7 @@ impl TypeChecker {
                         });
                     }
                     ImportSpecifier::Namespace(ident) => {
-                        self.env.declare(ident.value.name.clone(), VarInfo {
+                        self.env.declare(ident.value.name.to_string(), VarInfo {
                             ty: Type::Any,
                             ownership: OwnershipState::Borrowed,
                             is_mutable: false,
@@ -439,7 +439,7 @@ impl TypeChecker {
                             .unwrap_or_else(|| local_name.clone());
 
                         // Register the export
-                        self.env.export_symbol(export_name, var_info.ty.clone());
+                        self.env.export_symbol(export_name.to_string(), var_info.ty.clone());
                     } else {
                         // Symbol being exported doesn't exist
                         return Err(TypeError {
@@ -490,14 +490,14 @@ impl TypeChecker {
                             if let zaco_ast::Pattern::Ident { name: ident, .. } = &declarator.pattern.value {
                                 let n = ident.value.name.clone();
                                 let t = self.env.lookup(&n).map(|vi| vi.ty.clone()).unwrap_or(Type::Any);
-                                self.env.export_symbol(n, t);
+                                self.env.export_symbol(n.to_string(), t);
                             }
                         }
                         return Ok(());
                     }
-                    zaco_ast::Decl::Module(_) => ("module".to_string(), Type::Any),
+                    zaco_ast::Decl::Module(_) => ("module".into(), Type::Any),
                 };
-                self.env.export_symbol(name, ty);
+                self.env.export_symbol(name.to_string(), ty);
             }
             ExportDecl::All { .. } => {
                 // export * from "module"
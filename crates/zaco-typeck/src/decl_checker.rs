@@ -49,7 +49,7 @@ impl TypeChecker {
 
         // Declare function in environment
         self.env.declare(
-            func.name.value.name.clone(),
+            func.name.value.name.to_string(),
             VarInfo {
                 ty: func_type,
                 ownership: OwnershipState::Owned,
@@ -100,7 +100,7 @@ impl TypeChecker {
                 };
 
                 self.env.declare(
-                    name.value.name.clone(),
+                    name.value.name.to_string(),
                     VarInfo {
                         ty: param_ty,
                         ownership: ownership_state,
@@ -194,24 +194,24 @@ impl TypeChecker {
         }
 
         let class_type = Type::Class {
-            name: class.name.value.name.clone(),
+            name: class.name.value.name.to_string(),
             fields,
             methods,
         };
 
-        self.env.define_class(class.name.value.name.clone(), class_type.clone());
+        self.env.define_class(class.name.value.name.to_string(), class_type.clone());
 
         // Register generic type parameter names if present
         if let Some(ref type_params) = class.type_params {
             let param_names: Vec<String> = type_params.iter()
-                .map(|tp| tp.name.value.name.clone())
+                .map(|tp| tp.name.value.name.to_string())
                 .collect();
-            self.env.define_type_params(class.name.value.name.clone(), param_names);
+            self.env.define_type_params(class.name.value.name.to_string(), param_names);
         }
 
         // Also declare constructor
         self.env.declare(
-            class.name.value.name.clone(),
+            class.name.value.name.to_string(),
             VarInfo {
                 ty: class_type,
                 ownership: OwnershipState::Owned,
@@ -247,19 +247,19 @@ impl TypeChecker {
         }
 
         let interface_type = Type::Interface {
-            name: interface.name.value.name.clone(),
+            name: interface.name.value.name.to_string(),
             properties,
         };
 
         self.env
-            .define_interface(interface.name.value.name.clone(), interface_type);
+            .define_interface(interface.name.value.name.to_string(), interface_type);
 
         // Register generic type parameter names if present
         if let Some(ref type_params) = interface.type_params {
             let param_names: Vec<String> = type_params.iter()
-                .map(|tp| tp.name.value.name.clone())
+                .map(|tp| tp.name.value.name.to_string())
                 .collect();
-            self.env.define_type_params(interface.name.value.name.clone(), param_names);
+            self.env.define_type_params(interface.name.value.name.to_string(), param_names);
         }
 
         Ok(())
@@ -267,7 +267,7 @@ impl TypeChecker {
 
     fn check_type_alias(&mut self, alias: &TypeAliasDecl, _span: &Span) -> Result<(), TypeError> {
         let ty = self.convert_ast_type(&alias.ty.value)?;
-        self.env.define_type_alias(alias.name.value.name.clone(), ty);
+        self.env.define_type_alias(alias.name.value.name.to_string(), ty);
         Ok(())
     }
 
@@ -275,15 +275,15 @@ impl TypeChecker {
         let members: Vec<String> = enum_decl
             .members
             .iter()
-            .map(|m| m.name.value.name.clone())
+            .map(|m| m.name.value.name.to_string())
             .collect();
 
         let enum_type = Type::Enum {
-            name: enum_decl.name.value.name.clone(),
+            name: enum_decl.name.value.name.to_string(),
             members,
         };
 
-        self.env.define_enum(enum_decl.name.value.name.clone(), enum_type);
+        self.env.define_enum(enum_decl.name.value.name.to_string(), enum_type);
         Ok(())
     }
 }
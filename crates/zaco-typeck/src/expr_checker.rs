@@ -38,8 +38,9 @@ impl TypeChecker {
                 params,
                 return_type,
                 body,
+                is_async,
                 ..
-            } => self.check_arrow(params, return_type.as_ref(), body, span),
+            } => self.check_arrow(params, return_type.as_ref(), body, *is_async, span),
             Expr::Function {
                 params,
                 return_type,
@@ -160,7 +161,7 @@ impl TypeChecker {
     fn check_literal(&self, lit: &Literal) -> Type {
         match lit {
             Literal::Number(n) => Type::Literal(LiteralType::Number(*n)),
-            Literal::String(s) => Type::Literal(LiteralType::String(s.clone())),
+            Literal::String(s) => Type::Literal(LiteralType::String(s.to_string())),
             Literal::Boolean(b) => Type::Literal(LiteralType::Boolean(*b)),
             Literal::Null => Type::Null,
             Literal::Undefined => Type::Undefined,
@@ -294,7 +295,7 @@ impl TypeChecker {
             if let Some(var_info) = self.env.lookup(var_name) {
                 if !var_info.is_mutable {
                     return Err(TypeError::new(
-                        TypeErrorKind::AssignToImmutable(var_name.clone()),
+                        TypeErrorKind::AssignToImmutable(var_name.to_string()),
                         span.clone(),
                     ));
                 }
@@ -331,7 +332,7 @@ impl TypeChecker {
                 }
             } else {
                 return Err(TypeError::new(
-                    TypeErrorKind::UndefinedVariable(var_name.clone()),
+                    TypeErrorKind::UndefinedVariable(var_name.to_string()),
                     span.clone(),
                 ));
             }
@@ -415,7 +416,7 @@ impl TypeChecker {
                 Err(TypeError::new(
                     TypeErrorKind::PropertyNotFound {
                         ty: object_ty,
-                        property: prop_name.clone(),
+                        property: prop_name.to_string(),
                     },
                     span.clone(),
                 ))
@@ -436,7 +437,7 @@ impl TypeChecker {
                 Err(TypeError::new(
                     TypeErrorKind::PropertyNotFound {
                         ty: object_ty,
-                        property: prop_name.clone(),
+                        property: prop_name.to_string(),
                     },
                     span.clone(),
                 ))
@@ -450,7 +451,7 @@ impl TypeChecker {
                 Err(TypeError::new(
                     TypeErrorKind::PropertyNotFound {
                         ty: object_ty,
-                        property: prop_name.clone(),
+                        property: prop_name.to_string(),
                     },
                     span.clone(),
                 ))
@@ -498,7 +499,7 @@ impl TypeChecker {
                             Err(TypeError::new(
                                 TypeErrorKind::PropertyNotFound {
                                     ty: resolved.clone(),
-                                    property: prop_name.clone(),
+                                    property: prop_name.to_string(),
                                 },
                                 span.clone(),
                             ))
@@ -517,7 +518,7 @@ impl TypeChecker {
                             Err(TypeError::new(
                                 TypeErrorKind::PropertyNotFound {
                                     ty: resolved.clone(),
-                                    property: prop_name.clone(),
+                                    property: prop_name.to_string(),
                                 },
                                 span.clone(),
                             ))
@@ -536,11 +537,20 @@ impl TypeChecker {
                 }
                 Ok(Type::Any)
             }
+            Type::Array(_) | Type::Tuple(_) if prop_name == "length" => Ok(Type::Number),
+            Type::Array(elem_ty) if prop_name == "indexOf" => Ok(Type::Function {
+                params: vec![(**elem_ty).clone()],
+                return_type: Box::new(Type::Number),
+            }),
+            Type::Array(_) if prop_name == "reverse" => Ok(Type::Function {
+                params: vec![],
+                return_type: Box::new(object_ty.clone()),
+            }),
             Type::Any | Type::Unknown => Ok(Type::Any),
             _ => Err(TypeError::new(
                 TypeErrorKind::PropertyNotFound {
                     ty: object_ty,
-                    property: prop_name.clone(),
+                    property: prop_name.to_string(),
                 },
                 span.clone(),
             )),
@@ -649,6 +659,7 @@ impl TypeChecker {
         params: &[Param],
         return_type: Option<&Box<Node<zaco_ast::Type>>>,
         body: &ArrowBody,
+        is_async: bool,
         _span: &Span,
     ) -> Result<Type, TypeError> {
         self.env.push_scope();
@@ -663,6 +674,11 @@ impl TypeChecker {
         }
 
         let ret_ty = match body {
+            // An async arrow's expression body settles the promise it returns
+            ArrowBody::Expr(expr) if is_async => match self.check_expr(&expr.value, &expr.span)? {
+                promise @ Type::Promise(_) => promise,
+                value => Type::Promise(Box::new(value)),
+            },
             ArrowBody::Expr(expr) => self.check_expr(&expr.value, &expr.span)?,
             ArrowBody::Block(block) => {
                 self.check_block_stmt(&block.value, &block.span)?;
@@ -828,7 +844,7 @@ impl TypeChecker {
                     return Ok(Type::Promise(Box::new(converted_args.into_iter().next().unwrap())));
                 }
 
-                Ok(Type::TypeRef { name: type_name, type_args: converted_args })
+                Ok(Type::TypeRef { name: type_name.to_string(), type_args: converted_args })
             }
             zaco_ast::Type::Object(obj_ty) => {
                 let mut properties = Vec::new();
@@ -43,7 +43,7 @@ impl TypeHelpers {
 
     pub fn property_name_to_string(name: &PropertyName) -> String {
         match name {
-            PropertyName::Ident(ident) => ident.value.name.clone(),
+            PropertyName::Ident(ident) => ident.value.name.to_string(),
             PropertyName::String(s) => s.clone(),
             PropertyName::Number(n) => n.to_string(),
             PropertyName::Computed(_) => "__computed__".to_string(),
@@ -92,7 +92,7 @@ mod tests {
                             ownership: None,
                         }),
                         init: Some(make_node(Expr::Literal(Literal::String(
-                            "hello".to_string(),
+                            "hello".into(),
                         )))),
                     }],
                 },
@@ -280,7 +280,7 @@ mod tests {
                                 ObjectProperty::Property {
                                     key: PropertyName::Ident(make_node(Ident::new("name"))),
                                     value: make_node(Expr::Literal(Literal::String(
-                                        "foo".to_string(),
+                                        "foo".into(),
                                     ))),
                                     shorthand: false,
                                 },
@@ -436,8 +436,8 @@ mod tests {
                             callee: Box::new(make_node(Expr::Ident(Ident::new("readFileSync")))),
                             type_args: None,
                             args: vec![
-                                make_node(Expr::Literal(Literal::String("test.txt".to_string()))),
-                                make_node(Expr::Literal(Literal::String("utf-8".to_string()))),
+                                make_node(Expr::Literal(Literal::String("test.txt".into()))),
+                                make_node(Expr::Literal(Literal::String("utf-8".into()))),
                             ],
                         })),
                     }],
@@ -497,8 +497,8 @@ mod tests {
                             callee: Box::new(make_node(Expr::Ident(Ident::new("read")))),
                             type_args: None,
                             args: vec![
-                                make_node(Expr::Literal(Literal::String("test.txt".to_string()))),
-                                make_node(Expr::Literal(Literal::String("utf-8".to_string()))),
+                                make_node(Expr::Literal(Literal::String("test.txt".into()))),
+                                make_node(Expr::Literal(Literal::String("utf-8".into()))),
                             ],
                         })),
                     }],
@@ -538,8 +538,8 @@ mod tests {
                             })),
                             type_args: None,
                             args: vec![
-                                make_node(Expr::Literal(Literal::String("test.txt".to_string()))),
-                                make_node(Expr::Literal(Literal::String("utf-8".to_string()))),
+                                make_node(Expr::Literal(Literal::String("test.txt".into()))),
+                                make_node(Expr::Literal(Literal::String("utf-8".into()))),
                             ],
                         })),
                     }],
@@ -597,7 +597,7 @@ mod tests {
                     })),
                     type_args: None,
                     args: vec![make_node(Expr::Literal(Literal::String(
-                        "Hello".to_string(),
+                        "Hello".into(),
                     )))],
                 }),
             ))))],
@@ -799,4 +799,27 @@ mod tests {
         assert!(result.is_ok(), "Should resolve generic interface member access");
         assert_eq!(result.unwrap(), TyType::String, "Wrapper<string>.data should be string");
     }
+
+    #[test]
+    fn test_array_length_is_number() {
+        use crate::types::Type as TyType;
+
+        let mut checker = TypeChecker::new();
+        checker.env.declare("xs".to_string(), VarInfo {
+            ty: TyType::Array(Box::new(TyType::Number)),
+            ownership: OwnershipState::Owned,
+            is_mutable: false,
+            is_initialized: true,
+        });
+
+        let result = checker.check_expr(
+            &Expr::Member {
+                object: Box::new(make_node(Expr::Ident(Ident::new("xs")))),
+                property: make_node(Ident::new("length")),
+                computed: false,
+            },
+            &dummy_span(),
+        );
+        assert_eq!(result.unwrap(), TyType::Number);
+    }
 }
@@ -1,6 +1,6 @@
 //! Statement checking methods
 
-use zaco_ast::{BlockStmt, ForInit, Pattern, Span, Stmt, VarDecl, VarDeclKind};
+use zaco_ast::{BlockStmt, ForInLeft, ForInit, Pattern, Span, Stmt, VarDecl, VarDeclKind};
 use crate::checker::TypeChecker;
 use crate::error::{TypeError, TypeErrorKind};
 use crate::types::Type;
@@ -93,13 +93,34 @@ impl TypeChecker {
                 Ok(())
             }
             Stmt::ForOf {
-                left: _,
+                left,
                 right,
                 body,
                 ..
             } => {
                 self.env.push_scope();
-                self.check_expr(&right.value, &right.span)?;
+                let iter_ty = self.check_expr(&right.value, &right.span)?;
+                // Declare loop variable with the element type
+                let elem_ty = match iter_ty {
+                    Type::Array(elem_ty) => *elem_ty,
+                    Type::String => Type::String,
+                    _ => Type::Any,
+                };
+                if let ForInLeft::VarDecl(VarDecl { kind, declarations }) = left {
+                    for declarator in declarations {
+                        if let Pattern::Ident { name, .. } = &declarator.pattern.value {
+                            self.env.declare(
+                                name.value.name.to_string(),
+                                VarInfo {
+                                    ty: elem_ty.clone(),
+                                    ownership: OwnershipState::Owned,
+                                    is_mutable: *kind != VarDeclKind::Const,
+                                    is_initialized: true,
+                                },
+                            );
+                        }
+                    }
+                }
                 self.check_stmt(&body.value, &body.span)?;
                 self.env.pop_scope();
                 Ok(())
@@ -132,7 +153,7 @@ impl TypeChecker {
                     if let Some(ref param) = catch.param {
                         if let Pattern::Ident { name, .. } = &param.value {
                             self.env.declare(
-                                name.value.name.clone(),
+                                name.value.name.to_string(),
                                 VarInfo {
                                     ty: Type::Unknown,
                                     ownership: OwnershipState::Owned,
@@ -231,13 +252,13 @@ impl TypeChecker {
                         && self.env.has_in_current_scope(var_name)
                     {
                         return Err(TypeError::new(
-                            TypeErrorKind::DuplicateDeclaration(var_name.clone()),
+                            TypeErrorKind::DuplicateDeclaration(var_name.to_string()),
                             span.clone(),
                         ));
                     }
 
                     self.env.declare(
-                        var_name.clone(),
+                        var_name.to_string(),
                         VarInfo {
                             ty,
                             ownership: ownership_state,
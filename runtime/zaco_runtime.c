@@ -12,28 +12,565 @@
 #include <math.h>
 #include <ctype.h>
 #include <time.h>
-#include <setjmp.h>
 #include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
 #include <unistd.h>
+#include <errno.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ZACO_AVX2_DISPATCH 1
+#endif
 
 /* ========== Memory Layout ==========
  * Every heap-allocated object has a header:
  * [ref_count: i64][size: i64][data...]
  * Header is 16 bytes, data starts at offset 16.
+ *
+ * A negative ref_count marks a static object (string literals emitted by
+ * codegen into read-only data); these are never counted or freed.
+ *
+ * For strings, size is the allocation size including the NUL terminator,
+ * so the byte length is size - 1 (see ZACO_STR_LEN).
+ *
+ * The top byte of size holds the value's kind (ZACO_KIND_*) for objects,
+ * arrays and JSON.parse scalar roots, and is 0 for everything else, so a
+ * value of unknown static type can be classified from its header alone.
  */
 
 #define HEADER_SIZE 16
 #define RC_OFFSET   0
 #define SIZE_OFFSET  8
 
-/* ========== Allocation ========== */
+#define ZACO_RC_STATIC (-1)
+#define ZACO_HEADER_RC(p)   (*(int64_t*)((char*)(p) - HEADER_SIZE + RC_OFFSET))
+#define SIZE_MASK    0x00ffffffffffffffLL
+#define KIND_SHIFT   56
+#define ZACO_HEADER_WORD(p) (*(int64_t*)((char*)(p) - HEADER_SIZE + SIZE_OFFSET))
+#define ZACO_HEADER_SIZE(p) (ZACO_HEADER_WORD(p) & SIZE_MASK)
+#define ZACO_HEADER_KIND(p) ((uint8_t)((uint64_t)ZACO_HEADER_WORD(p) >> KIND_SHIFT))
+#define ZACO_STR_LEN(p)     (ZACO_HEADER_SIZE(p) - 1)
+
+/* ========== Profiling ==========
+ * Setting ZACO_PROFILE=<path> turns on two things:
+ *
+ * - Counters for allocations, out-of-line refcount updates, string bytes
+ *   copied, uncached property lookups and timer/task/promise activity,
+ *   printed to stderr at exit. Compiled code updates most refcounts
+ *   inline, so the refcount counters only see calls into the runtime.
+ * - In programs compiled with `--profile`, a SIGPROF sampler. Every
+ *   function calls zaco_profile_enter/zaco_profile_exit, which maintain a
+ *   shadow stack of function names; each sample aggregates the current
+ *   stack, and at exit the stacks are written to <path> in the folded
+ *   format read by flamegraph.pl and speedscope. main starts the sampler
+ *   through zaco_profile_start.
+ * - In those programs on ELF targets, a perf map (/tmp/perf-<pid>.map)
+ *   listing the address, size and name of every compiled function, from
+ *   the zaco_perf_map section codegen emits, so `perf report` attributes
+ *   samples to TypeScript functions even in a stripped binary.
+ *
+ * Without ZACO_PROFILE the counters cost one predictable branch and the
+ * probes only maintain the shadow stack.
+ */
+
+typedef enum {
+    ZACO_COUNT_ALLOCS,
+    ZACO_COUNT_RC_INC,
+    ZACO_COUNT_RC_DEC,
+    ZACO_COUNT_STR_BYTES,
+    ZACO_COUNT_PROP_LOOKUPS,
+    ZACO_COUNT_TIMERS,
+    ZACO_COUNT_TIMER_FIRES,
+    ZACO_COUNT_TASKS,
+    ZACO_COUNT_MICROTASKS,
+    ZACO_COUNT_PROMISES, /* counted by the Rust runtime */
+    ZACO_COUNT_NUM
+} ZacoCounter;
+
+static const char* const counter_names[ZACO_COUNT_NUM] = {
+    "allocations", "rc increments", "rc decrements", "string bytes copied",
+    "property lookups", "timers scheduled", "timer callbacks", "tasks run",
+    "microtasks run", "promises created",
+};
+
+static int64_t counters[ZACO_COUNT_NUM];
+static int profile_on;
+static const char* profile_path;
+static pthread_once_t profile_once = PTHREAD_ONCE_INIT;
+
+#define ZACO_COUNT(counter, n) do { \
+    if (profile_on) __atomic_fetch_add(&counters[counter], (int64_t)(n), __ATOMIC_RELAXED); \
+} while (0)
+
+/* Bump a counter from outside this file (the Rust runtime). */
+void zaco_profile_count(int64_t counter, int64_t n) {
+    if (counter >= 0 && counter < ZACO_COUNT_NUM) ZACO_COUNT(counter, n);
+}
+
+#define ZACO_PROF_MAX_DEPTH   64
+#define ZACO_PROF_STACKS      4096 /* distinct stacks kept; power of two */
+#define ZACO_PROF_MAX_PROBES  64
+#define ZACO_PROF_INTERVAL_US 1000
+
+/* Shadow stack of the JS thread. prof_depth may exceed ZACO_PROF_MAX_DEPTH;
+ * frames past it are not recorded. */
+static const char* prof_stack[ZACO_PROF_MAX_DEPTH];
+static volatile int32_t prof_depth;
 
-void* zaco_alloc(int64_t size) {
-    void* ptr = calloc(1, HEADER_SIZE + size);
-    if (!ptr) {
+typedef struct {
+    uint64_t hash;
+    int64_t count;
+    int32_t depth;
+    const char* frames[ZACO_PROF_MAX_DEPTH];
+} ProfStack;
+
+static ProfStack prof_stacks[ZACO_PROF_STACKS];
+static int64_t prof_samples, prof_dropped;
+static int prof_busy;
+static int prof_sampling;
+static pthread_t prof_thread;
+
+static const char prof_runtime_frame[] = "(runtime)";
+static const char prof_threads_frame[] = "(runtime threads)";
+
+/* Add one sample of `frames` to the stack table. Signal handler context:
+ * no allocation, no locks. */
+static void prof_record(const char* const* frames, int32_t depth) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ (uint64_t)depth;
+    for (int32_t i = 0; i < depth; i++) {
+        h = (h ^ (uint64_t)(uintptr_t)frames[i]) * 0x100000001b3ULL;
+    }
+    for (int64_t probe = 0; probe < ZACO_PROF_MAX_PROBES; probe++) {
+        ProfStack* s = &prof_stacks[(h + (uint64_t)probe) & (ZACO_PROF_STACKS - 1)];
+        if (s->count == 0) {
+            s->hash = h;
+            s->depth = depth;
+            memcpy(s->frames, frames, (size_t)depth * sizeof(frames[0]));
+            s->count = 1;
+            prof_samples++;
+            return;
+        }
+        if (s->hash == h && s->depth == depth
+            && memcmp(s->frames, frames, (size_t)depth * sizeof(frames[0])) == 0) {
+            s->count++;
+            prof_samples++;
+            return;
+        }
+    }
+    prof_dropped++;
+}
+
+static void prof_on_sigprof(int sig) {
+    (void)sig;
+    int saved_errno = errno;
+    /* A tick handled on another thread can overlap one on the JS thread */
+    if (__atomic_exchange_n(&prof_busy, 1, __ATOMIC_ACQUIRE)) {
+        prof_dropped++;
+        errno = saved_errno;
+        return;
+    }
+    if (!pthread_equal(pthread_self(), prof_thread)) {
+        const char* frame = prof_threads_frame;
+        prof_record(&frame, 1);
+    } else if (prof_depth == 0) {
+        const char* frame = prof_runtime_frame;
+        prof_record(&frame, 1);
+    } else {
+        int32_t depth = prof_depth;
+        prof_record(prof_stack, depth < ZACO_PROF_MAX_DEPTH ? depth : ZACO_PROF_MAX_DEPTH);
+    }
+    __atomic_store_n(&prof_busy, 0, __ATOMIC_RELEASE);
+    errno = saved_errno;
+}
+
+static void prof_sampler_start(void) {
+    prof_thread = pthread_self();
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = prof_on_sigprof;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, NULL) != 0) return;
+    struct itimerval it;
+    it.it_interval.tv_sec = 0;
+    it.it_interval.tv_usec = ZACO_PROF_INTERVAL_US;
+    it.it_value = it.it_interval;
+    if (setitimer(ITIMER_PROF, &it, NULL) == 0) {
+        prof_sampling = 1;
+    }
+}
+
+static void prof_write_stacks(void) {
+    struct itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_PROF, &off, NULL);
+    /* Keep a tick already in flight away from the table */
+    while (__atomic_exchange_n(&prof_busy, 1, __ATOMIC_ACQUIRE)) {}
+
+    FILE* out = fopen(profile_path, "w");
+    if (!out) {
+        fprintf(stderr, "zaco profile: cannot write %s\n", profile_path);
+        return;
+    }
+    for (int64_t i = 0; i < ZACO_PROF_STACKS; i++) {
+        ProfStack* s = &prof_stacks[i];
+        if (s->count == 0) continue;
+        for (int32_t f = 0; f < s->depth; f++) {
+            if (f) fputc(';', out);
+            fputs(s->frames[f], out);
+        }
+        fprintf(out, " %lld\n", (long long)s->count);
+    }
+    fclose(out);
+    fprintf(stderr, "zaco profile: %lld samples written to %s",
+            (long long)prof_samples, profile_path);
+    if (prof_dropped) {
+        fprintf(stderr, " (%lld dropped)", (long long)prof_dropped);
+    }
+    fputc('\n', stderr);
+}
+
+static void profile_report(void) {
+    if (prof_sampling) {
+        prof_write_stacks();
+    }
+    fprintf(stderr, "zaco profile counters:\n");
+    for (int c = 0; c < ZACO_COUNT_NUM; c++) {
+        fprintf(stderr, "  %-20s %14lld\n", counter_names[c],
+                (long long)__atomic_load_n(&counters[c], __ATOMIC_RELAXED));
+    }
+}
+
+static void profile_init(void) {
+    const char* path = getenv("ZACO_PROFILE");
+    if (!path || !*path) return;
+    profile_path = path;
+    profile_on = 1;
+    atexit(profile_report);
+}
+
+#ifdef __ELF__
+/* One entry per compiled function; the linker defines the section bounds. */
+typedef struct {
+    const void* addr;
+    int64_t size;
+    const char* name;
+} ZacoPerfEntry;
+
+extern const ZacoPerfEntry __start_zaco_perf_map[] __attribute__((weak));
+extern const ZacoPerfEntry __stop_zaco_perf_map[] __attribute__((weak));
+
+static void prof_write_perf_map(void) {
+    const ZacoPerfEntry* begin = __start_zaco_perf_map;
+    const ZacoPerfEntry* end = __stop_zaco_perf_map;
+    if (begin == end) return;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%d.map", (int)getpid());
+    FILE* out = fopen(path, "w");
+    if (!out) return;
+    for (const ZacoPerfEntry* e = begin; e < end; e++) {
+        fprintf(out, "%llx %llx %s\n", (unsigned long long)(uintptr_t)e->addr,
+                (unsigned long long)e->size, e->name);
+    }
+    fclose(out);
+}
+#else
+static void prof_write_perf_map(void) {}
+#endif
+
+/* Called once at the top of an instrumented main, so only programs built
+ * with `--profile` are sampled and the probes never initialise anything. */
+void zaco_profile_start(void) {
+    pthread_once(&profile_once, profile_init);
+    if (!profile_on) return;
+    prof_sampler_start();
+    prof_write_perf_map();
+}
+
+/* Entry probe inserted by `--profile`; `name` is a static string. */
+void zaco_profile_enter(const char* name) {
+    int32_t depth = prof_depth;
+    if (depth < ZACO_PROF_MAX_DEPTH) prof_stack[depth] = name;
+    /* The handler must never see the new depth before the frame */
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    prof_depth = depth + 1;
+}
+
+/* Exit probe, before every return of an instrumented function. */
+void zaco_profile_exit(void) {
+    if (prof_depth > 0) prof_depth = prof_depth - 1;
+}
+
+/* ========== Allocation (size-class pool) ==========
+ * Blocks of up to ZACO_POOL_MAX_BLOCK bytes (header included) are served
+ * from per-size-class free lists. Each thread keeps a small cache per class
+ * and only touches the shared pool (under a per-class lock) to refill or to
+ * hand back a batch of ZACO_POOL_BATCH blocks at once. Larger blocks go
+ * straight to calloc/free.
+ *
+ * The class is recovered on free from the header's size field, so `size`
+ * must never change after allocation.
+ */
+
+#define ZACO_POOL_NUM_CLASSES 19
+#define ZACO_POOL_MAX_BLOCK   1024
+#define ZACO_POOL_BATCH       32
+#define ZACO_POOL_CACHE_MAX   (ZACO_POOL_BATCH * 2)
+#define ZACO_POOL_CHUNK_SIZE  (64 * 1024)
+
+static const int64_t pool_class_sizes[ZACO_POOL_NUM_CLASSES] = {
+    32, 48, 64, 80, 96, 112, 128, 160, 192, 224,
+    256, 320, 384, 448, 512, 640, 768, 896, 1024,
+};
+
+/* Maps (block_size + 15) / 16 to a class index */
+static uint8_t pool_class_lookup[ZACO_POOL_MAX_BLOCK / 16 + 1];
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_cache_key;
+
+typedef struct PoolBlock {
+    struct PoolBlock* next;
+} PoolBlock;
+
+typedef struct {
+    pthread_mutex_t lock;
+    PoolBlock* free_list;
+    int64_t free_count;
+    /* Bump region in the current chunk */
+    char* chunk_cursor;
+    char* chunk_end;
+    /* Stats merged from exited/flushed thread caches */
+    int64_t allocs;
+    int64_t cache_hits;
+    int64_t refills;
+    int64_t frees;
+} PoolClass;
+
+static PoolClass pool_classes[ZACO_POOL_NUM_CLASSES];
+
+typedef struct {
+    PoolBlock* head;
+    int64_t count;
+    int64_t allocs;
+    int64_t cache_hits;
+    int64_t refills;
+    int64_t frees;
+} ThreadClassCache;
+
+typedef struct {
+    ThreadClassCache classes[ZACO_POOL_NUM_CLASSES];
+} ThreadCache;
+
+static _Thread_local ThreadCache* tl_cache = NULL;
+/* Set once this thread's cache has been destroyed. Destructors that run
+ * after it (other TLS keys, Tokio/reqwest teardown) still allocate and
+ * free, and go straight to the shared pool. */
+static _Thread_local int tl_cache_exited = 0;
+
+static int64_t large_allocs = 0;
+static pthread_mutex_t large_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void zaco_alloc_stats(void);
+
+static void pool_merge_stats(int cls, ThreadClassCache* tc) {
+    PoolClass* pc = &pool_classes[cls];
+    pc->allocs += tc->allocs;
+    pc->cache_hits += tc->cache_hits;
+    pc->refills += tc->refills;
+    pc->frees += tc->frees;
+    tc->allocs = tc->cache_hits = tc->refills = tc->frees = 0;
+}
+
+/* Return every cached block to the shared pool (thread exit). */
+static void pool_thread_cache_destroy(void* arg) {
+    ThreadCache* cache = (ThreadCache*)arg;
+    if (!cache) return;
+    tl_cache = NULL;
+    tl_cache_exited = 1;
+    for (int cls = 0; cls < ZACO_POOL_NUM_CLASSES; cls++) {
+        ThreadClassCache* tc = &cache->classes[cls];
+        PoolClass* pc = &pool_classes[cls];
+        pthread_mutex_lock(&pc->lock);
+        while (tc->head) {
+            PoolBlock* b = tc->head;
+            tc->head = b->next;
+            b->next = pc->free_list;
+            pc->free_list = b;
+            pc->free_count++;
+        }
+        tc->count = 0;
+        pool_merge_stats(cls, tc);
+        pthread_mutex_unlock(&pc->lock);
+    }
+    free(cache);
+}
+
+static void pool_init(void) {
+    int cls = 0;
+    for (int64_t i = 0; i <= ZACO_POOL_MAX_BLOCK / 16; i++) {
+        while (pool_class_sizes[cls] < i * 16) cls++;
+        pool_class_lookup[i] = (uint8_t)cls;
+    }
+    for (int c = 0; c < ZACO_POOL_NUM_CLASSES; c++) {
+        pthread_mutex_init(&pool_classes[c].lock, NULL);
+    }
+    pthread_key_create(&pool_cache_key, pool_thread_cache_destroy);
+    pthread_once(&profile_once, profile_init);
+    if (getenv("ZACO_ALLOC_STATS")) {
+        atexit(zaco_alloc_stats);
+    }
+}
+
+/* This thread's cache, or NULL once it has been destroyed at thread exit. */
+static ThreadCache* pool_thread_cache(void) {
+    ThreadCache* cache = tl_cache;
+    if (cache) return cache;
+    pthread_once(&pool_once, pool_init);
+    if (tl_cache_exited) return NULL;
+    cache = (ThreadCache*)calloc(1, sizeof(ThreadCache));
+    if (!cache) {
         fprintf(stderr, "zaco: out of memory\n");
         exit(1);
     }
+    tl_cache = cache;
+    pthread_setspecific(pool_cache_key, cache);
+    return cache;
+}
+
+static inline int pool_class_of(int64_t block_size) {
+    return pool_class_lookup[(block_size + 15) / 16];
+}
+
+/* Cut one block from the class's current chunk, starting a new chunk when
+ * it is used up. Called with pc->lock held. */
+static PoolBlock* pool_carve(PoolClass* pc, int64_t block_size) {
+    if (pc->chunk_cursor + block_size > pc->chunk_end) {
+        char* chunk = (char*)malloc(ZACO_POOL_CHUNK_SIZE);
+        if (!chunk) {
+            pthread_mutex_unlock(&pc->lock);
+            fprintf(stderr, "zaco: out of memory\n");
+            exit(1);
+        }
+        pc->chunk_cursor = chunk;
+        pc->chunk_end = chunk + ZACO_POOL_CHUNK_SIZE;
+    }
+    PoolBlock* b = (PoolBlock*)pc->chunk_cursor;
+    pc->chunk_cursor += block_size;
+    return b;
+}
+
+/* Allocate and free one block through the shared pool, for threads whose
+ * cache is gone. */
+static PoolBlock* pool_take_shared(int cls) {
+    PoolClass* pc = &pool_classes[cls];
+    pthread_mutex_lock(&pc->lock);
+    PoolBlock* b = pc->free_list;
+    if (b) {
+        pc->free_list = b->next;
+        pc->free_count--;
+    } else {
+        b = pool_carve(pc, pool_class_sizes[cls]);
+    }
+    pc->allocs++;
+    pthread_mutex_unlock(&pc->lock);
+    return b;
+}
+
+static void pool_give_shared(int cls, PoolBlock* b) {
+    PoolClass* pc = &pool_classes[cls];
+    pthread_mutex_lock(&pc->lock);
+    b->next = pc->free_list;
+    pc->free_list = b;
+    pc->free_count++;
+    pc->frees++;
+    pthread_mutex_unlock(&pc->lock);
+}
+
+/* Move up to ZACO_POOL_BATCH blocks from the shared pool into the thread
+ * cache, carving a fresh chunk when the shared free list is empty. */
+static void pool_refill(int cls, ThreadClassCache* tc) {
+    PoolClass* pc = &pool_classes[cls];
+    int64_t block_size = pool_class_sizes[cls];
+
+    pthread_mutex_lock(&pc->lock);
+    int64_t moved = 0;
+    while (moved < ZACO_POOL_BATCH && pc->free_list) {
+        PoolBlock* b = pc->free_list;
+        pc->free_list = b->next;
+        b->next = tc->head;
+        tc->head = b;
+        moved++;
+    }
+    pc->free_count -= moved;
+
+    while (moved < ZACO_POOL_BATCH) {
+        PoolBlock* b = pool_carve(pc, block_size);
+        b->next = tc->head;
+        tc->head = b;
+        moved++;
+    }
+    pthread_mutex_unlock(&pc->lock);
+
+    tc->count += moved;
+    tc->refills++;
+}
+
+/* Hand ZACO_POOL_BATCH blocks back to the shared pool in one locked splice. */
+static void pool_release_batch(int cls, ThreadClassCache* tc) {
+    PoolBlock* first = tc->head;
+    PoolBlock* last = first;
+    for (int64_t i = 1; i < ZACO_POOL_BATCH; i++) {
+        last = last->next;
+    }
+    tc->head = last->next;
+    tc->count -= ZACO_POOL_BATCH;
+
+    PoolClass* pc = &pool_classes[cls];
+    pthread_mutex_lock(&pc->lock);
+    last->next = pc->free_list;
+    pc->free_list = first;
+    pc->free_count += ZACO_POOL_BATCH;
+    pthread_mutex_unlock(&pc->lock);
+}
+
+void* zaco_alloc(int64_t size) {
+    int64_t block_size = HEADER_SIZE + size;
+    void* ptr;
+
+    ZACO_COUNT(ZACO_COUNT_ALLOCS, 1);
+    if (block_size <= ZACO_POOL_MAX_BLOCK) {
+        int cls = pool_class_of(block_size);
+        ThreadCache* cache = pool_thread_cache();
+        if (cache) {
+            ThreadClassCache* tc = &cache->classes[cls];
+            tc->allocs++;
+            if (tc->head) {
+                tc->cache_hits++;
+            } else {
+                pool_refill(cls, tc);
+            }
+            PoolBlock* b = tc->head;
+            tc->head = b->next;
+            tc->count--;
+            ptr = b;
+        } else {
+            ptr = pool_take_shared(cls);
+        }
+        memset(ptr, 0, (size_t)block_size);
+    } else {
+        ptr = calloc(1, HEADER_SIZE + size);
+        if (!ptr) {
+            fprintf(stderr, "zaco: out of memory\n");
+            exit(1);
+        }
+        pthread_mutex_lock(&large_stats_mutex);
+        large_allocs++;
+        pthread_mutex_unlock(&large_stats_mutex);
+    }
+
     // Initialize ref count to 1
     *((int64_t*)ptr) = 1;
     *((int64_t*)((char*)ptr + SIZE_OFFSET)) = size;
@@ -43,8 +580,66 @@ void* zaco_alloc(int64_t size) {
 
 void zaco_free(void* data_ptr) {
     if (!data_ptr) return;
+    if (ZACO_HEADER_RC(data_ptr) < 0) return; /* static object */
     void* real_ptr = (char*)data_ptr - HEADER_SIZE;
-    free(real_ptr);
+    int64_t block_size = HEADER_SIZE + ZACO_HEADER_SIZE(data_ptr);
+
+    if (block_size > ZACO_POOL_MAX_BLOCK) {
+        free(real_ptr);
+        return;
+    }
+
+    int cls = pool_class_of(block_size);
+    PoolBlock* b = (PoolBlock*)real_ptr;
+    ThreadCache* cache = pool_thread_cache();
+    if (!cache) {
+        pool_give_shared(cls, b);
+        return;
+    }
+    ThreadClassCache* tc = &cache->classes[cls];
+    b->next = tc->head;
+    tc->head = b;
+    tc->count++;
+    tc->frees++;
+    if (tc->count > ZACO_POOL_CACHE_MAX) {
+        pool_release_batch(cls, tc);
+    }
+}
+
+/* Print per-size-class allocator statistics to stderr (also run at exit
+ * when ZACO_ALLOC_STATS is set).
+ * Counters from the calling thread and from threads that have exited are
+ * included; caches of other live threads are reported once they exit. */
+void zaco_alloc_stats(void) {
+    ThreadCache* cache = pool_thread_cache();
+    int64_t total_allocs = 0, total_hits = 0;
+
+    fprintf(stderr, "zaco alloc stats:\n");
+    fprintf(stderr, "  %6s %12s %12s %8s %10s %10s\n",
+            "class", "allocs", "cache hits", "hit %", "refills", "pooled");
+    for (int cls = 0; cls < ZACO_POOL_NUM_CLASSES; cls++) {
+        PoolClass* pc = &pool_classes[cls];
+        pthread_mutex_lock(&pc->lock);
+        if (cache) pool_merge_stats(cls, &cache->classes[cls]);
+        int64_t allocs = pc->allocs, hits = pc->cache_hits;
+        int64_t refills = pc->refills, pooled = pc->free_count;
+        pthread_mutex_unlock(&pc->lock);
+
+        total_allocs += allocs;
+        total_hits += hits;
+        if (allocs == 0) continue;
+        fprintf(stderr, "  %6lld %12lld %12lld %7.1f%% %10lld %10lld\n",
+                (long long)pool_class_sizes[cls], (long long)allocs, (long long)hits,
+                100.0 * (double)hits / (double)allocs, (long long)refills, (long long)pooled);
+    }
+
+    pthread_mutex_lock(&large_stats_mutex);
+    int64_t large = large_allocs;
+    pthread_mutex_unlock(&large_stats_mutex);
+    fprintf(stderr, "  pooled allocs: %lld (%.1f%% cache hits), large allocs: %lld\n",
+            (long long)total_allocs,
+            total_allocs ? 100.0 * (double)total_hits / (double)total_allocs : 0.0,
+            (long long)large);
 }
 
 /* ========== Reference Counting ========== */
@@ -52,12 +647,16 @@ void zaco_free(void* data_ptr) {
 void zaco_rc_inc(void* data_ptr) {
     if (!data_ptr) return;
     int64_t* rc = (int64_t*)((char*)data_ptr - HEADER_SIZE);
+    if (*rc < 0) return; /* static object */
+    ZACO_COUNT(ZACO_COUNT_RC_INC, 1);
     (*rc)++;
 }
 
 void zaco_rc_dec(void* data_ptr) {
     if (!data_ptr) return;
     int64_t* rc = (int64_t*)((char*)data_ptr - HEADER_SIZE);
+    if (*rc < 0) return; /* static object */
+    ZACO_COUNT(ZACO_COUNT_RC_DEC, 1);
     (*rc)--;
     if (*rc <= 0) {
         zaco_free(data_ptr);
@@ -72,123 +671,436 @@ int64_t zaco_rc_get(void* data_ptr) {
 
 /* ========== String Operations ========== */
 
-void* zaco_str_new(const char* s) {
-    int64_t len = strlen(s);
+/* Managed strings carry their length in the header, so every zaco_str_*
+ * routine below gets it in O(1). Only zaco_str_new, which accepts a raw C
+ * string, needs strlen. */
+
+/* ========== Small-String Table ==========
+ * The empty string, every one-byte string and the decimal forms of small
+ * integers exist once per process as static strings (negative ref count),
+ * so charAt, split into characters and number-to-string return them
+ * without allocating. Refcounting and zaco_free already skip static
+ * objects, so callers cannot tell them from heap strings.
+ */
+
+#define ZACO_SMALL_INT_MIN (-128)
+#define ZACO_SMALL_INT_MAX 1023
+
+typedef struct {
+    int64_t rc;
+    int64_t size;
+    char data[8]; /* at HEADER_SIZE, like any managed string */
+} ZacoSmallStr;
+
+static ZacoSmallStr small_bytes[257]; /* [0] is "", [1 + b] is byte b */
+static ZacoSmallStr small_ints[ZACO_SMALL_INT_MAX - ZACO_SMALL_INT_MIN + 1];
+static pthread_once_t small_str_once = PTHREAD_ONCE_INIT;
+
+/* Write the decimal form of `n` to the bytes ending at `end`; returns the
+ * first byte. `end` must have 20 bytes of room before it. */
+static char* format_i64(char* end, int64_t n) {
+    char* p = end;
+    uint64_t u = n < 0 ? -(uint64_t)n : (uint64_t)n;
+    do {
+        *--p = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (n < 0) *--p = '-';
+    return p;
+}
+
+static void small_str_init(void) {
+    small_bytes[0].rc = ZACO_RC_STATIC;
+    small_bytes[0].size = 1;
+    for (int b = 0; b < 256; b++) {
+        small_bytes[1 + b].rc = ZACO_RC_STATIC;
+        small_bytes[1 + b].size = 2;
+        small_bytes[1 + b].data[0] = (char)b;
+    }
+    for (int64_t n = ZACO_SMALL_INT_MIN; n <= ZACO_SMALL_INT_MAX; n++) {
+        ZacoSmallStr* str = &small_ints[n - ZACO_SMALL_INT_MIN];
+        char buf[24];
+        char* end = buf + sizeof(buf);
+        char* start = format_i64(end, n);
+        str->rc = ZACO_RC_STATIC;
+        str->size = (end - start) + 1;
+        memcpy(str->data, start, (size_t)(end - start));
+    }
+}
+
+/* Static string for `len` (0 or 1) bytes copied from `bytes`. */
+static void* small_str(const char* bytes, int64_t len) {
+    pthread_once(&small_str_once, small_str_init);
+    return small_bytes[len ? 1 + (unsigned char)bytes[0] : 0].data;
+}
+
+/* Heap-allocate a string of `len` bytes copied from `bytes`, even when a
+ * small-string entry exists. For strings whose header is written to, such
+ * as the kind-tagged scalar roots of JSON.parse. */
+static void* str_alloc_private(const char* bytes, int64_t len) {
+    ZACO_COUNT(ZACO_COUNT_STR_BYTES, len);
     void* ptr = zaco_alloc(len + 1);
-    memcpy(ptr, s, len + 1);
+    memcpy(ptr, bytes, len);
+    /* zaco_alloc zero-fills, so the terminator is already in place */
     return ptr;
 }
 
+/* Allocate a managed string of `len` bytes copied from `bytes`. */
+static void* zaco_str_from_bytes(const char* bytes, int64_t len) {
+    if (len <= 1) return small_str(bytes, len);
+    return str_alloc_private(bytes, len);
+}
+
+void* zaco_str_new(const char* s) {
+    return zaco_str_from_bytes(s, (int64_t)strlen(s));
+}
+
 void* zaco_str_concat(void* a, void* b) {
     if (!a && !b) return zaco_str_new("");
     if (!a) { zaco_rc_inc(b); return b; }
     if (!b) { zaco_rc_inc(a); return a; }
 
-    int64_t len_a = strlen((char*)a);
-    int64_t len_b = strlen((char*)b);
+    int64_t len_a = ZACO_STR_LEN(a);
+    int64_t len_b = ZACO_STR_LEN(b);
+    ZACO_COUNT(ZACO_COUNT_STR_BYTES, len_a + len_b);
     void* result = zaco_alloc(len_a + len_b + 1);
     memcpy(result, a, len_a);
-    memcpy((char*)result + len_a, b, len_b + 1);
+    memcpy((char*)result + len_a, b, len_b);
     return result;
 }
 
 int64_t zaco_str_len(void* s) {
     if (!s) return 0;
-    return (int64_t)strlen((char*)s);
+    return ZACO_STR_LEN(s);
 }
 
 int64_t zaco_str_eq(void* a, void* b) {
     if (a == b) return 1;
     if (!a || !b) return 0;
-    return strcmp((char*)a, (char*)b) == 0 ? 1 : 0;
+    int64_t len = ZACO_STR_LEN(a);
+    if (len != ZACO_STR_LEN(b)) return 0;
+    return memcmp(a, b, (size_t)len) == 0 ? 1 : 0;
+}
+
+/* ========== String Builder ==========
+ * Append buffer used by the lowerer for `s += x` accumulator loops and long
+ * concatenation chains. Appends grow the buffer geometrically, so building a
+ * string of n bytes costs O(n) instead of the O(n^2) of repeated concat.
+ * zaco_strbuf_finish freezes the contents into a managed string and frees
+ * the builder; the builder itself never escapes to user code.
+ */
+
+#define ZACO_STRBUF_MIN_CAP 64
+
+typedef struct {
+    char* data;
+    int64_t len;
+    int64_t cap;
+} ZacoStrBuilder;
+
+void zaco_strbuf_append(void* builder, void* s);
+
+static void strbuf_reserve(ZacoStrBuilder* sb, int64_t extra) {
+    int64_t need = sb->len + extra;
+    if (need <= sb->cap) return;
+    int64_t cap = sb->cap > 0 ? sb->cap : ZACO_STRBUF_MIN_CAP;
+    while (cap < need) cap *= 2;
+    char* data = (char*)realloc(sb->data, (size_t)cap);
+    if (!data) {
+        fprintf(stderr, "zaco: out of memory (string builder)\n");
+        exit(1);
+    }
+    sb->data = data;
+    sb->cap = cap;
+}
+
+/* Create a builder seeded with a copy of `init` (may be NULL). */
+void* zaco_strbuf_new(void* init) {
+    ZacoStrBuilder* sb = (ZacoStrBuilder*)calloc(1, sizeof(ZacoStrBuilder));
+    if (!sb) {
+        fprintf(stderr, "zaco: out of memory (string builder)\n");
+        exit(1);
+    }
+    zaco_strbuf_append(sb, init);
+    return sb;
+}
+
+void zaco_strbuf_append(void* builder, void* s) {
+    if (!builder || !s) return;
+    ZacoStrBuilder* sb = (ZacoStrBuilder*)builder;
+    int64_t len = ZACO_STR_LEN(s);
+    if (len == 0) return;
+    strbuf_reserve(sb, len);
+    ZACO_COUNT(ZACO_COUNT_STR_BYTES, len);
+    memcpy(sb->data + sb->len, s, (size_t)len);
+    sb->len += len;
+}
+
+/* Freeze the builder into a managed string and release it. */
+void* zaco_strbuf_finish(void* builder) {
+    if (!builder) return zaco_str_new("");
+    ZacoStrBuilder* sb = (ZacoStrBuilder*)builder;
+    void* result = zaco_str_from_bytes(sb->data ? sb->data : "", sb->len);
+    free(sb->data);
+    free(sb);
+    return result;
 }
 
 /* ========== Number to String ========== */
 
 void* zaco_i64_to_str(int64_t n) {
-    char buf[32];
-    snprintf(buf, sizeof(buf), "%lld", (long long)n);
-    return zaco_str_new(buf);
+    if (n >= ZACO_SMALL_INT_MIN && n <= ZACO_SMALL_INT_MAX) {
+        pthread_once(&small_str_once, small_str_init);
+        return small_ints[n - ZACO_SMALL_INT_MIN].data;
+    }
+    char buf[24];
+    char* end = buf + sizeof(buf);
+    char* start = format_i64(end, n);
+    return zaco_str_from_bytes(start, end - start);
 }
 
 void* zaco_f64_to_str(double n) {
-    char buf[64];
     if (floor(n) == n && fabs(n) < 1e15) {
-        snprintf(buf, sizeof(buf), "%.0f", n);
-    } else {
-        snprintf(buf, sizeof(buf), "%g", n);
+        if (n == 0 && signbit(n)) return zaco_str_from_bytes("-0", 2);
+        return zaco_i64_to_str((int64_t)n);
+    }
+    char buf[64];
+    int len = snprintf(buf, sizeof(buf), "%g", n);
+    return zaco_str_from_bytes(buf, len);
+}
+
+/* ========== Console I/O ==========
+ * console.* output is collected in one runtime-owned buffer per stream and
+ * written with a single write(2) when the buffer fills, at the end of each
+ * line when the stream is a terminal, whenever the event loop goes idle,
+ * and at exit. stderr is always flushed at the end of each line, after
+ * any pending stdout, so errors are never held back or reordered when the
+ * streams are redirected. Numbers are formatted by hand; only non-integral doubles go
+ * through snprintf, straight into a local buffer. Console functions run on
+ * the JS thread only, so the buffers need no lock.
+ */
+
+#define ZACO_OUT_BUF_SIZE 16384
+
+typedef struct {
+    int fd;
+    int line_flush; /* flush at each newline */
+    size_t len;
+    char data[ZACO_OUT_BUF_SIZE];
+} ZacoOutBuf;
+
+static ZacoOutBuf out_stdout = { .fd = 1 };
+static ZacoOutBuf out_stderr = { .fd = 2 };
+static int out_initialized;
+
+static void out_write_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t written = write(fd, p, n);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return; /* closed pipe and the like: drop the output, as stdio does */
+        }
+        p += written;
+        n -= (size_t)written;
     }
-    return zaco_str_new(buf);
 }
 
-/* ========== Console I/O ========== */
+static void out_flush(ZacoOutBuf* b) {
+    out_write_all(b->fd, b->data, b->len);
+    b->len = 0;
+}
 
-void zaco_print_str(void* s) {
+/* Write out everything buffered on stdout and stderr. */
+void zaco_console_flush(void) {
+    out_flush(&out_stdout);
+    out_flush(&out_stderr);
+}
+
+static void out_init(void) {
+    out_initialized = 1;
+    out_stdout.line_flush = isatty(out_stdout.fd);
+    out_stderr.line_flush = 1;
+    atexit(zaco_console_flush);
+}
+
+static void out_write(ZacoOutBuf* b, const char* s, size_t n) {
+    if (!out_initialized) out_init();
+    if (b->len + n > ZACO_OUT_BUF_SIZE) {
+        out_flush(b);
+        if (n > ZACO_OUT_BUF_SIZE) {
+            out_write_all(b->fd, s, n);
+            return;
+        }
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    if (b->line_flush && memchr(s, '\n', n)) {
+        if (b == &out_stderr) out_flush(&out_stdout);
+        out_flush(b);
+    }
+}
+
+static void out_str(ZacoOutBuf* b, void* s) {
     if (s) {
-        printf("%s", (char*)s);
+        out_write(b, (const char*)s, strlen((const char*)s));
     }
 }
 
-void zaco_print_i64(int64_t n) {
-    printf("%lld", (long long)n);
+static void out_i64(ZacoOutBuf* b, int64_t n) {
+    char buf[24];
+    char* end = buf + sizeof(buf);
+    char* start = format_i64(end, n);
+    out_write(b, start, (size_t)(end - start));
 }
 
-void zaco_print_f64(double n) {
+/* Same output as "%.0f" for integral values below 1e15 and "%g" otherwise. */
+static void out_f64(ZacoOutBuf* b, double n) {
     if (floor(n) == n && fabs(n) < 1e15) {
-        printf("%.0f", n);
+        if (n == 0 && signbit(n)) {
+            out_write(b, "-0", 2);
+        } else {
+            out_i64(b, (int64_t)n);
+        }
+        return;
+    }
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%g", n);
+    out_write(b, buf, (size_t)len);
+}
+
+static void out_bool(ZacoOutBuf* b, int64_t v) {
+    if (v) {
+        out_write(b, "true", 4);
     } else {
-        printf("%g", n);
+        out_write(b, "false", 5);
     }
 }
 
+void zaco_print_str(void* s) {
+    out_str(&out_stdout, s);
+}
+
+void zaco_print_i64(int64_t n) {
+    out_i64(&out_stdout, n);
+}
+
+void zaco_print_f64(double n) {
+    out_f64(&out_stdout, n);
+}
+
 void zaco_print_bool(int64_t b) {
-    printf("%s", b ? "true" : "false");
+    out_bool(&out_stdout, b);
 }
 
 void zaco_println_str(void* s) {
-    zaco_print_str(s);
-    printf("\n");
+    out_str(&out_stdout, s);
+    out_write(&out_stdout, "\n", 1);
 }
 
 void zaco_println_i64(int64_t n) {
-    zaco_print_i64(n);
-    printf("\n");
+    out_i64(&out_stdout, n);
+    out_write(&out_stdout, "\n", 1);
+}
+
+/* ========== Value Kinds ==========
+ * Dynamic type of a value held in an untyped 64-bit slot. Objects record
+ * one per property, and arrays built at runtime (JSON.parse) one per
+ * element, so such values can be walked without static types. A pointer
+ * stored without one (ZACO_KIND_PTR) is classified by its header.
+ */
+
+#define ZACO_KIND_UNKNOWN 0
+#define ZACO_KIND_NULL    1
+#define ZACO_KIND_BOOL    2
+#define ZACO_KIND_I64     3
+#define ZACO_KIND_F64     4
+#define ZACO_KIND_STR     5
+#define ZACO_KIND_OBJECT  6
+#define ZACO_KIND_ARRAY   7
+#define ZACO_KIND_PTR     8
+
+/* Record `kind` in the header of the heap value at `ptr`. */
+static void zaco_header_set_kind(void* ptr, uint8_t kind) {
+    ZACO_HEADER_WORD(ptr) = ZACO_HEADER_SIZE(ptr) | ((int64_t)kind << KIND_SHIFT);
+}
+
+/* Kind of a non-null value of unknown static type. Objects, arrays and
+ * scalar JSON.parse roots are tagged; anything else is a string. */
+static uint8_t zaco_ptr_kind(const void* ptr) {
+    uint8_t kind = ZACO_HEADER_KIND(ptr);
+    return kind ? kind : ZACO_KIND_STR;
 }
 
 /* ========== Array Operations ========== */
 
+/* The one array layout, shared with codegen (which reads `length` at offset
+ * 0 and `data` at offset 24 to index arrays inline). Elements are stored
+ * contiguously in `data`; `number[]` is a dense buffer of doubles.
+ *
+ * Array literals are allocated in one block with their elements right after
+ * the header (`data == arr + 1`). That buffer is part of the array itself, so
+ * growth copies out of it instead of freeing it. */
 typedef struct {
     int64_t length;
     int64_t capacity;
     int64_t elem_size;
     void*   data;
+    uint8_t* kinds;  /* per-element ZACO_KIND_*, NULL for statically typed arrays */
 } ZacoArray;
 
+static int zaco_array_owns_data(const ZacoArray* arr) {
+    return arr->data && arr->data != (const void*)(arr + 1);
+}
+
 void* zaco_array_new(int64_t elem_size, int64_t initial_capacity) {
     ZacoArray* arr = (ZacoArray*)zaco_alloc(sizeof(ZacoArray));
     arr->length = 0;
     arr->capacity = initial_capacity > 0 ? initial_capacity : 8;
     arr->elem_size = elem_size;
     arr->data = zaco_alloc(arr->capacity * elem_size);
+    arr->kinds = NULL;
+    zaco_header_set_kind(arr, ZACO_KIND_ARRAY);
     return arr;
 }
 
 void zaco_array_push(void* array_ptr, void* elem) {
     ZacoArray* arr = (ZacoArray*)array_ptr;
     if (arr->length >= arr->capacity) {
-        arr->capacity *= 2;
+        arr->capacity = arr->capacity > 0 ? arr->capacity * 2 : 8;
         void* new_data = zaco_alloc(arr->capacity * arr->elem_size);
         memcpy(new_data, arr->data, arr->length * arr->elem_size);
-        zaco_free(arr->data);
+        if (zaco_array_owns_data(arr)) zaco_free(arr->data);
         arr->data = new_data;
+        if (arr->kinds) {
+            arr->kinds = (uint8_t*)realloc(arr->kinds, (size_t)arr->capacity);
+            if (!arr->kinds) {
+                fprintf(stderr, "zaco: out of memory (array)\n");
+                exit(1);
+            }
+        }
     }
     memcpy((char*)arr->data + arr->length * arr->elem_size, elem, arr->elem_size);
+    if (arr->kinds) arr->kinds[arr->length] = ZACO_KIND_UNKNOWN;
     arr->length++;
 }
 
+/* Append a 64-bit element and record its kind (arrays with elem_size 8). */
+static void zaco_array_push_kind(ZacoArray* arr, uint64_t bits, uint8_t kind) {
+    if (!arr->kinds) {
+        arr->kinds = (uint8_t*)calloc((size_t)arr->capacity, 1);
+        if (!arr->kinds) {
+            fprintf(stderr, "zaco: out of memory (array)\n");
+            exit(1);
+        }
+    }
+    zaco_array_push(arr, &bits);
+    arr->kinds[arr->length - 1] = kind;
+}
+
 void* zaco_array_get(void* array_ptr, int64_t index) {
     ZacoArray* arr = (ZacoArray*)array_ptr;
     if (index < 0 || index >= arr->length) {
+        zaco_console_flush();
         fprintf(stderr, "zaco: array index out of bounds: %lld (length: %lld)\n",
                 (long long)index, (long long)arr->length);
         exit(1);
@@ -207,16 +1119,16 @@ int64_t zaco_array_len(void* array_ptr) {
 void zaco_array_destroy(void* array_ptr) {
     if (!array_ptr) return;
     ZacoArray* arr = (ZacoArray*)array_ptr;
-    if (arr->data) {
-        zaco_free(arr->data);
-        arr->data = NULL;
-    }
+    if (zaco_array_owns_data(arr)) zaco_free(arr->data);
+    arr->data = NULL;
+    free(arr->kinds);
     zaco_free(array_ptr);
 }
 
 void zaco_array_rc_dec(void* array_ptr) {
     if (!array_ptr) return;
     int64_t* rc = (int64_t*)((char*)array_ptr - HEADER_SIZE);
+    if (*rc < 0) return; /* static object */
     (*rc)--;
     if (*rc <= 0) {
         zaco_array_destroy(array_ptr);
@@ -302,222 +1214,69 @@ double zaco_math_e() {
     return M_E;
 }
 
-/* ========== JSON Functions ========== */
-
-// Minimal JSON parser - handles basic primitives and simple structures
-void* zaco_json_parse(void* json_str) {
-    if (!json_str) return NULL;
-
-    const char* s = (const char*)json_str;
-    // Skip leading whitespace
-    while (*s && isspace(*s)) s++;
-
-    // Parse strings — Fix #7: handle escape sequences properly
-    if (*s == '"') {
-        s++; // skip opening quote
-        // First pass: calculate output length
-        const char* scan = s;
-        size_t out_len = 0;
-        while (*scan && *scan != '"') {
-            if (*scan == '\\' && *(scan+1)) {
-                scan += 2; // skip escape pair
-            } else {
-                scan++;
-            }
-            out_len++;
-        }
-        char* result_buf = malloc(out_len + 1);
-        size_t wi = 0;
-        while (*s && *s != '"') {
-            if (*s == '\\' && *(s+1)) {
-                s++; // skip backslash
-                switch (*s) {
-                    case 'n':  result_buf[wi++] = '\n'; break;
-                    case 't':  result_buf[wi++] = '\t'; break;
-                    case 'r':  result_buf[wi++] = '\r'; break;
-                    case '"':  result_buf[wi++] = '"';  break;
-                    case '\\': result_buf[wi++] = '\\'; break;
-                    case '/':  result_buf[wi++] = '/';  break;
-                    default:   result_buf[wi++] = *s;   break;
-                }
-                s++;
-            } else {
-                result_buf[wi++] = *s++;
-            }
-        }
-        result_buf[wi] = '\0';
-        void* result = zaco_str_new(result_buf);
-        free(result_buf);
-        return result;
-    }
-
-    // Parse booleans
-    if (strncmp(s, "true", 4) == 0) {
-        return zaco_str_new("true");
-    }
-    if (strncmp(s, "false", 5) == 0) {
-        return zaco_str_new("false");
-    }
-
-    // Parse null
-    if (strncmp(s, "null", 4) == 0) {
-        return zaco_str_new("null");
-    }
-
-    // Parse numbers - return as string for now
-    if (*s == '-' || isdigit(*s)) {
-        const char* start = s;
-        if (*s == '-') s++;
-        while (*s && isdigit(*s)) s++;
-        if (*s == '.') {
-            s++;
-            while (*s && isdigit(*s)) s++;
-        }
-        size_t len = s - start;
-        char* result_buf = malloc(len + 1);
-        memcpy(result_buf, start, len);
-        result_buf[len] = '\0';
-        void* result = zaco_str_new(result_buf);
-        free(result_buf);
-        return result;
-    }
-
-    // For arrays/objects, return string representation for now
-    return zaco_str_new((const char*)json_str);
-}
-
-// Minimal JSON stringifier - handles basic primitives
-void* zaco_json_stringify(void* value) {
-    if (!value) {
-        return zaco_str_new("null");
-    }
-
-    // For now, assume value is a string and just quote it
-    // More sophisticated handling would check type
-    const char* s = (const char*)value;
-
-    // Check if it's already a JSON primitive (number, boolean, null)
-    if (strcmp(s, "true") == 0 || strcmp(s, "false") == 0 || strcmp(s, "null") == 0) {
-        return zaco_str_new(s);
-    }
-
-    // Check if it's a number
-    char* endptr;
-    strtod(s, &endptr);
-    if (*endptr == '\0' && *s != '\0') {
-        return zaco_str_new(s);
-    }
-
-    // Otherwise, quote it as a string with proper escaping
-    size_t len = strlen(s);
-
-    // First pass: calculate escaped length
-    size_t escaped_len = 0;
-    for (size_t i = 0; i < len; i++) {
-        switch (s[i]) {
-            case '"':  escaped_len += 2; break; /* \" */
-            case '\\': escaped_len += 2; break; /* \\ */
-            case '\n': escaped_len += 2; break; /* \n */
-            case '\t': escaped_len += 2; break; /* \t */
-            case '\r': escaped_len += 2; break; /* \r */
-            case '\b': escaped_len += 2; break; /* \b */
-            case '\f': escaped_len += 2; break; /* \f */
-            default:   escaped_len += 1; break;
-        }
-    }
-
-    // Second pass: build escaped string
-    char* buf = malloc(escaped_len + 3); // quotes + null
-    buf[0] = '"';
-    size_t pos = 1;
-    for (size_t i = 0; i < len; i++) {
-        switch (s[i]) {
-            case '"':  buf[pos++] = '\\'; buf[pos++] = '"';  break;
-            case '\\': buf[pos++] = '\\'; buf[pos++] = '\\'; break;
-            case '\n': buf[pos++] = '\\'; buf[pos++] = 'n';  break;
-            case '\t': buf[pos++] = '\\'; buf[pos++] = 't';  break;
-            case '\r': buf[pos++] = '\\'; buf[pos++] = 'r';  break;
-            case '\b': buf[pos++] = '\\'; buf[pos++] = 'b';  break;
-            case '\f': buf[pos++] = '\\'; buf[pos++] = 'f';  break;
-            default:   buf[pos++] = s[i]; break;
-        }
-    }
-    buf[pos++] = '"';
-    buf[pos] = '\0';
-    void* result = zaco_str_new(buf);
-    free(buf);
-    return result;
-}
-
 /* ========== Enhanced Console Functions ========== */
 
 void zaco_console_error_str(void* s) {
-    if (s) {
-        fprintf(stderr, "%s", (char*)s);
-    }
+    out_str(&out_stderr, s);
 }
 
 void zaco_console_error_i64(int64_t n) {
-    fprintf(stderr, "%lld", (long long)n);
+    out_i64(&out_stderr, n);
 }
 
 void zaco_console_error_f64(double n) {
-    if (floor(n) == n && fabs(n) < 1e15) {
-        fprintf(stderr, "%.0f", n);
-    } else {
-        fprintf(stderr, "%g", n);
-    }
+    out_f64(&out_stderr, n);
 }
 
 void zaco_console_error_bool(int64_t b) {
-    fprintf(stderr, "%s", b ? "true" : "false");
+    out_bool(&out_stderr, b);
 }
 
 void zaco_console_errorln(void* s) {
-    zaco_console_error_str(s);
-    fprintf(stderr, "\n");
+    out_str(&out_stderr, s);
+    out_write(&out_stderr, "\n", 1);
 }
 
 void zaco_console_warn_str(void* s) {
-    if (s) {
-        fprintf(stderr, "%s", (char*)s);
-    }
+    out_str(&out_stderr, s);
 }
 
 void zaco_console_warn_i64(int64_t n) {
-    fprintf(stderr, "%lld", (long long)n);
+    out_i64(&out_stderr, n);
+}
+
+void zaco_console_warn_f64(double n) {
+    out_f64(&out_stderr, n);
+}
+
+void zaco_console_warn_bool(int64_t b) {
+    out_bool(&out_stderr, b);
 }
 
 void zaco_console_warnln(void* s) {
-    zaco_console_warn_str(s);
-    fprintf(stderr, "\n");
+    out_str(&out_stderr, s);
+    out_write(&out_stderr, "\n", 1);
 }
 
 void zaco_console_debug_str(void* s) {
-    if (s) {
-        fprintf(stdout, "%s", (char*)s);
-    }
+    out_str(&out_stdout, s);
 }
 
 void zaco_console_debug_i64(int64_t n) {
-    fprintf(stdout, "%lld", (long long)n);
+    out_i64(&out_stdout, n);
 }
 
 void zaco_console_debug_f64(double n) {
-    if (floor(n) == n && fabs(n) < 1e15) {
-        fprintf(stdout, "%.0f", n);
-    } else {
-        fprintf(stdout, "%g", n);
-    }
+    out_f64(&out_stdout, n);
 }
 
 void zaco_console_debug_bool(int64_t b) {
-    fprintf(stdout, "%s", b ? "true" : "false");
+    out_bool(&out_stdout, b);
 }
 
 void zaco_console_debugln(void* s) {
-    zaco_console_debug_str(s);
-    fprintf(stdout, "\n");
+    out_str(&out_stdout, s);
+    out_write(&out_stdout, "\n", 1);
 }
 
 /* ========== String Methods ========== */
@@ -525,7 +1284,7 @@ void zaco_console_debugln(void* s) {
 void* zaco_str_slice(void* s, int64_t start, int64_t end) {
     if (!s) return zaco_str_new("");
 
-    int64_t len = strlen((char*)s);
+    int64_t len = ZACO_STR_LEN(s);
 
     // Handle negative indices
     if (start < 0) start = len + start;
@@ -538,18 +1297,13 @@ void* zaco_str_slice(void* s, int64_t start, int64_t end) {
     if (end > len) end = len;
     if (start > end) start = end;
 
-    int64_t slice_len = end - start;
-    /* Fix #13: single allocation via zaco_alloc */
-    void* result = zaco_alloc(slice_len + 1);
-    memcpy(result, (char*)s + start, slice_len);
-    ((char*)result)[slice_len] = '\0';
-    return result;
+    return zaco_str_from_bytes((char*)s + start, end - start);
 }
 
 void* zaco_str_to_upper(void* s) {
     if (!s) return zaco_str_new("");
 
-    int64_t len = strlen((char*)s);
+    int64_t len = ZACO_STR_LEN(s);
     /* Fix #13: single allocation */
     void* result = zaco_alloc(len + 1);
     for (int64_t i = 0; i < len; i++) {
@@ -562,7 +1316,7 @@ void* zaco_str_to_upper(void* s) {
 void* zaco_str_to_lower(void* s) {
     if (!s) return zaco_str_new("");
 
-    int64_t len = strlen((char*)s);
+    int64_t len = ZACO_STR_LEN(s);
     /* Fix #13: single allocation */
     void* result = zaco_alloc(len + 1);
     for (int64_t i = 0; i < len; i++) {
@@ -584,7 +1338,7 @@ void* zaco_str_trim(void* s) {
     if (*start == '\0') return zaco_str_new("");
 
     // Trim trailing whitespace
-    const char* end = str + strlen(str) - 1;
+    const char* end = str + ZACO_STR_LEN(s) - 1;
     while (end > start && isspace(*end)) end--;
 
     int64_t len = end - start + 1;
@@ -597,6 +1351,7 @@ void* zaco_str_trim(void* s) {
 
 int64_t zaco_str_index_of(void* s, void* search) {
     if (!s || !search) return -1;
+    if (ZACO_STR_LEN(search) > ZACO_STR_LEN(s)) return -1;
 
     const char* found = strstr((char*)s, (char*)search);
     if (!found) return -1;
@@ -620,26 +1375,25 @@ void* zaco_str_replace(void* s, void* search, void* replace) {
     const char* search_str = (const char*)search;
     const char* replace_str = replace ? (const char*)replace : "";
 
-    const char* found = strstr(str, search_str);
+    int64_t str_len = ZACO_STR_LEN(s);
+    int64_t search_len = ZACO_STR_LEN(search);
+    int64_t replace_len = replace ? ZACO_STR_LEN(replace) : 0;
+
+    const char* found = search_len <= str_len ? strstr(str, search_str) : NULL;
     if (!found) {
         zaco_rc_inc(s);
         return s;
     }
 
-    int64_t search_len = strlen(search_str);
-    int64_t replace_len = strlen(replace_str);
     int64_t prefix_len = found - str;
-    int64_t suffix_len = strlen(found + search_len);
+    int64_t suffix_len = str_len - prefix_len - search_len;
     int64_t total_len = prefix_len + replace_len + suffix_len;
 
-    char* buf = malloc(total_len + 1);
-    memcpy(buf, str, prefix_len);
-    memcpy(buf + prefix_len, replace_str, replace_len);
-    memcpy(buf + prefix_len + replace_len, found + search_len, suffix_len);
-    buf[total_len] = '\0';
-
-    void* result = zaco_str_new(buf);
-    free(buf);
+    /* Write straight into the result allocation */
+    char* result = (char*)zaco_alloc(total_len + 1);
+    memcpy(result, str, prefix_len);
+    memcpy(result + prefix_len, replace_str, replace_len);
+    memcpy(result + prefix_len + replace_len, found + search_len, suffix_len);
     return result;
 }
 
@@ -650,16 +1404,15 @@ void* zaco_str_split(void* s, void* separator) {
 
     const char* str = (const char*)s;
     const char* sep = separator ? (const char*)separator : "";
-    int64_t sep_len = strlen(sep);
+    int64_t sep_len = separator ? ZACO_STR_LEN(separator) : 0;
 
     ZacoArray* result = (ZacoArray*)zaco_array_new(sizeof(void*), 4);
 
     if (sep_len == 0) {
         // Split every character
-        int64_t len = strlen(str);
+        int64_t len = ZACO_STR_LEN(s);
         for (int64_t i = 0; i < len; i++) {
-            char buf[2] = {str[i], '\0'};
-            void* elem = zaco_str_new(buf);
+            void* elem = zaco_str_from_bytes(str + i, 1);
             zaco_array_push(result, &elem);
         }
         return result;
@@ -669,18 +1422,13 @@ void* zaco_str_split(void* s, void* separator) {
     const char* found;
 
     while ((found = strstr(current, sep)) != NULL) {
-        int64_t len = found - current;
-        char* buf = malloc(len + 1);
-        memcpy(buf, current, len);
-        buf[len] = '\0';
-        void* elem = zaco_str_new(buf);
-        free(buf);
+        void* elem = zaco_str_from_bytes(current, found - current);
         zaco_array_push(result, &elem);
         current = found + sep_len;
     }
 
     // Add remaining part
-    void* elem = zaco_str_new(current);
+    void* elem = zaco_str_from_bytes(current, ZACO_STR_LEN(s) - (current - str));
     zaco_array_push(result, &elem);
 
     return result;
@@ -689,40 +1437,37 @@ void* zaco_str_split(void* s, void* separator) {
 int64_t zaco_str_starts_with(void* s, void* prefix) {
     if (!s || !prefix) return 0;
 
-    const char* str = (const char*)s;
-    const char* pre = (const char*)prefix;
-    int64_t pre_len = strlen(pre);
+    int64_t pre_len = ZACO_STR_LEN(prefix);
+    if (pre_len > ZACO_STR_LEN(s)) return 0;
 
-    return strncmp(str, pre, pre_len) == 0 ? 1 : 0;
+    return memcmp(s, prefix, (size_t)pre_len) == 0 ? 1 : 0;
 }
 
 int64_t zaco_str_ends_with(void* s, void* suffix) {
     if (!s || !suffix) return 0;
 
     const char* str = (const char*)s;
-    const char* suf = (const char*)suffix;
-    int64_t str_len = strlen(str);
-    int64_t suf_len = strlen(suf);
+    int64_t str_len = ZACO_STR_LEN(s);
+    int64_t suf_len = ZACO_STR_LEN(suffix);
 
     if (suf_len > str_len) return 0;
 
-    return strcmp(str + str_len - suf_len, suf) == 0 ? 1 : 0;
+    return memcmp(str + str_len - suf_len, suffix, (size_t)suf_len) == 0 ? 1 : 0;
 }
 
 void* zaco_str_char_at(void* s, int64_t index) {
     if (!s) return zaco_str_new("");
 
-    int64_t len = strlen((char*)s);
+    int64_t len = ZACO_STR_LEN(s);
     if (index < 0 || index >= len) return zaco_str_new("");
 
-    char buf[2] = {((char*)s)[index], '\0'};
-    return zaco_str_new(buf);
+    return zaco_str_from_bytes((char*)s + index, 1);
 }
 
 void* zaco_str_repeat(void* s, int64_t count) {
     if (!s || count <= 0) return zaco_str_new("");
 
-    int64_t len = strlen((char*)s);
+    int64_t len = ZACO_STR_LEN(s);
     /* Fix #8: overflow check before multiplication */
     if (len == 0) return zaco_str_new("");
     if (count > INT64_MAX / len) return zaco_str_new(""); /* overflow */
@@ -744,7 +1489,7 @@ void* zaco_str_pad_start(void* s, int64_t target_len, void* pad_str) {
     int need_free_s = 0;
     if (!s) { s = zaco_str_new(""); need_free_s = 1; }
 
-    int64_t current_len = strlen((char*)s);
+    int64_t current_len = ZACO_STR_LEN(s);
     if (current_len >= target_len) {
         if (!need_free_s) zaco_rc_inc(s);
         /* if need_free_s, s already has rc=1, just return it */
@@ -752,7 +1497,7 @@ void* zaco_str_pad_start(void* s, int64_t target_len, void* pad_str) {
     }
 
     const char* pad = pad_str ? (const char*)pad_str : " ";
-    int64_t pad_len = strlen(pad);
+    int64_t pad_len = pad_str ? ZACO_STR_LEN(pad_str) : 1;
     if (pad_len == 0) {
         if (!need_free_s) zaco_rc_inc(s);
         return s;
@@ -781,14 +1526,14 @@ void* zaco_str_pad_end(void* s, int64_t target_len, void* pad_str) {
     int need_free_s = 0;
     if (!s) { s = zaco_str_new(""); need_free_s = 1; }
 
-    int64_t current_len = strlen((char*)s);
+    int64_t current_len = ZACO_STR_LEN(s);
     if (current_len >= target_len) {
         if (!need_free_s) zaco_rc_inc(s);
         return s;
     }
 
     const char* pad = pad_str ? (const char*)pad_str : " ";
-    int64_t pad_len = strlen(pad);
+    int64_t pad_len = pad_str ? ZACO_STR_LEN(pad_str) : 1;
     if (pad_len == 0) {
         if (!need_free_s) zaco_rc_inc(s);
         return s;
@@ -910,48 +1655,60 @@ void* zaco_array_join(void* arr, void* separator) {
     if (array->length == 0) return zaco_str_new("");
 
     const char* sep = separator ? (const char*)separator : ",";
-    int64_t sep_len = strlen(sep);
+    int64_t sep_len = separator ? ZACO_STR_LEN(separator) : 1;
 
     // Calculate total length needed
     int64_t total_len = 0;
     for (int64_t i = 0; i < array->length; i++) {
         void* elem_ptr = *((void**)((char*)array->data + i * array->elem_size));
         if (elem_ptr) {
-            total_len += strlen((char*)elem_ptr);
+            total_len += ZACO_STR_LEN(elem_ptr);
         }
         if (i < array->length - 1) {
             total_len += sep_len;
         }
     }
 
-    char* buf = malloc(total_len + 1);
+    /* Write straight into the result allocation */
+    char* result = (char*)zaco_alloc(total_len + 1);
     int64_t pos = 0;
 
     for (int64_t i = 0; i < array->length; i++) {
         void* elem_ptr = *((void**)((char*)array->data + i * array->elem_size));
         if (elem_ptr) {
-            int64_t elem_len = strlen((char*)elem_ptr);
-            memcpy(buf + pos, elem_ptr, elem_len);
+            int64_t elem_len = ZACO_STR_LEN(elem_ptr);
+            memcpy(result + pos, elem_ptr, elem_len);
             pos += elem_len;
         }
         if (i < array->length - 1) {
-            memcpy(buf + pos, sep, sep_len);
+            memcpy(result + pos, sep, sep_len);
             pos += sep_len;
         }
     }
 
-    buf[pos] = '\0';
-    void* result = zaco_str_new(buf);
-    free(buf);
     return result;
 }
 
+static void u64_reverse(uint64_t* data, int64_t n);
+
 void zaco_array_reverse(void* arr) {
     if (!arr) return;
 
     ZacoArray* array = (ZacoArray*)arr;
     if (array->length <= 1) return;
 
+    if (array->elem_size == 8) {
+        u64_reverse((uint64_t*)array->data, array->length);
+        if (array->kinds) {
+            for (int64_t i = 0, j = array->length - 1; i < j; i++, j--) {
+                uint8_t k = array->kinds[i];
+                array->kinds[i] = array->kinds[j];
+                array->kinds[j] = k;
+            }
+        }
+        return;
+    }
+
     void* temp = malloc(array->elem_size);
 
     for (int64_t i = 0; i < array->length / 2; i++) {
@@ -962,6 +1719,11 @@ void zaco_array_reverse(void* arr) {
         memcpy(temp, left, array->elem_size);
         memcpy(left, right, array->elem_size);
         memcpy(right, temp, array->elem_size);
+        if (array->kinds) {
+            uint8_t k = array->kinds[i];
+            array->kinds[i] = array->kinds[j];
+            array->kinds[j] = k;
+        }
     }
 
     free(temp);
@@ -990,38 +1752,20 @@ void zaco_exit(int64_t code) {
     exit((int)code);
 }
 
-/* ========== Exception Handling (setjmp/longjmp) ========== */
+/* ========== Exception Handling ========== */
 
-#define MAX_TRY_DEPTH 64
-static jmp_buf try_stack[MAX_TRY_DEPTH];
-static int try_depth = 0;
+/* A throw never unwinds the C stack. zaco_throw records the error and sets
+ * zaco_exception_pending; compiled code tests the flag after every call that
+ * can throw and branches to the enclosing catch block, or returns to its
+ * caller, which repeats the test. Entering a try block therefore costs
+ * nothing. All JS code runs on the event loop thread, so a single flag is
+ * enough. */
+int64_t zaco_exception_pending = 0;
 static void* current_error = NULL;
 
-int64_t zaco_try_push() {
-    if (try_depth >= MAX_TRY_DEPTH) {
-        fprintf(stderr, "zaco: try/catch nesting too deep\n");
-        exit(1);
-    }
-    return setjmp(try_stack[try_depth++]);
-}
-
-void zaco_try_pop() {
-    if (try_depth > 0) try_depth--;
-}
-
 void zaco_throw(void* error) {
     current_error = error;
-    if (try_depth > 0) {
-        try_depth--;
-        longjmp(try_stack[try_depth], 1);
-    }
-    /* Uncaught exception */
-    if (error) {
-        fprintf(stderr, "Uncaught exception: %s\n", (char*)error);
-    } else {
-        fprintf(stderr, "Uncaught exception\n");
-    }
-    exit(1);
+    zaco_exception_pending = 1;
 }
 
 void* zaco_get_error() {
@@ -1030,6 +1774,19 @@ void* zaco_get_error() {
 
 void zaco_clear_error() {
     current_error = NULL;
+    zaco_exception_pending = 0;
+}
+
+/* Report an exception that propagated out of main or a callback. */
+void zaco_check_uncaught() {
+    if (!zaco_exception_pending) return;
+    zaco_console_flush();
+    if (current_error) {
+        fprintf(stderr, "Uncaught exception: %s\n", (char*)current_error);
+    } else {
+        fprintf(stderr, "Uncaught exception\n");
+    }
+    exit(1);
 }
 
 /* ========== Global Number Functions ========== */
@@ -1066,108 +1823,504 @@ int64_t zaco_is_finite(double n) {
     return isfinite(n) ? 1 : 0;
 }
 
-/* ========== Inline Array Helpers ==========
- * These work with the inline array format used by codegen:
- *   [length: i64][elem0][elem1]...
- * Each element is 8 bytes (f64 or pointer).
+/* ========== Typed Array Helpers ==========
+ * Element access for arrays of 8-byte elements (f64 or pointer). Codegen
+ * expands these inline; the definitions serve indirect callers. The checked
+ * forms return 0/NULL for null arrays and out-of-range indices; the
+ * `_unchecked` forms are only emitted where a loop bound already proves the
+ * index in range.
  */
 
 int64_t zaco_array_length(void* arr) {
     if (!arr) return 0;
-    return *((int64_t*)arr);
+    return ((ZacoArray*)arr)->length;
 }
 
 double zaco_array_get_f64(void* arr, int64_t index) {
     if (!arr) return 0.0;
-    int64_t length = *((int64_t*)arr);
-    if (index < 0 || index >= length) return 0.0;
-    return *((double*)((char*)arr + 8 + index * 8));
+    ZacoArray* array = (ZacoArray*)arr;
+    if (index < 0 || index >= array->length) return 0.0;
+    return ((double*)array->data)[index];
 }
 
 void* zaco_array_get_ptr(void* arr, int64_t index) {
     if (!arr) return NULL;
-    int64_t length = *((int64_t*)arr);
-    if (index < 0 || index >= length) return NULL;
-    return *((void**)((char*)arr + 8 + index * 8));
+    ZacoArray* array = (ZacoArray*)arr;
+    if (index < 0 || index >= array->length) return NULL;
+    return ((void**)array->data)[index];
+}
+
+double zaco_array_get_f64_unchecked(void* arr, int64_t index) {
+    return ((double*)((ZacoArray*)arr)->data)[index];
+}
+
+void* zaco_array_get_ptr_unchecked(void* arr, int64_t index) {
+    return ((void**)((ZacoArray*)arr)->data)[index];
+}
+
+void zaco_array_push_f64(void* arr, double value) {
+    if (!arr) return;
+    zaco_array_push(arr, &value);
+}
+
+/* ========== Vectorized Array Kernels ==========
+ * Scans over arrays of 8-byte elements. SSE2 (always present on x86_64)
+ * takes two elements per step, and an AVX2 path taking four is picked at
+ * run time when the CPU has it; other targets use the scalar loops. Every
+ * kernel returns exactly what its scalar loop would, NaN and -0 included.
+ */
+
+#ifdef ZACO_AVX2_DISPATCH
+static int zaco_cpu_has_avx2(void) {
+    /* Racing threads all store the same answer */
+    static int has_avx2 = -1;
+    if (has_avx2 < 0) {
+        __builtin_cpu_init();
+        has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return has_avx2;
+}
+
+__attribute__((target("avx2")))
+static int64_t f64_find_avx2(const double* data, int64_t n, double value) {
+    const __m256d needle = _mm256_set1_pd(value);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), needle, _CMP_EQ_OQ));
+        if (mask) return i + __builtin_ctz((unsigned)mask);
+    }
+    for (; i < n; i++) {
+        if (data[i] == value) return i;
+    }
+    return -1;
+}
+
+__attribute__((target("avx2")))
+static double f64_extreme_avx2(const double* data, int64_t n, double init, int want_max) {
+    int64_t i = 0;
+    double best = init;
+    if (n >= 4) {
+        __m256d acc = _mm256_set1_pd(init);
+        for (; i + 4 <= n; i += 4) {
+            __m256d v = _mm256_loadu_pd(data + i);
+            acc = want_max ? _mm256_max_pd(acc, v) : _mm256_min_pd(acc, v);
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, acc);
+        for (int k = 0; k < 4; k++) {
+            if (want_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+        }
+    }
+    for (; i < n; i++) {
+        if (want_max ? data[i] > best : data[i] < best) best = data[i];
+    }
+    return best;
+}
+#endif
+
+/* First index with data[i] == value (IEEE equality), or -1. */
+static int64_t f64_find(const double* data, int64_t n, double value) {
+    int64_t i = 0;
+#ifdef ZACO_AVX2_DISPATCH
+    if (zaco_cpu_has_avx2()) return f64_find_avx2(data, n, value);
+#endif
+#if defined(__SSE2__)
+    const __m128d needle = _mm_set1_pd(value);
+    for (; i + 2 <= n; i += 2) {
+        int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data + i), needle));
+        if (mask) return i + ((mask & 1) ? 0 : 1);
+    }
+#endif
+    for (; i < n; i++) {
+        if (data[i] == value) return i;
+    }
+    return -1;
 }
 
-/* ========== Object (Key-Value Map) ========== */
+/* Last index in [lo, hi) equal to `value`, or holding a NaN when `value` is
+ * NaN; -1 if there is none. */
+static int64_t f64_find_last(const double* data, int64_t lo, int64_t hi, double value) {
+    int want_nan = value != value;
+    int64_t i = hi;
+#if defined(__SSE2__)
+    const __m128d needle = _mm_set1_pd(value);
+    for (; i - 2 >= lo; i -= 2) {
+        __m128d v = _mm_loadu_pd(data + i - 2);
+        int mask = _mm_movemask_pd(want_nan ? _mm_cmpunord_pd(v, v) : _mm_cmpeq_pd(v, needle));
+        if (mask) return i - 2 + ((mask & 2) ? 1 : 0);
+    }
+#endif
+    for (; i > lo; i--) {
+        double x = data[i - 1];
+        if (want_nan ? x != x : x == value) return i - 1;
+    }
+    return -1;
+}
+
+/* Numeric max (or min) of `init` and data[0..n), which must hold no NaN.
+ * Which zero is returned when -0 and +0 tie is unspecified. */
+static double f64_extreme(const double* data, int64_t n, double init, int want_max) {
+#ifdef ZACO_AVX2_DISPATCH
+    if (zaco_cpu_has_avx2()) return f64_extreme_avx2(data, n, init, want_max);
+#endif
+    int64_t i = 0;
+    double best = init;
+#if defined(__SSE2__)
+    if (n >= 2) {
+        __m128d acc = _mm_set1_pd(init);
+        for (; i + 2 <= n; i += 2) {
+            __m128d v = _mm_loadu_pd(data + i);
+            acc = want_max ? _mm_max_pd(acc, v) : _mm_min_pd(acc, v);
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, acc);
+        for (int k = 0; k < 2; k++) {
+            if (want_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (want_max ? data[i] > best : data[i] < best) best = data[i];
+    }
+    return best;
+}
+
+/* The result of `acc = zaco_math_max(acc, a[i])` (or `zaco_math_min`) over
+ * the whole array, without the loop-carried dependency. The sequential fold
+ * forgets everything up to its last NaN element (a NaN acc is replaced by
+ * the next element), and an element equal to acc replaces it, so the result
+ * is the last element equal to the extreme, or acc if none is. */
+static double f64_fold_extreme(void* arr, double acc, int want_max) {
+    if (!arr) return acc;
+    ZacoArray* array = (ZacoArray*)arr;
+    const double* data = (const double*)array->data;
+    int64_t n = array->length;
+    int64_t start = 0;
+
+    int64_t last_nan = f64_find_last(data, 0, n, NAN);
+    if (last_nan >= 0) {
+        if (last_nan == n - 1) return data[last_nan];
+        acc = data[last_nan + 1];
+        start = last_nan + 2;
+    } else if (acc != acc) {
+        if (n == 0) return acc;
+        acc = data[0];
+        start = 1;
+    }
+
+    double extreme = f64_extreme(data + start, n - start, acc, want_max);
+    int64_t last = f64_find_last(data, start, n, extreme);
+    return last >= 0 ? data[last] : acc;
+}
+
+double zaco_array_fold_max_f64(void* arr, double acc) {
+    return f64_fold_extreme(arr, acc, 1);
+}
+
+double zaco_array_fold_min_f64(void* arr, double acc) {
+    return f64_fold_extreme(arr, acc, 0);
+}
+
+/* `number[]` indexOf: strict equality, so NaN is never found and -0 finds 0 */
+int64_t zaco_array_index_of_f64(void* arr, double value) {
+    if (!arr) return -1;
+    ZacoArray* array = (ZacoArray*)arr;
+    return f64_find((const double*)array->data, array->length, value);
+}
+
+/* Reverse 8-byte elements in place, swapping two-element blocks from each
+ * end while they don't overlap. */
+static void u64_reverse(uint64_t* data, int64_t n) {
+    int64_t i = 0, j = n;
+#if defined(__SSE2__)
+    for (; j - i >= 4; i += 2, j -= 2) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(data + j - 2));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_shuffle_epi32(hi, 0x4E));
+        _mm_storeu_si128((__m128i*)(data + j - 2), _mm_shuffle_epi32(lo, 0x4E));
+    }
+#endif
+    for (; j - i >= 2; i++, j--) {
+        uint64_t t = data[i];
+        data[i] = data[j - 1];
+        data[j - 1] = t;
+    }
+}
+
+/* ========== Object (Key-Value Map) ==========
+ * Objects use hidden classes ("shapes"). A shape maps each key to a slot
+ * index and is shared by every object that acquired the same keys in the
+ * same order, so objects built from one literal share one shape. Adding a
+ * key follows a cached transition to a child shape; the slot of an existing
+ * key never changes.
+ *
+ * The object layout is part of the codegen ABI: compiled code reads `shape`
+ * at offset 0 and `slots` at offset 8 for inline-cached property access
+ * (see zaco_object_cache_shape).
+ *
+ * Objects that grow past ZACO_SHAPE_MAX_KEYS switch to a private dictionary
+ * shape that is extended in place and never cached.
+ */
+
+#define ZACO_SHAPE_MAX_KEYS 64
+#define ZACO_OBJECT_INITIAL_SLOTS 8
 
 typedef struct {
-    char* key;
-    uint64_t value_bits; /* Stores any 8-byte value via memcpy */
-} ZacoObjEntry;
+    const char* key;   /* NULL marks an empty bucket */
+    uint64_t hash;
+    int64_t slot;
+} ZacoShapeEntry;
+
+typedef struct ZacoShape {
+    int64_t count;              /* number of keys (= slots) */
+    const char** keys;          /* keys in slot order */
+    ZacoShapeEntry* table;      /* key -> slot, open addressing */
+    int64_t table_cap;          /* power of two, or 0 when empty */
+    int dictionary;             /* private to one object, mutated in place */
+    int64_t owned_from;         /* dictionary: keys[owned_from..] are owned copies */
+    struct ZacoShape** children;
+    int64_t child_count;
+    int64_t child_cap;
+} ZacoShape;
 
 typedef struct {
-    int64_t count;
+    ZacoShape* shape;
+    uint64_t* slots;
     int64_t capacity;
-    ZacoObjEntry* entries;
+    uint8_t* kinds;             /* ZACO_KIND_* of each slot */
 } ZacoObject;
 
-static int64_t zaco_object_find(ZacoObject* obj, const char* key) {
-    for (int64_t i = 0; i < obj->count; i++) {
-        if (obj->entries[i].key && strcmp(obj->entries[i].key, key) == 0) {
-            return i;
+/* Shapes are immortal; transitions are created under this lock. */
+static ZacoShape shape_root;
+static pthread_mutex_t shape_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t shape_hash(const char* key) {
+    uint64_t h = 1469598103934665603ULL; /* FNV-1a */
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static int64_t shape_lookup_hashed(const ZacoShape* shape, const char* key, uint64_t h) {
+    if (shape->table_cap == 0) return -1;
+    uint64_t mask = (uint64_t)shape->table_cap - 1;
+    for (uint64_t i = h & mask;; i = (i + 1) & mask) {
+        const ZacoShapeEntry* e = &shape->table[i];
+        if (!e->key) return -1;
+        if (e->hash == h && (e->key == key || strcmp(e->key, key) == 0)) return e->slot;
+    }
+}
+
+static void shape_table_put(ZacoShapeEntry* table, int64_t cap, const char* key, uint64_t h, int64_t slot) {
+    uint64_t mask = (uint64_t)cap - 1;
+    uint64_t i = h & mask;
+    while (table[i].key) i = (i + 1) & mask;
+    table[i].key = key;
+    table[i].hash = h;
+    table[i].slot = slot;
+}
+
+/* Append `key` as the next slot of `shape`, growing the index to keep the
+ * load factor at or below 1/2. */
+static void shape_append_key(ZacoShape* shape, const char* key, uint64_t h) {
+    int64_t slot = shape->count;
+    if ((slot + 1) * 2 > shape->table_cap) {
+        int64_t cap = shape->table_cap ? shape->table_cap * 2 : 8;
+        ZacoShapeEntry* table = (ZacoShapeEntry*)calloc((size_t)cap, sizeof(ZacoShapeEntry));
+        const char** keys = (const char**)realloc((void*)shape->keys, (size_t)cap * sizeof(char*));
+        if (!table || !keys) {
+            fprintf(stderr, "zaco: out of memory (object shape)\n");
+            exit(1);
         }
+        for (int64_t i = 0; i < shape->table_cap; i++) {
+            ZacoShapeEntry* e = &shape->table[i];
+            if (e->key) shape_table_put(table, cap, e->key, e->hash, e->slot);
+        }
+        free(shape->table);
+        shape->table = table;
+        shape->table_cap = cap;
+        shape->keys = keys;
     }
-    return -1;
+    shape->keys[slot] = key;
+    shape_table_put(shape->table, shape->table_cap, key, h, slot);
+    shape->count = slot + 1;
 }
 
-static void zaco_object_set_raw(ZacoObject* obj, const char* key, uint64_t bits) {
-    int64_t idx = zaco_object_find(obj, key);
-    if (idx >= 0) {
-        obj->entries[idx].value_bits = bits;
-        return;
+/* Copy `parent`'s keys and index into a fresh shape. */
+static ZacoShape* shape_clone(const ZacoShape* parent, int dictionary) {
+    ZacoShape* shape = (ZacoShape*)calloc(1, sizeof(ZacoShape));
+    if (!shape) {
+        fprintf(stderr, "zaco: out of memory (object shape)\n");
+        exit(1);
+    }
+    shape->dictionary = dictionary;
+    shape->owned_from = parent->count;
+    if (parent->table_cap > 0) {
+        shape->table = (ZacoShapeEntry*)malloc((size_t)parent->table_cap * sizeof(ZacoShapeEntry));
+        shape->keys = (const char**)malloc((size_t)parent->table_cap * sizeof(char*));
+        if (!shape->table || !shape->keys) {
+            fprintf(stderr, "zaco: out of memory (object shape)\n");
+            exit(1);
+        }
+        memcpy(shape->table, parent->table, (size_t)parent->table_cap * sizeof(ZacoShapeEntry));
+        memcpy((void*)shape->keys, parent->keys, (size_t)parent->count * sizeof(char*));
+        shape->table_cap = parent->table_cap;
+        shape->count = parent->count;
     }
-    if (obj->count >= obj->capacity) {
+    return shape;
+}
+
+/* Shared child of `shape` with `key` appended. */
+static ZacoShape* shape_transition(ZacoShape* shape, const char* key, uint64_t h) {
+    pthread_mutex_lock(&shape_mutex);
+    for (int64_t i = 0; i < shape->child_count; i++) {
+        ZacoShape* child = shape->children[i];
+        if (strcmp(child->keys[shape->count], key) == 0) {
+            pthread_mutex_unlock(&shape_mutex);
+            return child;
+        }
+    }
+    ZacoShape* child = shape_clone(shape, 0);
+    char* owned = strdup(key);
+    if (!owned) {
+        fprintf(stderr, "zaco: out of memory (object shape)\n");
+        exit(1);
+    }
+    shape_append_key(child, owned, h);
+    if (shape->child_count >= shape->child_cap) {
+        shape->child_cap = shape->child_cap ? shape->child_cap * 2 : 4;
+        shape->children = (ZacoShape**)realloc(shape->children, (size_t)shape->child_cap * sizeof(ZacoShape*));
+        if (!shape->children) {
+            fprintf(stderr, "zaco: out of memory (object shape)\n");
+            exit(1);
+        }
+    }
+    shape->children[shape->child_count++] = child;
+    pthread_mutex_unlock(&shape_mutex);
+    return child;
+}
+
+static void zaco_object_add_slot(ZacoObject* obj, const char* key, uint64_t h, uint64_t bits, uint8_t kind) {
+    ZacoShape* shape = obj->shape;
+    if (shape->dictionary) {
+        char* owned = strdup(key);
+        if (!owned) {
+            fprintf(stderr, "zaco: out of memory (object)\n");
+            exit(1);
+        }
+        shape_append_key(shape, owned, h);
+    } else if (shape->count >= ZACO_SHAPE_MAX_KEYS) {
+        ZacoShape* dict = shape_clone(shape, 1);
+        char* owned = strdup(key);
+        if (!owned) {
+            fprintf(stderr, "zaco: out of memory (object)\n");
+            exit(1);
+        }
+        shape_append_key(dict, owned, h);
+        obj->shape = dict;
+    } else {
+        obj->shape = shape_transition(shape, key, h);
+    }
+
+    int64_t slot = obj->shape->count - 1;
+    if (slot >= obj->capacity) {
         obj->capacity *= 2;
-        obj->entries = (ZacoObjEntry*)realloc(obj->entries, obj->capacity * sizeof(ZacoObjEntry));
+        obj->slots = (uint64_t*)realloc(obj->slots, (size_t)obj->capacity * sizeof(uint64_t));
+        obj->kinds = (uint8_t*)realloc(obj->kinds, (size_t)obj->capacity);
+        if (!obj->slots || !obj->kinds) {
+            fprintf(stderr, "zaco: out of memory (object)\n");
+            exit(1);
+        }
+    }
+    obj->slots[slot] = bits;
+    obj->kinds[slot] = kind;
+}
+
+static void zaco_object_set_raw(ZacoObject* obj, const char* key, uint64_t bits, uint8_t kind) {
+    ZACO_COUNT(ZACO_COUNT_PROP_LOOKUPS, 1);
+    uint64_t h = shape_hash(key);
+    int64_t slot = shape_lookup_hashed(obj->shape, key, h);
+    if (slot >= 0) {
+        obj->slots[slot] = bits;
+        obj->kinds[slot] = kind;
+        return;
     }
-    obj->entries[obj->count].key = strdup(key);
-    obj->entries[obj->count].value_bits = bits;
-    obj->count++;
+    zaco_object_add_slot(obj, key, h, bits, kind);
 }
 
 static uint64_t zaco_object_get_raw(ZacoObject* obj, const char* key) {
-    int64_t idx = zaco_object_find(obj, key);
-    if (idx >= 0) return obj->entries[idx].value_bits;
+    if (!obj) return 0;
+    ZACO_COUNT(ZACO_COUNT_PROP_LOOKUPS, 1);
+    int64_t slot = shape_lookup_hashed(obj->shape, key, shape_hash(key));
+    if (slot >= 0) return obj->slots[slot];
     return 0;
 }
 
 void* zaco_object_new(void) {
-    ZacoObject* obj = (ZacoObject*)malloc(sizeof(ZacoObject));
-    if (!obj) {
+    ZacoObject* obj = (ZacoObject*)zaco_alloc(sizeof(ZacoObject));
+    zaco_header_set_kind(obj, ZACO_KIND_OBJECT);
+    obj->shape = &shape_root;
+    obj->capacity = ZACO_OBJECT_INITIAL_SLOTS;
+    obj->slots = (uint64_t*)calloc(obj->capacity, sizeof(uint64_t));
+    obj->kinds = (uint8_t*)calloc(obj->capacity, 1);
+    if (!obj->slots || !obj->kinds) {
         fprintf(stderr, "zaco: out of memory (object)\n");
         exit(1);
     }
-    obj->count = 0;
-    obj->capacity = 8;
-    obj->entries = (ZacoObjEntry*)calloc(obj->capacity, sizeof(ZacoObjEntry));
     return obj;
 }
 
+static void zaco_object_set_kind(void* o, const char* key, uint64_t bits, uint8_t kind) {
+    zaco_object_set_raw((ZacoObject*)o, key, bits, kind);
+}
+
+/* Inline-cache support: return the object's shape if `key` lives at `slot`
+ * in it and the shape is shared (cacheable), NULL otherwise. Compiled code
+ * stores the result in a per-site cache cell; while an object's shape equals
+ * the cached one it reads slots[slot] directly without a lookup. */
+void* zaco_object_cache_shape(void* o, const char* key, int64_t slot) {
+    if (!o) return NULL;
+    ZacoShape* shape = ((ZacoObject*)o)->shape;
+    if (shape->dictionary || slot < 0 || slot >= shape->count) return NULL;
+    if (strcmp(shape->keys[slot], key) != 0) return NULL;
+    return shape;
+}
+
 void zaco_object_set_str(void* o, const char* key, const char* value) {
     uint64_t bits;
     memcpy(&bits, &value, sizeof(bits));
-    zaco_object_set_raw((ZacoObject*)o, key, bits);
+    zaco_object_set_raw((ZacoObject*)o, key, bits, ZACO_KIND_STR);
 }
 
 void zaco_object_set_f64(void* o, const char* key, double value) {
     uint64_t bits;
     memcpy(&bits, &value, sizeof(bits));
-    zaco_object_set_raw((ZacoObject*)o, key, bits);
+    zaco_object_set_raw((ZacoObject*)o, key, bits, ZACO_KIND_F64);
 }
 
 void zaco_object_set_i64(void* o, const char* key, int64_t value) {
     uint64_t bits;
     memcpy(&bits, &value, sizeof(bits));
-    zaco_object_set_raw((ZacoObject*)o, key, bits);
+    zaco_object_set_raw((ZacoObject*)o, key, bits, ZACO_KIND_I64);
 }
 
 void zaco_object_set_ptr(void* o, const char* key, void* value) {
     uint64_t bits;
     memcpy(&bits, &value, sizeof(bits));
-    zaco_object_set_raw((ZacoObject*)o, key, bits);
+    zaco_object_set_raw((ZacoObject*)o, key, bits, ZACO_KIND_PTR);
+}
+
+void zaco_object_set_bool(void* o, const char* key, int64_t value) {
+    zaco_object_set_raw((ZacoObject*)o, key, value ? 1 : 0, ZACO_KIND_BOOL);
+}
+
+/* Like zaco_object_set_ptr, for a value known to be a ZacoObject. */
+void zaco_object_set_obj(void* o, const char* key, void* value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    zaco_object_set_raw((ZacoObject*)o, key, bits, value ? ZACO_KIND_OBJECT : ZACO_KIND_NULL);
 }
 
 const char* zaco_object_get_str(void* o, const char* key) {
@@ -1200,107 +2353,1057 @@ void* zaco_object_get_ptr(void* o, const char* key) {
 
 int64_t zaco_object_has(void* o, const char* key) {
     if (!o) return 0;
-    return zaco_object_find((ZacoObject*)o, key) >= 0 ? 1 : 0;
+    ZacoObject* obj = (ZacoObject*)o;
+    return shape_lookup_hashed(obj->shape, key, shape_hash(key)) >= 0 ? 1 : 0;
 }
 
 void zaco_object_free(void* o) {
     if (!o) return;
     ZacoObject* obj = (ZacoObject*)o;
-    for (int64_t i = 0; i < obj->count; i++) {
-        free(obj->entries[i].key);
+    ZacoShape* shape = obj->shape;
+    if (shape->dictionary) {
+        for (int64_t i = shape->owned_from; i < shape->count; i++) {
+            free((void*)shape->keys[i]);
+        }
+        free((void*)shape->keys);
+        free(shape->table);
+        free(shape);
     }
-    free(obj->entries);
-    free(obj);
+    free(obj->slots);
+    free(obj->kinds);
+    zaco_free(obj);
 }
 
-/* ========== Missing Console Warn Functions ========== */
+/* ========== JSON Functions ========== */
+
+/* JSON.parse is a push parser: input is fed in chunks of any size and only
+ * the token under construction (a string, number or literal that straddles
+ * a chunk boundary) is buffered, never the document. Objects and arrays are
+ * built directly as ZacoObject/ZacoArray with kinds recorded per value, and
+ * numbers become doubles.
+ *
+ * String bodies and whitespace runs are scanned 16 bytes at a time with SSE2
+ * where available (the structural/quote classification of simdjson's stage
+ * 1, applied per run so it works on partial input); other targets use the
+ * scalar loop. */
+
+#define ZACO_JSON_MAX_DEPTH 1024
+
+enum {
+    JSON_S_VALUE,         /* expecting a value */
+    JSON_S_ARRAY_FIRST,   /* after '[': a value or ']' */
+    JSON_S_OBJECT_FIRST,  /* after '{': a key or '}' */
+    JSON_S_KEY,           /* after ',' in an object */
+    JSON_S_COLON,
+    JSON_S_AFTER,         /* after a value: ',' or a closing bracket */
+    JSON_S_STRING,
+    JSON_S_ESCAPE,        /* after a backslash in a string */
+    JSON_S_UNICODE,       /* inside \uXXXX */
+    JSON_S_NUMBER,
+    JSON_S_LITERAL,       /* inside true/false/null */
+    JSON_S_DONE,          /* root complete, only whitespace may follow */
+    JSON_S_ERROR
+};
 
-void zaco_console_warn_f64(double n) {
-    if (floor(n) == n && fabs(n) < 1e15) {
-        fprintf(stderr, "%.0f", n);
+typedef struct {
+    uint8_t kind;         /* ZACO_KIND_OBJECT or ZACO_KIND_ARRAY */
+    void* container;
+    int64_t key_off;      /* object: offset of the pending key in `keys` */
+} JsonFrame;
+
+typedef struct {
+    int state;
+    JsonFrame* stack;
+    int64_t depth;
+    int64_t stack_cap;
+    ZacoStrBuilder tok;   /* bytes of the token under construction */
+    ZacoStrBuilder keys;  /* NUL-terminated pending keys, one per open object */
+    int string_is_key;
+    uint32_t unicode;     /* \\u escape being decoded */
+    int unicode_digits;
+    uint32_t high_surrogate;
+    const char* literal;
+    int literal_pos;
+    uint64_t root_bits;
+    uint8_t root_kind;
+    const char* error;
+} ZacoJsonParser;
+
+static void zaco_object_set_kind(void* o, const char* key, uint64_t bits, uint8_t kind);
+
+/* Length of the leading run of `s` that needs no handling inside a string:
+ * stops at '"', '\\' or a control character. */
+static size_t json_plain_run(const char* s, size_t n) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+        /* unsigned v <= 0x1f */
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+        int mask = _mm_movemask_epi8(special);
+        if (mask) return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+#endif
+    for (; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\' || c < 0x20) break;
+    }
+    return i;
+}
+
+static const char* json_skip_ws(const char* s, const char* end) {
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    while (end - s >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)s);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, nl)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, tab)));
+        int mask = ~_mm_movemask_epi8(ws) & 0xffff;
+        if (mask) return s + __builtin_ctz((unsigned)mask);
+        s += 16;
+    }
+#endif
+    while (s < end && (*s == ' ' || *s == '\n' || *s == '\r' || *s == '\t')) s++;
+    return s;
+}
+
+static int json_fail(ZacoJsonParser* p, const char* msg) {
+    p->state = JSON_S_ERROR;
+    p->error = msg;
+    return -1;
+}
+
+static void json_tok_put(ZacoJsonParser* p, const char* bytes, int64_t len) {
+    strbuf_reserve(&p->tok, len);
+    memcpy(p->tok.data + p->tok.len, bytes, (size_t)len);
+    p->tok.len += len;
+}
+
+static void json_tok_put_utf8(ZacoJsonParser* p, uint32_t cp) {
+    char buf[4];
+    int n;
+    if (cp < 0x80) {
+        buf[0] = (char)cp; n = 1;
+    } else if (cp < 0x800) {
+        buf[0] = (char)(0xc0 | (cp >> 6));
+        buf[1] = (char)(0x80 | (cp & 0x3f)); n = 2;
+    } else if (cp < 0x10000) {
+        buf[0] = (char)(0xe0 | (cp >> 12));
+        buf[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+        buf[2] = (char)(0x80 | (cp & 0x3f)); n = 3;
     } else {
-        fprintf(stderr, "%g", n);
+        buf[0] = (char)(0xf0 | (cp >> 18));
+        buf[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+        buf[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+        buf[3] = (char)(0x80 | (cp & 0x3f)); n = 4;
+    }
+    json_tok_put(p, buf, n);
+}
+
+/* Free a parsed value and everything it owns. */
+static void json_release(uint64_t bits, uint8_t kind) {
+    void* ptr;
+    memcpy(&ptr, &bits, sizeof(ptr));
+    if (!ptr) return;
+    if (kind == ZACO_KIND_STR) {
+        zaco_rc_dec(ptr);
+    } else if (kind == ZACO_KIND_ARRAY) {
+        ZacoArray* arr = (ZacoArray*)ptr;
+        for (int64_t i = 0; arr->kinds && i < arr->length; i++) {
+            json_release(((uint64_t*)arr->data)[i], arr->kinds[i]);
+        }
+        zaco_array_destroy(arr);
+    } else if (kind == ZACO_KIND_OBJECT) {
+        ZacoObject* obj = (ZacoObject*)ptr;
+        for (int64_t i = 0; i < obj->shape->count; i++) {
+            json_release(obj->slots[i], obj->kinds[i]);
+        }
+        zaco_object_free(obj);
     }
 }
 
-void zaco_console_warn_bool(int64_t b) {
-    fprintf(stderr, "%s", b ? "true" : "false");
+/* Hand a completed value to the innermost open container, or make it the
+ * root. */
+static int json_emit(ZacoJsonParser* p, uint64_t bits, uint8_t kind) {
+    if (p->depth == 0) {
+        p->root_bits = bits;
+        p->root_kind = kind;
+        p->state = JSON_S_DONE;
+        return 0;
+    }
+    JsonFrame* top = &p->stack[p->depth - 1];
+    if (top->kind == ZACO_KIND_ARRAY) {
+        zaco_array_push_kind((ZacoArray*)top->container, bits, kind);
+    } else {
+        zaco_object_set_kind(top->container, p->keys.data + top->key_off, bits, kind);
+        p->keys.len = top->key_off;
+    }
+    p->state = JSON_S_AFTER;
+    return 0;
+}
+
+static int json_emit_ptr(ZacoJsonParser* p, void* ptr, uint8_t kind) {
+    uint64_t bits;
+    memcpy(&bits, &ptr, sizeof(bits));
+    return json_emit(p, bits, kind);
+}
+
+static int json_open(ZacoJsonParser* p, uint8_t kind) {
+    if (p->depth >= ZACO_JSON_MAX_DEPTH) return json_fail(p, "nesting too deep");
+    if (p->depth >= p->stack_cap) {
+        p->stack_cap = p->stack_cap ? p->stack_cap * 2 : 16;
+        p->stack = (JsonFrame*)realloc(p->stack, (size_t)p->stack_cap * sizeof(JsonFrame));
+        if (!p->stack) {
+            fprintf(stderr, "zaco: out of memory (json)\n");
+            exit(1);
+        }
+    }
+    JsonFrame* f = &p->stack[p->depth++];
+    f->kind = kind;
+    f->key_off = p->keys.len;
+    if (kind == ZACO_KIND_ARRAY) {
+        f->container = zaco_array_new(sizeof(uint64_t), 0);
+        p->state = JSON_S_ARRAY_FIRST;
+    } else {
+        f->container = zaco_object_new();
+        p->state = JSON_S_OBJECT_FIRST;
+    }
+    return 0;
+}
+
+static int json_close(ZacoJsonParser* p) {
+    JsonFrame f = p->stack[--p->depth];
+    return json_emit_ptr(p, f.container, f.kind);
+}
+
+static int json_end_string(ZacoJsonParser* p) {
+    if (p->high_surrogate) return json_fail(p, "unpaired surrogate in string");
+    if (p->string_is_key) {
+        strbuf_reserve(&p->keys, p->tok.len + 1);
+        memcpy(p->keys.data + p->keys.len, p->tok.data, (size_t)p->tok.len);
+        p->keys.data[p->keys.len + p->tok.len] = '\0';
+        p->keys.len += p->tok.len + 1;
+        p->state = JSON_S_COLON;
+        return 0;
+    }
+    return json_emit_ptr(p, zaco_str_from_bytes(p->tok.data ? p->tok.data : "", p->tok.len),
+                         ZACO_KIND_STR);
+}
+
+/* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+static int json_number_valid(const char* s, int64_t n) {
+    int64_t i = 0;
+    if (i < n && s[i] == '-') i++;
+    if (i < n && s[i] == '0') {
+        i++;
+    } else if (i < n && s[i] >= '1' && s[i] <= '9') {
+        while (i < n && isdigit((unsigned char)s[i])) i++;
+    } else {
+        return 0;
+    }
+    if (i < n && s[i] == '.') {
+        i++;
+        if (i >= n || !isdigit((unsigned char)s[i])) return 0;
+        while (i < n && isdigit((unsigned char)s[i])) i++;
+    }
+    if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < n && (s[i] == '+' || s[i] == '-')) i++;
+        if (i >= n || !isdigit((unsigned char)s[i])) return 0;
+        while (i < n && isdigit((unsigned char)s[i])) i++;
+    }
+    return i == n;
+}
+
+static int json_end_number(ZacoJsonParser* p) {
+    if (!json_number_valid(p->tok.data, p->tok.len)) return json_fail(p, "invalid number");
+    strbuf_reserve(&p->tok, 1);
+    p->tok.data[p->tok.len] = '\0';
+    double d = strtod(p->tok.data, NULL);
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return json_emit(p, bits, ZACO_KIND_F64);
+}
+
+static int json_begin_value(ZacoJsonParser* p, char c) {
+    switch (c) {
+        case '{': return json_open(p, ZACO_KIND_OBJECT);
+        case '[': return json_open(p, ZACO_KIND_ARRAY);
+        case '"':
+            p->tok.len = 0;
+            p->string_is_key = 0;
+            p->state = JSON_S_STRING;
+            return 0;
+        case 't': p->literal = "true"; break;
+        case 'f': p->literal = "false"; break;
+        case 'n': p->literal = "null"; break;
+        default:
+            if (c == '-' || isdigit((unsigned char)c)) {
+                p->tok.len = 0;
+                json_tok_put(p, &c, 1);
+                p->state = JSON_S_NUMBER;
+                return 0;
+            }
+            return json_fail(p, "unexpected character");
+    }
+    p->literal_pos = 1;
+    p->state = JSON_S_LITERAL;
+    return 0;
+}
+
+void* zaco_json_parser_new(void) {
+    ZacoJsonParser* p = (ZacoJsonParser*)calloc(1, sizeof(ZacoJsonParser));
+    if (!p) {
+        fprintf(stderr, "zaco: out of memory (json)\n");
+        exit(1);
+    }
+    p->state = JSON_S_VALUE;
+    return p;
+}
+
+/* Feed the next `len` bytes of the document. Returns 0, or -1 once the
+ * input is known to be malformed (zaco_json_parser_finish reports why). */
+int64_t zaco_json_parser_feed(void* parser, const char* chunk, int64_t len) {
+    ZacoJsonParser* p = (ZacoJsonParser*)parser;
+    if (!p || p->state == JSON_S_ERROR) return -1;
+    const char* s = chunk;
+    const char* end = chunk + len;
+
+    while (s < end) {
+        switch (p->state) {
+            case JSON_S_STRING: {
+                size_t run = json_plain_run(s, (size_t)(end - s));
+                if (run) {
+                    json_tok_put(p, s, (int64_t)run);
+                    s += run;
+                    if (s == end) break;
+                }
+                unsigned char c = (unsigned char)*s++;
+                if (c == '"') {
+                    json_end_string(p);
+                } else if (c == '\\') {
+                    p->state = JSON_S_ESCAPE;
+                } else {
+                    json_fail(p, "control character in string");
+                }
+                break;
+            }
+            case JSON_S_ESCAPE: {
+                char c = *s++;
+                char out;
+                switch (c) {
+                    case '"':  out = '"';  break;
+                    case '\\': out = '\\'; break;
+                    case '/':  out = '/';  break;
+                    case 'b':  out = '\b'; break;
+                    case 'f':  out = '\f'; break;
+                    case 'n':  out = '\n'; break;
+                    case 'r':  out = '\r'; break;
+                    case 't':  out = '\t'; break;
+                    case 'u':
+                        p->unicode = 0;
+                        p->unicode_digits = 0;
+                        p->state = JSON_S_UNICODE;
+                        continue;
+                    default:
+                        json_fail(p, "invalid escape in string");
+                        continue;
+                }
+                if (p->high_surrogate) {
+                    json_fail(p, "unpaired surrogate in string");
+                    continue;
+                }
+                json_tok_put(p, &out, 1);
+                p->state = JSON_S_STRING;
+                break;
+            }
+            case JSON_S_UNICODE: {
+                char c = *s++;
+                int digit;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                else {
+                    json_fail(p, "invalid \\u escape in string");
+                    continue;
+                }
+                p->unicode = (p->unicode << 4) | (uint32_t)digit;
+                if (++p->unicode_digits < 4) break;
+                uint32_t u = p->unicode;
+                p->state = JSON_S_STRING;
+                if (p->high_surrogate) {
+                    if (u < 0xdc00 || u > 0xdfff) {
+                        json_fail(p, "unpaired surrogate in string");
+                        continue;
+                    }
+                    json_tok_put_utf8(p, 0x10000 + ((p->high_surrogate - 0xd800) << 10) + (u - 0xdc00));
+                    p->high_surrogate = 0;
+                } else if (u >= 0xd800 && u <= 0xdbff) {
+                    p->high_surrogate = u;
+                } else if (u >= 0xdc00 && u <= 0xdfff) {
+                    json_fail(p, "unpaired surrogate in string");
+                } else {
+                    json_tok_put_utf8(p, u);
+                }
+                break;
+            }
+            case JSON_S_NUMBER: {
+                const char* start = s;
+                while (s < end && (isdigit((unsigned char)*s) || *s == '-' || *s == '+' ||
+                                   *s == '.' || *s == 'e' || *s == 'E')) {
+                    s++;
+                }
+                json_tok_put(p, start, (int64_t)(s - start));
+                if (s < end) json_end_number(p);
+                break;
+            }
+            case JSON_S_LITERAL: {
+                if (*s++ != p->literal[p->literal_pos]) {
+                    json_fail(p, "unexpected character");
+                    continue;
+                }
+                if (p->literal[++p->literal_pos] != '\0') break;
+                switch (p->literal[0]) {
+                    case 't': json_emit(p, 1, ZACO_KIND_BOOL); break;
+                    case 'f': json_emit(p, 0, ZACO_KIND_BOOL); break;
+                    default:  json_emit(p, 0, ZACO_KIND_NULL); break;
+                }
+                break;
+            }
+            default: {
+                s = json_skip_ws(s, end);
+                if (s == end) break;
+                char c = *s++;
+                switch (p->state) {
+                    case JSON_S_VALUE:
+                        json_begin_value(p, c);
+                        break;
+                    case JSON_S_ARRAY_FIRST:
+                        if (c == ']') json_close(p);
+                        else json_begin_value(p, c);
+                        break;
+                    case JSON_S_OBJECT_FIRST:
+                    case JSON_S_KEY:
+                        if (c == '}' && p->state == JSON_S_OBJECT_FIRST) {
+                            json_close(p);
+                        } else if (c == '"') {
+                            p->tok.len = 0;
+                            p->string_is_key = 1;
+                            p->state = JSON_S_STRING;
+                        } else {
+                            json_fail(p, "expected property name");
+                        }
+                        break;
+                    case JSON_S_COLON:
+                        if (c == ':') p->state = JSON_S_VALUE;
+                        else json_fail(p, "expected ':'");
+                        break;
+                    case JSON_S_AFTER: {
+                        uint8_t kind = p->stack[p->depth - 1].kind;
+                        if (c == ',') {
+                            p->state = kind == ZACO_KIND_ARRAY ? JSON_S_VALUE : JSON_S_KEY;
+                        } else if ((c == ']' && kind == ZACO_KIND_ARRAY) ||
+                                   (c == '}' && kind == ZACO_KIND_OBJECT)) {
+                            json_close(p);
+                        } else {
+                            json_fail(p, "expected ',' or closing bracket");
+                        }
+                        break;
+                    }
+                    default: /* JSON_S_DONE */
+                        json_fail(p, "unexpected data after JSON value");
+                        break;
+                }
+                break;
+            }
+        }
+        if (p->state == JSON_S_ERROR) return -1;
+    }
+    return 0;
+}
+
+static void json_parser_destroy(ZacoJsonParser* p) {
+    free(p->stack);
+    free(p->tok.data);
+    free(p->keys.data);
+    free(p);
+}
+
+static void json_put_number(ZacoStrBuilder* sb, double d);
+
+/* Complete the document and release the parser. Returns the root value: a
+ * ZacoObject, ZacoArray or string. A scalar root comes back in its string
+ * form ("42", "true", "null") since the result is a single pointer; its
+ * header carries its kind so JSON.stringify writes it back unquoted.
+ * Throws a SyntaxError on malformed input. */
+void* zaco_json_parser_finish(void* parser) {
+    ZacoJsonParser* p = (ZacoJsonParser*)parser;
+    if (!p) return NULL;
+    if (p->state == JSON_S_NUMBER) json_end_number(p);
+    if (p->state != JSON_S_DONE && p->state != JSON_S_ERROR) {
+        json_fail(p, "unexpected end of JSON input");
+    }
+    if (p->state == JSON_S_ERROR) {
+        for (int64_t i = p->depth - 1; i >= 0; i--) {
+            uint64_t bits;
+            memcpy(&bits, &p->stack[i].container, sizeof(bits));
+            json_release(bits, p->stack[i].kind);
+        }
+        char msg[96];
+        snprintf(msg, sizeof(msg), "SyntaxError: JSON.parse: %s", p->error);
+        json_parser_destroy(p);
+        zaco_throw(zaco_str_new(msg));
+        return NULL;
+    }
+
+    uint64_t bits = p->root_bits;
+    uint8_t kind = p->root_kind;
+    json_parser_destroy(p);
+    void* result;
+    memcpy(&result, &bits, sizeof(result));
+    /* Objects, arrays and strings are returned as built. A scalar root is
+     * returned in string form, in its own allocation so it can carry its
+     * kind for JSON.stringify. */
+    switch (kind) {
+        case ZACO_KIND_F64: {
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            ZacoStrBuilder sb = {0};
+            json_put_number(&sb, d);
+            result = str_alloc_private(sb.data, sb.len);
+            free(sb.data);
+            break;
+        }
+        case ZACO_KIND_BOOL:
+            result = str_alloc_private(bits ? "true" : "false", bits ? 4 : 5);
+            break;
+        case ZACO_KIND_NULL:
+            result = str_alloc_private("null", 4);
+            break;
+        default:
+            return result;
+    }
+    zaco_header_set_kind(result, kind);
+    return result;
+}
+
+void* zaco_json_parse(void* json_str) {
+    if (!json_str) return NULL;
+    void* p = zaco_json_parser_new();
+    zaco_json_parser_feed(p, (const char*)json_str, ZACO_STR_LEN(json_str));
+    return zaco_json_parser_finish(p);
+}
+
+/* Free a JSON.parse result and everything it owns. A scalar root is a
+ * string despite the kind in its header. */
+void zaco_json_free(void* value) {
+    if (!value) return;
+    uint8_t kind = zaco_ptr_kind(value);
+    if (kind != ZACO_KIND_OBJECT && kind != ZACO_KIND_ARRAY) kind = ZACO_KIND_STR;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    json_release(bits, kind);
+}
+
+/* JSON.stringify writes into one growable buffer. Values with a static type
+ * use the typed entry points (the lowerer emits a serializer per object
+ * shape that appends precomputed key fragments and calls the
+ * zaco_json_write_* helpers); everything else is walked by kind. */
+
+static void json_put(ZacoStrBuilder* sb, const char* bytes, int64_t len) {
+    strbuf_reserve(sb, len);
+    memcpy(sb->data + sb->len, bytes, (size_t)len);
+    sb->len += len;
+}
+
+static void json_put_string(ZacoStrBuilder* sb, const char* s, int64_t len) {
+    static const char hex[] = "0123456789abcdef";
+    strbuf_reserve(sb, len + 2);
+    sb->data[sb->len++] = '"';
+    int64_t i = 0;
+    while (i < len) {
+        size_t run = json_plain_run(s + i, (size_t)(len - i));
+        if (run) {
+            json_put(sb, s + i, (int64_t)run);
+            i += (int64_t)run;
+            if (i == len) break;
+        }
+        unsigned char c = (unsigned char)s[i++];
+        char esc[6] = {'\\', 0, 0, 0, 0, 0};
+        int n = 2;
+        switch (c) {
+            case '"':  esc[1] = '"';  break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b';  break;
+            case '\f': esc[1] = 'f';  break;
+            case '\n': esc[1] = 'n';  break;
+            case '\r': esc[1] = 'r';  break;
+            case '\t': esc[1] = 't';  break;
+            default:
+                esc[1] = 'u';
+                esc[2] = '0';
+                esc[3] = '0';
+                esc[4] = hex[c >> 4];
+                esc[5] = hex[c & 0xf];
+                n = 6;
+                break;
+        }
+        json_put(sb, esc, n);
+    }
+    strbuf_reserve(sb, 1);
+    sb->data[sb->len++] = '"';
+}
+
+/* Shortest representation that reads back as `d`, in JavaScript's format
+ * (no "+" or leading zeros in exponents); non-finite numbers are null. */
+static void json_put_number(ZacoStrBuilder* sb, double d) {
+    char buf[32];
+    int n;
+    if (!isfinite(d)) {
+        json_put(sb, "null", 4);
+        return;
+    }
+    if (d == floor(d) && fabs(d) < 1e21) {
+        n = snprintf(buf, sizeof(buf), "%.0f", d == 0 ? 0.0 : d);
+    } else {
+        int prec = 15;
+        do {
+            n = snprintf(buf, sizeof(buf), "%.*g", prec, d);
+        } while (strtod(buf, NULL) != d && ++prec <= 17);
+        char* e = strchr(buf, 'e');
+        if (e) {
+            char* src = e + 1;
+            char* dst = e + 1;
+            if (*src == '+') src++;
+            else if (*src == '-') *dst++ = *src++;
+            while (*src == '0' && src[1]) src++;
+            while (*src) *dst++ = *src++;
+            *dst = '\0';
+            n = (int)(dst - buf);
+        }
+    }
+    json_put(sb, buf, n);
+}
+
+static void json_fail_stringify(ZacoStrBuilder* sb, const char* msg) {
+    free(sb->data);
+    sb->data = NULL;
+    sb->len = sb->cap = 0;
+    zaco_throw(zaco_str_new(msg));
+}
+
+static void json_write(ZacoStrBuilder* sb, uint64_t bits, uint8_t kind, int depth);
+
+static void json_write_object(ZacoStrBuilder* sb, ZacoObject* obj, int depth) {
+    strbuf_reserve(sb, 1);
+    sb->data[sb->len++] = '{';
+    for (int64_t i = 0; i < obj->shape->count; i++) {
+        if (i > 0) json_put(sb, ",", 1);
+        const char* key = obj->shape->keys[i];
+        json_put_string(sb, key, (int64_t)strlen(key));
+        json_put(sb, ":", 1);
+        json_write(sb, obj->slots[i], obj->kinds[i], depth + 1);
+    }
+    json_put(sb, "}", 1);
+}
+
+static void json_write_array(ZacoStrBuilder* sb, ZacoArray* arr, int depth) {
+    json_put(sb, "[", 1);
+    for (int64_t i = 0; i < arr->length; i++) {
+        if (i > 0) json_put(sb, ",", 1);
+        uint64_t bits = ((uint64_t*)arr->data)[i];
+        /* Arrays without kinds come from typed code and hold numbers */
+        json_write(sb, bits, arr->kinds ? arr->kinds[i] : ZACO_KIND_F64, depth + 1);
+    }
+    json_put(sb, "]", 1);
+}
+
+static void json_write(ZacoStrBuilder* sb, uint64_t bits, uint8_t kind, int depth) {
+    if (zaco_exception_pending) return;
+    if (depth > ZACO_JSON_MAX_DEPTH) {
+        json_fail_stringify(sb, "TypeError: JSON.stringify: value too deeply nested (cyclic?)");
+        return;
+    }
+    void* ptr;
+    memcpy(&ptr, &bits, sizeof(ptr));
+    if (kind == ZACO_KIND_PTR && ptr) {
+        kind = zaco_ptr_kind(ptr);
+        if (kind == ZACO_KIND_F64 || kind == ZACO_KIND_BOOL || kind == ZACO_KIND_NULL) {
+            /* Scalar JSON.parse root, already in JSON form */
+            json_put(sb, (const char*)ptr, ZACO_STR_LEN(ptr));
+            return;
+        }
+    }
+    switch (kind) {
+        case ZACO_KIND_BOOL:
+            if (bits) json_put(sb, "true", 4);
+            else json_put(sb, "false", 5);
+            return;
+        case ZACO_KIND_I64: {
+            char buf[24];
+            int n = snprintf(buf, sizeof(buf), "%lld", (long long)(int64_t)bits);
+            json_put(sb, buf, n);
+            return;
+        }
+        case ZACO_KIND_F64: {
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            json_put_number(sb, d);
+            return;
+        }
+        case ZACO_KIND_STR:
+            if (ptr) {
+                json_put_string(sb, (const char*)ptr, ZACO_STR_LEN(ptr));
+                return;
+            }
+            break;
+        case ZACO_KIND_OBJECT:
+            if (ptr) {
+                json_write_object(sb, (ZacoObject*)ptr, depth);
+                return;
+            }
+            break;
+        case ZACO_KIND_ARRAY:
+            if (ptr) {
+                json_write_array(sb, (ZacoArray*)ptr, depth);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    json_put(sb, "null", 4);
+}
+
+/* ---- Builder helpers for compiled serializers ---- */
+
+void zaco_json_write_str(void* sb, void* s) {
+    ZacoStrBuilder* b = (ZacoStrBuilder*)sb;
+    if (!s) json_put(b, "null", 4);
+    else json_put_string(b, (const char*)s, ZACO_STR_LEN(s));
 }
 
-/* ========== Timer Functions (setTimeout/setInterval) ========== */
+void zaco_json_write_f64(void* sb, double d) {
+    json_put_number((ZacoStrBuilder*)sb, d);
+}
+
+void zaco_json_write_i64(void* sb, int64_t n) {
+    json_write((ZacoStrBuilder*)sb, (uint64_t)n, ZACO_KIND_I64, 0);
+}
+
+void zaco_json_write_bool(void* sb, int64_t b) {
+    json_write((ZacoStrBuilder*)sb, b ? 1 : 0, ZACO_KIND_BOOL, 0);
+}
+
+/* Write `obj[key]` by the kind recorded for its slot. */
+void zaco_json_write_field(void* sb, void* o, const char* key) {
+    ZacoObject* obj = (ZacoObject*)o;
+    int64_t slot = obj ? shape_lookup_hashed(obj->shape, key, shape_hash(key)) : -1;
+    if (slot < 0) json_put((ZacoStrBuilder*)sb, "null", 4);
+    else json_write((ZacoStrBuilder*)sb, obj->slots[slot], obj->kinds[slot], 1);
+}
+
+/* ---- Entry points ---- */
+
+static void* json_builder_finish(ZacoStrBuilder* sb) {
+    void* result = zaco_str_from_bytes(sb->data ? sb->data : "", sb->len);
+    free(sb->data);
+    return result;
+}
+
+/* Value of unknown static type, written by the kind in its header. */
+void* zaco_json_stringify(void* value) {
+    ZacoStrBuilder sb = {0};
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    json_write(&sb, bits, ZACO_KIND_PTR, 0);
+    return json_builder_finish(&sb);
+}
+
+/* Value statically known to be an array. */
+void* zaco_json_stringify_array(void* arr) {
+    ZacoStrBuilder sb = {0};
+    uint64_t bits;
+    memcpy(&bits, &arr, sizeof(bits));
+    json_write(&sb, bits, ZACO_KIND_ARRAY, 0);
+    return json_builder_finish(&sb);
+}
+
+void* zaco_json_stringify_str(void* s) {
+    ZacoStrBuilder sb = {0};
+    zaco_json_write_str(&sb, s);
+    return json_builder_finish(&sb);
+}
+
+void* zaco_json_stringify_f64(double d) {
+    ZacoStrBuilder sb = {0};
+    json_put_number(&sb, d);
+    return json_builder_finish(&sb);
+}
+
+void* zaco_json_stringify_bool(int64_t b) {
+    return zaco_str_new(b ? "true" : "false");
+}
+
+/* ========== Timer Functions (setTimeout/setInterval) ==========
+ *
+ * All timers live in one hierarchical timing wheel with 1 ms ticks, driven
+ * by the event loop below on the main thread once the top-level code has
+ * finished. Callbacks therefore never run concurrently with JS code.
+ *
+ * Level 0 has 256 buckets of one tick each; levels 1-4 have 64 buckets
+ * covering 2^8, 2^14, 2^20 and 2^26 ticks. A timer goes into the lowest
+ * level whose enclosing block also contains the current tick, so every
+ * bucket holds timers that are all due at the same cascade point. When the
+ * wheel crosses a block boundary the matching bucket of the level above is
+ * redistributed downwards. Timers more than one 2^32-tick block ahead wait
+ * on the overflow list.
+ *
+ * Timers are slots in a growable table, linked into their bucket by index,
+ * so scheduling and cancellation are O(1). Freed slots are reused; the id
+ * handed to JS carries the slot's generation in its upper bits so a stale
+ * clearTimeout cannot cancel the slot's next occupant.
+ */
+
+#define TIMER_L0_BITS 8
+#define TIMER_LN_BITS 6
+#define TIMER_LEVELS 5
+#define TIMER_L0_SIZE (1 << TIMER_L0_BITS)
+#define TIMER_LN_SIZE (1 << TIMER_LN_BITS)
+#define TIMER_OVERFLOW (TIMER_L0_SIZE + (TIMER_LEVELS - 1) * TIMER_LN_SIZE)
+#define TIMER_DUE (TIMER_OVERFLOW + 1)
+#define TIMER_BUCKETS (TIMER_DUE + 1)
+#define TIMER_RUNNING (-1)
+#define TIMER_FREE (-2)
+#define TIMER_MAX_DELAY 2147483647LL
 
 typedef struct {
     void (*callback)(void*);
     void* context;
-    int64_t delay_ms;
-    int is_interval;
-    volatile int cancelled;
-} TimerContext;
-
-#define MAX_TIMERS 1024
-static TimerContext* timer_table[MAX_TIMERS];
-static int64_t next_timer_id = 1;
+    int64_t interval_ms;   /* 0 for setTimeout */
+    uint64_t expires;      /* absolute tick */
+    int32_t prev, next;    /* bucket links; next doubles as the free list */
+    int32_t bucket;        /* TIMER_RUNNING while its callback runs */
+    uint32_t generation;
+    int cancelled;         /* cleared while running; freed when it returns */
+} ZacoTimer;
+
+static ZacoTimer* timers;
+static int32_t timer_cap;
+static int32_t timer_free_head = -1;
+static int64_t timer_live;
+static int32_t timer_head[TIMER_BUCKETS];
+static int32_t timer_tail[TIMER_BUCKETS];
+static uint64_t wheel_now;          /* next tick to process */
+static int64_t wheel_epoch_ms = -1; /* monotonic ms at tick 0 */
 static pthread_mutex_t timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond = PTHREAD_COND_INITIALIZER;
 
-static void* timer_thread_fn(void* arg) {
-    TimerContext* tc = (TimerContext*)arg;
-    do {
-        usleep((useconds_t)(tc->delay_ms * 1000));
-        if (!tc->cancelled) {
-            tc->callback(tc->context);
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Current tick. Never behind the wheel: ticks up to the clock are processed
+ * only once they have passed. */
+static uint64_t wheel_clock(void) {
+    if (wheel_epoch_ms < 0) {
+        for (int i = 0; i < TIMER_BUCKETS; i++) {
+            timer_head[i] = timer_tail[i] = -1;
         }
-    } while (tc->is_interval && !tc->cancelled);
-    return NULL;
+        wheel_epoch_ms = monotonic_ms();
+    }
+    return (uint64_t)(monotonic_ms() - wheel_epoch_ms);
 }
 
-int64_t zaco_set_timeout(void (*callback)(void*), void* context, int64_t delay_ms) {
-    pthread_mutex_lock(&timer_mutex);
-    int64_t id = next_timer_id++;
-    if (id >= MAX_TIMERS) {
-        pthread_mutex_unlock(&timer_mutex);
-        return -1;
-    }
-    TimerContext* tc = (TimerContext*)malloc(sizeof(TimerContext));
-    tc->callback = callback;
-    tc->context = context;
-    tc->delay_ms = delay_ms;
-    tc->is_interval = 0;
-    tc->cancelled = 0;
-    timer_table[id] = tc;
-    pthread_mutex_unlock(&timer_mutex);
+static int wheel_shift(int level) {
+    return level == 0 ? 0 : TIMER_L0_BITS + (level - 1) * TIMER_LN_BITS;
+}
 
-    pthread_t thread;
-    pthread_create(&thread, NULL, timer_thread_fn, tc);
-    pthread_detach(thread);
-    return id;
+static int wheel_bits(int level) {
+    return level == 0 ? TIMER_L0_BITS : TIMER_LN_BITS;
 }
 
-int64_t zaco_set_interval(void (*callback)(void*), void* context, int64_t delay_ms) {
+static int wheel_first_bucket(int level) {
+    return level == 0 ? 0 : TIMER_L0_SIZE + (level - 1) * TIMER_LN_SIZE;
+}
+
+static void timer_link(int32_t idx, int bucket) {
+    ZacoTimer* t = &timers[idx];
+    t->bucket = bucket;
+    t->next = -1;
+    t->prev = timer_tail[bucket];
+    if (t->prev >= 0) {
+        timers[t->prev].next = idx;
+    } else {
+        timer_head[bucket] = idx;
+    }
+    timer_tail[bucket] = idx;
+}
+
+static void timer_unlink(int32_t idx) {
+    ZacoTimer* t = &timers[idx];
+    if (t->prev >= 0) timers[t->prev].next = t->next; else timer_head[t->bucket] = t->next;
+    if (t->next >= 0) timers[t->next].prev = t->prev; else timer_tail[t->bucket] = t->prev;
+    t->bucket = TIMER_RUNNING;
+}
+
+/* File a timer under the lowest level whose block contains both its expiry
+ * and the current tick. */
+static void wheel_insert(int32_t idx) {
+    uint64_t expires = timers[idx].expires;
+    for (int level = 0; level < TIMER_LEVELS; level++) {
+        int shift = wheel_shift(level);
+        int top = shift + wheel_bits(level);
+        if ((expires >> top) == (wheel_now >> top)) {
+            uint64_t slot = (expires >> shift) & (((uint64_t)1 << wheel_bits(level)) - 1);
+            timer_link(idx, wheel_first_bucket(level) + (int)slot);
+            return;
+        }
+    }
+    timer_link(idx, TIMER_OVERFLOW);
+}
+
+/* Move every timer of a bucket back through wheel_insert. */
+static void wheel_cascade(int bucket) {
+    int32_t idx = timer_head[bucket];
+    timer_head[bucket] = timer_tail[bucket] = -1;
+    while (idx >= 0) {
+        int32_t next = timers[idx].next;
+        wheel_insert(idx);
+        idx = next;
+    }
+}
+
+/* Earliest tick at which the wheel has work: a level-0 expiry or the cascade
+ * of a non-empty bucket higher up. Within a level the first occupied slot is
+ * the earliest; UINT64_MAX when nothing is scheduled. */
+static uint64_t wheel_next_event(void) {
+    uint64_t best = UINT64_MAX;
+    for (int level = 0; level < TIMER_LEVELS; level++) {
+        int shift = wheel_shift(level);
+        int top = shift + wheel_bits(level);
+        int size = 1 << wheel_bits(level);
+        int first = wheel_first_bucket(level);
+        for (int slot = (int)((wheel_now >> shift) & (uint64_t)(size - 1)); slot < size; slot++) {
+            if (timer_head[first + slot] >= 0) {
+                uint64_t at = ((wheel_now >> top) << top) | ((uint64_t)slot << shift);
+                if (at < wheel_now) at = wheel_now;
+                if (at < best) best = at;
+                break;
+            }
+        }
+    }
+    if (timer_head[TIMER_OVERFLOW] >= 0) {
+        uint64_t at = ((wheel_now + 0xFFFFFFFFu) >> 32) << 32;
+        if (at < best) best = at;
+    }
+    return best;
+}
+
+/* Process tick wheel_now: redistribute the buckets whose block starts here
+ * (highest level first), then move the due level-0 bucket to TIMER_DUE. */
+static void wheel_process_tick(void) {
+    uint64_t t = wheel_now;
+    if ((t & 0xFFFFFFFFu) == 0) {
+        wheel_cascade(TIMER_OVERFLOW);
+    }
+    for (int level = TIMER_LEVELS - 1; level >= 1; level--) {
+        int shift = wheel_shift(level);
+        if ((t & (((uint64_t)1 << shift) - 1)) == 0) {
+            uint64_t slot = (t >> shift) & (TIMER_LN_SIZE - 1);
+            wheel_cascade(wheel_first_bucket(level) + (int)slot);
+        }
+    }
+    int bucket = (int)(t & (TIMER_L0_SIZE - 1));
+    int32_t idx = timer_head[bucket];
+    timer_head[bucket] = timer_tail[bucket] = -1;
+    while (idx >= 0) {
+        int32_t next = timers[idx].next;
+        timer_link(idx, TIMER_DUE);
+        idx = next;
+    }
+    wheel_now = t + 1;
+}
+
+static void timer_release(int32_t idx) {
+    ZacoTimer* t = &timers[idx];
+    t->bucket = TIMER_FREE;
+    t->generation++;
+    t->next = timer_free_head;
+    timer_free_head = idx;
+    timer_live--;
+}
+
+static int64_t timer_schedule(void (*callback)(void*), void* context, int64_t delay_ms, int is_interval) {
+    /* Match Node: delays outside [1, 2^31-1] become 1 ms. */
+    if (delay_ms < 1 || delay_ms > TIMER_MAX_DELAY) {
+        delay_ms = 1;
+    }
+    ZACO_COUNT(ZACO_COUNT_TIMERS, 1);
     pthread_mutex_lock(&timer_mutex);
-    int64_t id = next_timer_id++;
-    if (id >= MAX_TIMERS) {
-        pthread_mutex_unlock(&timer_mutex);
-        return -1;
-    }
-    TimerContext* tc = (TimerContext*)malloc(sizeof(TimerContext));
-    tc->callback = callback;
-    tc->context = context;
-    tc->delay_ms = delay_ms;
-    tc->is_interval = 1;
-    tc->cancelled = 0;
-    timer_table[id] = tc;
+    uint64_t now = wheel_clock();
+    if (timer_free_head < 0) {
+        int32_t new_cap = timer_cap ? timer_cap * 2 : 64;
+        ZacoTimer* grown = (ZacoTimer*)realloc(timers, (size_t)new_cap * sizeof(ZacoTimer));
+        if (!grown) {
+            pthread_mutex_unlock(&timer_mutex);
+            return -1;
+        }
+        timers = grown;
+        for (int32_t i = new_cap - 1; i >= timer_cap; i--) {
+            timers[i].bucket = TIMER_FREE;
+            timers[i].generation = 0;
+            timers[i].next = timer_free_head;
+            timer_free_head = i;
+        }
+        timer_cap = new_cap;
+    }
+    int32_t idx = timer_free_head;
+    ZacoTimer* t = &timers[idx];
+    timer_free_head = t->next;
+    t->callback = callback;
+    t->context = context;
+    t->interval_ms = is_interval ? delay_ms : 0;
+    t->expires = now + (uint64_t)delay_ms;
+    t->cancelled = 0;
+    wheel_insert(idx);
+    timer_live++;
+    int64_t id = ((int64_t)(t->generation & 0xFFFFF) << 32) | (int64_t)(idx + 1);
+    pthread_cond_signal(&timer_cond);
     pthread_mutex_unlock(&timer_mutex);
-
-    pthread_t thread;
-    pthread_create(&thread, NULL, timer_thread_fn, tc);
-    pthread_detach(thread);
     return id;
 }
 
+int64_t zaco_set_timeout(void (*callback)(void*), void* context, int64_t delay_ms) {
+    return timer_schedule(callback, context, delay_ms, 0);
+}
+
+int64_t zaco_set_interval(void (*callback)(void*), void* context, int64_t delay_ms) {
+    return timer_schedule(callback, context, delay_ms, 1);
+}
+
 void zaco_clear_timeout(int64_t timer_id) {
+    int64_t idx = (timer_id & 0xFFFFFFFF) - 1;
+    uint32_t generation = (uint32_t)(timer_id >> 32);
     pthread_mutex_lock(&timer_mutex);
-    if (timer_id > 0 && timer_id < MAX_TIMERS && timer_table[timer_id]) {
-        timer_table[timer_id]->cancelled = 1;
+    if (timer_id > 0 && idx >= 0 && idx < timer_cap
+        && timers[idx].bucket != TIMER_FREE
+        && (timers[idx].generation & 0xFFFFF) == generation) {
+        if (timers[idx].bucket == TIMER_RUNNING) {
+            timers[idx].cancelled = 1;
+        } else {
+            timer_unlink((int32_t)idx);
+            timer_release((int32_t)idx);
+        }
     }
     pthread_mutex_unlock(&timer_mutex);
 }
@@ -1308,3 +3411,221 @@ void zaco_clear_timeout(int64_t timer_id) {
 void zaco_clear_interval(int64_t timer_id) {
     zaco_clear_timeout(timer_id);
 }
+
+/* ========== Event Loop ==========
+ *
+ * One loop runs every JS callback on the JS (main) thread: timers from the
+ * wheel above, tasks posted by other threads, and microtasks.
+ *
+ * - Tasks: zaco_loop_post() may be called from any thread, typically a Tokio
+ *   worker handing over an I/O completion. Tasks go through an intrusive
+ *   lock-free MPSC queue (one atomic exchange per push); the loop is only
+ *   signalled when it is actually asleep.
+ * - Pending operations: an async operation calls zaco_loop_ref() when it
+ *   starts and zaco_loop_unref() once its completion has run, which keeps
+ *   the loop alive while nothing is queued yet.
+ * - Microtasks (promise reactions) are queued from the JS thread only and
+ *   drained after the top-level code and after every task or timer.
+ */
+
+typedef struct ZacoTask {
+    void (*fn)(void*);
+    void* ctx;
+    struct ZacoTask* next;
+} ZacoTask;
+
+static ZacoTask loop_stub;
+static ZacoTask* loop_head = &loop_stub;  /* producers swap in here */
+static ZacoTask* loop_tail = &loop_stub;  /* JS thread pops from here */
+static int64_t loop_queued;
+static int64_t loop_pending;
+static int loop_sleeping;
+static int loop_has_js_thread;
+static pthread_t loop_js_thread;
+
+typedef struct {
+    void (*fn)(void*);
+    void* ctx;
+} ZacoMicrotask;
+
+static ZacoMicrotask* microtasks;
+static int64_t microtask_head, microtask_len, microtask_cap;
+
+void zaco_event_loop_init(void) {
+    loop_js_thread = pthread_self();
+    loop_has_js_thread = 1;
+}
+
+int64_t zaco_loop_is_js_thread(void) {
+    return !loop_has_js_thread || pthread_equal(loop_js_thread, pthread_self());
+}
+
+static void loop_push(ZacoTask* task) {
+    __atomic_store_n(&task->next, NULL, __ATOMIC_RELAXED);
+    ZacoTask* prev = __atomic_exchange_n(&loop_head, task, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, task, __ATOMIC_RELEASE);
+}
+
+/* Single consumer. Returns NULL when empty, or while a producer is between
+ * its exchange and its link (loop_queued then stays non-zero and the caller
+ * simply retries). */
+static ZacoTask* loop_pop(void) {
+    ZacoTask* tail = loop_tail;
+    ZacoTask* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (tail == &loop_stub) {
+        if (!next) return NULL;
+        loop_tail = tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+    if (next) {
+        loop_tail = next;
+        return tail;
+    }
+    if (tail != __atomic_load_n(&loop_head, __ATOMIC_ACQUIRE)) return NULL;
+    loop_push(&loop_stub);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next) {
+        loop_tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/* Queue fn(ctx) to run on the JS thread. Safe from any thread. */
+void zaco_loop_post(void (*fn)(void*), void* ctx) {
+    ZacoTask* task = (ZacoTask*)malloc(sizeof(ZacoTask));
+    task->fn = fn;
+    task->ctx = ctx;
+    loop_push(task);
+    __atomic_fetch_add(&loop_queued, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&loop_sleeping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&timer_mutex);
+        pthread_cond_signal(&timer_cond);
+        pthread_mutex_unlock(&timer_mutex);
+    }
+}
+
+void zaco_loop_ref(void) {
+    __atomic_fetch_add(&loop_pending, 1, __ATOMIC_SEQ_CST);
+}
+
+void zaco_loop_unref(void) {
+    __atomic_fetch_sub(&loop_pending, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Queue fn(ctx) as a microtask. JS thread only. */
+void zaco_queue_microtask(void (*fn)(void*), void* ctx) {
+    if (microtask_len == microtask_cap) {
+        int64_t new_cap = microtask_cap ? microtask_cap * 2 : 64;
+        ZacoMicrotask* grown = (ZacoMicrotask*)malloc((size_t)new_cap * sizeof(ZacoMicrotask));
+        for (int64_t i = 0; i < microtask_len; i++) {
+            grown[i] = microtasks[(microtask_head + i) % microtask_cap];
+        }
+        free(microtasks);
+        microtasks = grown;
+        microtask_head = 0;
+        microtask_cap = new_cap;
+    }
+    microtasks[(microtask_head + microtask_len) % microtask_cap] = (ZacoMicrotask){ fn, ctx };
+    microtask_len++;
+}
+
+/* Run microtasks until the queue is empty, including ones queued meanwhile. */
+void zaco_run_microtasks(void) {
+    while (microtask_len > 0) {
+        ZacoMicrotask task = microtasks[microtask_head];
+        microtask_head = (microtask_head + 1) % microtask_cap;
+        microtask_len--;
+        ZACO_COUNT(ZACO_COUNT_MICROTASKS, 1);
+        task.fn(task.ctx);
+        zaco_check_uncaught();
+    }
+}
+
+static int loop_alive(void) {
+    return timer_live > 0
+        || __atomic_load_n(&loop_queued, __ATOMIC_SEQ_CST) > 0
+        || __atomic_load_n(&loop_pending, __ATOMIC_SEQ_CST) > 0;
+}
+
+/* Run the loop until done(ctx) returns non-zero, or, with done == NULL, until
+ * there is nothing left to wait for. Used for a blocking await, where the
+ * awaited promise settles from a callback run here. */
+void zaco_event_loop_run_until(int64_t (*done)(void*), void* ctx) {
+    zaco_run_microtasks();
+    pthread_mutex_lock(&timer_mutex);
+    wheel_clock();
+    while (!(done && done(ctx)) && loop_alive()) {
+        ZacoTask* task = loop_pop();
+        if (task) {
+            __atomic_fetch_sub(&loop_queued, 1, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&timer_mutex);
+            ZACO_COUNT(ZACO_COUNT_TASKS, 1);
+            task->fn(task->ctx);
+            zaco_check_uncaught();
+            free(task);
+            zaco_run_microtasks();
+            pthread_mutex_lock(&timer_mutex);
+            continue;
+        }
+
+        if (timer_head[TIMER_DUE] >= 0) {
+            int32_t idx = timer_head[TIMER_DUE];
+            timer_unlink(idx);
+            void (*callback)(void*) = timers[idx].callback;
+            void* context = timers[idx].context;
+            pthread_mutex_unlock(&timer_mutex);
+            ZACO_COUNT(ZACO_COUNT_TIMER_FIRES, 1);
+            callback(context);
+            zaco_check_uncaught();
+            zaco_run_microtasks();
+            pthread_mutex_lock(&timer_mutex);
+            /* The table may have grown during the callback. */
+            ZacoTimer* t = &timers[idx];
+            if (t->interval_ms > 0 && !t->cancelled) {
+                t->expires = wheel_clock() + (uint64_t)t->interval_ms;
+                wheel_insert(idx);
+            } else {
+                timer_release(idx);
+            }
+            continue;
+        }
+
+        uint64_t now = wheel_clock();
+        uint64_t next = wheel_next_event();
+        if (next <= now) {
+            wheel_now = next;
+            wheel_process_tick();
+            continue;
+        }
+        /* Nothing due before `next`: skip the idle ticks and sleep until
+         * then or until another thread posts a task. Output produced so
+         * far is written out before the loop goes idle. */
+        zaco_console_flush();
+        wheel_now = now + 1;
+        __atomic_store_n(&loop_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&loop_queued, __ATOMIC_SEQ_CST) == 0) {
+            if (next == UINT64_MAX) {
+                pthread_cond_wait(&timer_cond, &timer_mutex);
+            } else {
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                int64_t wait_ms = (int64_t)(next - now);
+                deadline.tv_sec += wait_ms / 1000;
+                deadline.tv_nsec += (wait_ms % 1000) * 1000000;
+                if (deadline.tv_nsec >= 1000000000) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000;
+                }
+                pthread_cond_timedwait(&timer_cond, &timer_mutex, &deadline);
+            }
+        }
+        __atomic_store_n(&loop_sleeping, 0, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&timer_mutex);
+}
+
+/* Drain the loop. Called by main after the top-level code. */
+void zaco_event_loop_run(void) {
+    zaco_event_loop_run_until(NULL, NULL);
+}
@@ -1,21 +1,40 @@
+//! Bridge between Tokio and the JS event loop in the C runtime.
+//!
+//! Tokio only does the I/O. Every JS-visible callback — timers, fs/http
+//! completions, cross-thread event emits, promise reactions — runs on the
+//! JS thread inside `zaco_event_loop_run` (zaco_runtime.c). Worker threads
+//! hand results over with `post_to_js`, which goes through the loop's
+//! lock-free MPSC queue.
+
+use std::os::raw::c_void;
 use std::sync::OnceLock;
 use tokio::runtime::Runtime;
 
 static RUNTIME: OnceLock<Runtime> = OnceLock::new();
 
+extern "C" {
+    fn zaco_event_loop_init();
+    fn zaco_event_loop_run_until(done: extern "C" fn(*mut c_void) -> i64, ctx: *mut c_void);
+    fn zaco_loop_post(task: extern "C" fn(*mut c_void), ctx: *mut c_void);
+    fn zaco_loop_ref();
+    fn zaco_loop_unref();
+    fn zaco_loop_is_js_thread() -> i64;
+    fn zaco_queue_microtask(task: extern "C" fn(*mut c_void), ctx: *mut c_void);
+}
+
 pub fn init_runtime() {
     RUNTIME.get_or_init(|| {
         Runtime::new().expect("Failed to create Tokio runtime")
     });
+    unsafe { zaco_event_loop_init() };
 }
 
 pub fn shutdown_runtime() {
     // OnceLock does not give ownership, so we cannot call shutdown_timeout/shutdown_background.
-    // Instead, block on an empty future to flush any pending spawned tasks, then the
-    // runtime will be cleaned up when the process exits.
+    // main has already drained the JS event loop, so every operation that
+    // posts back to it has completed; the runtime is cleaned up at exit.
     if let Some(rt) = RUNTIME.get() {
         rt.block_on(async {
-            // Yield to let pending tasks make progress
             tokio::task::yield_now().await;
         });
     }
@@ -38,3 +57,52 @@ where
 {
     get_runtime().spawn(f)
 }
+
+extern "C" fn run_boxed<F: FnOnce()>(ctx: *mut c_void) {
+    let task = unsafe { Box::from_raw(ctx as *mut F) };
+    task();
+}
+
+/// Run `task` on the JS thread. Callable from any thread.
+pub fn post_to_js<F: FnOnce() + Send + 'static>(task: F) {
+    let ctx = Box::into_raw(Box::new(task)) as *mut c_void;
+    unsafe { zaco_loop_post(run_boxed::<F>, ctx) };
+}
+
+/// Queue `task` as a microtask. JS thread only.
+pub fn queue_microtask<F: FnOnce() + 'static>(task: F) {
+    let ctx = Box::into_raw(Box::new(task)) as *mut c_void;
+    unsafe { zaco_queue_microtask(run_boxed::<F>, ctx) };
+}
+
+/// True on the thread that runs JS callbacks.
+pub fn is_js_thread() -> bool {
+    unsafe { zaco_loop_is_js_thread() != 0 }
+}
+
+/// Run `fut` on Tokio and hand its output to `complete` on the JS thread.
+/// The pending operation keeps the event loop alive until `complete` ran.
+pub fn spawn_io<Fut, T, C>(fut: Fut, complete: C)
+where
+    Fut: std::future::Future<Output = T> + Send + 'static,
+    T: Send + 'static,
+    C: FnOnce(T) + Send + 'static,
+{
+    unsafe { zaco_loop_ref() };
+    spawn(async move {
+        let output = fut.await;
+        post_to_js(move || {
+            complete(output);
+            unsafe { zaco_loop_unref() };
+        });
+    });
+}
+
+/// Run the JS event loop until `done()` holds or nothing is left to wait for.
+pub fn run_until<F: FnMut() -> bool>(mut done: F) {
+    extern "C" fn check<F: FnMut() -> bool>(ctx: *mut c_void) -> i64 {
+        let done = unsafe { &mut *(ctx as *mut F) };
+        done() as i64
+    }
+    unsafe { zaco_event_loop_run_until(check::<F>, &mut done as *mut F as *mut c_void) };
+}
@@ -1,14 +1,32 @@
 //! EventEmitter implementation (Node.js compatible)
 //! Provides a simple pub/sub event system
-
+//!
+//! Event names are interned into numeric ids. Each emitter publishes an
+//! immutable snapshot of its listeners and bumps a version counter whenever
+//! it replaces the snapshot. The JS thread, where every emit runs, caches
+//! the snapshot of each emitter it has used and only re-reads it when the
+//! version changed, so a steady-state emit takes no lock and allocates
+//! nothing. Registration and removal copy the affected listener list.
+
+use std::cell::RefCell;
 use std::collections::HashMap;
+use std::hash::{BuildHasherDefault, Hasher};
 use std::os::raw::{c_char, c_void};
+use std::sync::atomic::{AtomicI64, AtomicU64, Ordering};
 use std::sync::{Arc, Mutex};
-use std::sync::atomic::{AtomicI64, Ordering};
+
+extern "C" {
+    /// Set by `zaco_throw` (zaco_runtime.c)
+    static zaco_exception_pending: i64;
+}
 
 /// Callback function type — fix #6: receives event data pointer
 type Callback = extern "C" fn(*mut c_void, *mut c_void);
 
+/// Interned event name
+#[derive(Clone, Copy, PartialEq, Eq, Hash)]
+struct EventId(u32);
+
 /// Listener entry
 #[derive(Clone)]
 struct Listener {
@@ -17,83 +35,157 @@ struct Listener {
     once: bool,
 }
 
+/// Listeners of one event, in registration order
+struct EventListeners {
+    event: EventId,
+    listeners: Arc<[Listener]>,
+    has_once: bool,
+}
+
+/// Immutable listener table of an emitter
+#[derive(Default)]
+struct Snapshot {
+    events: Vec<EventListeners>,
+}
+
+impl Snapshot {
+    fn get(&self, event: EventId) -> Option<&EventListeners> {
+        self.events.iter().find(|e| e.event == event)
+    }
+
+    /// Copy of this table with `event`'s listeners replaced by `listeners`.
+    fn with(&self, event: EventId, listeners: Vec<Listener>) -> Snapshot {
+        let mut events: Vec<EventListeners> = self
+            .events
+            .iter()
+            .filter(|e| e.event != event)
+            .map(|e| EventListeners { event: e.event, listeners: e.listeners.clone(), has_once: e.has_once })
+            .collect();
+        if !listeners.is_empty() {
+            let has_once = listeners.iter().any(|l| l.once);
+            events.push(EventListeners { event, listeners: listeners.into(), has_once });
+        }
+        Snapshot { events }
+    }
+}
+
 /// EventEmitter structure
 struct EventEmitter {
-    listeners: HashMap<String, Vec<Listener>>,
+    /// Bumped after every change of `snapshot`
+    version: AtomicU64,
+    snapshot: Mutex<Arc<Snapshot>>,
 }
 
 impl EventEmitter {
     fn new() -> Self {
         Self {
-            listeners: HashMap::new(),
+            version: AtomicU64::new(0),
+            snapshot: Mutex::new(Arc::new(Snapshot::default())),
         }
     }
 
-    fn on(&mut self, event: &str, callback: Callback, context: *mut c_void) {
-        let listener = Listener {
-            callback,
-            context: context as usize,
-            once: false,
-        };
-        self.listeners
-            .entry(event.to_string())
-            .or_insert_with(Vec::new)
-            .push(listener);
+    fn current(&self) -> Arc<Snapshot> {
+        self.snapshot.lock().unwrap().clone()
     }
 
-    fn once(&mut self, event: &str, callback: Callback, context: *mut c_void) {
+    /// Replace the listeners of `event` with `update(current listeners)`.
+    fn update(&self, event: EventId, update: impl FnOnce(&mut Vec<Listener>) -> bool) -> bool {
+        let mut snapshot = self.snapshot.lock().unwrap();
+        let mut listeners = snapshot.get(event).map(|e| e.listeners.to_vec()).unwrap_or_default();
+        let changed = update(&mut listeners);
+        if changed {
+            *snapshot = Arc::new(snapshot.with(event, listeners));
+            self.version.fetch_add(1, Ordering::Release);
+        }
+        changed
+    }
+
+    fn add(&self, event: EventId, callback: Callback, context: *mut c_void, once: bool) {
         let listener = Listener {
             callback,
             context: context as usize,
-            once: true,
+            once,
         };
-        self.listeners
-            .entry(event.to_string())
-            .or_insert_with(Vec::new)
-            .push(listener);
+        self.update(event, |listeners| {
+            listeners.push(listener);
+            true
+        });
     }
 
-    /// Collect listeners for emission — returns cloned list and removes once listeners
-    fn take_listeners_for_emit(&mut self, event: &str) -> Vec<Listener> {
-        let listeners = match self.listeners.get_mut(event) {
-            Some(l) => l,
-            None => return Vec::new(),
-        };
-
-        let snapshot: Vec<Listener> = listeners.clone();
-
-        // Remove once listeners
-        listeners.retain(|l| !l.once);
-
-        snapshot
+    /// Listeners to run for an emit of `event`; once listeners are removed
+    /// before any of them runs.
+    fn listeners_for_emit(&self, event: EventId) -> Option<Arc<[Listener]>> {
+        let mut snapshot = self.snapshot.lock().unwrap();
+        let entry = snapshot.get(event)?;
+        let listeners = entry.listeners.clone();
+        if entry.has_once {
+            let remaining = listeners.iter().filter(|l| !l.once).cloned().collect();
+            *snapshot = Arc::new(snapshot.with(event, remaining));
+            self.version.fetch_add(1, Ordering::Release);
+        }
+        Some(listeners)
     }
 
-    fn remove_all(&mut self, event: &str) {
-        self.listeners.remove(event);
+    fn remove_all(&self, event: EventId) {
+        self.update(event, |listeners| {
+            let had_any = !listeners.is_empty();
+            listeners.clear();
+            had_any
+        });
     }
 
-    fn listener_count(&self, event: &str) -> i64 {
-        self.listeners
-            .get(event)
-            .map(|l| l.len() as i64)
-            .unwrap_or(0)
+    fn listener_count(&self, event: EventId) -> i64 {
+        self.current().get(event).map(|e| e.listeners.len() as i64).unwrap_or(0)
     }
 
-    fn remove_listener(&mut self, event: &str, callback: Callback) -> bool {
-        if let Some(listeners) = self.listeners.get_mut(event) {
-            if let Some(pos) = listeners.iter().position(|l| {
-                l.callback as usize == callback as usize
-            }) {
-                listeners.remove(pos);
-                return true;
+    fn remove_listener(&self, event: EventId, callback: Callback) -> bool {
+        self.update(event, |listeners| {
+            match listeners.iter().position(|l| l.callback as usize == callback as usize) {
+                Some(pos) => {
+                    listeners.remove(pos);
+                    true
+                }
+                None => false,
             }
-        }
-        false
+        })
     }
 }
 
+/// Event name table shared by all emitters
+#[derive(Default)]
+struct Interner {
+    ids: HashMap<Box<str>, EventId>,
+    names: Vec<Box<str>>,
+}
+
+static INTERNER: Mutex<Option<Interner>> = Mutex::new(None);
+
+/// Id of `name`, interning it on first use
+fn intern(name: &str) -> EventId {
+    let mut interner = INTERNER.lock().unwrap();
+    let interner = interner.get_or_insert_with(Interner::default);
+    if let Some(&id) = interner.ids.get(name) {
+        return id;
+    }
+    let id = EventId(interner.names.len() as u32);
+    interner.names.push(name.into());
+    interner.ids.insert(name.into(), id);
+    id
+}
+
+/// Id of an already interned `name`, if any
+fn lookup(name: &str) -> Option<EventId> {
+    let interner = INTERNER.lock().unwrap();
+    interner.as_ref().and_then(|i| i.ids.get(name).copied())
+}
+
+fn event_name(id: EventId) -> String {
+    let interner = INTERNER.lock().unwrap();
+    interner.as_ref().map(|i| i.names[id.0 as usize].to_string()).unwrap_or_default()
+}
+
 /// Global registry of EventEmitters
-static EMITTERS: Mutex<Option<HashMap<i64, Arc<Mutex<EventEmitter>>>>> = Mutex::new(None);
+static EMITTERS: Mutex<Option<HashMap<i64, Arc<EventEmitter>>>> = Mutex::new(None);
 static NEXT_HANDLE: AtomicI64 = AtomicI64::new(1);
 
 /// Initialize the global emitter registry
@@ -104,13 +196,104 @@ fn ensure_registry() {
     }
 }
 
+fn find_emitter(handle: i64) -> Option<Arc<EventEmitter>> {
+    let registry = EMITTERS.lock().unwrap();
+    registry.as_ref().and_then(|map| map.get(&handle).cloned())
+}
+
+/// The JS thread's view of an emitter
+struct View {
+    emitter: Arc<EventEmitter>,
+    version: u64,
+    snapshot: Arc<Snapshot>,
+}
+
+/// FNV-1a for the JS-thread caches. Their keys are short event names and
+/// handles, for which SipHash would dominate the cost of an emit.
+struct FastHasher(u64);
+
+impl Default for FastHasher {
+    fn default() -> Self {
+        FastHasher(0xcbf2_9ce4_8422_2325)
+    }
+}
+
+impl Hasher for FastHasher {
+    fn finish(&self) -> u64 {
+        self.0
+    }
+
+    fn write(&mut self, bytes: &[u8]) {
+        for &byte in bytes {
+            self.0 = (self.0 ^ byte as u64).wrapping_mul(0x0100_0000_01b3);
+        }
+    }
+
+    fn write_i64(&mut self, n: i64) {
+        self.0 = (self.0 ^ n as u64).wrapping_mul(0x9e37_79b9_7f4a_7c15);
+    }
+}
+
+type FastMap<K, V> = HashMap<K, V, BuildHasherDefault<FastHasher>>;
+
+/// JS-thread state read by emit without locking: emitter views and the
+/// event names already resolved to ids.
+#[derive(Default)]
+struct JsCache {
+    views: FastMap<i64, View>,
+    ids: FastMap<Box<str>, EventId>,
+}
+
+thread_local! {
+    static JS_CACHE: RefCell<JsCache> = RefCell::new(JsCache::default());
+}
+
+/// Listeners of `event` on `handle` as seen by the JS thread.
+fn js_listeners(handle: i64, event: &str) -> Option<Arc<[Listener]>> {
+    JS_CACHE.with(|cache| {
+        let mut cache = cache.borrow_mut();
+        let cache = &mut *cache;
+
+        let id = match cache.ids.get(event) {
+            Some(&id) => id,
+            None => {
+                // Not registered anywhere yet; cache only names that exist
+                let id = lookup(event)?;
+                cache.ids.insert(event.into(), id);
+                id
+            }
+        };
+
+        if !cache.views.contains_key(&handle) {
+            let emitter = find_emitter(handle)?;
+            let version = emitter.version.load(Ordering::Acquire);
+            let snapshot = emitter.current();
+            cache.views.insert(handle, View { emitter, version, snapshot });
+        }
+        let view = cache.views.get_mut(&handle)?;
+
+        let version = view.emitter.version.load(Ordering::Acquire);
+        if version != view.version {
+            view.version = version;
+            view.snapshot = view.emitter.current();
+        }
+
+        let entry = view.snapshot.get(id)?;
+        if entry.has_once {
+            // Removing the once listeners changes the snapshot
+            return view.emitter.listeners_for_emit(id);
+        }
+        Some(entry.listeners.clone())
+    })
+}
+
 /// Create a new EventEmitter
 #[no_mangle]
 pub extern "C" fn zaco_events_new() -> i64 {
     ensure_registry();
 
     let handle = NEXT_HANDLE.fetch_add(1, Ordering::SeqCst);
-    let emitter = Arc::new(Mutex::new(EventEmitter::new()));
+    let emitter = Arc::new(EventEmitter::new());
 
     let mut registry = EMITTERS.lock().unwrap();
     if let Some(ref mut map) = *registry {
@@ -130,12 +313,8 @@ pub extern "C" fn zaco_events_on(
 ) {
     let event_str = unsafe { crate::cstr_to_str(event) };
 
-    let registry = EMITTERS.lock().unwrap();
-    if let Some(ref map) = *registry {
-        if let Some(emitter) = map.get(&emitter) {
-            let mut em = emitter.lock().unwrap();
-            em.on(event_str, callback, context);
-        }
+    if let Some(emitter) = find_emitter(emitter) {
+        emitter.add(intern(event_str), callback, context, false);
     }
 }
 
@@ -149,17 +328,18 @@ pub extern "C" fn zaco_events_once(
 ) {
     let event_str = unsafe { crate::cstr_to_str(event) };
 
-    let registry = EMITTERS.lock().unwrap();
-    if let Some(ref map) = *registry {
-        if let Some(emitter) = map.get(&emitter) {
-            let mut em = emitter.lock().unwrap();
-            em.once(event_str, callback, context);
-        }
+    if let Some(emitter) = find_emitter(emitter) {
+        emitter.add(intern(event_str), callback, context, true);
     }
 }
 
-/// Emit an event — fix #4: clone listeners, drop lock, THEN invoke callbacks to prevent deadlock
+/// Emit an event. Listeners run on a snapshot of the listener list, so
+/// callbacks can safely call the events API.
 /// Fix #6: pass data to callbacks
+///
+/// On the JS thread listeners run synchronously, as in Node. An emit from any
+/// other thread is posted to the event loop and returns the current listener
+/// count.
 #[no_mangle]
 pub extern "C" fn zaco_events_emit(
     emitter: i64,
@@ -168,34 +348,31 @@ pub extern "C" fn zaco_events_emit(
 ) -> i64 {
     let event_str = unsafe { crate::cstr_to_str(event) };
 
-    // Clone the emitter Arc while holding registry lock, then drop registry lock
-    let emitter_arc = {
-        let registry = EMITTERS.lock().unwrap();
-        match *registry {
-            Some(ref map) => map.get(&emitter).cloned(),
-            None => None,
-        }
-    };
+    if !crate::event_loop::is_js_thread() {
+        let event_owned = format!("{}\0", event_str);
+        let data_addr = data as usize;
+        let count = zaco_events_listener_count(emitter, event);
+        crate::event_loop::post_to_js(move || {
+            zaco_events_emit(emitter, event_owned.as_ptr() as *const c_char, data_addr as *mut c_void);
+        });
+        return count;
+    }
 
-    let emitter_arc = match emitter_arc {
-        Some(e) => e,
+    let listeners = match js_listeners(emitter, event_str) {
+        Some(l) => l,
         None => return 0,
     };
 
-    // Take snapshot of listeners (and remove once listeners) while holding emitter lock
-    let listeners = {
-        let mut em = emitter_arc.lock().unwrap();
-        em.take_listeners_for_emit(event_str)
-    };
-    // Emitter lock is now dropped — callbacks can safely call events API
-
-    let mut count = 0i64;
-    for listener in &listeners {
+    for listener in listeners.iter() {
         (listener.callback)(listener.context as *mut c_void, data);
-        count += 1;
+        // A throwing listener ends the emit, as in Node; the exception is
+        // left pending for the caller
+        if unsafe { std::ptr::read_volatile(std::ptr::addr_of!(zaco_exception_pending)) } != 0 {
+            break;
+        }
     }
 
-    count
+    listeners.len() as i64
 }
 
 /// Remove all listeners for an event
@@ -203,12 +380,8 @@ pub extern "C" fn zaco_events_emit(
 pub extern "C" fn zaco_events_remove_all(emitter: i64, event: *const c_char) {
     let event_str = unsafe { crate::cstr_to_str(event) };
 
-    let registry = EMITTERS.lock().unwrap();
-    if let Some(ref map) = *registry {
-        if let Some(emitter) = map.get(&emitter) {
-            let mut em = emitter.lock().unwrap();
-            em.remove_all(event_str);
-        }
+    if let (Some(emitter), Some(id)) = (find_emitter(emitter), lookup(event_str)) {
+        emitter.remove_all(id);
     }
 }
 
@@ -217,14 +390,10 @@ pub extern "C" fn zaco_events_remove_all(emitter: i64, event: *const c_char) {
 pub extern "C" fn zaco_events_listener_count(emitter: i64, event: *const c_char) -> i64 {
     let event_str = unsafe { crate::cstr_to_str(event) };
 
-    let registry = EMITTERS.lock().unwrap();
-    if let Some(ref map) = *registry {
-        if let Some(emitter) = map.get(&emitter) {
-            let em = emitter.lock().unwrap();
-            return em.listener_count(event_str);
-        }
+    match (find_emitter(emitter), lookup(event_str)) {
+        (Some(emitter), Some(id)) => emitter.listener_count(id),
+        _ => 0,
     }
-    0
 }
 
 /// Remove a specific listener
@@ -236,27 +405,19 @@ pub extern "C" fn zaco_events_remove_listener(
 ) -> i64 {
     let event_str = unsafe { crate::cstr_to_str(event) };
 
-    let registry = EMITTERS.lock().unwrap();
-    if let Some(ref map) = *registry {
-        if let Some(emitter) = map.get(&emitter) {
-            let mut em = emitter.lock().unwrap();
-            return if em.remove_listener(event_str, callback) { 1 } else { 0 };
-        }
+    match (find_emitter(emitter), lookup(event_str)) {
+        (Some(emitter), Some(id)) => emitter.remove_listener(id, callback) as i64,
+        _ => 0,
     }
-    0
 }
 
-/// Get all event names
+/// Get the names of events that have listeners
 #[no_mangle]
 pub extern "C" fn zaco_events_event_names(emitter: i64) -> *mut c_char {
-    let registry = EMITTERS.lock().unwrap();
-    if let Some(ref map) = *registry {
-        if let Some(emitter) = map.get(&emitter) {
-            let em = emitter.lock().unwrap();
-            let names: Vec<String> = em.listeners.keys().cloned().collect();
-            let joined = names.join("\n");
-            return crate::zaco_compatible_str_new(&joined);
-        }
+    if let Some(emitter) = find_emitter(emitter) {
+        let names: Vec<String> = emitter.current().events.iter().map(|e| event_name(e.event)).collect();
+        let joined = names.join("\n");
+        return crate::zaco_compatible_str_new(&joined);
     }
     std::ptr::null_mut()
 }
@@ -264,8 +425,17 @@ pub extern "C" fn zaco_events_event_names(emitter: i64) -> *mut c_char {
 /// Destroy an EventEmitter
 #[no_mangle]
 pub extern "C" fn zaco_events_destroy(emitter: i64) {
-    let mut registry = EMITTERS.lock().unwrap();
-    if let Some(ref mut map) = *registry {
-        map.remove(&emitter);
+    let removed = {
+        let mut registry = EMITTERS.lock().unwrap();
+        registry.as_mut().and_then(|map| map.remove(&emitter))
+    };
+    let Some(removed) = removed else { return };
+    // A view cached by the JS thread sees the emitter empty from now on
+    *removed.snapshot.lock().unwrap() = Arc::new(Snapshot::default());
+    removed.version.fetch_add(1, Ordering::Release);
+    if crate::event_loop::is_js_thread() {
+        JS_CACHE.with(|cache| {
+            cache.borrow_mut().views.remove(&emitter);
+        });
     }
 }
@@ -1,14 +1,77 @@
 use std::os::raw::c_char;
 use std::ffi::CStr;
-use std::fs;
+use std::fs::{self, File, OpenOptions};
+use std::io::{self, BufWriter, Read, Write};
+use std::collections::HashMap;
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicI64, Ordering};
+
+extern "C" {
+    fn zaco_alloc(size: i64) -> *mut std::os::raw::c_void;
+    fn zaco_free(ptr: *mut std::os::raw::c_void);
+}
+
+/// Read a whole file straight into a runtime string. For a regular file the
+/// bytes are copied once, from the kernel into the string's own allocation,
+/// with no intermediate buffer. Anything past the size reported at open
+/// (files that grew, or pipes and `/proc` files that report size 0) is read
+/// to EOF into a growable buffer and the string is reallocated to fit. The
+/// allocator is thread-safe, so this also runs on Tokio's blocking pool.
+fn read_to_runtime_str(path: &str) -> io::Result<*mut c_char> {
+    let mut file = File::open(path)?;
+    let len = file.metadata()?.len() as usize;
+    unsafe {
+        // zaco_alloc zero-fills, so the string is terminated wherever the
+        // read stops, even if the file shrank in the meantime
+        let mut data = zaco_alloc(len as i64 + 1) as *mut u8;
+        let buf = std::slice::from_raw_parts_mut(data, len);
+        let mut filled = 0;
+        let mut at_eof = false;
+        while filled < len {
+            match file.read(&mut buf[filled..]) {
+                Ok(0) => {
+                    at_eof = true;
+                    break;
+                }
+                Ok(n) => filled += n,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                Err(e) => {
+                    zaco_free(data as *mut _);
+                    return Err(e);
+                }
+            }
+        }
+        if !at_eof {
+            let mut rest = Vec::new();
+            if let Err(e) = file.read_to_end(&mut rest) {
+                zaco_free(data as *mut _);
+                return Err(e);
+            }
+            if !rest.is_empty() {
+                let total = filled + rest.len();
+                let grown = zaco_alloc(total as i64 + 1) as *mut u8;
+                std::ptr::copy_nonoverlapping(data, grown, filled);
+                std::ptr::copy_nonoverlapping(rest.as_ptr(), grown.add(filled), rest.len());
+                zaco_free(data as *mut _);
+                data = grown;
+                filled = total;
+            }
+        }
+        if std::str::from_utf8(std::slice::from_raw_parts(data, filled)).is_err() {
+            zaco_free(data as *mut _);
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "stream did not contain valid UTF-8"));
+        }
+        Ok(data as *mut c_char)
+    }
+}
 
 // === Sync API ===
 
 #[no_mangle]
 pub extern "C" fn zaco_fs_read_file_sync(path: *const c_char, _encoding: *const c_char) -> *mut c_char {
     let path_str = unsafe { crate::cstr_to_str(path) };
-    match fs::read_to_string(path_str) {
-        Ok(content) => crate::zaco_compatible_str_new(&content),
+    match read_to_runtime_str(path_str) {
+        Ok(content) => content,
         Err(e) => {
             eprintln!("Error reading file '{}': {}", path_str, e);
             std::ptr::null_mut()
@@ -115,7 +178,8 @@ pub extern "C" fn zaco_fs_readdir_sync(path: *const c_char) -> *mut c_char {
 
 // === Async API (callback-based) ===
 
-/// Async readFile: reads file on a background thread, then calls callback(err, data).
+/// Async readFile: reads the file on Tokio's blocking pool, then calls
+/// callback(err, data) on the JS thread.
 /// callback signature: extern "C" fn(err: *const c_char, data: *const c_char)
 #[no_mangle]
 pub extern "C" fn zaco_fs_read_file(
@@ -131,17 +195,170 @@ pub extern "C" fn zaco_fs_read_file(
         }
     };
 
-    std::thread::spawn(move || {
-        match fs::read_to_string(&path_string) {
-            Ok(content) => {
-                let data_ptr = crate::zaco_compatible_str_new(&content);
-                callback(std::ptr::null(), data_ptr);
+    crate::event_loop::spawn_io(
+        async move {
+            // Raw pointers are not Send; the string is only touched again on the JS thread
+            let (path_string, result) = tokio::task::spawn_blocking(move || {
+                let result = read_to_runtime_str(&path_string).map(|ptr| ptr as usize);
+                (path_string, result)
+            })
+            .await
+            .expect("readFile worker panicked");
+            (path_string, result)
+        },
+        move |(path_string, result)| match result {
+            Ok(data) => {
+                callback(std::ptr::null(), data as *const c_char);
             }
             Err(e) => {
                 let err_msg = format!("Error reading '{}': {}", path_string, e);
                 let err_ptr = crate::zaco_compatible_str_new(&err_msg);
                 callback(err_ptr, std::ptr::null());
             }
+        },
+    );
+}
+
+// === Streams ===
+//
+// createReadStream/createWriteStream return a numeric handle. A read stream
+// hands out one chunk per call through a buffer allocated once for the life
+// of the stream, and a write stream batches writes in a fixed-size buffer,
+// so files of any size are processed in constant memory.
+
+const DEFAULT_CHUNK_SIZE: usize = 64 * 1024;
+
+enum Stream {
+    Read {
+        file: File,
+        /// Reused for every chunk. The first `carry` bytes are the start of
+        /// a UTF-8 sequence split by the previous chunk boundary.
+        buf: Vec<u8>,
+        carry: usize,
+        chunk_size: usize,
+    },
+    Write(BufWriter<File>),
+}
+
+static STREAMS: Mutex<Option<HashMap<i64, Stream>>> = Mutex::new(None);
+static NEXT_STREAM: AtomicI64 = AtomicI64::new(1);
+
+fn register_stream(stream: Stream) -> f64 {
+    let handle = NEXT_STREAM.fetch_add(1, Ordering::Relaxed);
+    STREAMS.lock().unwrap().get_or_insert_with(HashMap::new).insert(handle, stream);
+    handle as f64
+}
+
+fn chunk_size_arg(chunk_size: f64) -> usize {
+    if chunk_size >= 1.0 { chunk_size as usize } else { DEFAULT_CHUNK_SIZE }
+}
+
+/// Open `path` for chunked reading; `chunk_size` <= 0 selects 64 KiB.
+/// Returns a stream handle, or -1 on error.
+#[no_mangle]
+pub extern "C" fn zaco_fs_create_read_stream(path: *const c_char, chunk_size: f64) -> f64 {
+    let path_str = unsafe { crate::cstr_to_str(path) };
+    match File::open(path_str) {
+        Ok(file) => {
+            let chunk_size = chunk_size_arg(chunk_size);
+            // Room for a chunk plus up to three carried bytes
+            let buf = vec![0u8; chunk_size + 3];
+            register_stream(Stream::Read { file, buf, carry: 0, chunk_size })
         }
-    });
+        Err(e) => {
+            eprintln!("Error opening file '{}': {}", path_str, e);
+            -1.0
+        }
+    }
+}
+
+/// Open `path` for buffered writing, truncating it unless `append` is set.
+/// Returns a stream handle, or -1 on error.
+#[no_mangle]
+pub extern "C" fn zaco_fs_create_write_stream(path: *const c_char, append: i64) -> f64 {
+    let path_str = unsafe { crate::cstr_to_str(path) };
+    let file = OpenOptions::new()
+        .write(true)
+        .create(true)
+        .append(append != 0)
+        .truncate(append == 0)
+        .open(path_str);
+    match file {
+        Ok(file) => register_stream(Stream::Write(BufWriter::with_capacity(DEFAULT_CHUNK_SIZE, file))),
+        Err(e) => {
+            eprintln!("Error opening file '{}': {}", path_str, e);
+            -1.0
+        }
+    }
+}
+
+/// Next chunk of a read stream as a string; the empty string at end of file.
+/// Chunks never split a UTF-8 sequence.
+#[no_mangle]
+pub extern "C" fn zaco_fs_read_chunk(handle: f64) -> *mut c_char {
+    let mut streams = STREAMS.lock().unwrap();
+    let Some(Stream::Read { file, buf, carry, chunk_size }) =
+        streams.as_mut().and_then(|s| s.get_mut(&(handle as i64)))
+    else {
+        return crate::zaco_compatible_str_new("");
+    };
+
+    // One read normally fills the chunk. A short read (small chunk sizes,
+    // pipes) can stop inside a UTF-8 sequence; then keep reading, past the
+    // chunk size if needed, until a whole character is available, so ""
+    // is only ever returned at end of file
+    let mut filled = *carry;
+    let mut end = *carry + *chunk_size;
+    let mut at_eof = false;
+    let valid = loop {
+        if filled < end {
+            match file.read(&mut buf[filled..end]) {
+                Ok(0) => at_eof = true,
+                Ok(n) => filled += n,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => continue,
+                Err(e) => {
+                    eprintln!("Error reading stream: {}", e);
+                    at_eof = true;
+                }
+            }
+        }
+        match std::str::from_utf8(&buf[..filled]) {
+            Ok(_) => break filled,
+            // Hold back a sequence cut off by the chunk boundary
+            Err(e) if e.error_len().is_none() && !at_eof && e.valid_up_to() > 0 => break e.valid_up_to(),
+            Err(e) if e.error_len().is_none() && !at_eof && filled < buf.len() => end = buf.len(),
+            Err(_) => {
+                let chunk = crate::zaco_compatible_str_new(&String::from_utf8_lossy(&buf[..filled]));
+                *carry = 0;
+                return chunk;
+            }
+        }
+    };
+    let chunk = crate::zaco_compatible_str_new(unsafe { std::str::from_utf8_unchecked(&buf[..valid]) });
+    buf.copy_within(valid..filled, 0);
+    *carry = filled - valid;
+    chunk
+}
+
+/// Append `data` to a write stream.
+#[no_mangle]
+pub extern "C" fn zaco_fs_write_chunk(handle: f64, data: *const c_char) {
+    let data_str = unsafe { crate::cstr_to_str(data) };
+    let mut streams = STREAMS.lock().unwrap();
+    if let Some(Stream::Write(writer)) = streams.as_mut().and_then(|s| s.get_mut(&(handle as i64))) {
+        if let Err(e) = writer.write_all(data_str.as_bytes()) {
+            eprintln!("Error writing stream: {}", e);
+        }
+    }
+}
+
+/// Close a stream, flushing buffered writes.
+#[no_mangle]
+pub extern "C" fn zaco_fs_close_stream(handle: f64) {
+    let stream = STREAMS.lock().unwrap().as_mut().and_then(|s| s.remove(&(handle as i64)));
+    if let Some(Stream::Write(mut writer)) = stream {
+        if let Err(e) = writer.flush() {
+            eprintln!("Error writing stream: {}", e);
+        }
+    }
 }
@@ -1,123 +1,378 @@
 //! HTTP client implementation using reqwest
-//! Provides both synchronous and asynchronous HTTP operations
+//!
+//! Every request goes through a long-lived `reqwest::Client`, so connections
+//! stay alive in a per-host pool and HTTPS origins that negotiate HTTP/2
+//! multiplex concurrent requests over one connection instead of paying a
+//! TCP+TLS handshake each. The URL-only calls share one process-wide client;
+//! `zaco_http_client_new` creates a client with its own pool. A request
+//! yields a single `ZacoHttpResponse` holding status, headers and body, so
+//! reading metadata never re-issues the request.
 
 use std::os::raw::{c_char, c_void};
-use std::collections::HashMap;
+use std::sync::OnceLock;
+use std::time::Duration;
+
+use reqwest::header::CONTENT_TYPE;
+use reqwest::Method;
 
 use crate::event_loop;
 
-/// HTTP GET request (synchronous)
-#[no_mangle]
-pub extern "C" fn zaco_http_get(url: *const c_char) -> *mut c_char {
-    let url_str = unsafe { crate::cstr_to_str(url) };
-    if url_str.is_empty() {
-        return std::ptr::null_mut();
+/// Idle connections kept per host when the caller does not choose
+const DEFAULT_MAX_IDLE_PER_HOST: usize = 32;
+/// How long an idle pooled connection is kept before it is closed
+const POOL_IDLE_TIMEOUT: Duration = Duration::from_secs(90);
+/// TCP keep-alive probe interval for pooled connections
+const TCP_KEEPALIVE: Duration = Duration::from_secs(60);
+
+/// A persistent HTTP client: one connection pool shared by its requests.
+pub struct ZacoHttpClient {
+    client: reqwest::Client,
+}
+
+impl ZacoHttpClient {
+    fn new(max_idle_per_host: usize) -> Self {
+        let client = reqwest::Client::builder()
+            .pool_max_idle_per_host(max_idle_per_host)
+            .pool_idle_timeout(POOL_IDLE_TIMEOUT)
+            .tcp_keepalive(TCP_KEEPALIVE)
+            .tcp_nodelay(true)
+            .http2_adaptive_window(true)
+            .build()
+            .unwrap_or_else(|_| reqwest::Client::new());
+        ZacoHttpClient { client }
     }
+}
 
-    match reqwest::blocking::get(url_str) {
-        Ok(response) => match response.text() {
-            Ok(body) => crate::zaco_compatible_str_new(&body),
-            Err(_) => std::ptr::null_mut(),
-        },
-        Err(_) => std::ptr::null_mut(),
+/// The client behind the URL-only calls and a null client handle.
+fn shared_client() -> &'static ZacoHttpClient {
+    static CLIENT: OnceLock<ZacoHttpClient> = OnceLock::new();
+    CLIENT.get_or_init(|| ZacoHttpClient::new(DEFAULT_MAX_IDLE_PER_HOST))
+}
+
+fn client_or_shared<'a>(client: *const ZacoHttpClient) -> &'a ZacoHttpClient {
+    if client.is_null() {
+        shared_client()
+    } else {
+        unsafe { &*client }
     }
 }
 
-/// HTTP POST request (synchronous)
+/// A completed HTTP response.
+pub struct ZacoHttpResponse {
+    status: u16,
+    /// Header names are lowercase, in the order received
+    headers: Vec<(String, String)>,
+    body: String,
+}
+
+impl ZacoHttpResponse {
+    /// All values of header `name`, joined with ", " as Node does.
+    fn header(&self, name: &str) -> Option<String> {
+        let mut values = self
+            .headers
+            .iter()
+            .filter(|(n, _)| n.eq_ignore_ascii_case(name))
+            .map(|(_, v)| v.as_str());
+        let first = values.next()?;
+        Some(values.fold(first.to_string(), |mut joined, v| {
+            joined.push_str(", ");
+            joined.push_str(v);
+            joined
+        }))
+    }
+
+    fn headers_json(&self) -> String {
+        let mut map = serde_json::Map::new();
+        for (name, _) in &self.headers {
+            if !map.contains_key(name) {
+                map.insert(name.clone(), self.header(name).unwrap_or_default().into());
+            }
+        }
+        serde_json::Value::Object(map).to_string()
+    }
+}
+
+/// Request parameters, copied out of the C strings so they can move to Tokio.
+struct RequestSpec {
+    method: Method,
+    url: String,
+    body: Option<String>,
+    content_type: String,
+}
+
+impl RequestSpec {
+    /// An empty method means GET; a null body sends none.
+    unsafe fn from_c(
+        method: *const c_char,
+        url: *const c_char,
+        body: *const c_char,
+        content_type: *const c_char,
+    ) -> Option<Self> {
+        let url = crate::cstr_to_str(url);
+        if url.is_empty() {
+            return None;
+        }
+        let method = match crate::cstr_to_str(method) {
+            "" => Method::GET,
+            m => Method::from_bytes(m.to_ascii_uppercase().as_bytes()).ok()?,
+        };
+        Some(RequestSpec {
+            method,
+            url: url.to_string(),
+            body: (!body.is_null()).then(|| crate::cstr_to_str(body).to_string()),
+            content_type: crate::cstr_to_str(content_type).to_string(),
+        })
+    }
+
+    fn new(method: Method, url: *const c_char, body: Option<&str>, content_type: &str) -> Option<Self> {
+        let url = unsafe { crate::cstr_to_str(url) };
+        if url.is_empty() {
+            return None;
+        }
+        Some(RequestSpec {
+            method,
+            url: url.to_string(),
+            body: body.map(str::to_string),
+            content_type: content_type.to_string(),
+        })
+    }
+
+    async fn send(self, client: reqwest::Client) -> Option<ZacoHttpResponse> {
+        let mut request = client.request(self.method, &self.url);
+        if !self.content_type.is_empty() {
+            request = request.header(CONTENT_TYPE, self.content_type);
+        }
+        if let Some(body) = self.body {
+            request = request.body(body);
+        }
+
+        let response = request.send().await.ok()?;
+        let status = response.status().as_u16();
+        let headers = response
+            .headers()
+            .iter()
+            .filter_map(|(name, value)| {
+                value.to_str().ok().map(|v| (name.as_str().to_string(), v.to_string()))
+            })
+            .collect();
+        let body = response.text().await.ok()?;
+        Some(ZacoHttpResponse { status, headers, body })
+    }
+}
+
+/// Run a request to completion on the calling thread.
+fn perform(client: &ZacoHttpClient, spec: Option<RequestSpec>) -> Option<ZacoHttpResponse> {
+    let spec = spec?;
+    event_loop::block_on(spec.send(client.client.clone()))
+}
+
+fn body_or_null(response: Option<ZacoHttpResponse>) -> *mut c_char {
+    match response {
+        Some(response) => crate::zaco_compatible_str_new(&response.body),
+        None => std::ptr::null_mut(),
+    }
+}
+
+/// Create a persistent client with its own connection pool.
+/// `max_idle_per_host <= 0` uses the default pool size.
 #[no_mangle]
-pub extern "C" fn zaco_http_post(
+pub extern "C" fn zaco_http_client_new(max_idle_per_host: i64) -> *mut ZacoHttpClient {
+    let max_idle = if max_idle_per_host > 0 {
+        max_idle_per_host as usize
+    } else {
+        DEFAULT_MAX_IDLE_PER_HOST
+    };
+    Box::into_raw(Box::new(ZacoHttpClient::new(max_idle)))
+}
+
+/// Free a client; its idle connections are closed. In-flight async
+/// requests keep their own reference to the pool.
+#[no_mangle]
+pub extern "C" fn zaco_http_client_free(client: *mut ZacoHttpClient) {
+    if !client.is_null() {
+        unsafe {
+            let _ = Box::from_raw(client);
+        }
+    }
+}
+
+/// Perform a request (synchronous). `client` may be null for the shared
+/// client. Returns null on a network error or an invalid method/URL; any
+/// HTTP status, including 4xx/5xx, yields a response.
+#[no_mangle]
+pub extern "C" fn zaco_http_request(
+    client: *const ZacoHttpClient,
+    method: *const c_char,
     url: *const c_char,
     body: *const c_char,
     content_type: *const c_char,
-) -> *mut c_char {
-    let url_str = unsafe { crate::cstr_to_str(url) };
-    let body_str = unsafe { crate::cstr_to_str(body) };
-    let content_type_str = unsafe { crate::cstr_to_str(content_type) };
-
-    if url_str.is_empty() {
-        return std::ptr::null_mut();
+) -> *mut ZacoHttpResponse {
+    let spec = unsafe { RequestSpec::from_c(method, url, body, content_type) };
+    match perform(client_or_shared(client), spec) {
+        Some(response) => Box::into_raw(Box::new(response)),
+        None => std::ptr::null_mut(),
     }
+}
 
-    let client = reqwest::blocking::Client::new();
-    let mut request = client.post(url_str);
+/// Callback for async requests: receives the response (null on error)
+type ResponseCallback = extern "C" fn(*mut ZacoHttpResponse, *mut c_void);
 
-    if !content_type_str.is_empty() {
-        request = request.header("Content-Type", content_type_str);
-    }
+/// Perform a request on Tokio; the callback runs on the JS thread and owns
+/// the response.
+#[no_mangle]
+pub extern "C" fn zaco_http_request_async(
+    client: *const ZacoHttpClient,
+    method: *const c_char,
+    url: *const c_char,
+    body: *const c_char,
+    content_type: *const c_char,
+    callback: ResponseCallback,
+    context: *mut c_void,
+) {
+    let spec = unsafe { RequestSpec::from_c(method, url, body, content_type) };
+    let client = client_or_shared(client).client.clone();
+    let context_addr = context as usize;
 
-    match request.body(body_str.to_string()).send() {
-        Ok(response) => match response.text() {
-            Ok(body) => crate::zaco_compatible_str_new(&body),
-            Err(_) => std::ptr::null_mut(),
+    event_loop::spawn_io(
+        async move {
+            match spec {
+                Some(spec) => spec.send(client).await,
+                None => None,
+            }
         },
-        Err(_) => std::ptr::null_mut(),
-    }
+        move |response| {
+            let response = match response {
+                Some(response) => Box::into_raw(Box::new(response)),
+                None => std::ptr::null_mut(),
+            };
+            callback(response, context_addr as *mut c_void);
+        },
+    );
 }
 
-/// HTTP GET with status code
+/// Response status code, or -1 for a null response
 #[no_mangle]
-pub extern "C" fn zaco_http_get_status(url: *const c_char) -> i64 {
-    let url_str = unsafe { crate::cstr_to_str(url) };
-    if url_str.is_empty() {
+pub extern "C" fn zaco_http_response_status(response: *const ZacoHttpResponse) -> i64 {
+    if response.is_null() {
         return -1;
     }
+    unsafe { (*response).status as i64 }
+}
 
-    match reqwest::blocking::get(url_str) {
-        Ok(response) => response.status().as_u16() as i64,
-        Err(_) => -1,
+/// Value of one response header (case-insensitive), or null if absent
+#[no_mangle]
+pub extern "C" fn zaco_http_response_header(
+    response: *const ZacoHttpResponse,
+    name: *const c_char,
+) -> *mut c_char {
+    if response.is_null() {
+        return std::ptr::null_mut();
+    }
+    let name = unsafe { crate::cstr_to_str(name) };
+    match unsafe { (*response).header(name) } {
+        Some(value) => crate::zaco_compatible_str_new(&value),
+        None => std::ptr::null_mut(),
     }
 }
 
-/// HTTP GET response headers (returns JSON string of headers)
+/// All response headers as a JSON object string
 #[no_mangle]
-pub extern "C" fn zaco_http_get_headers(url: *const c_char) -> *mut c_char {
-    let url_str = unsafe { crate::cstr_to_str(url) };
-    if url_str.is_empty() {
+pub extern "C" fn zaco_http_response_headers(response: *const ZacoHttpResponse) -> *mut c_char {
+    if response.is_null() {
         return std::ptr::null_mut();
     }
+    crate::zaco_compatible_str_new(&unsafe { (*response).headers_json() })
+}
 
-    match reqwest::blocking::get(url_str) {
-        Ok(response) => {
-            let mut headers_map: HashMap<String, String> = HashMap::new();
-            for (name, value) in response.headers() {
-                if let Ok(value_str) = value.to_str() {
-                    headers_map.insert(name.to_string(), value_str.to_string());
-                }
-            }
+/// Response body as a string
+#[no_mangle]
+pub extern "C" fn zaco_http_response_body(response: *const ZacoHttpResponse) -> *mut c_char {
+    if response.is_null() {
+        return std::ptr::null_mut();
+    }
+    crate::zaco_compatible_str_new(unsafe { &(*response).body })
+}
 
-            match serde_json::to_string(&headers_map) {
-                Ok(json) => crate::zaco_compatible_str_new(&json),
-                Err(_) => std::ptr::null_mut(),
-            }
+/// Free a response
+#[no_mangle]
+pub extern "C" fn zaco_http_response_free(response: *mut ZacoHttpResponse) {
+    if !response.is_null() {
+        unsafe {
+            let _ = Box::from_raw(response);
         }
-        Err(_) => std::ptr::null_mut(),
+    }
+}
+
+/// HTTP GET request (synchronous)
+#[no_mangle]
+pub extern "C" fn zaco_http_get(url: *const c_char) -> *mut c_char {
+    body_or_null(perform(shared_client(), RequestSpec::new(Method::GET, url, None, "")))
+}
+
+/// HTTP POST request (synchronous)
+#[no_mangle]
+pub extern "C" fn zaco_http_post(
+    url: *const c_char,
+    body: *const c_char,
+    content_type: *const c_char,
+) -> *mut c_char {
+    let body_str = unsafe { crate::cstr_to_str(body) };
+    let content_type_str = unsafe { crate::cstr_to_str(content_type) };
+    let spec = RequestSpec::new(Method::POST, url, Some(body_str), content_type_str);
+    body_or_null(perform(shared_client(), spec))
+}
+
+/// HTTP GET with status code. Prefer `zaco_http_request`, which returns
+/// status, headers and body from one request.
+#[no_mangle]
+pub extern "C" fn zaco_http_get_status(url: *const c_char) -> i64 {
+    match perform(shared_client(), RequestSpec::new(Method::GET, url, None, "")) {
+        Some(response) => response.status as i64,
+        None => -1,
+    }
+}
+
+/// HTTP GET response headers (returns JSON string of headers). Prefer
+/// `zaco_http_request`, which returns status, headers and body from one
+/// request.
+#[no_mangle]
+pub extern "C" fn zaco_http_get_headers(url: *const c_char) -> *mut c_char {
+    match perform(shared_client(), RequestSpec::new(Method::GET, url, None, "")) {
+        Some(response) => crate::zaco_compatible_str_new(&response.headers_json()),
+        None => std::ptr::null_mut(),
     }
 }
 
 /// Callback function type for async operations
 type AsyncCallback = extern "C" fn(i64, *mut c_char, *mut c_void);
 
-/// Async HTTP GET (uses Tokio)
+/// Async HTTP GET (uses Tokio; the callback runs on the JS thread with the
+/// status code, or -1 and a null body on error)
 #[no_mangle]
 pub extern "C" fn zaco_http_get_async(
     url: *const c_char,
     callback: AsyncCallback,
     context: *mut c_void,
 ) {
-    let url_str = unsafe { crate::cstr_to_str(url) }.to_string();
+    let spec = RequestSpec::new(Method::GET, url, None, "");
+    let client = shared_client().client.clone();
     let context_addr = context as usize;
 
-    event_loop::spawn(async move {
-        let result = match reqwest::get(&url_str).await {
-            Ok(response) => match response.text().await {
-                Ok(body) => crate::zaco_compatible_str_new(&body),
-                Err(_) => std::ptr::null_mut(),
-            },
-            Err(_) => std::ptr::null_mut(),
-        };
-
-        callback(0, result, context_addr as *mut c_void);
-    });
+    event_loop::spawn_io(
+        async move {
+            match spec {
+                Some(spec) => spec.send(client).await,
+                None => None,
+            }
+        },
+        move |response| {
+            let (status, body) = match response {
+                Some(response) => (response.status as i64, crate::zaco_compatible_str_new(&response.body)),
+                None => (-1, std::ptr::null_mut()),
+            };
+            callback(status, body, context_addr as *mut c_void);
+        },
+    );
 }
 
 /// HTTP PUT request (synchronous)
@@ -127,44 +382,14 @@ pub extern "C" fn zaco_http_put(
     body: *const c_char,
     content_type: *const c_char,
 ) -> *mut c_char {
-    let url_str = unsafe { crate::cstr_to_str(url) };
     let body_str = unsafe { crate::cstr_to_str(body) };
     let content_type_str = unsafe { crate::cstr_to_str(content_type) };
-
-    if url_str.is_empty() {
-        return std::ptr::null_mut();
-    }
-
-    let client = reqwest::blocking::Client::new();
-    let mut request = client.put(url_str);
-
-    if !content_type_str.is_empty() {
-        request = request.header("Content-Type", content_type_str);
-    }
-
-    match request.body(body_str.to_string()).send() {
-        Ok(response) => match response.text() {
-            Ok(body) => crate::zaco_compatible_str_new(&body),
-            Err(_) => std::ptr::null_mut(),
-        },
-        Err(_) => std::ptr::null_mut(),
-    }
+    let spec = RequestSpec::new(Method::PUT, url, Some(body_str), content_type_str);
+    body_or_null(perform(shared_client(), spec))
 }
 
 /// HTTP DELETE request (synchronous)
 #[no_mangle]
 pub extern "C" fn zaco_http_delete(url: *const c_char) -> *mut c_char {
-    let url_str = unsafe { crate::cstr_to_str(url) };
-    if url_str.is_empty() {
-        return std::ptr::null_mut();
-    }
-
-    let client = reqwest::blocking::Client::new();
-    match client.delete(url_str).send() {
-        Ok(response) => match response.text() {
-            Ok(body) => crate::zaco_compatible_str_new(&body),
-            Err(_) => std::ptr::null_mut(),
-        },
-        Err(_) => std::ptr::null_mut(),
-    }
+    body_or_null(perform(shared_client(), RequestSpec::new(Method::DELETE, url, None, "")))
 }
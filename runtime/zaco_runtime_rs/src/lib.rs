@@ -9,7 +9,6 @@ mod process_api;
 mod os;
 mod http;
 mod events;
-mod timer;
 
 pub use event_loop::*;
 pub use promise::*;
@@ -19,7 +18,6 @@ pub use process_api::*;
 pub use os::*;
 pub use http::*;
 pub use events::*;
-pub use timer::*;
 
 use std::ffi::CStr;
 use std::os::raw::c_char;
@@ -31,32 +29,27 @@ pub(crate) unsafe fn cstr_to_str<'a>(ptr: *const c_char) -> &'a str {
     CStr::from_ptr(ptr).to_str().unwrap_or("")
 }
 
-/// Allocate a string using the same memory layout as the C runtime's zaco_alloc.
-/// Layout: [ref_count: i64 = 1][size: i64 = len][data: char[len+1]]
-/// Returns a pointer to the data portion (offset 16), compatible with zaco_free/zaco_rc_inc/zaco_rc_dec.
+extern "C" {
+    /// Header-prefixed allocator from the C runtime (zaco_runtime.c).
+    fn zaco_alloc(size: i64) -> *mut std::os::raw::c_void;
+}
+
+/// Allocate a string through the C runtime's zaco_alloc so it lands in the
+/// same size-class pool and can be released with zaco_free/zaco_rc_dec.
+/// Layout: [ref_count: i64 = 1][size: i64 = len + 1][data: char[len+1]]
+/// Returns a pointer to the data portion (offset 16).
 pub(crate) fn zaco_compatible_str_new(s: &str) -> *mut c_char {
     let len = s.len();
-    let total = 16 + len + 1; // header + data + null terminator
     unsafe {
-        let layout = std::alloc::Layout::from_size_align(total, 8).unwrap();
-        let base = std::alloc::alloc_zeroed(layout);
-        if base.is_null() {
-            std::alloc::handle_alloc_error(layout);
-        }
-        // Write ref_count = 1 at offset 0
-        *(base as *mut i64) = 1;
-        // Write size = len at offset 8
-        *((base as *mut i64).add(1)) = len as i64;
-        // Copy string data at offset 16
-        let data_ptr = base.add(16);
+        // zaco_alloc zero-fills, so the null terminator is already in place
+        let data_ptr = zaco_alloc(len as i64 + 1) as *mut u8;
         std::ptr::copy_nonoverlapping(s.as_ptr(), data_ptr, len);
-        // Null terminator (already zeroed, but be explicit)
-        *data_ptr.add(len) = 0;
         data_ptr as *mut c_char
     }
 }
 
-/// Initialize the Tokio runtime (called once at program start)
+/// Initialize the Tokio runtime and bind the JS event loop to this thread
+/// (called once at program start)
 #[no_mangle]
 pub extern "C" fn zaco_runtime_init() {
     event_loop::init_runtime();
@@ -1,7 +1,22 @@
 //! Promise implementation for async/await support
+//!
+//! Promises are settled and observed on the JS thread. Reactions registered
+//! with then/catch/finally run as microtasks on the event loop. An `await`
+//! inside an async function suspends its state machine until the promise
+//! settles; only a top-level `await` keeps running the event loop in place.
 
-use std::sync::{Mutex, Condvar};
 use std::ffi::c_void;
+use std::sync::Mutex;
+
+use crate::event_loop;
+
+extern "C" {
+    fn zaco_profile_count(counter: i64, n: i64);
+    fn zaco_throw(error: *mut c_void);
+}
+
+/// `ZACO_COUNT_PROMISES` in zaco_runtime.c
+const COUNT_PROMISES: i64 = 9;
 
 /// Promise state
 #[derive(Clone, Copy, PartialEq)]
@@ -11,55 +26,185 @@ enum PromiseState {
     Rejected,
 }
 
-/// Promise implementation using condition variables for blocking await
+/// Compiled callback: `f(env, value)` for closures with captures, `f(value)`
+/// otherwise (the closure's environment is only passed when it has one).
+#[derive(Clone, Copy)]
+struct Handler {
+    func: usize,
+    env: usize,
+}
+
+impl Handler {
+    fn call(&self, value: *mut c_void) -> *mut c_void {
+        unsafe {
+            if self.env != 0 {
+                let f: extern "C" fn(*mut c_void, *mut c_void) -> *mut c_void =
+                    std::mem::transmute(self.func);
+                f(self.env as *mut c_void, value)
+            } else {
+                let f: extern "C" fn(*mut c_void) -> *mut c_void = std::mem::transmute(self.func);
+                f(value)
+            }
+        }
+    }
+
+    /// Continue a suspended async function: `resume(frame, value)`.
+    fn resume(&self, value: *mut c_void) {
+        unsafe {
+            let f: extern "C" fn(*mut c_void, *mut c_void) = std::mem::transmute(self.func);
+            f(self.env as *mut c_void, value)
+        }
+    }
+}
+
+#[derive(Clone, Copy)]
+enum ReactionKind {
+    Then,
+    Catch,
+    Finally,
+    /// An async function suspended on the promise; its handler is the
+    /// resume function and frame, and there is no derived promise
+    Await,
+}
+
+/// A then/catch/finally registration and the promise it settles.
+#[derive(Clone, Copy)]
+struct Reaction {
+    kind: ReactionKind,
+    handler: Option<Handler>,
+    derived: usize,
+}
+
+struct PromiseInner {
+    state: PromiseState,
+    value: usize,
+    reactions: Vec<Reaction>,
+}
+
 pub struct ZacoPromise {
-    state: Mutex<PromiseState>,
-    value: Mutex<Option<*mut c_void>>,
-    condvar: Condvar,
+    inner: Mutex<PromiseInner>,
 }
 
 impl ZacoPromise {
     fn new() -> Self {
         ZacoPromise {
-            state: Mutex::new(PromiseState::Pending),
-            value: Mutex::new(None),
-            condvar: Condvar::new(),
+            inner: Mutex::new(PromiseInner {
+                state: PromiseState::Pending,
+                value: 0,
+                reactions: Vec::new(),
+            }),
         }
     }
 
-    fn resolve(&self, value: *mut c_void) {
-        let mut state = self.state.lock().unwrap();
-        if *state == PromiseState::Pending {
-            *state = PromiseState::Resolved;
-            *self.value.lock().unwrap() = Some(value);
-            self.condvar.notify_all();
+    fn settle(&self, state: PromiseState, value: *mut c_void) {
+        let reactions = {
+            let mut inner = self.inner.lock().unwrap();
+            if inner.state != PromiseState::Pending {
+                return;
+            }
+            inner.state = state;
+            inner.value = value as usize;
+            std::mem::take(&mut inner.reactions)
+        };
+        for reaction in reactions {
+            schedule_reaction(reaction, state, value as usize);
         }
     }
 
+    fn resolve(&self, value: *mut c_void) {
+        self.settle(PromiseState::Resolved, value);
+    }
+
     fn reject(&self, error: *mut c_void) {
-        let mut state = self.state.lock().unwrap();
-        if *state == PromiseState::Pending {
-            *state = PromiseState::Rejected;
-            *self.value.lock().unwrap() = Some(error);
-            self.condvar.notify_all();
-        }
+        self.settle(PromiseState::Rejected, error);
     }
 
-    fn wait(&self) -> *mut c_void {
-        let mut state = self.state.lock().unwrap();
-        while *state == PromiseState::Pending {
-            state = self.condvar.wait(state).unwrap();
+    fn settled(&self) -> bool {
+        self.inner.lock().unwrap().state != PromiseState::Pending
+    }
+
+    fn value(&self) -> *mut c_void {
+        self.inner.lock().unwrap().value as *mut c_void
+    }
+
+    /// Register a reaction settling a new derived promise.
+    fn react(&self, kind: ReactionKind, handler: Option<Handler>) -> *mut ZacoPromise {
+        let derived = Box::into_raw(Box::new(ZacoPromise::new())) as usize;
+        self.add_reaction(Reaction { kind, handler, derived });
+        derived as *mut ZacoPromise
+    }
+
+    /// Queue a reaction, scheduling it right away if already settled.
+    fn add_reaction(&self, reaction: Reaction) {
+        let mut inner = self.inner.lock().unwrap();
+        if inner.state == PromiseState::Pending {
+            inner.reactions.push(reaction);
+        } else {
+            let (state, value) = (inner.state, inner.value);
+            drop(inner);
+            schedule_reaction(reaction, state, value);
         }
-        self.value.lock().unwrap().unwrap_or(std::ptr::null_mut())
     }
 }
 
 unsafe impl Send for ZacoPromise {}
 unsafe impl Sync for ZacoPromise {}
 
+/// Run a reaction as a microtask and settle its derived promise with the
+/// outcome. Reactions fire on the JS thread: a promise settled elsewhere
+/// posts them to the loop first.
+fn schedule_reaction(reaction: Reaction, state: PromiseState, value: usize) {
+    let run = move || {
+        let value_ptr = value as *mut c_void;
+        if let (ReactionKind::Await, Some(h)) = (reaction.kind, reaction.handler) {
+            resume_awaiter(h, state, value_ptr);
+            return;
+        }
+        let derived = unsafe { &*(reaction.derived as *const ZacoPromise) };
+        match (reaction.kind, reaction.handler, state) {
+            (ReactionKind::Then, Some(h), PromiseState::Resolved)
+            | (ReactionKind::Catch, Some(h), PromiseState::Rejected) => {
+                derived.resolve(h.call(value_ptr));
+            }
+            (ReactionKind::Finally, Some(h), _) => {
+                h.call(std::ptr::null_mut());
+                derived.settle(state, value_ptr);
+            }
+            _ => derived.settle(state, value_ptr),
+        }
+    };
+    if event_loop::is_js_thread() {
+        event_loop::queue_microtask(run);
+    } else {
+        event_loop::post_to_js(run);
+    }
+}
+
+/// Resume an async function with the value its awaited promise fulfilled
+/// with. A rejection resumes it with the error thrown, so the `await` raises
+/// it: a surrounding try catches it, and otherwise the function rejects its
+/// own promise and drops its frame.
+fn resume_awaiter(awaiter: Handler, state: PromiseState, value: *mut c_void) {
+    if state == PromiseState::Resolved {
+        awaiter.resume(value);
+        return;
+    }
+    unsafe { zaco_throw(value) };
+    awaiter.resume(std::ptr::null_mut());
+}
+
+fn handler(callback: *mut c_void, context: *mut c_void) -> Option<Handler> {
+    if callback.is_null() {
+        None
+    } else {
+        Some(Handler { func: callback as usize, env: context as usize })
+    }
+}
+
 /// Create a new pending promise
 #[no_mangle]
 pub extern "C" fn zaco_promise_new() -> *mut ZacoPromise {
+    unsafe { zaco_profile_count(COUNT_PROMISES, 1) };
     Box::into_raw(Box::new(ZacoPromise::new()))
 }
 
@@ -85,19 +230,90 @@ pub extern "C" fn zaco_promise_reject(promise: *mut ZacoPromise, error: *mut c_v
     }
 }
 
-/// Block on a promise until it resolves or rejects (returns the value/error)
+/// promise.then(callback) -> derived promise
+#[no_mangle]
+pub extern "C" fn zaco_promise_then(
+    promise: *mut ZacoPromise,
+    callback: *mut c_void,
+    context: *mut c_void,
+) -> *mut ZacoPromise {
+    if promise.is_null() {
+        return std::ptr::null_mut();
+    }
+    unsafe { (*promise).react(ReactionKind::Then, handler(callback, context)) }
+}
+
+/// promise.catch(callback) -> derived promise
+#[no_mangle]
+pub extern "C" fn zaco_promise_catch(
+    promise: *mut ZacoPromise,
+    callback: *mut c_void,
+    context: *mut c_void,
+) -> *mut ZacoPromise {
+    if promise.is_null() {
+        return std::ptr::null_mut();
+    }
+    unsafe { (*promise).react(ReactionKind::Catch, handler(callback, context)) }
+}
+
+/// promise.finally(callback) -> derived promise
+#[no_mangle]
+pub extern "C" fn zaco_promise_finally(
+    promise: *mut ZacoPromise,
+    callback: *mut c_void,
+    context: *mut c_void,
+) -> *mut ZacoPromise {
+    if promise.is_null() {
+        return std::ptr::null_mut();
+    }
+    unsafe { (*promise).react(ReactionKind::Finally, handler(callback, context)) }
+}
+
+/// Suspend an async function on a promise. `resume(frame, value)` runs as a
+/// microtask once the promise settles — never synchronously, even if it
+/// already has — and the caller returns straight to the event loop.
+#[no_mangle]
+pub extern "C" fn zaco_async_await(
+    promise: *mut ZacoPromise,
+    resume: *mut c_void,
+    frame: *mut c_void,
+) {
+    let awaiter = Handler { func: resume as usize, env: frame as usize };
+    if promise.is_null() {
+        // Awaiting nothing resumes with undefined on the next microtask turn
+        event_loop::queue_microtask(move || awaiter.resume(std::ptr::null_mut()));
+        return;
+    }
+    let reaction = Reaction { kind: ReactionKind::Await, handler: Some(awaiter), derived: 0 };
+    unsafe { (*promise).add_reaction(reaction) }
+}
+
+/// The value an `await` resumed with. After a rejection the function
+/// resumes with the error pending (see `resume_awaiter`); compiled code tests
+/// for it after this call, so the error is thrown at the `await`.
+#[no_mangle]
+pub extern "C" fn zaco_async_resumed(value: *mut c_void) -> *mut c_void {
+    value
+}
+
+/// Wait for a promise (returns the value/error). Runs the event loop — timers,
+/// I/O completions, microtasks — until the promise settles, so nothing blocks
+/// on a condition variable. Returns null if the loop runs dry first.
 #[no_mangle]
 pub extern "C" fn zaco_async_block_on(promise: *mut ZacoPromise) -> *mut c_void {
     if promise.is_null() {
         return std::ptr::null_mut();
     }
-    unsafe {
-        (*promise).wait()
+    let promise = unsafe { &*promise };
+    if !promise.settled() {
+        event_loop::run_until(|| promise.settled());
     }
+    promise.value()
 }
 
 /// Spawn an async task (simplified version - just calls fn and resolves promise)
-/// In a real implementation, this would use tokio::spawn
+/// The async function body runs to completion synchronously; its awaits
+/// drive the event loop.
 #[no_mangle]
 pub extern "C" fn zaco_async_spawn(
     fn_ptr: extern "C" fn(*mut c_void) -> *mut c_void,
@@ -106,8 +322,6 @@ pub extern "C" fn zaco_async_spawn(
     let promise = ZacoPromise::new();
     let promise_ptr = Box::into_raw(Box::new(promise));
 
-    // For now, execute synchronously
-    // TODO: Use tokio::spawn for true async execution
     let result = fn_ptr(arg);
 
     unsafe {
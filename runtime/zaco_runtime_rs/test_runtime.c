@@ -3,6 +3,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+// C runtime allocator (strings returned by the Rust runtime come from zaco_alloc)
+extern void zaco_free(void* data_ptr);
+
 // Declare Rust runtime functions
 extern void zaco_runtime_init(void);
 extern void zaco_runtime_shutdown(void);
@@ -24,6 +27,12 @@ extern char* zaco_http_get(const char* url);
 extern char* zaco_http_post(const char* url, const char* body, const char* content_type);
 extern long long zaco_http_get_status(const char* url);
 extern char* zaco_http_get_headers(const char* url);
+extern void* zaco_http_request(void* client, const char* method, const char* url,
+                               const char* body, const char* content_type);
+extern long long zaco_http_response_status(const void* response);
+extern char* zaco_http_response_header(const void* response, const char* name);
+extern char* zaco_http_response_body(const void* response);
+extern void zaco_http_response_free(void* response);
 
 // Events module functions
 extern long long zaco_events_new(void);
@@ -63,15 +72,15 @@ int main() {
     printf("2. Testing path module:\n");
     char* joined = zaco_path_join("/usr/local", "bin/zaco");
     printf("   path.join('/usr/local', 'bin/zaco') = %s\n", joined);
-    free(joined);
+    zaco_free(joined);
 
     char* basename = zaco_path_basename("/path/to/file.ts");
     printf("   path.basename('/path/to/file.ts') = %s\n", basename);
-    free(basename);
+    zaco_free(basename);
 
     char* extname = zaco_path_extname("test.ts");
     printf("   path.extname('test.ts') = %s\n", extname);
-    free(extname);
+    zaco_free(extname);
 
     long long is_abs = zaco_path_is_absolute("/usr/bin");
     printf("   path.isAbsolute('/usr/bin') = %s\n", is_abs ? "true" : "false");
@@ -81,21 +90,21 @@ int main() {
     printf("3. Testing process module:\n");
     char* cwd = zaco_process_cwd();
     printf("   process.cwd() = %s\n", cwd);
-    free(cwd);
+    zaco_free(cwd);
 
     long long pid = zaco_process_pid();
     printf("   process.pid = %lld\n", pid);
 
     char* platform = zaco_process_platform();
     printf("   process.platform = %s\n", platform);
-    free(platform);
+    zaco_free(platform);
     printf("   ✓ Process operations working\n\n");
 
     // Test os module
     printf("4. Testing os module:\n");
     char* arch = zaco_os_arch();
     printf("   os.arch() = %s\n", arch);
-    free(arch);
+    zaco_free(arch);
 
     long long cpus = zaco_os_cpus();
     printf("   os.cpus().length = %lld\n", cpus);
@@ -115,7 +124,7 @@ int main() {
     char* content = zaco_fs_read_file_sync(test_file, "utf8");
     if (content) {
         printf("   fs.readFileSync('%s') = \"%s\"\n", test_file, content);
-        free(content);
+        zaco_free(content);
     }
     printf("   ✓ FS operations working\n\n");
 
@@ -137,7 +146,7 @@ int main() {
     char* response = zaco_http_get("https://httpbin.org/get");
     if (response) {
         printf("   http.get('https://httpbin.org/get') = %.100s...\n", response);
-        free(response);
+        zaco_free(response);
         printf("   ✓ HTTP GET test passed\n");
     } else {
         printf("   ✗ HTTP GET test failed\n");
@@ -151,7 +160,7 @@ int main() {
     );
     if (post_response) {
         printf("   http.post() = %.100s...\n", post_response);
-        free(post_response);
+        zaco_free(post_response);
         printf("   ✓ HTTP POST test passed\n");
     } else {
         printf("   ✗ HTTP POST test failed\n");
@@ -161,12 +170,27 @@ int main() {
     char* headers = zaco_http_get_headers("https://httpbin.org/headers");
     if (headers) {
         printf("   http.getHeaders() = %.100s...\n", headers);
-        free(headers);
+        zaco_free(headers);
         printf("   ✓ HTTP headers test passed\n");
     } else {
         printf("   ✗ HTTP headers test failed\n");
     }
 
+    // Test response object: status, headers and body from one request
+    void* res = zaco_http_request(NULL, "GET", "https://httpbin.org/get", NULL, NULL);
+    if (res) {
+        char* res_type = zaco_http_response_header(res, "Content-Type");
+        char* res_body = zaco_http_response_body(res);
+        printf("   http.request() status = %lld, content-type = %s\n",
+               zaco_http_response_status(res), res_type ? res_type : "(none)");
+        printf("   ✓ HTTP response object test passed\n");
+        if (res_type) zaco_free(res_type);
+        zaco_free(res_body);
+        zaco_http_response_free(res);
+    } else {
+        printf("   ✗ HTTP response object test failed\n");
+    }
+
     printf("   ✓ HTTP operations working\n\n");
 
     // Test Events module
@@ -4,6 +4,10 @@
  * Include this header when linking against libzaco_runtime_rs.a
  * All functions use C ABI and are compatible with Cranelift codegen.
  *
+ * Returned strings are allocated with the C runtime's zaco_alloc, so
+ * "caller must free" below means zaco_free()/zaco_rc_dec(), not free().
+ * The C runtime (runtime/zaco_runtime.c) must be linked in as well.
+ *
  * Linking on macOS requires:
  *   -framework CoreFoundation -framework Security -framework SystemConfiguration -lpthread -ldl
  *
@@ -264,6 +268,77 @@ char* zaco_os_eol(void);
 // HTTP Module (http.*)
 // ============================================================================
 
+/**
+ * Requests are sent through a long-lived client: connections are pooled per
+ * host and kept alive, and origins negotiating HTTP/2 multiplex concurrent
+ * requests over one connection. The URL-only functions share one
+ * process-wide client.
+ */
+typedef struct ZacoHttpClient ZacoHttpClient;
+typedef struct ZacoHttpResponse ZacoHttpResponse;
+
+/**
+ * Create a client with its own connection pool.
+ * max_idle_per_host: Idle connections kept per host (<= 0 for the default, 32)
+ * Returns: Client handle (free with zaco_http_client_free).
+ */
+ZacoHttpClient* zaco_http_client_new(long long max_idle_per_host);
+
+/**
+ * Free a client and close its idle connections.
+ */
+void zaco_http_client_free(ZacoHttpClient* client);
+
+/**
+ * Perform an HTTP request (synchronous).
+ * client: Client handle, or NULL for the shared client
+ * method: "GET", "POST", ... (case-insensitive; "" means GET)
+ * body: Request body, or NULL for none
+ * content_type: Content-Type header, or NULL/"" for none
+ * Returns: Response (free with zaco_http_response_free), or NULL on a network
+ * error or invalid method/URL. Every HTTP status yields a response.
+ */
+ZacoHttpResponse* zaco_http_request(ZacoHttpClient* client, const char* method, const char* url,
+                                    const char* body, const char* content_type);
+
+/**
+ * Perform an HTTP request asynchronously. The callback runs on the JS thread
+ * and owns the response (NULL on error).
+ */
+typedef void (*zaco_http_response_callback)(ZacoHttpResponse* response, void* context);
+void zaco_http_request_async(ZacoHttpClient* client, const char* method, const char* url,
+                             const char* body, const char* content_type,
+                             zaco_http_response_callback callback, void* context);
+
+/**
+ * Response status code, or -1 for a NULL response.
+ */
+long long zaco_http_response_status(const ZacoHttpResponse* response);
+
+/**
+ * Value of a response header (case-insensitive name; repeated headers are
+ * joined with ", ").
+ * Returns: Header value (caller must free), or NULL if absent.
+ */
+char* zaco_http_response_header(const ZacoHttpResponse* response, const char* name);
+
+/**
+ * All response headers as a JSON object.
+ * Returns: JSON string (caller must free).
+ */
+char* zaco_http_response_headers(const ZacoHttpResponse* response);
+
+/**
+ * Response body.
+ * Returns: Body string (caller must free).
+ */
+char* zaco_http_response_body(const ZacoHttpResponse* response);
+
+/**
+ * Free a response.
+ */
+void zaco_http_response_free(ZacoHttpResponse* response);
+
 /**
  * Perform HTTP GET request (synchronous).
  * Returns: Response body (caller must free), or NULL on error.
@@ -295,20 +370,24 @@ char* zaco_http_put(const char* url, const char* body, const char* content_type)
 char* zaco_http_delete(const char* url);
 
 /**
- * Perform HTTP GET and return only the status code.
+ * Perform HTTP GET and return only the status code. Issues its own request;
+ * use zaco_http_request to read status, headers and body from one request.
  * Returns: HTTP status code (200, 404, etc.), or -1 on error.
  */
 long long zaco_http_get_status(const char* url);
 
 /**
- * Perform HTTP GET and return response headers as JSON.
+ * Perform HTTP GET and return response headers as JSON. Issues its own
+ * request; use zaco_http_request to read status, headers and body from one
+ * request.
  * Returns: JSON string of headers (caller must free), or NULL on error.
  */
 char* zaco_http_get_headers(const char* url);
 
 /**
  * Perform HTTP GET asynchronously.
- * callback: Function to call when complete: void callback(i64 status, char* body, void* context)
+ * callback: Function to call when complete: void callback(i64 status, char* body, void* context);
+ *           status is -1 and body NULL on error
  * context: User data to pass to callback
  */
 typedef void (*zaco_http_callback)(long long status, char* body, void* context);